@@ -16,7 +16,7 @@ public class NVSceneCapturer : ModuleRules
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "Json", "JsonUtilities", "InputCore", "RHI", "RenderCore", "ShaderCore"});
         PublicDependencyModuleNames.AddRange(new string[] { "MovieSceneCapture", "ImageWrapper" });
 
-        PrivateDependencyModuleNames.AddRange(new string[] { "zlib", "UElibPNG" } );
+        PrivateDependencyModuleNames.AddRange(new string[] { "zlib", "UElibPNG", "Projects", "Renderer" } );
 
         if (Target.Type == TargetRules.TargetType.Editor)
         {
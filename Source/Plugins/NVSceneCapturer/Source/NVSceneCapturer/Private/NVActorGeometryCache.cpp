@@ -0,0 +1,616 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVActorGeometryCache.h"
+#include "NVSceneCapturerUtils.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Components/StaticMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/SkeletalMesh.h"
+#include "StaticMeshResources.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Async/ParallelFor.h"
+
+TMap<TWeakObjectPtr<UWorld>, TSharedPtr<FNVActorGeometryCache>> FNVActorGeometryCache::WorldCaches;
+FDelegateHandle FNVActorGeometryCache::WorldCleanupHandle;
+FCriticalSection FNVMeshOrientedBoundsCache::CacheCriticalSection;
+FCriticalSection FNVMeshHullCache::CacheCriticalSection;
+TMap<TWeakObjectPtr<const UObject>, FNVMeshHullCache::FCachedMeshHull> FNVMeshHullCache::CachedMeshHulls;
+FNVMeshOrientedBoundsCache::FCachedMeshBoundsMap FNVMeshOrientedBoundsCache::CachedMeshBounds;
+FNVMeshOrientedBoundsCache::FCachedMeshBoundsMap FNVMeshOrientedBoundsCache::CachedRenderVertexesPCAs;
+
+namespace
+{
+    // Get the static or skeletal mesh a mesh component is using
+    const UObject* GetMeshAsset(const UMeshComponent* MeshComp)
+    {
+        const UStaticMeshComponent* StaticMeshComp = Cast<UStaticMeshComponent>(MeshComp);
+        if (StaticMeshComp)
+        {
+            return StaticMeshComp->GetStaticMesh();
+        }
+        const USkeletalMeshComponent* SkeletalMeshComp = Cast<USkeletalMeshComponent>(MeshComp);
+        if (SkeletalMeshComp)
+        {
+            return SkeletalMeshComp->SkeletalMesh;
+        }
+        return nullptr;
+    }
+
+    // Get the render vertexes of a static mesh's LOD0
+    void GetMeshRenderVertexes(const UStaticMesh* StaticMesh, TArray<FVector>& OutVertexes)
+    {
+        const FStaticMeshRenderData* MeshRenderData = StaticMesh ? StaticMesh->RenderData.Get() : nullptr;
+        if (MeshRenderData && (MeshRenderData->LODResources.Num() > 0))
+        {
+            const FPositionVertexBuffer& MeshVertexBuffer = MeshRenderData->LODResources[0].VertexBuffers.PositionVertexBuffer;
+            const uint32 VertexesCount = MeshVertexBuffer.GetNumVertices();
+            OutVertexes.SetNumUninitialized(VertexesCount);
+            for (uint32 i = 0; i < VertexesCount; i++)
+            {
+                OutVertexes[i] = MeshVertexBuffer.VertexPosition(i);
+            }
+        }
+    }
+}
+
+//====================================== FNVMeshHull ==========================================
+FNVMeshHull::FNVMeshHull()
+    : VertexCount(0),
+    PaddedVertexCount(0),
+    SourceVertexCount(0)
+{
+}
+
+void FNVMeshHull::Build(const TArray<FVector>& SourceVertexes)
+{
+    SourceVertexCount = SourceVertexes.Num();
+
+    TArray<FVector> HullVertexes;
+    NVSceneCapturerUtils::ComputeConvexHullVertexes(SourceVertexes, 0, HullVertexes);
+    VertexCount = HullVertexes.Num();
+    PaddedVertexCount = Align(VertexCount, 4);
+
+    Vertexes.SetNumUninitialized(PaddedVertexCount * 3);
+    float* VertexesX = Vertexes.GetData();
+    float* VertexesY = VertexesX + PaddedVertexCount;
+    float* VertexesZ = VertexesY + PaddedVertexCount;
+    for (int32 i = 0; i < PaddedVertexCount; i++)
+    {
+        const FVector& HullVertex = HullVertexes[FMath::Min(i, VertexCount - 1)];
+        VertexesX[i] = HullVertex.X;
+        VertexesY[i] = HullVertex.Y;
+        VertexesZ[i] = HullVertex.Z;
+    }
+}
+
+void FNVMeshHull::TransformVertexes(const FMatrix& LocalToTargetMatrix, TArray<FVector>& OutVertexes) const
+{
+    OutVertexes.SetNumUninitialized(VertexCount);
+
+    const float* VertexesX = Vertexes.GetData();
+    const float* VertexesY = VertexesX + PaddedVertexCount;
+    const float* VertexesZ = VertexesY + PaddedVertexCount;
+    const FMatrix& M = LocalToTargetMatrix;
+    for (int32 i = 0; i < VertexCount; i++)
+    {
+        const float X = VertexesX[i];
+        const float Y = VertexesY[i];
+        const float Z = VertexesZ[i];
+        OutVertexes[i] = FVector(X * M.M[0][0] + Y * M.M[1][0] + Z * M.M[2][0] + M.M[3][0],
+                                 X * M.M[0][1] + Y * M.M[1][1] + Z * M.M[2][1] + M.M[3][1],
+                                 X * M.M[0][2] + Y * M.M[1][2] + Z * M.M[2][2] + M.M[3][2]);
+    }
+}
+
+FBox FNVMeshHull::GetTransformedBounds(const FMatrix& LocalToTargetMatrix) const
+{
+    FBox HullBounds(EForceInit::ForceInitToZero);
+    if (VertexCount > 0)
+    {
+        const float* VertexesX = Vertexes.GetData();
+        const float* VertexesY = VertexesX + PaddedVertexCount;
+        const float* VertexesZ = VertexesY + PaddedVertexCount;
+        const FMatrix& M = LocalToTargetMatrix;
+
+        FVector MinVertex(BIG_NUMBER);
+        FVector MaxVertex(-BIG_NUMBER);
+        for (int32 i = 0; i < VertexCount; i++)
+        {
+            const float X = VertexesX[i];
+            const float Y = VertexesY[i];
+            const float Z = VertexesZ[i];
+            const float TargetX = X * M.M[0][0] + Y * M.M[1][0] + Z * M.M[2][0] + M.M[3][0];
+            const float TargetY = X * M.M[0][1] + Y * M.M[1][1] + Z * M.M[2][1] + M.M[3][1];
+            const float TargetZ = X * M.M[0][2] + Y * M.M[1][2] + Z * M.M[2][2] + M.M[3][2];
+
+            MinVertex.X = FMath::Min(MinVertex.X, TargetX);
+            MinVertex.Y = FMath::Min(MinVertex.Y, TargetY);
+            MinVertex.Z = FMath::Min(MinVertex.Z, TargetZ);
+            MaxVertex.X = FMath::Max(MaxVertex.X, TargetX);
+            MaxVertex.Y = FMath::Max(MaxVertex.Y, TargetY);
+            MaxVertex.Z = FMath::Max(MaxVertex.Z, TargetZ);
+        }
+        HullBounds = FBox(MinVertex, MaxVertex);
+    }
+    return HullBounds;
+}
+
+void FNVMeshHull::TransformVertexesToClipSpace(const FMatrix& LocalToClipMatrix, TArray<float>& OutClipPositions) const
+{
+    OutClipPositions.SetNumUninitialized(PaddedVertexCount * 3);
+
+    const float* VertexesX = Vertexes.GetData();
+    const float* VertexesY = VertexesX + PaddedVertexCount;
+    const float* VertexesZ = VertexesY + PaddedVertexCount;
+    float* ClipX = OutClipPositions.GetData();
+    float* ClipY = ClipX + PaddedVertexCount;
+    float* ClipW = ClipY + PaddedVertexCount;
+
+    // Each matrix element is replicated in a register so 4 vertexes are transformed by each instruction
+    const FMatrix& M = LocalToClipMatrix;
+    const VectorRegister M00 = VectorSetFloat1(M.M[0][0]);
+    const VectorRegister M10 = VectorSetFloat1(M.M[1][0]);
+    const VectorRegister M20 = VectorSetFloat1(M.M[2][0]);
+    const VectorRegister M30 = VectorSetFloat1(M.M[3][0]);
+    const VectorRegister M01 = VectorSetFloat1(M.M[0][1]);
+    const VectorRegister M11 = VectorSetFloat1(M.M[1][1]);
+    const VectorRegister M21 = VectorSetFloat1(M.M[2][1]);
+    const VectorRegister M31 = VectorSetFloat1(M.M[3][1]);
+    const VectorRegister M03 = VectorSetFloat1(M.M[0][3]);
+    const VectorRegister M13 = VectorSetFloat1(M.M[1][3]);
+    const VectorRegister M23 = VectorSetFloat1(M.M[2][3]);
+    const VectorRegister M33 = VectorSetFloat1(M.M[3][3]);
+    for (int32 i = 0; i < PaddedVertexCount; i += 4)
+    {
+        const VectorRegister X = VectorLoad(VertexesX + i);
+        const VectorRegister Y = VectorLoad(VertexesY + i);
+        const VectorRegister Z = VectorLoad(VertexesZ + i);
+        VectorStore(VectorMultiplyAdd(X, M00, VectorMultiplyAdd(Y, M10, VectorMultiplyAdd(Z, M20, M30))), ClipX + i);
+        VectorStore(VectorMultiplyAdd(X, M01, VectorMultiplyAdd(Y, M11, VectorMultiplyAdd(Z, M21, M31))), ClipY + i);
+        VectorStore(VectorMultiplyAdd(X, M03, VectorMultiplyAdd(Y, M13, VectorMultiplyAdd(Z, M23, M33))), ClipW + i);
+    }
+}
+
+//====================================== FNVMeshGeometry ==========================================
+FNVMeshGeometry::FNVMeshGeometry()
+    : LocalBounds(EForceInit::ForceInitToZero)
+{
+}
+
+int32 FNVMeshGeometry::GetHullVertexCount() const
+{
+    return Hull.IsValid() ? Hull->VertexCount : 0;
+}
+
+//====================================== FNVActorGeometryRecord ==========================================
+FNVActorGeometryRecord::FNVActorGeometryRecord()
+    : PrimaryMeshIndex(INDEX_NONE),
+    ComponentCount(0),
+    bHasHullGeometry(false)
+{
+}
+
+const FNVMeshGeometry* FNVActorGeometryRecord::GetPrimaryMesh() const
+{
+    return Meshes.IsValidIndex(PrimaryMeshIndex) ? &Meshes[PrimaryMeshIndex] : nullptr;
+}
+
+UMeshComponent* FNVActorGeometryRecord::GetPrimaryMeshComponent() const
+{
+    const FNVMeshGeometry* PrimaryMesh = GetPrimaryMesh();
+    return PrimaryMesh ? PrimaryMesh->MeshComponent.Get() : nullptr;
+}
+
+//====================================== FNVActorGeometryCache ==========================================
+FNVActorGeometryCache::FNVActorGeometryCache(UWorld* InWorld)
+    : OwnerWorld(InWorld),
+    bHasSpawnedActors(false)
+{
+    if (InWorld)
+    {
+        ActorSpawnedHandle = InWorld->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateRaw(this, &FNVActorGeometryCache::OnActorSpawned));
+    }
+}
+
+FNVActorGeometryCache::~FNVActorGeometryCache()
+{
+    UWorld* World = OwnerWorld.Get();
+    if (World)
+    {
+        World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+    }
+}
+
+FNVActorGeometryCache* FNVActorGeometryCache::Get(UWorld* World)
+{
+    ensure(World);
+    if (!World)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return nullptr;
+    }
+
+    TSharedPtr<FNVActorGeometryCache>& WorldCache = WorldCaches.FindOrAdd(World);
+    if (!WorldCache.IsValid())
+    {
+        WorldCache = MakeShareable(new FNVActorGeometryCache(World));
+    }
+    return WorldCache.Get();
+}
+
+TSharedPtr<const FNVActorGeometryRecord> FNVActorGeometryCache::FindOrAddActorRecord(const AActor* CheckActor, bool bNeedHullGeometry /*= true*/)
+{
+    FNVActorGeometryCache* WorldCache = CheckActor ? Get(CheckActor->GetWorld()) : nullptr;
+    return WorldCache ? WorldCache->FindOrAddRecord(CheckActor, bNeedHullGeometry) : nullptr;
+}
+
+TSharedPtr<const FNVActorGeometryRecord> FNVActorGeometryCache::FindOrAddRecord(const AActor* CheckActor, bool bNeedHullGeometry /*= true*/)
+{
+    ensure(CheckActor);
+    if (!CheckActor)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return nullptr;
+    }
+
+    if (bHasSpawnedActors)
+    {
+        RemoveDestroyedActors();
+    }
+
+    TSharedPtr<FNVActorGeometryRecord>& ActorRecord = Records.FindOrAdd(CheckActor);
+    const bool bNeedRebuild = !ActorRecord.IsValid() || IsRecordOutdated(CheckActor, *ActorRecord) ||
+                              (bNeedHullGeometry && !ActorRecord->bHasHullGeometry);
+    if (bNeedRebuild)
+    {
+        // Always build a new record instead of updating the old one in place since the caller may still hold it
+        ActorRecord = MakeShareable(new FNVActorGeometryRecord());
+        BuildRecord(CheckActor, bNeedHullGeometry, *ActorRecord);
+    }
+    return ActorRecord;
+}
+
+void FNVActorGeometryCache::InvalidateActor(const AActor* CheckActor)
+{
+    // The hulls are shared by all the actors using the same meshes, rebuild them too in case the meshes' collision changed
+    const TSharedPtr<FNVActorGeometryRecord>* CachedRecord = Records.Find(CheckActor);
+    if (CachedRecord && CachedRecord->IsValid())
+    {
+        for (const FNVMeshGeometry& MeshGeometry : (*CachedRecord)->Meshes)
+        {
+            FNVMeshHullCache::Invalidate(MeshGeometry.MeshAsset.Get());
+        }
+    }
+    Records.Remove(CheckActor);
+}
+
+void FNVActorGeometryCache::Invalidate()
+{
+    Records.Reset();
+}
+
+int32 FNVActorGeometryCache::GetRecordCount() const
+{
+    return Records.Num();
+}
+
+void FNVActorGeometryCache::RegisterWorldDelegates()
+{
+    if (!WorldCleanupHandle.IsValid())
+    {
+        WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddStatic(&FNVActorGeometryCache::OnWorldCleanup);
+    }
+}
+
+void FNVActorGeometryCache::UnregisterWorldDelegates()
+{
+    if (WorldCleanupHandle.IsValid())
+    {
+        FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupHandle);
+        WorldCleanupHandle.Reset();
+    }
+    WorldCaches.Empty();
+}
+
+void FNVActorGeometryCache::BuildRecord(const AActor* CheckActor, bool bBuildHullGeometry, FNVActorGeometryRecord& OutRecord)
+{
+    OutRecord.Tag = Cast<UNVCapturableActorTag>(CheckActor->GetComponentByClass(UNVCapturableActorTag::StaticClass()));
+    OutRecord.ComponentCount = CheckActor->GetComponents().Num();
+    OutRecord.PrimaryMeshIndex = INDEX_NONE;
+    OutRecord.Meshes.Reset();
+    OutRecord.bHasHullGeometry = bBuildHullGeometry;
+
+    TArray<UMeshComponent*> MeshComponents;
+    CheckActor->GetComponents(MeshComponents);
+    OutRecord.Meshes.Reserve(MeshComponents.Num());
+    for (UMeshComponent* CheckMeshComp : MeshComponents)
+    {
+        if (!CheckMeshComp)
+        {
+            continue;
+        }
+
+        const int32 MeshIndex = OutRecord.Meshes.AddDefaulted();
+        FNVMeshGeometry& MeshGeometry = OutRecord.Meshes[MeshIndex];
+        MeshGeometry.MeshComponent = CheckMeshComp;
+        MeshGeometry.MeshAsset = GetMeshAsset(CheckMeshComp);
+        if (MeshGeometry.MeshAsset.IsValid() && (OutRecord.PrimaryMeshIndex == INDEX_NONE))
+        {
+            OutRecord.PrimaryMeshIndex = MeshIndex;
+        }
+
+        if (!bBuildHullGeometry)
+        {
+            continue;
+        }
+
+        MeshGeometry.Hull = FNVMeshHullCache::FindOrAdd(CheckMeshComp);
+
+        if (Cast<UStaticMeshComponent>(CheckMeshComp))
+        {
+            MeshGeometry.LocalBounds = NVSceneCapturerUtils::GetMeshLocalBounds(CheckMeshComp, false);
+        }
+    }
+}
+
+bool FNVActorGeometryCache::IsRecordOutdated(const AActor* CheckActor, const FNVActorGeometryRecord& CheckRecord)
+{
+    if (CheckActor->GetComponents().Num() != CheckRecord.ComponentCount)
+    {
+        return true;
+    }
+    if (CheckRecord.Tag.IsStale())
+    {
+        return true;
+    }
+    for (const FNVMeshGeometry& MeshGeometry : CheckRecord.Meshes)
+    {
+        const UMeshComponent* MeshComp = MeshGeometry.MeshComponent.Get();
+        if (!MeshComp || (GetMeshAsset(MeshComp) != MeshGeometry.MeshAsset.Get()))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FNVActorGeometryCache::OnActorSpawned(AActor* SpawnedActor)
+{
+    // Clean up the records of the destroyed actors the next time the cache is used instead of doing it for every spawned actor
+    bHasSpawnedActors = true;
+}
+
+void FNVActorGeometryCache::RemoveDestroyedActors()
+{
+    for (auto It = Records.CreateIterator(); It; ++It)
+    {
+        if (!It.Key().IsValid())
+        {
+            It.RemoveCurrent();
+        }
+    }
+    bHasSpawnedActors = false;
+}
+
+void FNVActorGeometryCache::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+    WorldCaches.Remove(World);
+}
+
+//====================================== FNVMeshOrientedBoundsCache ==========================================
+FNVOrientedBounds FNVMeshOrientedBoundsCache::FindOrAdd(const UStaticMesh* StaticMesh)
+{
+    if (!StaticMesh)
+    {
+        return FNVOrientedBounds();
+    }
+
+    {
+        FScopeLock ScopeLock(&CacheCriticalSection);
+        const FNVOrientedBounds* CachedBounds = FindCachedBounds(CachedMeshBounds, StaticMesh);
+        if (CachedBounds)
+        {
+            return *CachedBounds;
+        }
+    }
+
+    // NOTE: The bounds are calculated outside of the lock so the other threads don't wait for them,
+    // 2 threads may calculate the same mesh at the same time but they get the same result
+    const FNVOrientedBounds MeshBounds = CalculateMeshBounds(StaticMesh);
+    FScopeLock ScopeLock(&CacheCriticalSection);
+    AddCachedBounds(CachedMeshBounds, StaticMesh, MeshBounds);
+    return MeshBounds;
+}
+
+FNVOrientedBounds FNVMeshOrientedBoundsCache::FindOrAddRenderVertexesPCA(const UStaticMesh* StaticMesh)
+{
+    ensure(StaticMesh);
+    if (!StaticMesh)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return FNVOrientedBounds();
+    }
+
+    {
+        FScopeLock ScopeLock(&CacheCriticalSection);
+        const FNVOrientedBounds* CachedPCA = FindCachedBounds(CachedRenderVertexesPCAs, StaticMesh);
+        if (CachedPCA)
+        {
+            return *CachedPCA;
+        }
+    }
+
+    const FNVOrientedBounds MeshPCA = CalculateRenderVertexesPCA(StaticMesh);
+    FScopeLock ScopeLock(&CacheCriticalSection);
+    AddCachedBounds(CachedRenderVertexesPCAs, StaticMesh, MeshPCA);
+    return MeshPCA;
+}
+
+void FNVMeshOrientedBoundsCache::Prefetch(const TArray<const UStaticMesh*>& StaticMeshes)
+{
+    TArray<const UStaticMesh*> MissingMeshes;
+    {
+        FScopeLock ScopeLock(&CacheCriticalSection);
+        for (const UStaticMesh* CheckMesh : StaticMeshes)
+        {
+            if (CheckMesh && !FindCachedBounds(CachedMeshBounds, CheckMesh))
+            {
+                MissingMeshes.AddUnique(CheckMesh);
+            }
+        }
+    }
+
+    const int32 MissingMeshCount = MissingMeshes.Num();
+    if (MissingMeshCount > 0)
+    {
+        TArray<FNVOrientedBounds> MissingBoundsList;
+        MissingBoundsList.SetNum(MissingMeshCount);
+        ParallelFor(MissingMeshCount, [&](int32 MeshIndex)
+        {
+            MissingBoundsList[MeshIndex] = CalculateMeshBounds(MissingMeshes[MeshIndex]);
+        }, (MissingMeshCount <= 1));
+
+        FScopeLock ScopeLock(&CacheCriticalSection);
+        for (int32 MeshIndex = 0; MeshIndex < MissingMeshCount; MeshIndex++)
+        {
+            AddCachedBounds(CachedMeshBounds, MissingMeshes[MeshIndex], MissingBoundsList[MeshIndex]);
+        }
+    }
+}
+
+void FNVMeshOrientedBoundsCache::Reset()
+{
+    FScopeLock ScopeLock(&CacheCriticalSection);
+    CachedMeshBounds.Empty();
+    CachedRenderVertexesPCAs.Empty();
+}
+
+FNVOrientedBounds FNVMeshOrientedBoundsCache::CalculateMeshBounds(const UStaticMesh* StaticMesh)
+{
+    TArray<FVector> MeshVertexes;
+    // If the static mesh have body setup with its convex collision then use it
+    if (StaticMesh->BodySetup)
+    {
+        for (const FKConvexElem& ConvexElem : StaticMesh->BodySetup->AggGeom.ConvexElems)
+        {
+            MeshVertexes.Append(ConvexElem.VertexData);
+        }
+    }
+    // Otherwise use the render vertexes of the mesh's LOD0
+    if (MeshVertexes.Num() == 0)
+    {
+        GetMeshRenderVertexes(StaticMesh, MeshVertexes);
+    }
+
+    return NVSceneCapturerUtils::CalculateOrientedBounds(MeshVertexes);
+}
+
+FNVOrientedBounds FNVMeshOrientedBoundsCache::CalculateRenderVertexesPCA(const UStaticMesh* StaticMesh)
+{
+    // NOTE: We need to check all the mesh's vertices here for accuracy, the box itself isn't used so it doesn't need to be minimized
+    TArray<FVector> MeshVertexes;
+    GetMeshRenderVertexes(StaticMesh, MeshVertexes);
+    return NVSceneCapturerUtils::CalculateOrientedBounds(MeshVertexes, false);
+}
+
+const void* FNVMeshOrientedBoundsCache::GetMeshRenderDataKey(const UStaticMesh* StaticMesh)
+{
+    return StaticMesh->RenderData.Get();
+}
+
+const FNVOrientedBounds* FNVMeshOrientedBoundsCache::FindCachedBounds(const FCachedMeshBoundsMap& CachedMap, const UStaticMesh* StaticMesh)
+{
+    const FCachedMeshBounds* CachedEntry = CachedMap.Find(StaticMesh);
+    if (CachedEntry && (CachedEntry->RenderDataKey == GetMeshRenderDataKey(StaticMesh)))
+    {
+        return &CachedEntry->Bounds;
+    }
+    return nullptr;
+}
+
+void FNVMeshOrientedBoundsCache::AddCachedBounds(FCachedMeshBoundsMap& CachedMap, const UStaticMesh* StaticMesh, const FNVOrientedBounds& MeshBounds)
+{
+    // Clean up the entries of the unloaded meshes before adding new ones so the cache doesn't keep growing
+    for (auto It = CachedMap.CreateIterator(); It; ++It)
+    {
+        if (!It.Key().IsValid())
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    FCachedMeshBounds& CachedEntry = CachedMap.FindOrAdd(StaticMesh);
+    CachedEntry.RenderDataKey = GetMeshRenderDataKey(StaticMesh);
+    CachedEntry.Bounds = MeshBounds;
+}
+
+//====================================== FNVMeshHullCache ==========================================
+TSharedPtr<const FNVMeshHull, ESPMode::ThreadSafe> FNVMeshHullCache::FindOrAdd(const UMeshComponent* MeshComp)
+{
+    const UObject* MeshAsset = MeshComp ? GetMeshAsset(MeshComp) : nullptr;
+    if (!MeshAsset)
+    {
+        return nullptr;
+    }
+
+    const void* SourceKey = GetMeshSourceKey(MeshComp);
+    {
+        FScopeLock ScopeLock(&CacheCriticalSection);
+        const FCachedMeshHull* CachedEntry = CachedMeshHulls.Find(MeshAsset);
+        if (CachedEntry && (CachedEntry->SourceKey == SourceKey))
+        {
+            return CachedEntry->Hull;
+        }
+    }
+
+    // NOTE: The hull is built outside of the lock so the other threads don't wait for it
+    TSharedPtr<FNVMeshHull, ESPMode::ThreadSafe> MeshHull = MakeShared<FNVMeshHull, ESPMode::ThreadSafe>();
+    MeshHull->Build(NVSceneCapturerUtils::GetSimpleCollisionVertexes(MeshComp, false));
+
+    FScopeLock ScopeLock(&CacheCriticalSection);
+    // Clean up the entries of the unloaded meshes before adding new ones so the cache doesn't keep growing
+    for (auto It = CachedMeshHulls.CreateIterator(); It; ++It)
+    {
+        if (!It.Key().IsValid())
+        {
+            It.RemoveCurrent();
+        }
+    }
+    FCachedMeshHull& CachedEntry = CachedMeshHulls.FindOrAdd(MeshAsset);
+    CachedEntry.SourceKey = SourceKey;
+    CachedEntry.Hull = MeshHull;
+    return MeshHull;
+}
+
+void FNVMeshHullCache::Invalidate(const UObject* MeshAsset)
+{
+    FScopeLock ScopeLock(&CacheCriticalSection);
+    CachedMeshHulls.Remove(MeshAsset);
+}
+
+void FNVMeshHullCache::Reset()
+{
+    FScopeLock ScopeLock(&CacheCriticalSection);
+    CachedMeshHulls.Empty();
+}
+
+const void* FNVMeshHullCache::GetMeshSourceKey(const UMeshComponent* MeshComp)
+{
+    // Same sources as NVSceneCapturerUtils::GetSimpleCollisionVertexes
+    const UStaticMeshComponent* StaticMeshComp = Cast<UStaticMeshComponent>(MeshComp);
+    const UStaticMesh* StaticMesh = StaticMeshComp ? StaticMeshComp->GetStaticMesh() : nullptr;
+    if (StaticMesh)
+    {
+        return StaticMesh->BodySetup ? (const void*)StaticMesh->BodySetup : (const void*)StaticMesh->RenderData.Get();
+    }
+    const USkeletalMeshComponent* SkeletalMeshComp = Cast<USkeletalMeshComponent>(MeshComp);
+    const USkeletalMesh* SkeletalMesh = SkeletalMeshComp ? SkeletalMeshComp->SkeletalMesh : nullptr;
+    return SkeletalMesh ? SkeletalMesh->PhysicsAsset : nullptr;
+}
@@ -6,6 +6,7 @@
 #include "NVSceneCapturerModule.h"
 #include "NVSceneCapturerUtils.h"
 #include "NVAnnotatedActor.h"
+#include "NVActorGeometryCache.h"
 #include "NVCoordinateComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "Engine.h"
@@ -121,10 +122,11 @@ void ANVAnnotatedActor::UpdateMeshCuboid()
     UStaticMesh* ActorStaticMesh = MeshComponent ? MeshComponent->GetStaticMesh() : nullptr;
     if (ActorStaticMesh)
     {
-        const FMatrix& PCATransformMat = CalculatePCA(ActorStaticMesh);
-        PCACenter = PCATransformMat.GetOrigin();
-        const FVector& TempPCADirection = PCATransformMat.GetUnitAxis(EAxis::Z);
-        PCARotation = (-TempPCADirection).ToOrientationRotator();
+        // NOTE: The PCA of all the mesh's LOD0 vertexes is only calculated once per mesh
+        const FNVOrientedBounds MeshPCA = FNVMeshOrientedBoundsCache::FindOrAddRenderVertexesPCA(ActorStaticMesh);
+        PCACenter = MeshPCA.MeanPoint;
+        PCADirection = MeshPCA.PrincipalAxis;
+        PCARotation = (-PCADirection).ToOrientationRotator();
 
         CoordComponent->SetRelativeRotation(PCARotation);
 
@@ -141,79 +143,6 @@ void ANVAnnotatedActor::UpdateMeshCuboid()
     }
 }
 
-FMatrix ANVAnnotatedActor::CalculatePCA(const class UStaticMesh* Mesh)
-{
-    FMatrix TransformMatrix = FMatrix::Identity;
-    if (Mesh)
-    {
-        TArray<FVector> MeshVertices;
-        MeshVertices.Reset();
-
-        const FPositionVertexBuffer& MeshVertexBuffer = Mesh->RenderData->LODResources[0].VertexBuffers.PositionVertexBuffer;
-        const uint32 VertexesCount = MeshVertexBuffer.GetNumVertices();
-        if (VertexesCount != 0)
-        {
-            MeshVertices.Reserve(VertexesCount);
-            for (uint32 i = 0; i < VertexesCount; i++)
-            {
-                const FVector& VertexPosition = MeshVertexBuffer.VertexPosition(i);
-                MeshVertices.Add(VertexPosition);
-            }
-
-            // Find the mean vertex
-            FVector MeanVertex = FVector::ZeroVector;
-            for (uint32 i = 0; i < VertexesCount; i++)
-            {
-                MeanVertex += MeshVertices[i];
-            }
-            MeanVertex /= VertexesCount;
-
-            // Calculate the covariance matrix
-            FMatrix CMat = FMatrix::Identity;
-            for (int i = 0; i < 3; i++)
-            {
-                for (int j = 0; j < 3; j++)
-                {
-                    float Cij = 0.f;
-                    for (uint32 k = 0; k < VertexesCount; k++)
-                    {
-                        Cij += (MeshVertices[k][i] - MeanVertex[i]) * (MeshVertices[k][j] - MeanVertex[j]);
-                    }
-                    Cij /= VertexesCount;
-
-                    CMat.M[i][j] = Cij;
-                }
-            }
-
-            // Find the EigenVector of the matrix
-            FVector ZAxis = ComputeEigenVector(CMat);
-            FVector XAxis, YAxis;
-            ZAxis.FindBestAxisVectors(YAxis, XAxis);
-
-            TransformMatrix = FMatrix(XAxis, YAxis, ZAxis, MeanVertex);
-        }
-    }
-    return TransformMatrix;
-}
-
-FVector ANVAnnotatedActor::ComputeEigenVector(const FMatrix& Mat)
-{
-    // NOTES: Copied from function ComputeEigenVector in PhysicsASsetUtils.cpp
-    //using the power method: this is ok because we only need the dominate eigenvector and speed is not critical:
-    // http://en.wikipedia.org/wiki/Power_iteration
-    FVector EVector = FVector(0, 0, 1.f);
-    for (int32 i = 0; i < 32; ++i)
-    {
-        float Length = EVector.Size();
-        if (Length > 0.f)
-        {
-            EVector = Mat.TransformVector(EVector) / Length;
-        }
-    }
-
-    return EVector.GetSafeNormal();
-}
-
 void ANVAnnotatedActor::UpdateStaticMesh()
 {
     UpdateMeshCuboid();
@@ -0,0 +1,734 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVAnnotationBinaryFormat.h"
+#include "NVSceneCapturerUtils.h"
+#include "NVJsonWriter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Json.h"
+
+namespace
+{
+    const uint8 AnnotationBinaryMagic[4] = { 'N', 'V', 'A', 'B' };
+    const uint32 AnnotationBinaryVersion = 4;
+    const uint32 VariableDataAlignment = 4;
+
+    void CopyVector(float* OutValues, const FVector& Value)
+    {
+        OutValues[0] = Value.X;
+        OutValues[1] = Value.Y;
+        OutValues[2] = Value.Z;
+    }
+
+    void CopyVector2D(float* OutValues, const FVector2D& Value)
+    {
+        OutValues[0] = Value.X;
+        OutValues[1] = Value.Y;
+    }
+
+    void CopyQuat(float* OutValues, const FQuat& Value)
+    {
+        OutValues[0] = Value.X;
+        OutValues[1] = Value.Y;
+        OutValues[2] = Value.Z;
+        OutValues[3] = Value.W;
+    }
+
+    void CopyRotator(float* OutValues, const FRotator& Value)
+    {
+        OutValues[0] = Value.Pitch;
+        OutValues[1] = Value.Yaw;
+        OutValues[2] = Value.Roll;
+    }
+
+    void CopyMatrix(float* OutValues, const FMatrix& Value)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            for (int j = 0; j < 4; j++)
+            {
+                OutValues[i * 4 + j] = Value.M[i][j];
+            }
+        }
+    }
+
+    FVector ToVector(const float* Values)
+    {
+        return FVector(Values[0], Values[1], Values[2]);
+    }
+
+    FVector2D ToVector2D(const float* Values)
+    {
+        return FVector2D(Values[0], Values[1]);
+    }
+
+    FQuat ToQuat(const float* Values)
+    {
+        return FQuat(Values[0], Values[1], Values[2], Values[3]);
+    }
+
+    FRotator ToRotator(const float* Values)
+    {
+        return FRotator(Values[0], Values[1], Values[2]);
+    }
+
+    FMatrix ToMatrix(const float* Values)
+    {
+        FMatrix OutMatrix;
+        for (int i = 0; i < 4; i++)
+        {
+            for (int j = 0; j < 4; j++)
+            {
+                OutMatrix.M[i][j] = Values[i * 4 + j];
+            }
+        }
+        return OutMatrix;
+    }
+
+    // Append an array to the variable data at the end of the buffer and return where it is
+    FNVAnnotationBinarySpan AppendVariableData(TArray<uint8>& Buffer, const void* Values, uint32 ElementSize, uint32 ElementCount)
+    {
+        FNVAnnotationBinarySpan NewSpan;
+        NewSpan.Count = ElementCount;
+        NewSpan.Offset = 0;
+        if (ElementCount > 0)
+        {
+            const int32 PaddingSize = Align(Buffer.Num(), VariableDataAlignment) - Buffer.Num();
+            Buffer.AddZeroed(PaddingSize);
+            NewSpan.Offset = Buffer.Num();
+            Buffer.Append((const uint8*)Values, ElementSize * ElementCount);
+        }
+        return NewSpan;
+    }
+
+    FNVAnnotationBinarySpan AppendString(TArray<uint8>& Buffer, const FString& Value)
+    {
+        if (Value.IsEmpty())
+        {
+            return AppendVariableData(Buffer, nullptr, 1, 0);
+        }
+
+        FTCHARToUTF8 ValueUTF8(*Value);
+        return AppendVariableData(Buffer, ValueUTF8.Get(), 1, ValueUTF8.Length());
+    }
+
+    //================ Schema ================
+    struct FSchemaField
+    {
+        const TCHAR* Name;
+        const TCHAR* Type;
+        uint32 Offset;
+        uint32 Count;
+    };
+
+    // NOTE: The field names are the same as the keys in the json
+    #define NV_ANNOTATION_SCHEMA_FIELD(StructType, Member, FieldName, FieldType, ElementType) \
+        { TEXT(FieldName), TEXT(FieldType), (uint32)STRUCT_OFFSET(StructType, Member), (uint32)(sizeof(((StructType*)nullptr)->Member) / sizeof(ElementType)) }
+
+    const FSchemaField SpanSchemaFields[] =
+    {
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinarySpan, Offset, "offset", "uint32", uint32),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinarySpan, Count, "count", "uint32", uint32),
+    };
+
+    const FSchemaField HeaderSchemaFields[] =
+    {
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryHeader, Magic, "magic", "uint8", uint8),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryHeader, Version, "version", "uint32", uint32),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryHeader, HeaderSize, "header_size", "uint32", uint32),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryHeader, ViewpointSize, "viewpoint_size", "uint32", uint32),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryHeader, ObjectSize, "object_size", "uint32", uint32),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryHeader, ObjectCount, "object_count", "uint32", uint32),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryHeader, TotalSize, "total_size", "uint32", uint32),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryHeader, OptionalObjectFields, "optional_object_fields", "uint32", uint32),
+    };
+
+    const FSchemaField ViewpointSchemaFields[] =
+    {
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryViewpoint, LocationWorldframe, "location_worldframe", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryViewpoint, QuaternionXYZWWorldframe, "quaternion_xyzw_worldframe", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryViewpoint, ProjectionMatrix, "projectionMatrix", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryViewpoint, ViewProjectionMatrix, "viewProjectionMatrix", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryViewpoint, ResX, "cameraSettings.resX", "int32", int32),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryViewpoint, ResY, "cameraSettings.resY", "int32", int32),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryViewpoint, Fx, "cameraSettings.fx", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryViewpoint, Fy, "cameraSettings.fy", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryViewpoint, Cx, "cameraSettings.cx", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryViewpoint, Cy, "cameraSettings.cy", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryViewpoint, S, "cameraSettings.s", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryViewpoint, IntrinsicMatrix, "cameraSettings.intrinsicMatrix", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryViewpoint, CameraProjectionMatrix, "cameraSettings.projectionMatrix", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryViewpoint, Fov, "fov", "float32", float),
+    };
+
+    const FSchemaField ObjectSchemaFields[] =
+    {
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, InstanceId, "instance_id", "uint32", uint32),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, Occluded, "occluded", "uint32", uint32),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, Truncated, "truncated", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, Occlusion, "occlusion", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, Visibility, "visibility", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, VisiblePixelCount, "visible_pixel_count", "uint32", uint32),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, ProjectedPixelCount, "projected_pixel_count", "uint32", uint32),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, TruncationFlags, "truncation_flags", "uint32", uint32),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, DimensionsWorldspace, "dimensions_worldspace", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, LocationWorldspace, "location_worldspace", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, Location, "location", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, RotationWorldspace, "rotation_worldspace", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, QuaternionWorldspace, "quaternion_worldspace", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, Rotation, "rotation", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, QuaternionXYZW, "quaternion_xyzw", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, ActorToWorldMatrixUE4, "actor_to_world_matrix_ue4", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, ActorToWorldMatrixOpenCV, "actor_to_world_matrix_opencv", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, ActorToCameraMatrix, "actor_to_camera_matrix", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, PoseTransform, "pose_transform", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, BoundingBoxCenterWorldspace, "bounding_box_center_worldspace", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, CuboidCentroid, "cuboid_centroid", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, ProjectedCuboidCentroid, "projected_cuboid_centroid", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, BoundingBoxForwardDirection, "bounding_box_forward_direction", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, BoundingBoxForwardDirectionImagespace, "bounding_box_forward_direction_imagespace", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, ViewpointAzimuthAngle, "viewpoint_azimuth_angle", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, ViewpointAltitudeAngle, "viewpoint_altitude_angle", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, DistanceScale, "distance_scale", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, BoundingBoxTopLeft, "bounding_box.top_left", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, BoundingBoxBottomRight, "bounding_box.bottom_right", "float32", float),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, SegmentationRleSize, "segmentation_rle.size", "uint32", uint32),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, Name, "name", "span:utf8", FNVAnnotationBinarySpan),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, Class, "class", "span:utf8", FNVAnnotationBinarySpan),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, Rgba, "rgba", "span:uint8", FNVAnnotationBinarySpan),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, Cuboid, "cuboid", "span:float32[3]", FNVAnnotationBinarySpan),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, ProjectedCuboid, "projected_cuboid", "span:float32[2]", FNVAnnotationBinarySpan),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, SegmentationRleCounts, "segmentation_rle.counts", "span:uint32", FNVAnnotationBinarySpan),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, SegmentationPolygons, "segmentation_polygons", "span:polygon", FNVAnnotationBinarySpan),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, SocketData, "socket_data", "span:socket", FNVAnnotationBinarySpan),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryObject, CustomData, "custom_data", "span:utf8_json", FNVAnnotationBinarySpan),
+    };
+
+    const FSchemaField PolygonSchemaFields[] =
+    {
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinaryPolygon, Points, "points", "span:float32[2]", FNVAnnotationBinarySpan),
+    };
+
+    const FSchemaField SocketSchemaFields[] =
+    {
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinarySocket, SocketName, "socketName", "span:utf8", FNVAnnotationBinarySpan),
+        NV_ANNOTATION_SCHEMA_FIELD(FNVAnnotationBinarySocket, SocketLocation, "socketLocation", "float32", float),
+    };
+
+    #undef NV_ANNOTATION_SCHEMA_FIELD
+
+    template<SIZE_T FieldCount>
+    TSharedPtr<FJsonObject> MakeSchemaRecord(uint32 RecordSize, const FSchemaField(&Fields)[FieldCount])
+    {
+        TSharedPtr<FJsonObject> RecordJsonObj = MakeShareable(new FJsonObject());
+        RecordJsonObj->SetNumberField(TEXT("size"), RecordSize);
+
+        TArray<TSharedPtr<FJsonValue>> FieldJsonValues;
+        for (const FSchemaField& Field : Fields)
+        {
+            TSharedPtr<FJsonObject> FieldJsonObj = MakeShareable(new FJsonObject());
+            FieldJsonObj->SetStringField(TEXT("name"), Field.Name);
+            FieldJsonObj->SetStringField(TEXT("type"), Field.Type);
+            FieldJsonObj->SetNumberField(TEXT("offset"), Field.Offset);
+            FieldJsonObj->SetNumberField(TEXT("count"), Field.Count);
+            FieldJsonValues.Add(MakeShareable(new FJsonValueObject(FieldJsonObj)));
+        }
+        RecordJsonObj->SetArrayField(TEXT("fields"), FieldJsonValues);
+        return RecordJsonObj;
+    }
+}
+
+//====================================== FNVAnnotationBinaryWriter ==========================================
+const FString FNVAnnotationBinaryWriter::FileExtension = TEXT(".nvab");
+const FString FNVAnnotationBinaryWriter::SchemaFileName = TEXT("_annotation_schema.json");
+
+void FNVAnnotationBinaryWriter::SerializeCapturedSceneData(const FCapturedSceneData& SceneData, TArray<uint8>& OutBinaryData)
+{
+    const int32 ObjectCount = SceneData.Objects.Num();
+    const int32 ViewpointOffset = sizeof(FNVAnnotationBinaryHeader);
+    const int32 ObjectsOffset = ViewpointOffset + sizeof(FNVAnnotationBinaryViewpoint);
+    const int32 FixedDataSize = ObjectsOffset + ObjectCount * sizeof(FNVAnnotationBinaryObject);
+
+    // NOTE: The fixed size records are reserved first, the variable data is appended after them
+    OutBinaryData.Reset();
+    OutBinaryData.AddZeroed(FixedDataSize);
+
+    FNVAnnotationBinaryViewpoint ViewpointRecord;
+    FMemory::Memzero(ViewpointRecord);
+    const FCapturedViewpointData& ViewpointData = SceneData.camera_data;
+    CopyVector(ViewpointRecord.LocationWorldframe, ViewpointData.location_worldframe);
+    CopyQuat(ViewpointRecord.QuaternionXYZWWorldframe, ViewpointData.quaternion_xyzw_worldframe);
+    CopyMatrix(ViewpointRecord.ProjectionMatrix, ViewpointData.ProjectionMatrix);
+    CopyMatrix(ViewpointRecord.ViewProjectionMatrix, ViewpointData.ViewProjectionMatrix);
+    const FCameraIntrinsicSettings& CameraSettings = ViewpointData.CameraSettings;
+    ViewpointRecord.ResX = CameraSettings.ResX;
+    ViewpointRecord.ResY = CameraSettings.ResY;
+    ViewpointRecord.Fx = CameraSettings.Fx;
+    ViewpointRecord.Fy = CameraSettings.Fy;
+    ViewpointRecord.Cx = CameraSettings.Cx;
+    ViewpointRecord.Cy = CameraSettings.Cy;
+    ViewpointRecord.S = CameraSettings.S;
+    CopyMatrix(ViewpointRecord.IntrinsicMatrix, CameraSettings.IntrinsicMatrix);
+    CopyMatrix(ViewpointRecord.CameraProjectionMatrix, CameraSettings.ProjectionMatrix);
+    ViewpointRecord.Fov = ViewpointData.fov;
+    FMemory::Memcpy(OutBinaryData.GetData() + ViewpointOffset, &ViewpointRecord, sizeof(ViewpointRecord));
+
+    TArray<FNVAnnotationBinaryPolygon> PolygonRecords;
+    TArray<FNVAnnotationBinarySocket> SocketRecords;
+    for (int32 ObjectIndex = 0; ObjectIndex < ObjectCount; ObjectIndex++)
+    {
+        const FCapturedObjectData& ObjectData = SceneData.Objects[ObjectIndex];
+
+        FNVAnnotationBinaryObject ObjectRecord;
+        FMemory::Memzero(ObjectRecord);
+        ObjectRecord.InstanceId = ObjectData.instance_id;
+        ObjectRecord.Occluded = ObjectData.occluded;
+        ObjectRecord.Truncated = ObjectData.truncated;
+        ObjectRecord.Occlusion = ObjectData.occlusion;
+        ObjectRecord.Visibility = ObjectData.visibility;
+        ObjectRecord.VisiblePixelCount = ObjectData.visible_pixel_count;
+        ObjectRecord.ProjectedPixelCount = ObjectData.projected_pixel_count;
+        ObjectRecord.TruncationFlags = ObjectData.truncation_flags;
+        CopyVector(ObjectRecord.DimensionsWorldspace, ObjectData.dimensions_worldspace);
+        CopyVector(ObjectRecord.LocationWorldspace, ObjectData.location_worldspace);
+        CopyVector(ObjectRecord.Location, ObjectData.location);
+        CopyRotator(ObjectRecord.RotationWorldspace, ObjectData.rotation_worldspace);
+        CopyQuat(ObjectRecord.QuaternionWorldspace, ObjectData.quaternion_worldspace);
+        CopyRotator(ObjectRecord.Rotation, ObjectData.rotation);
+        CopyQuat(ObjectRecord.QuaternionXYZW, ObjectData.quaternion_xyzw);
+        CopyMatrix(ObjectRecord.ActorToWorldMatrixUE4, ObjectData.actor_to_world_matrix_ue4);
+        CopyMatrix(ObjectRecord.ActorToWorldMatrixOpenCV, ObjectData.actor_to_world_matrix_opencv);
+        CopyMatrix(ObjectRecord.ActorToCameraMatrix, ObjectData.actor_to_camera_matrix);
+        CopyMatrix(ObjectRecord.PoseTransform, ObjectData.pose_transform);
+        CopyVector(ObjectRecord.BoundingBoxCenterWorldspace, ObjectData.bounding_box_center_worldspace);
+        CopyVector(ObjectRecord.CuboidCentroid, ObjectData.cuboid_centroid);
+        CopyVector2D(ObjectRecord.ProjectedCuboidCentroid, ObjectData.projected_cuboid_centroid);
+        CopyVector(ObjectRecord.BoundingBoxForwardDirection, ObjectData.bounding_box_forward_direction);
+        CopyVector2D(ObjectRecord.BoundingBoxForwardDirectionImagespace, ObjectData.bounding_box_forward_direction_imagespace);
+        ObjectRecord.ViewpointAzimuthAngle = ObjectData.viewpoint_azimuth_angle;
+        ObjectRecord.ViewpointAltitudeAngle = ObjectData.viewpoint_altitude_angle;
+        ObjectRecord.DistanceScale = ObjectData.distance_scale;
+        CopyVector2D(ObjectRecord.BoundingBoxTopLeft, ObjectData.bounding_box.top_left);
+        CopyVector2D(ObjectRecord.BoundingBoxBottomRight, ObjectData.bounding_box.bottom_right);
+        if (ObjectData.segmentation_rle.size.Num() == 2)
+        {
+            ObjectRecord.SegmentationRleSize[0] = ObjectData.segmentation_rle.size[0];
+            ObjectRecord.SegmentationRleSize[1] = ObjectData.segmentation_rle.size[1];
+        }
+
+        ObjectRecord.Name = AppendString(OutBinaryData, ObjectData.Name);
+        ObjectRecord.Class = AppendString(OutBinaryData, ObjectData.Class);
+        ObjectRecord.Rgba = AppendVariableData(OutBinaryData, ObjectData.rgba.GetData(), sizeof(uint8), ObjectData.rgba.Num());
+        // NOTE: FVector and FVector2D are tightly packed floats so the arrays can be copied as they are
+        ObjectRecord.Cuboid = AppendVariableData(OutBinaryData, ObjectData.cuboid.GetData(), sizeof(FVector), ObjectData.cuboid.Num());
+        ObjectRecord.ProjectedCuboid = AppendVariableData(OutBinaryData, ObjectData.projected_cuboid.GetData(), sizeof(FVector2D), ObjectData.projected_cuboid.Num());
+
+        ObjectRecord.SegmentationRleCounts = AppendVariableData(OutBinaryData, ObjectData.segmentation_rle.counts.GetData(), sizeof(uint32),
+                                                                ObjectData.segmentation_rle.counts.Num());
+
+        // The polygons' points are appended before the polygon records which point to them
+        PolygonRecords.Reset(ObjectData.segmentation_polygons.Num());
+        for (const FNVPolygon2D& Polygon : ObjectData.segmentation_polygons)
+        {
+            FNVAnnotationBinaryPolygon PolygonRecord;
+            PolygonRecord.Points = AppendVariableData(OutBinaryData, Polygon.points.GetData(), sizeof(FVector2D), Polygon.points.Num());
+            PolygonRecords.Add(PolygonRecord);
+        }
+        ObjectRecord.SegmentationPolygons = AppendVariableData(OutBinaryData, PolygonRecords.GetData(), sizeof(FNVAnnotationBinaryPolygon), PolygonRecords.Num());
+
+        // The socket names are appended before the socket records which point to them
+        SocketRecords.Reset(ObjectData.socket_data.Num());
+        for (const FNVSocketData& SocketData : ObjectData.socket_data)
+        {
+            FNVAnnotationBinarySocket SocketRecord;
+            SocketRecord.SocketName = AppendString(OutBinaryData, SocketData.SocketName);
+            CopyVector2D(SocketRecord.SocketLocation, SocketData.SocketLocation);
+            SocketRecords.Add(SocketRecord);
+        }
+        ObjectRecord.SocketData = AppendVariableData(OutBinaryData, SocketRecords.GetData(), sizeof(FNVAnnotationBinarySocket), SocketRecords.Num());
+
+        if (ObjectData.custom_data.IsValid())
+        {
+            FString CustomDataString;
+            TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> JsonWriter = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&CustomDataString);
+            FJsonSerializer::Serialize(ObjectData.custom_data.ToSharedRef(), JsonWriter);
+            JsonWriter->Close();
+            ObjectRecord.CustomData = AppendString(OutBinaryData, CustomDataString);
+        }
+
+        FMemory::Memcpy(OutBinaryData.GetData() + ObjectsOffset + ObjectIndex * sizeof(FNVAnnotationBinaryObject), &ObjectRecord, sizeof(ObjectRecord));
+    }
+
+    FNVAnnotationBinaryHeader Header;
+    FMemory::Memcpy(Header.Magic, AnnotationBinaryMagic, sizeof(AnnotationBinaryMagic));
+    Header.Version = AnnotationBinaryVersion;
+    Header.HeaderSize = sizeof(FNVAnnotationBinaryHeader);
+    Header.ViewpointSize = sizeof(FNVAnnotationBinaryViewpoint);
+    Header.ObjectSize = sizeof(FNVAnnotationBinaryObject);
+    Header.ObjectCount = ObjectCount;
+    Header.TotalSize = OutBinaryData.Num();
+    Header.OptionalObjectFields = SceneData.OptionalObjectFields;
+    FMemory::Memcpy(OutBinaryData.GetData(), &Header, sizeof(Header));
+}
+
+FString FNVAnnotationBinaryWriter::GetSchemaText()
+{
+    TSharedPtr<FJsonObject> SchemaJsonObj = MakeShareable(new FJsonObject());
+    SchemaJsonObj->SetStringField(TEXT("magic"), TEXT("NVAB"));
+    SchemaJsonObj->SetNumberField(TEXT("version"), AnnotationBinaryVersion);
+    SchemaJsonObj->SetStringField(TEXT("byte_order"), TEXT("little"));
+    SchemaJsonObj->SetNumberField(TEXT("variable_data_alignment"), VariableDataAlignment);
+    SchemaJsonObj->SetObjectField(TEXT("span"), MakeSchemaRecord(sizeof(FNVAnnotationBinarySpan), SpanSchemaFields));
+    SchemaJsonObj->SetObjectField(TEXT("header"), MakeSchemaRecord(sizeof(FNVAnnotationBinaryHeader), HeaderSchemaFields));
+    SchemaJsonObj->SetObjectField(TEXT("viewpoint"), MakeSchemaRecord(sizeof(FNVAnnotationBinaryViewpoint), ViewpointSchemaFields));
+    SchemaJsonObj->SetObjectField(TEXT("object"), MakeSchemaRecord(sizeof(FNVAnnotationBinaryObject), ObjectSchemaFields));
+    SchemaJsonObj->SetObjectField(TEXT("polygon"), MakeSchemaRecord(sizeof(FNVAnnotationBinaryPolygon), PolygonSchemaFields));
+    SchemaJsonObj->SetObjectField(TEXT("socket"), MakeSchemaRecord(sizeof(FNVAnnotationBinarySocket), SocketSchemaFields));
+
+    FString SchemaText;
+    auto JsonWriter = TJsonWriterFactory<>::Create(&SchemaText, 0);
+    FJsonSerializer::Serialize(SchemaJsonObj.ToSharedRef(), JsonWriter);
+    JsonWriter->Close();
+    return SchemaText;
+}
+
+//====================================== FNVAnnotationBinaryReader ==========================================
+FNVAnnotationBinaryReader::FNVAnnotationBinaryReader()
+    : Data(nullptr),
+    DataSize(0),
+    Header(nullptr)
+{
+}
+
+bool FNVAnnotationBinaryReader::Open(const uint8* InData, int64 InDataSize)
+{
+    Data = nullptr;
+    DataSize = 0;
+    Header = nullptr;
+
+    ensure(InData || (InDataSize == 0));
+    if (!InData || (InDataSize < (int64)sizeof(FNVAnnotationBinaryHeader)))
+    {
+        return false;
+    }
+
+    const FNVAnnotationBinaryHeader* CheckHeader = (const FNVAnnotationBinaryHeader*)InData;
+    const bool bValidHeader = (FMemory::Memcmp(CheckHeader->Magic, AnnotationBinaryMagic, sizeof(AnnotationBinaryMagic)) == 0) &&
+                              (CheckHeader->Version == AnnotationBinaryVersion) &&
+                              (CheckHeader->HeaderSize == sizeof(FNVAnnotationBinaryHeader)) &&
+                              (CheckHeader->ViewpointSize == sizeof(FNVAnnotationBinaryViewpoint)) &&
+                              (CheckHeader->ObjectSize == sizeof(FNVAnnotationBinaryObject)) &&
+                              (CheckHeader->TotalSize <= InDataSize);
+    const int64 FixedDataSize = int64(CheckHeader->HeaderSize) + CheckHeader->ViewpointSize + int64(CheckHeader->ObjectCount) * CheckHeader->ObjectSize;
+    if (!bValidHeader || (FixedDataSize > CheckHeader->TotalSize))
+    {
+        return false;
+    }
+
+    Data = InData;
+    DataSize = CheckHeader->TotalSize;
+    Header = CheckHeader;
+
+    // Check all the spans once so the accessors don't need to
+    bool bValidSpans = true;
+    for (int32 ObjectIndex = 0; bValidSpans && (ObjectIndex < GetObjectCount()); ObjectIndex++)
+    {
+        const FNVAnnotationBinaryObject& ObjectRecord = GetObject(ObjectIndex);
+        bValidSpans = IsValidSpan(ObjectRecord.Name, 1) &&
+                      IsValidSpan(ObjectRecord.Class, 1) &&
+                      IsValidSpan(ObjectRecord.Rgba, sizeof(uint8)) &&
+                      IsValidSpan(ObjectRecord.Cuboid, 3 * sizeof(float)) &&
+                      IsValidSpan(ObjectRecord.ProjectedCuboid, 2 * sizeof(float)) &&
+                      IsValidSpan(ObjectRecord.SegmentationRleCounts, sizeof(uint32)) &&
+                      IsValidSpan(ObjectRecord.SegmentationPolygons, sizeof(FNVAnnotationBinaryPolygon)) &&
+                      IsValidSpan(ObjectRecord.SocketData, sizeof(FNVAnnotationBinarySocket)) &&
+                      IsValidSpan(ObjectRecord.CustomData, 1);
+
+        const FNVAnnotationBinaryPolygon* PolygonRecords = GetArray<FNVAnnotationBinaryPolygon>(ObjectRecord.SegmentationPolygons);
+        for (uint32 PolygonIndex = 0; bValidSpans && (PolygonIndex < ObjectRecord.SegmentationPolygons.Count); PolygonIndex++)
+        {
+            bValidSpans = IsValidSpan(PolygonRecords[PolygonIndex].Points, 2 * sizeof(float));
+        }
+
+        const FNVAnnotationBinarySocket* SocketRecords = GetArray<FNVAnnotationBinarySocket>(ObjectRecord.SocketData);
+        for (uint32 SocketIndex = 0; bValidSpans && (SocketIndex < ObjectRecord.SocketData.Count); SocketIndex++)
+        {
+            bValidSpans = IsValidSpan(SocketRecords[SocketIndex].SocketName, 1);
+        }
+    }
+
+    if (!bValidSpans)
+    {
+        Data = nullptr;
+        DataSize = 0;
+        Header = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool FNVAnnotationBinaryReader::IsOpen() const
+{
+    return (Header != nullptr);
+}
+
+const FNVAnnotationBinaryViewpoint& FNVAnnotationBinaryReader::GetViewpoint() const
+{
+    check(IsOpen());
+    return *(const FNVAnnotationBinaryViewpoint*)(Data + Header->HeaderSize);
+}
+
+int32 FNVAnnotationBinaryReader::GetObjectCount() const
+{
+    return Header ? Header->ObjectCount : 0;
+}
+
+const FNVAnnotationBinaryObject& FNVAnnotationBinaryReader::GetObject(int32 ObjectIndex) const
+{
+    check((ObjectIndex >= 0) && (ObjectIndex < GetObjectCount()));
+    const int64 ObjectOffset = int64(Header->HeaderSize) + Header->ViewpointSize + int64(ObjectIndex) * Header->ObjectSize;
+    return *(const FNVAnnotationBinaryObject*)(Data + ObjectOffset);
+}
+
+FString FNVAnnotationBinaryReader::GetString(const FNVAnnotationBinarySpan& StringSpan) const
+{
+    if ((StringSpan.Count == 0) || !IsValidSpan(StringSpan, 1))
+    {
+        return FString();
+    }
+
+    FUTF8ToTCHAR StringTCHAR((const ANSICHAR*)(Data + StringSpan.Offset), StringSpan.Count);
+    return FString(StringTCHAR.Length(), StringTCHAR.Get());
+}
+
+bool FNVAnnotationBinaryReader::IsValidSpan(const FNVAnnotationBinarySpan& CheckSpan, uint32 ElementSize) const
+{
+    if (CheckSpan.Count == 0)
+    {
+        return true;
+    }
+    const int64 SpanEnd = int64(CheckSpan.Offset) + int64(CheckSpan.Count) * ElementSize;
+    return (CheckSpan.Offset >= Header->HeaderSize) && (SpanEnd <= DataSize);
+}
+
+void FNVAnnotationBinaryReader::ReadCapturedSceneData(FCapturedSceneData& OutSceneData) const
+{
+    OutSceneData.Objects.Reset();
+    OutSceneData.OptionalObjectFields = ENVOptionalObjectFields::None;
+    if (!IsOpen())
+    {
+        return;
+    }
+
+    OutSceneData.OptionalObjectFields = Header->OptionalObjectFields;
+
+    const FNVAnnotationBinaryViewpoint& ViewpointRecord = GetViewpoint();
+    FCapturedViewpointData& ViewpointData = OutSceneData.camera_data;
+    ViewpointData.location_worldframe = ToVector(ViewpointRecord.LocationWorldframe);
+    ViewpointData.quaternion_xyzw_worldframe = ToQuat(ViewpointRecord.QuaternionXYZWWorldframe);
+    ViewpointData.ProjectionMatrix = ToMatrix(ViewpointRecord.ProjectionMatrix);
+    ViewpointData.ViewProjectionMatrix = ToMatrix(ViewpointRecord.ViewProjectionMatrix);
+    FCameraIntrinsicSettings& CameraSettings = ViewpointData.CameraSettings;
+    CameraSettings.ResX = ViewpointRecord.ResX;
+    CameraSettings.ResY = ViewpointRecord.ResY;
+    CameraSettings.Fx = ViewpointRecord.Fx;
+    CameraSettings.Fy = ViewpointRecord.Fy;
+    CameraSettings.Cx = ViewpointRecord.Cx;
+    CameraSettings.Cy = ViewpointRecord.Cy;
+    CameraSettings.S = ViewpointRecord.S;
+    CameraSettings.IntrinsicMatrix = ToMatrix(ViewpointRecord.IntrinsicMatrix);
+    CameraSettings.ProjectionMatrix = ToMatrix(ViewpointRecord.CameraProjectionMatrix);
+    ViewpointData.fov = ViewpointRecord.Fov;
+
+    OutSceneData.Objects.SetNum(GetObjectCount());
+    for (int32 ObjectIndex = 0; ObjectIndex < GetObjectCount(); ObjectIndex++)
+    {
+        const FNVAnnotationBinaryObject& ObjectRecord = GetObject(ObjectIndex);
+        FCapturedObjectData& ObjectData = OutSceneData.Objects[ObjectIndex];
+
+        ObjectData.Name = GetString(ObjectRecord.Name);
+        ObjectData.Class = GetString(ObjectRecord.Class);
+        ObjectData.instance_id = ObjectRecord.InstanceId;
+        ObjectData.rgba = TArray<uint8>(GetArray<uint8>(ObjectRecord.Rgba), ObjectRecord.Rgba.Count);
+        ObjectData.truncated = ObjectRecord.Truncated;
+        ObjectData.occluded = ObjectRecord.Occluded;
+        ObjectData.occlusion = ObjectRecord.Occlusion;
+        ObjectData.visibility = ObjectRecord.Visibility;
+        ObjectData.visible_pixel_count = ObjectRecord.VisiblePixelCount;
+        ObjectData.projected_pixel_count = ObjectRecord.ProjectedPixelCount;
+        ObjectData.truncation_flags = ObjectRecord.TruncationFlags;
+        ObjectData.dimensions_worldspace = ToVector(ObjectRecord.DimensionsWorldspace);
+        ObjectData.location_worldspace = ToVector(ObjectRecord.LocationWorldspace);
+        ObjectData.location = ToVector(ObjectRecord.Location);
+        ObjectData.rotation_worldspace = ToRotator(ObjectRecord.RotationWorldspace);
+        ObjectData.quaternion_worldspace = ToQuat(ObjectRecord.QuaternionWorldspace);
+        ObjectData.rotation = ToRotator(ObjectRecord.Rotation);
+        ObjectData.quaternion_xyzw = ToQuat(ObjectRecord.QuaternionXYZW);
+        ObjectData.actor_to_world_matrix_ue4 = ToMatrix(ObjectRecord.ActorToWorldMatrixUE4);
+        ObjectData.actor_to_world_matrix_opencv = ToMatrix(ObjectRecord.ActorToWorldMatrixOpenCV);
+        ObjectData.actor_to_camera_matrix = ToMatrix(ObjectRecord.ActorToCameraMatrix);
+        ObjectData.pose_transform = ToMatrix(ObjectRecord.PoseTransform);
+        ObjectData.bounding_box_center_worldspace = ToVector(ObjectRecord.BoundingBoxCenterWorldspace);
+        ObjectData.cuboid_centroid = ToVector(ObjectRecord.CuboidCentroid);
+        ObjectData.projected_cuboid_centroid = ToVector2D(ObjectRecord.ProjectedCuboidCentroid);
+        ObjectData.bounding_box_forward_direction = ToVector(ObjectRecord.BoundingBoxForwardDirection);
+        ObjectData.bounding_box_forward_direction_imagespace = ToVector2D(ObjectRecord.BoundingBoxForwardDirectionImagespace);
+        ObjectData.viewpoint_azimuth_angle = ObjectRecord.ViewpointAzimuthAngle;
+        ObjectData.viewpoint_altitude_angle = ObjectRecord.ViewpointAltitudeAngle;
+        ObjectData.distance_scale = ObjectRecord.DistanceScale;
+        ObjectData.bounding_box.top_left = ToVector2D(ObjectRecord.BoundingBoxTopLeft);
+        ObjectData.bounding_box.bottom_right = ToVector2D(ObjectRecord.BoundingBoxBottomRight);
+
+        ObjectData.segmentation_rle.size.Reset();
+        if ((ObjectRecord.SegmentationRleSize[0] > 0) || (ObjectRecord.SegmentationRleSize[1] > 0))
+        {
+            ObjectData.segmentation_rle.size.Add(ObjectRecord.SegmentationRleSize[0]);
+            ObjectData.segmentation_rle.size.Add(ObjectRecord.SegmentationRleSize[1]);
+        }
+        ObjectData.segmentation_rle.counts = TArray<uint32>(GetArray<uint32>(ObjectRecord.SegmentationRleCounts), ObjectRecord.SegmentationRleCounts.Count);
+
+        const FNVAnnotationBinaryPolygon* PolygonRecords = GetArray<FNVAnnotationBinaryPolygon>(ObjectRecord.SegmentationPolygons);
+        ObjectData.segmentation_polygons.Reset(ObjectRecord.SegmentationPolygons.Count);
+        for (uint32 i = 0; i < ObjectRecord.SegmentationPolygons.Count; i++)
+        {
+            const float* PointValues = GetArray<float>(PolygonRecords[i].Points);
+            FNVPolygon2D& Polygon = ObjectData.segmentation_polygons[ObjectData.segmentation_polygons.AddDefaulted()];
+            Polygon.points.Reset(PolygonRecords[i].Points.Count);
+            for (uint32 j = 0; j < PolygonRecords[i].Points.Count; j++)
+            {
+                Polygon.points.Add(ToVector2D(PointValues + j * 2));
+            }
+        }
+
+        const float* CuboidValues = GetArray<float>(ObjectRecord.Cuboid);
+        ObjectData.cuboid.Reset(ObjectRecord.Cuboid.Count);
+        for (uint32 i = 0; i < ObjectRecord.Cuboid.Count; i++)
+        {
+            ObjectData.cuboid.Add(ToVector(CuboidValues + i * 3));
+        }
+
+        const float* ProjectedCuboidValues = GetArray<float>(ObjectRecord.ProjectedCuboid);
+        ObjectData.projected_cuboid.Reset(ObjectRecord.ProjectedCuboid.Count);
+        for (uint32 i = 0; i < ObjectRecord.ProjectedCuboid.Count; i++)
+        {
+            ObjectData.projected_cuboid.Add(ToVector2D(ProjectedCuboidValues + i * 2));
+        }
+
+        const FNVAnnotationBinarySocket* SocketRecords = GetArray<FNVAnnotationBinarySocket>(ObjectRecord.SocketData);
+        ObjectData.socket_data.Reset(ObjectRecord.SocketData.Count);
+        for (uint32 i = 0; i < ObjectRecord.SocketData.Count; i++)
+        {
+            FNVSocketData SocketData;
+            SocketData.SocketName = GetString(SocketRecords[i].SocketName);
+            SocketData.SocketLocation = ToVector2D(SocketRecords[i].SocketLocation);
+            ObjectData.socket_data.Add(SocketData);
+        }
+
+        ObjectData.custom_data.Reset();
+        if (ObjectRecord.CustomData.Count > 0)
+        {
+            TSharedPtr<FJsonObject> CustomDataJsonObj;
+            TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(GetString(ObjectRecord.CustomData));
+            if (FJsonSerializer::Deserialize(JsonReader, CustomDataJsonObj) && CustomDataJsonObj.IsValid())
+            {
+                ObjectData.custom_data = CustomDataJsonObj;
+            }
+        }
+    }
+}
+
+bool FNVAnnotationBinaryReader::ConvertToJson(const TArray<uint8>& BinaryData, TArray<uint8>& OutJsonData)
+{
+    FNVAnnotationBinaryReader BinaryReader;
+    if (!BinaryReader.Open(BinaryData.GetData(), BinaryData.Num()))
+    {
+        return false;
+    }
+
+    FCapturedSceneData SceneData;
+    BinaryReader.ReadCapturedSceneData(SceneData);
+    FNVJsonWriter::SerializeCapturedSceneData(SceneData, OutJsonData);
+    return true;
+}
+
+bool FNVAnnotationBinaryReader::ConvertFileToJson(const FString& BinaryFilePath, const FString& JsonFilePath)
+{
+    TArray<uint8> BinaryData;
+    if (!FFileHelper::LoadFileToArray(BinaryData, *BinaryFilePath))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Can't read the binary annotation file '%s'."), *BinaryFilePath);
+        return false;
+    }
+
+    TArray<uint8> JsonData;
+    if (!ConvertToJson(BinaryData, JsonData))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("'%s' is not a valid binary annotation file."), *BinaryFilePath);
+        return false;
+    }
+
+    if (!FFileHelper::SaveArrayToFile(JsonData, *JsonFilePath))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Unable to open file for writing.  Check permissions. File is %s"), *JsonFilePath);
+        return false;
+    }
+    return true;
+}
+
+int32 FNVAnnotationBinaryReader::ConvertDirectoryToJson(const FString& BinaryDirectory, const FString& JsonDirectory /*= TEXT("")*/)
+{
+    if (!IFileManager::Get().DirectoryExists(*BinaryDirectory))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("The binary annotation directory '%s' doesn't exist."), *BinaryDirectory);
+        return 0;
+    }
+
+    TArray<FString> BinaryFilePaths;
+    IFileManager::Get().FindFilesRecursive(BinaryFilePaths, *BinaryDirectory, *(FString(TEXT("*")) + FNVAnnotationBinaryWriter::FileExtension), true, false);
+    BinaryFilePaths.Sort();
+
+    const FString OutputDirectory = JsonDirectory.IsEmpty() ? BinaryDirectory : JsonDirectory;
+    int32 ConvertedFileCount = 0;
+    for (const FString& BinaryFilePath : BinaryFilePaths)
+    {
+        FString RelativeFilePath = BinaryFilePath;
+        // NOTE: The trailing slash make the path relative to the directory itself instead of its parent
+        FPaths::MakePathRelativeTo(RelativeFilePath, *(BinaryDirectory / TEXT("")));
+        const FString JsonFilePath = FPaths::Combine(OutputDirectory, FPaths::ChangeExtension(RelativeFilePath, TEXT(".json")));
+        if (ConvertFileToJson(BinaryFilePath, JsonFilePath))
+        {
+            ConvertedFileCount++;
+        }
+    }
+
+    UE_LOG(LogNVSceneCapturer, Log, TEXT("Converted %d of %d binary annotation files in '%s' to json."), ConvertedFileCount,
+           BinaryFilePaths.Num(), *BinaryDirectory);
+    return ConvertedFileCount;
+}
+
+namespace
+{
+    void ConvertAnnotationsToJson(const TArray<FString>& Args)
+    {
+        if (Args.Num() < 1)
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("Usage: NVSceneCapturer.ConvertAnnotationsToJson <BinaryDirectory> [JsonDirectory]"));
+            return;
+        }
+
+        FNVAnnotationBinaryReader::ConvertDirectoryToJson(Args[0], (Args.Num() > 1) ? Args[1] : FString());
+    }
+
+    FAutoConsoleCommand ConvertAnnotationsToJsonCommand(
+        TEXT("NVSceneCapturer.ConvertAnnotationsToJson"),
+        TEXT("Convert all the binary annotation files (.nvab) in a directory to the json files the json exporter would have written.\n")
+        TEXT("Usage: NVSceneCapturer.ConvertAnnotationsToJson <BinaryDirectory> [JsonDirectory]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&ConvertAnnotationsToJson));
+}
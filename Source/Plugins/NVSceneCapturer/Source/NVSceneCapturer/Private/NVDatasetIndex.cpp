@@ -0,0 +1,331 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVDatasetIndex.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+    const uint8 DatasetIndexMagic[4] = { 'N', 'V', 'D', 'I' };
+    const uint32 DatasetIndexVersion = 1;
+
+    bool IsValidIndexHeader(const FNVDatasetIndexHeader& Header)
+    {
+        return (FMemory::Memcmp(Header.Magic, DatasetIndexMagic, sizeof(DatasetIndexMagic)) == 0) &&
+               (Header.Version == DatasetIndexVersion) &&
+               (Header.HeaderSize == sizeof(FNVDatasetIndexHeader)) &&
+               (Header.RecordSize == sizeof(FNVDatasetIndexRecord));
+    }
+
+    // NOTE: Can't use FFileHelper::LoadFileToStringArray since it skip the empty lines, which are valid names
+    bool LoadIndexNames(const FString& NamesFilePath, TArray<FString>& OutNames)
+    {
+        OutNames.Reset();
+        FString NamesFileContent;
+        if (!FFileHelper::LoadFileToString(NamesFileContent, *NamesFilePath))
+        {
+            return false;
+        }
+
+        NamesFileContent.ParseIntoArray(OutNames, TEXT("\n"), false);
+        // Every name end with a line break so the last element is always empty
+        if ((OutNames.Num() > 0) && OutNames.Last().IsEmpty())
+        {
+            OutNames.Pop();
+        }
+        return true;
+    }
+}
+
+//====================================== FNVDatasetIndexWriter ==========================================
+FNVDatasetIndexWriter::FNVDatasetIndexWriter(const FString& InIndexFilePath, bool bAppendToExistingIndex /*= false*/, int32 InSyncEveryNumRecords /*= 256*/)
+    : IndexFilePath(InIndexFilePath),
+    SyncEveryNumRecords(FMath::Max(InSyncEveryNumRecords, 0)),
+    IndexFileHandle(nullptr),
+    NamesFileHandle(nullptr),
+    RecordCount(0),
+    UnsyncedRecordCount(0)
+{
+    Open(bAppendToExistingIndex);
+}
+
+FNVDatasetIndexWriter::~FNVDatasetIndexWriter()
+{
+    Close();
+}
+
+FString FNVDatasetIndexWriter::GetNamesFilePath(const FString& IndexFilePath)
+{
+    return FPaths::ChangeExtension(IndexFilePath, TEXT(".names"));
+}
+
+bool FNVDatasetIndexWriter::Open(bool bAppendToExistingIndex)
+{
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    const FString NamesFilePath = GetNamesFilePath(IndexFilePath);
+    PlatformFile.CreateDirectoryTree(*FPaths::GetPath(IndexFilePath));
+
+    bool bAppend = false;
+    if (bAppendToExistingIndex && PlatformFile.FileExists(*IndexFilePath))
+    {
+        // Only append to the existing index if it's written by the same version and doesn't end with a partial record
+        FNVDatasetIndexHeader ExistingHeader;
+        const int64 ExistingFileSize = PlatformFile.FileSize(*IndexFilePath);
+        IFileHandle* ExistingFileHandle = PlatformFile.OpenRead(*IndexFilePath);
+        if (ExistingFileHandle)
+        {
+            if (ExistingFileHandle->Read((uint8*)&ExistingHeader, sizeof(ExistingHeader)) && IsValidIndexHeader(ExistingHeader))
+            {
+                const int64 RecordDataSize = ExistingFileSize - ExistingHeader.HeaderSize;
+                bAppend = ((RecordDataSize % ExistingHeader.RecordSize) == 0);
+                RecordCount = bAppend ? (RecordDataSize / ExistingHeader.RecordSize) : 0;
+            }
+            delete ExistingFileHandle;
+        }
+
+        TArray<FString> ExistingNames;
+        if (bAppend && LoadIndexNames(NamesFilePath, ExistingNames))
+        {
+            for (int32 i = 0; i < ExistingNames.Num(); i++)
+            {
+                NameIdMap.Add(ExistingNames[i], (uint16)i);
+            }
+        }
+
+        if (!bAppend)
+        {
+            UE_LOG(LogNVSceneCapturer, Warning, TEXT("Existing dataset index '%s' can't be appended to, a new index is started."), *IndexFilePath);
+        }
+    }
+
+    IndexFileHandle = PlatformFile.OpenWrite(*IndexFilePath, bAppend);
+    NamesFileHandle = PlatformFile.OpenWrite(*NamesFilePath, bAppend);
+    if (!IndexFileHandle || !NamesFileHandle)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Unable to open file for writing.  Check permissions. File is %s"), *IndexFilePath);
+        Close();
+        return false;
+    }
+
+    if (!bAppend)
+    {
+        FNVDatasetIndexHeader NewHeader;
+        FMemory::Memcpy(NewHeader.Magic, DatasetIndexMagic, sizeof(DatasetIndexMagic));
+        NewHeader.Version = DatasetIndexVersion;
+        NewHeader.HeaderSize = sizeof(FNVDatasetIndexHeader);
+        NewHeader.RecordSize = sizeof(FNVDatasetIndexRecord);
+        IndexFileHandle->Write((const uint8*)&NewHeader, sizeof(NewHeader));
+        RecordCount = 0;
+        NameIdMap.Reset();
+    }
+
+    return true;
+}
+
+uint16 FNVDatasetIndexWriter::GetNameId(const FString& Name)
+{
+    FScopeLock ScopeLock(&WriterCriticalSection);
+    const uint16* ExistingNameId = NameIdMap.Find(Name);
+    if (ExistingNameId)
+    {
+        return *ExistingNameId;
+    }
+
+    ensure(NameIdMap.Num() < MAX_uint16);
+    const uint16 NewNameId = (uint16)NameIdMap.Num();
+    NameIdMap.Add(Name, NewNameId);
+
+    if (NamesFileHandle)
+    {
+        // NOTE: Each name take 1 line so the names can't contain line breaks
+        const FString NameLine = Name.Replace(TEXT("\n"), TEXT(" ")).Replace(TEXT("\r"), TEXT(" ")) + TEXT("\n");
+        FTCHARToUTF8 NameLineUTF8(*NameLine);
+        NamesFileHandle->Write((const uint8*)NameLineUTF8.Get(), NameLineUTF8.Length());
+    }
+    return NewNameId;
+}
+
+bool FNVDatasetIndexWriter::AddRecord(const FNVDatasetIndexRecord& Record)
+{
+    FScopeLock ScopeLock(&WriterCriticalSection);
+    if (!IndexFileHandle)
+    {
+        return false;
+    }
+
+    if (!IndexFileHandle->Write((const uint8*)&Record, sizeof(Record)))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Can't write to the dataset index '%s'. Check the disk space and permissions."), *IndexFilePath);
+        return false;
+    }
+    RecordCount++;
+
+    UnsyncedRecordCount++;
+    if ((SyncEveryNumRecords > 0) && (UnsyncedRecordCount >= SyncEveryNumRecords))
+    {
+        // NOTE: The names must be on disk before the records which use them
+        NamesFileHandle->Flush();
+        IndexFileHandle->Flush();
+        UnsyncedRecordCount = 0;
+    }
+    return true;
+}
+
+bool FNVDatasetIndexWriter::AddRecord(const FNVDatasetIndexRecord& Record, const uint8* Data, int64 DataSize)
+{
+    ensure(Data || (DataSize == 0));
+    if (!Data && (DataSize != 0))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return false;
+    }
+
+    // NOTE: Compute the checksum before taking the lock so the other threads don't need to wait for it
+    FNVDatasetIndexRecord DataRecord = Record;
+    DataRecord.DataSize = DataSize;
+    DataRecord.Checksum = (DataSize > 0) ? FCrc::MemCrc32(Data, DataSize) : 0;
+    return AddRecord(DataRecord);
+}
+
+void FNVDatasetIndexWriter::Flush()
+{
+    FScopeLock ScopeLock(&WriterCriticalSection);
+    if (NamesFileHandle)
+    {
+        NamesFileHandle->Flush();
+    }
+    if (IndexFileHandle)
+    {
+        IndexFileHandle->Flush();
+    }
+    UnsyncedRecordCount = 0;
+}
+
+void FNVDatasetIndexWriter::Close()
+{
+    FScopeLock ScopeLock(&WriterCriticalSection);
+    if (NamesFileHandle)
+    {
+        NamesFileHandle->Flush();
+        delete NamesFileHandle;
+        NamesFileHandle = nullptr;
+    }
+    if (IndexFileHandle)
+    {
+        IndexFileHandle->Flush();
+        delete IndexFileHandle;
+        IndexFileHandle = nullptr;
+    }
+    UnsyncedRecordCount = 0;
+}
+
+int64 FNVDatasetIndexWriter::GetRecordCount() const
+{
+    FScopeLock ScopeLock(&WriterCriticalSection);
+    return RecordCount;
+}
+
+//====================================== FNVDatasetIndexReader ==========================================
+FNVDatasetIndexReader::FNVDatasetIndexReader()
+    : MappedFileHandle(nullptr),
+    MappedFileRegion(nullptr),
+    Records(nullptr),
+    RecordCount(0)
+{
+}
+
+FNVDatasetIndexReader::~FNVDatasetIndexReader()
+{
+    Close();
+}
+
+bool FNVDatasetIndexReader::Open(const FString& IndexFilePath)
+{
+    Close();
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    const uint8* FileData = nullptr;
+    int64 FileSize = 0;
+
+    MappedFileHandle = PlatformFile.OpenMapped(*IndexFilePath);
+    if (MappedFileHandle)
+    {
+        MappedFileRegion = MappedFileHandle->MapRegion();
+        if (MappedFileRegion)
+        {
+            FileData = MappedFileRegion->GetMappedPtr();
+            FileSize = MappedFileRegion->GetMappedSize();
+        }
+        else
+        {
+            delete MappedFileHandle;
+            MappedFileHandle = nullptr;
+        }
+    }
+
+    // Read the whole file to memory instead if it can't be mapped
+    if (!FileData && FFileHelper::LoadFileToArray(LoadedFileData, *IndexFilePath))
+    {
+        FileData = LoadedFileData.GetData();
+        FileSize = LoadedFileData.Num();
+    }
+
+    const FNVDatasetIndexHeader* Header = (const FNVDatasetIndexHeader*)FileData;
+    if (!FileData || (FileSize < (int64)sizeof(FNVDatasetIndexHeader)) || !IsValidIndexHeader(*Header))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("'%s' is not a valid dataset index."), *IndexFilePath);
+        Close();
+        return false;
+    }
+
+    // NOTE: Ignore the partial record at the end if the capture was interrupted while writing it
+    Records = (const FNVDatasetIndexRecord*)(FileData + Header->HeaderSize);
+    RecordCount = (FileSize - Header->HeaderSize) / Header->RecordSize;
+
+    LoadIndexNames(FNVDatasetIndexWriter::GetNamesFilePath(IndexFilePath), Names);
+    return true;
+}
+
+void FNVDatasetIndexReader::Close()
+{
+    if (MappedFileRegion)
+    {
+        delete MappedFileRegion;
+        MappedFileRegion = nullptr;
+    }
+    if (MappedFileHandle)
+    {
+        delete MappedFileHandle;
+        MappedFileHandle = nullptr;
+    }
+    LoadedFileData.Empty();
+    Names.Empty();
+    Records = nullptr;
+    RecordCount = 0;
+}
+
+bool FNVDatasetIndexReader::IsOpen() const
+{
+    return (Records != nullptr);
+}
+
+int64 FNVDatasetIndexReader::Num() const
+{
+    return RecordCount;
+}
+
+const FNVDatasetIndexRecord& FNVDatasetIndexReader::GetRecord(int64 RecordIndex) const
+{
+    check((RecordIndex >= 0) && (RecordIndex < RecordCount));
+    return Records[RecordIndex];
+}
+
+FString FNVDatasetIndexReader::GetName(uint16 NameId) const
+{
+    return Names.IsValidIndex(NameId) ? Names[NameId] : FString();
+}
@@ -0,0 +1,272 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVDatasetShardWriter.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+    // Write a number as a zero-padded, null-terminated octal string which fill the whole field
+    void WriteTarOctalField(uint8* Field, int32 FieldSize, int64 Value)
+    {
+        Field[FieldSize - 1] = '\0';
+        for (int32 i = FieldSize - 2; i >= 0; i--)
+        {
+            Field[i] = (uint8)('0' + (Value & 7));
+            Value >>= 3;
+        }
+    }
+}
+
+//====================================== FNVDatasetShardWriter ==========================================
+FNVDatasetShardWriter::FNVDatasetShardWriter(const FString& InOutputDirectoryPath, const FString& InShardNamePrefix,
+        int64 InMaxShardSize, int32 InFlushEveryNumEntries)
+    : OutputDirectoryPath(InOutputDirectoryPath),
+    ShardNamePrefix(InShardNamePrefix),
+    MaxShardSize(FMath::Max<int64>(InMaxShardSize, 0)),
+    FlushEveryNumEntries(FMath::Max(InFlushEveryNumEntries, 0)),
+    ShardFileHandle(nullptr),
+    ShardCount(0),
+    CurrentShardSize(0),
+    UnflushedEntryCount(0),
+    EntryCount(0),
+    TotalWrittenSize(0),
+    bIsClosed(false)
+{
+    if (ShardNamePrefix.IsEmpty())
+    {
+        ShardNamePrefix = TEXT("shard");
+    }
+}
+
+FNVDatasetShardWriter::~FNVDatasetShardWriter()
+{
+    Close();
+}
+
+bool FNVDatasetShardWriter::AddEntry(const FString& EntryName, const TArray<uint8>& Data,
+        int32* OutShardIndex /*= nullptr*/, int64* OutDataOffset /*= nullptr*/)
+{
+    return AddEntry(EntryName, Data.GetData(), Data.Num(), OutShardIndex, OutDataOffset);
+}
+
+bool FNVDatasetShardWriter::AddEntry(const FString& EntryName, const uint8* Data, int64 DataSize,
+        int32* OutShardIndex /*= nullptr*/, int64* OutDataOffset /*= nullptr*/)
+{
+    ensure(Data || (DataSize == 0));
+    if (!Data && (DataSize != 0))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return false;
+    }
+
+    uint8 HeaderBlock[TarBlockSize];
+    if (!BuildEntryHeader(EntryName, DataSize, HeaderBlock))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Can't add entry '%s' to the dataset shard, the name is too long."), *EntryName);
+        return false;
+    }
+
+    // The entry's content is padded with zeros to the next block
+    static const uint8 ZeroBlock[TarBlockSize] = { 0 };
+    const int64 PaddingSize = (TarBlockSize - (DataSize % TarBlockSize)) % TarBlockSize;
+    const int64 EntrySize = TarBlockSize + DataSize + PaddingSize;
+
+    FScopeLock ScopeLock(&WriterCriticalSection);
+    if (bIsClosed)
+    {
+        return false;
+    }
+
+    // Start a new shard if this entry would make the current one too big
+    // NOTE: The 2 blocks at the end are the end-of-archive marker
+    const bool bShardIsFull = ShardFileHandle && (MaxShardSize > 0) && (CurrentShardSize > 0) &&
+                              (CurrentShardSize + EntrySize + 2 * TarBlockSize > MaxShardSize);
+    if (bShardIsFull)
+    {
+        CloseCurrentShard();
+    }
+    if (!ShardFileHandle && !OpenNextShard())
+    {
+        return false;
+    }
+
+    bool bResult = ShardFileHandle->Write(HeaderBlock, TarBlockSize);
+    if (bResult && (DataSize > 0))
+    {
+        bResult = ShardFileHandle->Write(Data, DataSize);
+    }
+    if (bResult && (PaddingSize > 0))
+    {
+        bResult = ShardFileHandle->Write(ZeroBlock, PaddingSize);
+    }
+
+    if (!bResult)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Can't write entry '%s' to the dataset shard. Check the disk space and permissions. No more entries are accepted."),
+               *EntryName);
+
+        // Drop the partially written entry: the shard end right after its last complete entry so it stay a valid archive
+        // and the offsets of the entries already written stay valid
+        // NOTE: The next writes would most likely fail the same way (e.g: the disk is full) so the writer stop there
+        if (!ShardFileHandle->Seek(CurrentShardSize))
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("Can't remove the partial entry '%s' from dataset shard %d, the end of the shard is corrupted."),
+                   *EntryName, ShardCount - 1);
+        }
+        CloseCurrentShard();
+        bIsClosed = true;
+        return false;
+    }
+
+    if (OutShardIndex)
+    {
+        *OutShardIndex = ShardCount - 1;
+    }
+    if (OutDataOffset)
+    {
+        *OutDataOffset = CurrentShardSize + TarBlockSize;
+    }
+
+    CurrentShardSize += EntrySize;
+    TotalWrittenSize += EntrySize;
+    EntryCount++;
+
+    // Batch the flushes so we keep the sequential write throughput
+    UnflushedEntryCount++;
+    if ((FlushEveryNumEntries > 0) && (UnflushedEntryCount >= FlushEveryNumEntries))
+    {
+        ShardFileHandle->Flush();
+        UnflushedEntryCount = 0;
+    }
+
+    return true;
+}
+
+void FNVDatasetShardWriter::Flush()
+{
+    FScopeLock ScopeLock(&WriterCriticalSection);
+    if (ShardFileHandle)
+    {
+        ShardFileHandle->Flush();
+        UnflushedEntryCount = 0;
+    }
+}
+
+void FNVDatasetShardWriter::Close()
+{
+    FScopeLock ScopeLock(&WriterCriticalSection);
+    if (!bIsClosed)
+    {
+        CloseCurrentShard();
+        bIsClosed = true;
+
+        UE_LOG(LogNVSceneCapturer, Log, TEXT("Wrote %lld entries (%lld bytes) into %d dataset shards in '%s'."),
+               EntryCount, TotalWrittenSize, ShardCount, *OutputDirectoryPath);
+    }
+}
+
+bool FNVDatasetShardWriter::IsClosed() const
+{
+    FScopeLock ScopeLock(&WriterCriticalSection);
+    return bIsClosed;
+}
+
+int32 FNVDatasetShardWriter::GetShardCount() const
+{
+    FScopeLock ScopeLock(&WriterCriticalSection);
+    return ShardCount;
+}
+
+int64 FNVDatasetShardWriter::GetEntryCount() const
+{
+    FScopeLock ScopeLock(&WriterCriticalSection);
+    return EntryCount;
+}
+
+int64 FNVDatasetShardWriter::GetTotalWrittenSize() const
+{
+    FScopeLock ScopeLock(&WriterCriticalSection);
+    return TotalWrittenSize;
+}
+
+bool FNVDatasetShardWriter::OpenNextShard()
+{
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    if (!PlatformFile.DirectoryExists(*OutputDirectoryPath))
+    {
+        PlatformFile.CreateDirectoryTree(*OutputDirectoryPath);
+    }
+
+    const FString ShardFileName = FString::Printf(TEXT("%s-%06d.tar"), *ShardNamePrefix, ShardCount);
+    const FString ShardFilePath = FPaths::Combine(OutputDirectoryPath, ShardFileName);
+    ShardFileHandle = PlatformFile.OpenWrite(*ShardFilePath);
+    if (!ShardFileHandle)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Unable to open file for writing.  Check permissions. File is %s"), *ShardFilePath);
+        return false;
+    }
+
+    ShardCount++;
+    CurrentShardSize = 0;
+    UnflushedEntryCount = 0;
+    return true;
+}
+
+void FNVDatasetShardWriter::CloseCurrentShard()
+{
+    if (ShardFileHandle)
+    {
+        // End the archive with 2 empty blocks
+        static const uint8 EndOfArchiveBlocks[2 * TarBlockSize] = { 0 };
+        ShardFileHandle->Write(EndOfArchiveBlocks, sizeof(EndOfArchiveBlocks));
+        ShardFileHandle->Flush();
+
+        delete ShardFileHandle;
+        ShardFileHandle = nullptr;
+        CurrentShardSize = 0;
+        UnflushedEntryCount = 0;
+    }
+}
+
+bool FNVDatasetShardWriter::BuildEntryHeader(const FString& EntryName, int64 DataSize, uint8* OutHeaderBlock)
+{
+    // ustar header layout: https://www.gnu.org/software/tar/manual/html_node/Standard.html
+    static const int32 NameFieldSize = 100;
+
+    FTCHARToUTF8 EntryNameUTF8(*EntryName);
+    const int32 EntryNameLength = EntryNameUTF8.Length();
+    if ((EntryNameLength == 0) || (EntryNameLength >= NameFieldSize))
+    {
+        return false;
+    }
+
+    FMemory::Memzero(OutHeaderBlock, TarBlockSize);
+    FMemory::Memcpy(OutHeaderBlock, EntryNameUTF8.Get(), EntryNameLength);
+
+    WriteTarOctalField(OutHeaderBlock + 100, 8, 0644);          // mode
+    WriteTarOctalField(OutHeaderBlock + 108, 8, 0);             // uid
+    WriteTarOctalField(OutHeaderBlock + 116, 8, 0);             // gid
+    WriteTarOctalField(OutHeaderBlock + 124, 12, DataSize);     // size
+    WriteTarOctalField(OutHeaderBlock + 136, 12, FDateTime::UtcNow().ToUnixTimestamp()); // mtime
+    OutHeaderBlock[156] = '0';                                  // typeflag: regular file
+    FMemory::Memcpy(OutHeaderBlock + 257, "ustar", 6);          // magic
+    OutHeaderBlock[263] = '0';                                  // version
+    OutHeaderBlock[264] = '0';
+
+    // The checksum is computed with the checksum field itself filled with spaces
+    FMemory::Memset(OutHeaderBlock + 148, ' ', 8);
+    int64 Checksum = 0;
+    for (int32 i = 0; i < TarBlockSize; i++)
+    {
+        Checksum += OutHeaderBlock[i];
+    }
+    WriteTarOctalField(OutHeaderBlock + 148, 7, Checksum);
+    OutHeaderBlock[155] = ' ';
+
+    return true;
+}
@@ -12,18 +12,12 @@
 #include "FileManager.h"
 #include "ImageUtils.h"
 #include "IImageWrapperModule.h"
+#include "Async/ParallelFor.h"
+#include "Math/Float16.h"
 #if WITH_UNREALPNG
 THIRD_PARTY_INCLUDES_START
 #include "ThirdParty/zlib/zlib-1.2.5/Inc/zlib.h"
-#include "ThirdParty/libPNG/libPNG-1.5.2/png.h"
-#include "ThirdParty/libPNG/libPNG-1.5.2/pnginfo.h"
-#include <setjmp.h>
 THIRD_PARTY_INCLUDES_END
-// Disable warning "interaction between '_setjmp' and C++ object destruction is non-portable"
-#ifdef _MSC_VER
-#pragma warning(push)
-#pragma warning(disable:4611)
-#endif
 #endif  // WITH_UNREALPNG
 
 // Convert a pixel format to an exportable one
@@ -51,6 +45,7 @@ bool CanPixelFormatBeExported(EPixelFormat CheckPixelFormat)
 	case EPixelFormat::PF_A16B16G16R16:
 	case EPixelFormat::PF_G32R32F:
 	case EPixelFormat::PF_G8:
+	case EPixelFormat::PF_G16:
 	case EPixelFormat::PF_ShadowDepth:
 		return true;
 	default:
@@ -82,6 +77,151 @@ bool GetExportedImageSettings(EPixelFormat ImgPixelFormat, uint8& ImageBitDepth,
 	return true;
 }
 
+//====================================== NVPixelLayout ==========================================
+// How the values are stored in the captured pixels, used by the formats which convert the pixels (PNG16, EXR, NPY)
+namespace NVPixelLayout
+{
+    enum class EChannelType : uint8
+    {
+        UNorm8,
+        UNorm16,
+        Half,
+        Float
+    };
+
+    struct FPixelLayout
+    {
+        uint32 ChannelCount;
+        EChannelType ChannelType;
+        uint32 BytesPerChannel;
+        /// The 4 channels are stored in BGRA order instead of RGBA
+        bool bIsBGRA;
+
+        uint32 GetBytesPerPixel() const
+        {
+            return ChannelCount * BytesPerChannel;
+        }
+    };
+
+    bool GetPixelLayout(EPixelFormat PixelFormat, FPixelLayout& OutLayout)
+    {
+        OutLayout.bIsBGRA = false;
+        switch (PixelFormat)
+        {
+            case EPixelFormat::PF_G8:
+                OutLayout.ChannelCount = 1;
+                OutLayout.ChannelType = EChannelType::UNorm8;
+                break;
+            case EPixelFormat::PF_B8G8R8A8:
+                OutLayout.ChannelCount = 4;
+                OutLayout.ChannelType = EChannelType::UNorm8;
+                OutLayout.bIsBGRA = true;
+                break;
+            case EPixelFormat::PF_G16:
+            case EPixelFormat::PF_R16_UINT:
+                OutLayout.ChannelCount = 1;
+                OutLayout.ChannelType = EChannelType::UNorm16;
+                break;
+            case EPixelFormat::PF_A16B16G16R16:
+                OutLayout.ChannelCount = 4;
+                OutLayout.ChannelType = EChannelType::UNorm16;
+                break;
+            // NOTE: The R16F pixels are read back as PF_ShadowDepth on D3D11, see FNVTextureReader::SetSourceTexture
+            case EPixelFormat::PF_R16F:
+            case EPixelFormat::PF_ShadowDepth:
+                OutLayout.ChannelCount = 1;
+                OutLayout.ChannelType = EChannelType::Half;
+                break;
+            // NOTE: The R32 float pixels are read back as PF_R32_UINT so their bytes are kept as is
+            case EPixelFormat::PF_R32_FLOAT:
+            case EPixelFormat::PF_R32_UINT:
+                OutLayout.ChannelCount = 1;
+                OutLayout.ChannelType = EChannelType::Float;
+                break;
+            case EPixelFormat::PF_G32R32F:
+                OutLayout.ChannelCount = 2;
+                OutLayout.ChannelType = EChannelType::Float;
+                break;
+            default:
+                return false;
+        }
+
+        OutLayout.BytesPerChannel = (OutLayout.ChannelType == EChannelType::UNorm8) ? 1 :
+                                    (OutLayout.ChannelType == EChannelType::Float) ? 4 : 2;
+        return true;
+    }
+
+    // Number of bytes between the start of 2 rows of the source pixels, the rows may be padded
+    uint32 GetSourceRowStride(const FNVTexturePixelData& SourcePixelData, const FPixelLayout& Layout)
+    {
+        const uint32 RowByteSize = SourcePixelData.PixelSize.X * Layout.GetBytesPerPixel();
+        return FMath::Max(SourcePixelData.RowStride, RowByteSize);
+    }
+
+    // Check the layout of the source pixels and whether there are enough pixels for the image's size
+    bool GetSourcePixelLayout(const FNVTexturePixelData& SourcePixelData, FPixelLayout& OutLayout)
+    {
+        if (!GetPixelLayout(SourcePixelData.PixelFormat, OutLayout))
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("Unsupported pixel format."));
+            return false;
+        }
+
+        const FIntPoint& ImageSize = SourcePixelData.PixelSize;
+        // NOTE: The last row doesn't need to be padded
+        const int64 RawDataSize = int64(GetSourceRowStride(SourcePixelData, OutLayout)) * (ImageSize.Y - 1) + int64(ImageSize.X) * OutLayout.GetBytesPerPixel();
+        if ((ImageSize.X <= 0) || (ImageSize.Y <= 0) || (SourcePixelData.PixelData.Num() < RawDataSize))
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("Number of Pixels is 0."));
+            return false;
+        }
+        return true;
+    }
+
+    // Index of the channel in the pixel's memory, the channels are always accessed in RGBA order
+    FORCEINLINE uint32 GetStoredChannel(const FPixelLayout& Layout, uint32 Channel)
+    {
+        return (Layout.bIsBGRA && (Channel != 1) && (Channel != 3)) ? (2 - Channel) : Channel;
+    }
+
+    // Read a channel of a pixel, the fixed point values are normalized to [0, 1]
+    float ReadChannel(const uint8* Pixel, const FPixelLayout& Layout, uint32 Channel)
+    {
+        const uint8* ChannelData = Pixel + GetStoredChannel(Layout, Channel) * Layout.BytesPerChannel;
+        switch (Layout.ChannelType)
+        {
+            case EChannelType::UNorm8:
+                return ChannelData[0] / 255.f;
+            case EChannelType::UNorm16:
+                return (*(const uint16*)ChannelData) / 65535.f;
+            case EChannelType::Half:
+            {
+                FFloat16 HalfValue;
+                HalfValue.Encoded = *(const uint16*)ChannelData;
+                return HalfValue.GetFloat();
+            }
+            case EChannelType::Float:
+            default:
+                return *(const float*)ChannelData;
+        }
+    }
+
+    // Read a channel of a pixel as a 16 bits fixed point value, the floating point values are clamped to [0, 1]
+    uint16 ReadChannelUNorm16(const uint8* Pixel, const FPixelLayout& Layout, uint32 Channel)
+    {
+        const uint8* ChannelData = Pixel + GetStoredChannel(Layout, Channel) * Layout.BytesPerChannel;
+        switch (Layout.ChannelType)
+        {
+            case EChannelType::UNorm8:
+                return uint16(ChannelData[0]) * 257;
+            case EChannelType::UNorm16:
+                return *(const uint16*)ChannelData;
+            default:
+                return uint16(FMath::RoundToInt(FMath::Clamp(ReadChannel(Pixel, Layout, Channel), 0.f, 1.f) * 65535.f));
+        }
+    }
+}
+
 FNVImageExporter::FNVImageExporter(IImageWrapperModule* InImageWrapperModule)
     : ImageWrapperModule(InImageWrapperModule)
 {
@@ -94,156 +234,962 @@ FNVImageExporter::~FNVImageExporter()
 }
 
 #if WITH_UNREALPNG
-/**
-* Guard that safely releases PNG Writer resources
-*/
-class PNGWriteGuard
+//====================================== NVPngEncoder ==========================================
+// NOTE: We write the PNG file ourselves instead of using libpng so the image can be compressed in parallel:
+// the rows are split into stripes, each stripe is filtered and deflated independently (the dictionary is reset between stripes)
+// then all the stripes are joined into a single zlib stream inside the IDAT chunk, the same way pigz does it
+namespace NVPngEncoder
 {
-public:
+    static const uint8 PngSignature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
 
-    PNGWriteGuard(png_structp* InWriteStruct, png_infop* InInfo)
-        : PNGWriteStruct(InWriteStruct)
-        , info_ptr(InInfo)
-        , PNGRowPointers(NULL)
+    // Minimum size (in bytes) of the raw pixels in each stripe
+    // Smaller stripes don't speed up the compression much but make the file bigger since each stripe starts with an empty dictionary
+    static const uint32 MinStripeByteSize = 256 * 1024;
+
+    // PNG filter types as written in front of each row
+    enum EPngRowFilter : uint8
+    {
+        RowFilter_None = 0,
+        RowFilter_Sub = 1,
+        RowFilter_Up = 2,
+        RowFilter_Average = 3,
+        RowFilter_Paeth = 4,
+        RowFilter_Count
+    };
+
+    // The compressed data of a stripe of rows
+    struct FPngStripeData
+    {
+        TArray<uint8> DeflatedData;
+        uint32 Adler;
+        uint32 FilteredDataSize;
+        bool bSucceeded;
+    };
+
+    void WriteUInt32BE(uint8* Dest, uint32 Value)
+    {
+        Dest[0] = (Value >> 24) & 0xFF;
+        Dest[1] = (Value >> 16) & 0xFF;
+        Dest[2] = (Value >> 8) & 0xFF;
+        Dest[3] = Value & 0xFF;
+    }
+
+    void AppendUInt32BE(TArray<uint8>& OutData, uint32 Value)
+    {
+        const int32 Offset = OutData.AddUninitialized(4);
+        WriteUInt32BE(&OutData[Offset], Value);
+    }
+
+    // Write the chunk's type and data then its CRC, the chunk's length must already be written before this
+    void AppendChunkCrc(TArray<uint8>& OutData, int32 ChunkTypeOffset)
     {
+        const uint32 ChunkCrc = crc32(0L, &OutData[ChunkTypeOffset], OutData.Num() - ChunkTypeOffset);
+        AppendUInt32BE(OutData, ChunkCrc);
     }
 
-    ~PNGWriteGuard()
+    FORCEINLINE uint8 PaethPredictor(uint8 A, uint8 B, uint8 C)
     {
-        if (PNGRowPointers != NULL)
+        const int32 P = int32(A) + int32(B) - int32(C);
+        const int32 PA = FMath::Abs(P - int32(A));
+        const int32 PB = FMath::Abs(P - int32(B));
+        const int32 PC = FMath::Abs(P - int32(C));
+        if ((PA <= PB) && (PA <= PC))
         {
-            png_free(*PNGWriteStruct, PNGRowPointers);
+            return A;
         }
-        png_destroy_write_struct(PNGWriteStruct, info_ptr);
+        return (PB <= PC) ? B : C;
     }
 
-    void SetRowPointers(png_bytep* InRowPointers)
+    // Filter a single byte
+    // X - the byte to filter, A - the byte of the previous pixel, B - the byte above, C - the byte above the previous pixel
+    FORCEINLINE uint8 FilterByte(uint8 FilterType, uint8 X, uint8 A, uint8 B, uint8 C)
     {
-        ensure(InRowPointers!=nullptr);
-        PNGRowPointers = InRowPointers;
+        switch (FilterType)
+        {
+            case RowFilter_Sub:
+                return X - A;
+            case RowFilter_Up:
+                return X - B;
+            case RowFilter_Average:
+                return X - uint8((uint32(A) + uint32(B)) >> 1);
+            case RowFilter_Paeth:
+                return X - PaethPredictor(A, B, C);
+            case RowFilter_None:
+            default:
+                return X;
+        }
     }
 
-private:
+    // Filter a row, PrevRow can be null for the first row of the image
+    void FilterRow(uint8 FilterType, const uint8* Row, const uint8* PrevRow, uint32 RowByteSize, uint32 BytesPerPixel, uint8* OutFilteredRow)
+    {
+        for (uint32 i = 0; i < RowByteSize; i++)
+        {
+            const uint8 A = (i >= BytesPerPixel) ? Row[i - BytesPerPixel] : 0;
+            const uint8 B = PrevRow ? PrevRow[i] : 0;
+            const uint8 C = (PrevRow && (i >= BytesPerPixel)) ? PrevRow[i - BytesPerPixel] : 0;
+            OutFilteredRow[i] = FilterByte(FilterType, Row[i], A, B, C);
+        }
+    }
 
-    png_structp* PNGWriteStruct;
-    png_infop* info_ptr;
-    png_bytep* PNGRowPointers;
-};
+    // Estimate how well a filtered row can be compressed: sum of the absolute values of the filtered bytes (as signed bytes)
+    // NOTE: This is the same heuristic libpng use to pick the filter
+    uint32 GetFilteredRowCost(uint8 FilterType, const uint8* Row, const uint8* PrevRow, uint32 RowByteSize, uint32 BytesPerPixel)
+    {
+        uint32 Cost = 0;
+        for (uint32 i = 0; i < RowByteSize; i++)
+        {
+            const uint8 A = (i >= BytesPerPixel) ? Row[i - BytesPerPixel] : 0;
+            const uint8 B = PrevRow ? PrevRow[i] : 0;
+            const uint8 C = (PrevRow && (i >= BytesPerPixel)) ? PrevRow[i - BytesPerPixel] : 0;
+            Cost += FMath::Abs(int32(int8(FilterByte(FilterType, Row[i], A, B, C))));
+        }
+        return Cost;
+    }
 
-void PngArrayWriteCallback(png_structp png_ptr, png_bytep data, png_size_t length)
-{
-    TArray<uint8>* CompressedData = (TArray<uint8>*)png_get_io_ptr(png_ptr);
-    ensure(CompressedData);
-    int32 Offset = CompressedData->AddUninitialized(length);
-    FMemory::Memcpy(&((*CompressedData)[Offset]), data, length);
+    uint8 PickRowFilter(ENVPngFilterType FilterType, const uint8* Row, const uint8* PrevRow, uint32 RowByteSize, uint32 BytesPerPixel)
+    {
+        switch (FilterType)
+        {
+            case ENVPngFilterType::None:
+                return RowFilter_None;
+            case ENVPngFilterType::Sub:
+                return RowFilter_Sub;
+            case ENVPngFilterType::Up:
+                return RowFilter_Up;
+            case ENVPngFilterType::Average:
+                return RowFilter_Average;
+            case ENVPngFilterType::Paeth:
+                return RowFilter_Paeth;
+            case ENVPngFilterType::Adaptive:
+            default:
+                break;
+        }
+
+        uint8 BestFilter = RowFilter_None;
+        uint32 BestCost = MAX_uint32;
+        for (uint8 CheckFilter = RowFilter_None; CheckFilter < RowFilter_Count; CheckFilter++)
+        {
+            const uint32 CheckCost = GetFilteredRowCost(CheckFilter, Row, PrevRow, RowByteSize, BytesPerPixel);
+            if (CheckCost < BestCost)
+            {
+                BestCost = CheckCost;
+                BestFilter = CheckFilter;
+            }
+        }
+        return BestFilter;
+    }
+
+    // Convert a row of pixels from the captured layout to the PNG's layout:
+    // BGRA => RGBA and little endian => big endian for the 16 bits channels
+    void TransformRow(const uint8* SrcRow, uint8* DestRow, uint32 Width, uint32 PixelChannels, uint32 BytesPerChannel, bool bSwapRedBlue)
+    {
+#if PLATFORM_LITTLE_ENDIAN
+        const bool bSwapEndian = (BytesPerChannel == 2);
+#else
+        const bool bSwapEndian = false;
+#endif
+        const uint32 BytesPerPixel = PixelChannels * BytesPerChannel;
+        if (!bSwapRedBlue && !bSwapEndian)
+        {
+            FMemory::Memcpy(DestRow, SrcRow, Width * BytesPerPixel);
+            return;
+        }
+
+        for (uint32 x = 0; x < Width; x++)
+        {
+            const uint8* SrcPixel = SrcRow + x * BytesPerPixel;
+            uint8* DestPixel = DestRow + x * BytesPerPixel;
+            for (uint32 Channel = 0; Channel < PixelChannels; Channel++)
+            {
+                uint32 SrcChannel = Channel;
+                if (bSwapRedBlue && (Channel != 1) && (Channel != 3))
+                {
+                    SrcChannel = 2 - Channel;
+                }
+                const uint8* SrcBytes = SrcPixel + SrcChannel * BytesPerChannel;
+                uint8* DestBytes = DestPixel + Channel * BytesPerChannel;
+                if (bSwapEndian)
+                {
+                    DestBytes[0] = SrcBytes[1];
+                    DestBytes[1] = SrcBytes[0];
+                }
+                else
+                {
+                    FMemory::Memcpy(DestBytes, SrcBytes, BytesPerChannel);
+                }
+            }
+        }
+    }
+
+    // Filter and deflate the rows [StartRow, EndRow)
+    void CompressStripe(const uint8* RawData, uint32 RawRowStride, uint32 Width, uint32 PixelChannels, uint32 BytesPerChannel, bool bSwapRedBlue,
+                        int32 StartRow, int32 EndRow, bool bIsLastStripe,
+                        int32 CompressionLevel, ENVPngFilterType FilterType, FPngStripeData& OutStripeData)
+    {
+        OutStripeData.bSucceeded = false;
+
+        const uint32 BytesPerPixel = PixelChannels * BytesPerChannel;
+        const uint32 RowByteSize = Width * BytesPerPixel;
+        const uint32 FilteredRowSize = RowByteSize + 1;
+        const int32 RowCount = EndRow - StartRow;
+
+        TArray<uint8> FilteredData;
+        FilteredData.SetNumUninitialized(FilteredRowSize * RowCount);
+
+        TArray<uint8> CurrentRow, PreviousRow;
+        CurrentRow.SetNumUninitialized(RowByteSize);
+        PreviousRow.SetNumUninitialized(RowByteSize);
+
+        // NOTE: The first row of the stripe is filtered using the last row of the previous stripe so the result is the same as a single stripe
+        bool bHasPreviousRow = false;
+        if (StartRow > 0)
+        {
+            TransformRow(RawData + (StartRow - 1) * RawRowStride, PreviousRow.GetData(), Width, PixelChannels, BytesPerChannel, bSwapRedBlue);
+            bHasPreviousRow = true;
+        }
+
+        uint8* FilteredRow = FilteredData.GetData();
+        for (int32 Row = StartRow; Row < EndRow; Row++)
+        {
+            TransformRow(RawData + Row * RawRowStride, CurrentRow.GetData(), Width, PixelChannels, BytesPerChannel, bSwapRedBlue);
+
+            const uint8* PrevRowData = bHasPreviousRow ? PreviousRow.GetData() : nullptr;
+            const uint8 RowFilter = PickRowFilter(FilterType, CurrentRow.GetData(), PrevRowData, RowByteSize, BytesPerPixel);
+            FilteredRow[0] = RowFilter;
+            FilterRow(RowFilter, CurrentRow.GetData(), PrevRowData, RowByteSize, BytesPerPixel, FilteredRow + 1);
+
+            FilteredRow += FilteredRowSize;
+            Swap(CurrentRow, PreviousRow);
+            bHasPreviousRow = true;
+        }
+
+        OutStripeData.FilteredDataSize = FilteredData.Num();
+        OutStripeData.Adler = adler32(adler32(0L, Z_NULL, 0), FilteredData.GetData(), FilteredData.Num());
+
+        // Raw deflate stream (no zlib header), the header and the checksum of the whole image are written when the stripes are joined
+        z_stream Stream;
+        FMemory::Memzero(Stream);
+        if (deflateInit2(&Stream, CompressionLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("deflateInit2 is failed"));
+            return;
+        }
+
+        // NOTE: The sync flush at the end of the stripes add a few bytes more than deflateBound
+        const uint32 MaxDeflatedSize = deflateBound(&Stream, FilteredData.Num()) + 16;
+        OutStripeData.DeflatedData.SetNumUninitialized(MaxDeflatedSize);
+
+        Stream.next_in = FilteredData.GetData();
+        Stream.avail_in = FilteredData.Num();
+        Stream.next_out = OutStripeData.DeflatedData.GetData();
+        Stream.avail_out = MaxDeflatedSize;
+
+        // Only the last stripe end the deflate stream, the others just flush to a byte boundary so they can be concatenated
+        const int32 FlushMode = bIsLastStripe ? Z_FINISH : Z_SYNC_FLUSH;
+        const int32 DeflateResult = deflate(&Stream, FlushMode);
+        const bool bFinished = bIsLastStripe ? (DeflateResult == Z_STREAM_END) : ((DeflateResult == Z_OK) && (Stream.avail_in == 0));
+        if (!bFinished)
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("deflate is failed: %d"), DeflateResult);
+        }
+        else
+        {
+            OutStripeData.DeflatedData.SetNum(MaxDeflatedSize - Stream.avail_out, false);
+            OutStripeData.bSucceeded = true;
+        }
+        deflateEnd(&Stream);
+    }
+
+    // The second byte of the zlib header, contain the compression level hint and the header's checksum
+    uint8 GetZlibHeaderFlags(uint8 CMF, int32 CompressionLevel)
+    {
+        uint8 FLevel = 2;
+        if (CompressionLevel >= 0)
+        {
+            FLevel = (CompressionLevel <= 1) ? 0 : ((CompressionLevel <= 5) ? 1 : ((CompressionLevel == 6) ? 2 : 3));
+        }
+        uint32 FLG = FLevel << 6;
+        FLG += 31 - ((uint32(CMF) * 256 + FLG) % 31);
+        return uint8(FLG);
+    }
+
+    // Color type of the PNG image: 0 - grayscale, 4 - grayscale + alpha, 2 - RGB, 6 - RGBA
+    uint8 GetColorType(uint32 PixelChannels)
+    {
+        switch (PixelChannels)
+        {
+            case 1:
+                return 0;
+            case 2:
+                return 4;
+            case 3:
+                return 2;
+            default:
+                return 6;
+        }
+    }
+
+    // Write the PNG image of the raw pixels, the rows are compressed in parallel
+    // NOTE: RawRowStride is the number of bytes between the start of 2 rows of the raw pixels
+    void EncodeImage(const uint8* RawData, uint32 RawRowStride, int32 Width, int32 Height, uint32 PixelChannels, uint32 BytesPerChannel, bool bSwapRedBlue,
+                     const FNVImageCompressionSettings& CompressionSettings, TArray<uint8>& CompressedData)
+    {
+        const uint32 BytesPerRow = PixelChannels * BytesPerChannel * Width;
+
+        const int32 CompressionLevel = FMath::Clamp(CompressionSettings.PngCompressionLevel, 0, 9);
+        const ENVPngFilterType FilterType = CompressionSettings.PngFilterType;
+
+        // Split the image into stripes, each stripe is compressed in its own task
+        // NOTE: When the image can't be compressed in parallel (e.g: on the image exporter's workers) it's kept in a single stripe,
+        // the stripes would only make the file bigger since each of them start with an empty dictionary
+        const int32 MinRowsPerStripe = FMath::Max(1, (int32)FMath::DivideAndRoundUp(MinStripeByteSize, BytesPerRow));
+        const int32 MaxStripeCount = CompressionSettings.bAllowParallelEncoding ? FMath::Max(1, FPlatformMisc::NumberOfCoresIncludingHyperthreads()) : 1;
+        const int32 StripeCount = FMath::Clamp(Height / MinRowsPerStripe, 1, MaxStripeCount);
+        const int32 RowsPerStripe = FMath::DivideAndRoundUp(Height, StripeCount);
+
+        TArray<FPngStripeData> StripeDataList;
+        StripeDataList.SetNum(StripeCount);
+        ParallelFor(StripeCount, [&](int32 StripeIndex)
+        {
+            const int32 StartRow = StripeIndex * RowsPerStripe;
+            const int32 EndRow = FMath::Min(StartRow + RowsPerStripe, Height);
+            const bool bIsLastStripe = (StripeIndex == StripeCount - 1);
+            CompressStripe(RawData, RawRowStride, Width, PixelChannels, BytesPerChannel, bSwapRedBlue, StartRow, EndRow, bIsLastStripe,
+                           CompressionLevel, FilterType, StripeDataList[StripeIndex]);
+        }, (StripeCount == 1));
+
+        // Join the stripes into a single zlib stream and combine their checksums
+        uint32 TotalDeflatedSize = 0;
+        uint32 ImageAdler = 0;
+        for (int32 i = 0; i < StripeCount; i++)
+        {
+            const FPngStripeData& StripeData = StripeDataList[i];
+            if (!StripeData.bSucceeded)
+            {
+                UE_LOG(LogNVSceneCapturer, Error, TEXT("Failed to compress the PNG image."));
+                return;
+            }
+            TotalDeflatedSize += StripeData.DeflatedData.Num();
+            ImageAdler = (i == 0) ? StripeData.Adler : adler32_combine(ImageAdler, StripeData.Adler, StripeData.FilteredDataSize);
+        }
+
+        const uint32 ZlibHeaderSize = 2;
+        const uint32 ZlibChecksumSize = 4;
+        const uint32 IDATDataSize = ZlibHeaderSize + TotalDeflatedSize + ZlibChecksumSize;
+        // Signature + IHDR + IDAT + IEND
+        CompressedData.Reserve(8 + (12 + 13) + (12 + IDATDataSize) + 12);
+
+        CompressedData.Append(PngSignature, sizeof(PngSignature));
+
+        // IHDR
+        {
+            AppendUInt32BE(CompressedData, 13);
+            const int32 ChunkTypeOffset = CompressedData.Num();
+            CompressedData.Append((const uint8*)"IHDR", 4);
+            AppendUInt32BE(CompressedData, Width);
+            AppendUInt32BE(CompressedData, Height);
+            CompressedData.Add(BytesPerChannel * 8);
+            CompressedData.Add(GetColorType(PixelChannels));
+            // Compression method, filter method, interlace method
+            CompressedData.Add(0);
+            CompressedData.Add(0);
+            CompressedData.Add(0);
+            AppendChunkCrc(CompressedData, ChunkTypeOffset);
+        }
+
+        // IDAT
+        {
+            AppendUInt32BE(CompressedData, IDATDataSize);
+            const int32 ChunkTypeOffset = CompressedData.Num();
+            CompressedData.Append((const uint8*)"IDAT", 4);
+            // zlib header: deflate with 32K window
+            const uint8 CMF = 0x78;
+            CompressedData.Add(CMF);
+            CompressedData.Add(GetZlibHeaderFlags(CMF, CompressionLevel));
+            for (const FPngStripeData& StripeData : StripeDataList)
+            {
+                CompressedData.Append(StripeData.DeflatedData);
+            }
+            AppendUInt32BE(CompressedData, ImageAdler);
+            AppendChunkCrc(CompressedData, ChunkTypeOffset);
+        }
+
+        // IEND
+        {
+            AppendUInt32BE(CompressedData, 0);
+            const int32 ChunkTypeOffset = CompressedData.Num();
+            CompressedData.Append((const uint8*)"IEND", 4);
+            AppendChunkCrc(CompressedData, ChunkTypeOffset);
+        }
+    }
 }
 #endif // WITH_UNREALPNG
 
-TArray<uint8> FNVImageExporter::CompressImagePNG(const FNVTexturePixelData& SourcePixelData)
+TArray<uint8> FNVImageExporter::CompressImagePNG(const FNVTexturePixelData& SourcePixelData,
+        const FNVImageCompressionSettings& CompressionSettings/*= FNVImageCompressionSettings()*/)
 {
     TArray<uint8> CompressedData;
-    CompressedData.Reset(0);
+    CompressImagePNG(SourcePixelData, CompressedData, CompressionSettings);
+    return CompressedData;
+}
+
+void FNVImageExporter::CompressImagePNG(const FNVTexturePixelData& SourcePixelData, TArray<uint8>& CompressedData,
+        const FNVImageCompressionSettings& CompressionSettings/*= FNVImageCompressionSettings()*/)
+{
+    // NOTE: Reset keeps the allocated memory so the buffer can be reused
+    CompressedData.Reset();
 
     // Currently, supported pixel format is limited.
     EPixelFormat ImgPixelFormat = SourcePixelData.PixelFormat;
-	if (ensure(CanPixelFormatBeExported(ImgPixelFormat)))
+    if (!ensure(CanPixelFormatBeExported(ImgPixelFormat)))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Unsupported pixel format."));
+        return;
+    }
+
+    uint8 RawBitDepth = 32;
+    ERGBFormat RawFormat = ERGBFormat::BGRA;
+    if (!GetExportedImageSettings(ImgPixelFormat, RawBitDepth, RawFormat))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Unsupported pixel format."));
+        return;
+    }
+
+    const auto& ImageSize = SourcePixelData.PixelSize;
+    const int32 Width = ImageSize.X;
+    const int32 Height = ImageSize.Y;
+    const uint32 PixelChannels = (RawFormat == ERGBFormat::Gray) ? 1 : 4;
+    const uint32 BytesPerChannel = RawBitDepth / 8;
+    const uint32 BytesPerRow = PixelChannels * BytesPerChannel * Width;
+    // NOTE: The rows of the source pixels may be padded, the last row doesn't need to be
+    const uint32 SourceRowStride = FMath::Max(SourcePixelData.RowStride, BytesPerRow);
+    const uint32 RawDataSize = SourceRowStride * (Height - 1) + BytesPerRow;
+
+    if ((Width <= 0) || (Height <= 0) || (SourcePixelData.PixelData.Num() < (int32)RawDataSize))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Number of Pixels is 0."));
+        return;
+    }
+
+#if WITH_UNREALPNG
+    // NOTE: Only the 8 bits pixels are stored in BGRA order, the 16 bits ones are already in RGBA order
+    const bool bSwapRedBlue = (PixelChannels == 4) && (BytesPerChannel == 1);
+    NVPngEncoder::EncodeImage(SourcePixelData.PixelData.GetData(), SourceRowStride, Width, Height, PixelChannels, BytesPerChannel, bSwapRedBlue,
+                              CompressionSettings, CompressedData);
+#endif // WITH_UNREALPNG
+}
+
+void FNVImageExporter::CompressImagePNG16(const FNVTexturePixelData& SourcePixelData, TArray<uint8>& CompressedData,
+        const FNVImageCompressionSettings& CompressionSettings/*= FNVImageCompressionSettings()*/)
+{
+    CompressedData.Reset();
+
+    NVPixelLayout::FPixelLayout SourceLayout;
+    if (!NVPixelLayout::GetSourcePixelLayout(SourcePixelData, SourceLayout))
+    {
+        return;
+    }
+
+    const int32 Width = SourcePixelData.PixelSize.X;
+    const int32 Height = SourcePixelData.PixelSize.Y;
+    // NOTE: PNG doesn't have a 2 channels color type, the 2 channels images (e.g: velocity) are written as RGB with an empty blue channel
+    const uint32 PixelChannels = (SourceLayout.ChannelCount == 2) ? 3 : SourceLayout.ChannelCount;
+    const uint32 SourceBytesPerPixel = SourceLayout.GetBytesPerPixel();
+    const uint32 SourceRowStride = NVPixelLayout::GetSourceRowStride(SourcePixelData, SourceLayout);
+    const uint8* SourceData = SourcePixelData.PixelData.GetData();
+
+    TArray<uint16> ConvertedPixels;
+    ConvertedPixels.SetNumUninitialized(Width * Height * PixelChannels);
+    ParallelFor(Height, [&](int32 Row)
     {
-        // NOTE: This code is similar to FImageWrapperBase::SetRaw
-        TArray<uint8> RawData = SourcePixelData.PixelData;
-        if (RawData.Num() <= 0)
+        const uint8* SourcePixel = SourceData + Row * SourceRowStride;
+        uint16* DestPixel = ConvertedPixels.GetData() + Row * Width * PixelChannels;
+        for (int32 x = 0; x < Width; x++)
         {
-            UE_LOG(LogNVSceneCapturer, Error, TEXT("Number of Pixels is 0."));
+            for (uint32 Channel = 0; Channel < PixelChannels; Channel++)
+            {
+                DestPixel[Channel] = (Channel < SourceLayout.ChannelCount) ? NVPixelLayout::ReadChannelUNorm16(SourcePixel, SourceLayout, Channel) : 0;
+            }
+            SourcePixel += SourceBytesPerPixel;
+            DestPixel += PixelChannels;
         }
-        else
+    }, !CompressionSettings.bAllowParallelEncoding);
+
+#if WITH_UNREALPNG
+    NVPngEncoder::EncodeImage((const uint8*)ConvertedPixels.GetData(), Width * PixelChannels * sizeof(uint16), Width, Height, PixelChannels, sizeof(uint16), false,
+                              CompressionSettings, CompressedData);
+#endif // WITH_UNREALPNG
+}
+
+//====================================== NVExrEncoder ==========================================
+// NOTE: We write the EXR file ourselves, the same way as the PNG files, so the channels keep their own type and the blocks
+// of scanlines can be compressed in parallel. Only the single part scanline images are written.
+namespace NVExrEncoder
+{
+    static const uint8 ExrMagicNumber[4] = { 0x76, 0x2f, 0x31, 0x01 };
+    // Version 2, single part scanline image
+    static const uint8 ExrVersion[4] = { 2, 0, 0, 0 };
+
+    // Values of the EXR attributes
+    enum EExrPixelType : int32
+    {
+        ExrPixelType_Half = 1,
+        ExrPixelType_Float = 2
+    };
+
+    enum EExrCompression : uint8
+    {
+        ExrCompression_None = 0,
+        ExrCompression_ZIPS = 2,
+        ExrCompression_ZIP = 3
+    };
+
+    // NOTE: The EXR files are little endian
+    template<typename ValueType>
+    void AppendValueLE(TArray<uint8>& OutData, ValueType Value)
+    {
+        const int32 Offset = OutData.AddUninitialized(sizeof(ValueType));
+        const uint8* ValueBytes = (const uint8*)&Value;
+        for (int32 i = 0; i < (int32)sizeof(ValueType); i++)
         {
-			uint8 RawBitDepth = 32;
-			ERGBFormat RawFormat = ERGBFormat::BGRA;
-			if (GetExportedImageSettings(ImgPixelFormat, RawBitDepth, RawFormat))
-			{
-				const auto& ImageSize = SourcePixelData.PixelSize;
-				int32 Width = ImageSize.X;
-				int32 Height = ImageSize.Y;
-
-				// NOTE: This code is similar to FPngImageWrapper::Compress without the scope lock so we can run this in parallel in multiple threads
-	#if WITH_UNREALPNG
-
-				jmp_buf SetjmpBuffer;
-
-				// Reset to the beginning of file so we can use png_read_png(), which expects to start at the beginning.
-				int32 ReadOffset = 0;
-
-				png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-				check(png_ptr);
-				if (png_ptr == nullptr)
-				{
-					UE_LOG(LogNVSceneCapturer, Error, TEXT("png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr) is failed"));
-				}
-				else
-				{
-					png_infop info_ptr = png_create_info_struct(png_ptr);
-					check(info_ptr);
-					if (info_ptr == nullptr)
-					{
-						UE_LOG(LogNVSceneCapturer, Error, TEXT("png_create_info_struct() is failed"));
-					}
-					else
-					{
-						png_bytep* row_pointers = (png_bytep*)png_malloc(png_ptr, Height * sizeof(png_bytep));
-						PNGWriteGuard PNGGuard(&png_ptr, &info_ptr);
-						PNGGuard.SetRowPointers(row_pointers);
-						{
-							png_set_compression_level(png_ptr, Z_BEST_SPEED);
-							png_set_IHDR(png_ptr, info_ptr, Width, Height, RawBitDepth, (RawFormat == ERGBFormat::Gray) ?
-								PNG_COLOR_TYPE_GRAY : PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
-							png_set_write_fn(png_ptr, &CompressedData, PngArrayWriteCallback, nullptr);
-
-							const uint32 PixelChannels = (RawFormat == ERGBFormat::Gray) ? 1 : 4;
-							const uint32 BytesPerPixel = (RawBitDepth * PixelChannels) / 8;
-							const uint32 BytesPerRow = BytesPerPixel * Width;
-
-							for (int32 i = 0; i < Height; i++)
-							{
-								row_pointers[i] = &RawData[i * BytesPerRow];
-							}
-							png_set_rows(png_ptr, info_ptr, row_pointers);
-
-							uint32 Transform = (RawFormat == ERGBFormat::BGRA) ? PNG_TRANSFORM_BGR : PNG_TRANSFORM_IDENTITY;
-
-							// PNG files store 16-bit pixels in network byte order (big-endian, ie. most significant bits first).
 #if PLATFORM_LITTLE_ENDIAN
-						// We're little endian so we need to swap
-							if (RawBitDepth == 16)
-							{
-								Transform |= PNG_TRANSFORM_SWAP_ENDIAN;
-							}
+            OutData[Offset + i] = ValueBytes[i];
+#else
+            OutData[Offset + i] = ValueBytes[sizeof(ValueType) - 1 - i];
 #endif
-							if (!setjmp(SetjmpBuffer))
-							{
-								png_write_png(png_ptr, info_ptr, Transform, NULL);
-							}
-						}
+        }
+    }
+
+    // Write a null terminated string
+    void AppendString(TArray<uint8>& OutData, const char* Str)
+    {
+        OutData.Append((const uint8*)Str, FCStringAnsi::Strlen(Str) + 1);
+    }
+
+    void AppendAttributeHeader(TArray<uint8>& OutData, const char* Name, const char* TypeName, int32 ValueSize)
+    {
+        AppendString(OutData, Name);
+        AppendString(OutData, TypeName);
+        AppendValueLE<int32>(OutData, ValueSize);
+    }
+
+    // The EXR channels must be sorted by name, get the name of each channel and the RGBA index of the source channel it's read from
+    void GetChannels(uint32 ChannelCount, TArray<const char*>& OutNames, TArray<uint32>& OutSourceChannels)
+    {
+        OutNames.Reset();
+        OutSourceChannels.Reset();
+        if (ChannelCount == 1)
+        {
+            OutNames.Add("Y");
+            OutSourceChannels.Add(0);
+            return;
+        }
+
+        static const char* RGBANames[4] = { "R", "G", "B", "A" };
+        // Alphabetical order: A, B, G, R
+        static const uint32 SortedChannels[4] = { 3, 2, 1, 0 };
+        for (uint32 SortedChannel : SortedChannels)
+        {
+            if (SortedChannel < ChannelCount)
+            {
+                OutNames.Add(RGBANames[SortedChannel]);
+                OutSourceChannels.Add(SortedChannel);
+            }
+        }
+    }
+
+    // Prepare the raw data of a block for zlib the same way OpenEXR's ZIP compressor does:
+    // split the even and odd bytes then store the difference between the consecutive bytes
+    void ReorderAndPredict(const TArray<uint8>& RawData, TArray<uint8>& OutData)
+    {
+        const int32 DataSize = RawData.Num();
+        OutData.SetNumUninitialized(DataSize);
+
+        uint8* EvenBytes = OutData.GetData();
+        uint8* OddBytes = OutData.GetData() + (DataSize + 1) / 2;
+        for (int32 i = 0; i < DataSize; i++)
+        {
+            if ((i & 1) == 0)
+            {
+                *(EvenBytes++) = RawData[i];
+            }
+            else
+            {
+                *(OddBytes++) = RawData[i];
+            }
+        }
+
+        int32 PrevValue = (DataSize > 0) ? OutData[0] : 0;
+        for (int32 i = 1; i < DataSize; i++)
+        {
+            const int32 CurrentValue = OutData[i];
+            OutData[i] = uint8(CurrentValue - PrevValue + (128 + 256));
+            PrevValue = CurrentValue;
+        }
+    }
+
+    // Compress the raw data of a block, the raw data is kept if it can't be compressed
+    void CompressBlock(const TArray<uint8>& RawData, EExrCompression Compression, int32 CompressionLevel, TArray<uint8>& OutBlockData)
+    {
+#if WITH_UNREALPNG
+        if (Compression != ExrCompression_None)
+        {
+            TArray<uint8> PredictedData;
+            ReorderAndPredict(RawData, PredictedData);
+
+            uLongf CompressedSize = compressBound(PredictedData.Num());
+            OutBlockData.SetNumUninitialized(CompressedSize);
+            const int32 CompressResult = compress2(OutBlockData.GetData(), &CompressedSize, PredictedData.GetData(), PredictedData.Num(), CompressionLevel);
+            // NOTE: The readers know the block isn't compressed when its size is the same as the raw data's size
+            if ((CompressResult == Z_OK) && (CompressedSize < (uLongf)RawData.Num()))
+            {
+                OutBlockData.SetNum(CompressedSize, false);
+                return;
+            }
+        }
 #endif // WITH_UNREALPNG
-					}
-				}
+        OutBlockData = RawData;
+    }
+}
+
+void FNVImageExporter::CompressImageEXR(const FNVTexturePixelData& SourcePixelData, TArray<uint8>& CompressedData,
+        const FNVImageCompressionSettings& CompressionSettings/*= FNVImageCompressionSettings()*/)
+{
+    CompressedData.Reset();
+
+    NVPixelLayout::FPixelLayout SourceLayout;
+    if (!NVPixelLayout::GetSourcePixelLayout(SourcePixelData, SourceLayout))
+    {
+        return;
+    }
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    const int32 Width = SourcePixelData.PixelSize.X;
+    const int32 Height = SourcePixelData.PixelSize.Y;
+    const uint32 SourceBytesPerPixel = SourceLayout.GetBytesPerPixel();
+    const uint32 SourceRowStride = NVPixelLayout::GetSourceRowStride(SourcePixelData, SourceLayout);
+    const uint8* SourceData = SourcePixelData.PixelData.GetData();
+
+    // Keep the precision of the source pixels unless the pixel type is forced
+    bool bUseHalf = false;
+    switch (CompressionSettings.ExrPixelType)
+    {
+        case ENVExrPixelType::Half:
+            bUseHalf = true;
+            break;
+        case ENVExrPixelType::Float:
+            bUseHalf = false;
+            break;
+        case ENVExrPixelType::Auto:
+        default:
+            bUseHalf = (SourceLayout.ChannelType == NVPixelLayout::EChannelType::UNorm8) ||
+                       (SourceLayout.ChannelType == NVPixelLayout::EChannelType::Half);
+            break;
+    }
+    const uint32 ExrBytesPerChannel = bUseHalf ? sizeof(uint16) : sizeof(float);
+
+    NVExrEncoder::EExrCompression Compression = NVExrEncoder::ExrCompression_None;
+    if (CompressionSettings.ExrCompression == ENVExrCompression::ZIPS)
+    {
+        Compression = NVExrEncoder::ExrCompression_ZIPS;
+    }
+    else if (CompressionSettings.ExrCompression == ENVExrCompression::ZIP)
+    {
+        Compression = NVExrEncoder::ExrCompression_ZIP;
+    }
+    const int32 LinesPerBlock = (Compression == NVExrEncoder::ExrCompression_ZIP) ? 16 : 1;
+    const int32 BlockCount = FMath::DivideAndRoundUp(Height, LinesPerBlock);
+    const int32 CompressionLevel = FMath::Clamp(CompressionSettings.ExrCompressionLevel, 0, 9);
+
+    TArray<const char*> ChannelNames;
+    TArray<uint32> SourceChannels;
+    NVExrEncoder::GetChannels(SourceLayout.ChannelCount, ChannelNames, SourceChannels);
+
+    // Header
+    CompressedData.Append(NVExrEncoder::ExrMagicNumber, sizeof(NVExrEncoder::ExrMagicNumber));
+    CompressedData.Append(NVExrEncoder::ExrVersion, sizeof(NVExrEncoder::ExrVersion));
+    {
+        // Each channel: name, pixel type, linear flag, 3 reserved bytes, x and y sampling. The list end with an empty name
+        int32 ChannelListSize = 1;
+        for (const char* ChannelName : ChannelNames)
+        {
+            ChannelListSize += FCStringAnsi::Strlen(ChannelName) + 1 + 16;
+        }
+        NVExrEncoder::AppendAttributeHeader(CompressedData, "channels", "chlist", ChannelListSize);
+        for (const char* ChannelName : ChannelNames)
+        {
+            NVExrEncoder::AppendString(CompressedData, ChannelName);
+            NVExrEncoder::AppendValueLE<int32>(CompressedData, bUseHalf ? NVExrEncoder::ExrPixelType_Half : NVExrEncoder::ExrPixelType_Float);
+            NVExrEncoder::AppendValueLE<uint32>(CompressedData, 0);
+            NVExrEncoder::AppendValueLE<int32>(CompressedData, 1);
+            NVExrEncoder::AppendValueLE<int32>(CompressedData, 1);
+        }
+        CompressedData.Add(0);
+    }
+    NVExrEncoder::AppendAttributeHeader(CompressedData, "compression", "compression", 1);
+    CompressedData.Add(Compression);
+    static const char* WindowNames[2] = { "dataWindow", "displayWindow" };
+    for (const char* WindowName : WindowNames)
+    {
+        NVExrEncoder::AppendAttributeHeader(CompressedData, WindowName, "box2i", 16);
+        NVExrEncoder::AppendValueLE<int32>(CompressedData, 0);
+        NVExrEncoder::AppendValueLE<int32>(CompressedData, 0);
+        NVExrEncoder::AppendValueLE<int32>(CompressedData, Width - 1);
+        NVExrEncoder::AppendValueLE<int32>(CompressedData, Height - 1);
+    }
+    // Increasing Y
+    NVExrEncoder::AppendAttributeHeader(CompressedData, "lineOrder", "lineOrder", 1);
+    CompressedData.Add(0);
+    NVExrEncoder::AppendAttributeHeader(CompressedData, "pixelAspectRatio", "float", 4);
+    NVExrEncoder::AppendValueLE<float>(CompressedData, 1.f);
+    NVExrEncoder::AppendAttributeHeader(CompressedData, "screenWindowCenter", "v2f", 8);
+    NVExrEncoder::AppendValueLE<float>(CompressedData, 0.f);
+    NVExrEncoder::AppendValueLE<float>(CompressedData, 0.f);
+    NVExrEncoder::AppendAttributeHeader(CompressedData, "screenWindowWidth", "float", 4);
+    NVExrEncoder::AppendValueLE<float>(CompressedData, 1.f);
+    CompressedData.Add(0);
+
+    // Convert and compress the blocks of scanlines, each block store the lines one after the other
+    // and each line store all the values of the first channel, then all the values of the next channel...
+    TArray<TArray<uint8>> BlockDataList;
+    BlockDataList.SetNum(BlockCount);
+    ParallelFor(BlockCount, [&](int32 BlockIndex)
+    {
+        const int32 StartLine = BlockIndex * LinesPerBlock;
+        const int32 EndLine = FMath::Min(StartLine + LinesPerBlock, Height);
+
+        TArray<uint8> RawBlockData;
+        RawBlockData.Reserve((EndLine - StartLine) * Width * SourceChannels.Num() * ExrBytesPerChannel);
+        for (int32 Line = StartLine; Line < EndLine; Line++)
+        {
+            const uint8* SourceRow = SourceData + Line * SourceRowStride;
+            for (uint32 SourceChannel : SourceChannels)
+            {
+                const uint8* SourcePixel = SourceRow;
+                for (int32 x = 0; x < Width; x++)
+                {
+                    const float Value = NVPixelLayout::ReadChannel(SourcePixel, SourceLayout, SourceChannel);
+                    if (bUseHalf)
+                    {
+                        NVExrEncoder::AppendValueLE<uint16>(RawBlockData, FFloat16(Value).Encoded);
+                    }
+                    else
+                    {
+                        NVExrEncoder::AppendValueLE<float>(RawBlockData, Value);
+                    }
+                    SourcePixel += SourceBytesPerPixel;
+                }
             }
-			else
-			{
-				UE_LOG(LogNVSceneCapturer, Error, TEXT("Unsupported pixel format."));
-			}
         }
+
+        NVExrEncoder::CompressBlock(RawBlockData, Compression, CompressionLevel, BlockDataList[BlockIndex]);
+    }, (BlockCount == 1) || !CompressionSettings.bAllowParallelEncoding);
+
+    // Offset table then the blocks, each block start with its first line and its size
+    uint64 BlockOffset = CompressedData.Num() + BlockCount * sizeof(uint64);
+    for (const TArray<uint8>& BlockData : BlockDataList)
+    {
+        NVExrEncoder::AppendValueLE<uint64>(CompressedData, BlockOffset);
+        BlockOffset += 2 * sizeof(int32) + BlockData.Num();
+    }
+    for (int32 BlockIndex = 0; BlockIndex < BlockCount; BlockIndex++)
+    {
+        const TArray<uint8>& BlockData = BlockDataList[BlockIndex];
+        NVExrEncoder::AppendValueLE<int32>(CompressedData, BlockIndex * LinesPerBlock);
+        NVExrEncoder::AppendValueLE<int32>(CompressedData, BlockData.Num());
+        CompressedData.Append(BlockData);
     }
-	else
-	{
-		UE_LOG(LogNVSceneCapturer, Error, TEXT("Unsupported pixel format."));
-	}
 
-    return CompressedData;
+    const double EncodeDuration = FPlatformTime::Seconds() - StartTime;
+    const uint32 RawDataSize = Width * Height * SourceChannels.Num() * ExrBytesPerChannel;
+    UE_LOG(LogNVSceneCapturer, Verbose, TEXT("EXR %dx%d - compression: %d, %s, blocks: %d - %.1f MB/s, %.1f%% of the raw size"),
+        Width, Height, (int32)Compression, bUseHalf ? TEXT("half") : TEXT("float"), BlockCount,
+        (EncodeDuration > 0.0) ? (RawDataSize / (1024.0 * 1024.0)) / EncodeDuration : 0.0,
+        (CompressedData.Num() * 100.f) / RawDataSize);
+}
+
+void FNVImageExporter::WriteImageNPY(const FNVTexturePixelData& SourcePixelData, TArray<uint8>& OutData)
+{
+    OutData.Reset();
+
+    NVPixelLayout::FPixelLayout SourceLayout;
+    if (!NVPixelLayout::GetSourcePixelLayout(SourcePixelData, SourceLayout))
+    {
+        return;
+    }
+
+    const int32 Width = SourcePixelData.PixelSize.X;
+    const int32 Height = SourcePixelData.PixelSize.Y;
+    const uint32 BytesPerPixel = SourceLayout.GetBytesPerPixel();
+    const uint32 RowByteSize = Width * BytesPerPixel;
+    const uint32 SourceRowStride = NVPixelLayout::GetSourceRowStride(SourcePixelData, SourceLayout);
+    const int32 RawDataSize = RowByteSize * Height;
+
+#if PLATFORM_LITTLE_ENDIAN
+    const TCHAR* ByteOrder = TEXT("<");
+#else
+    const TCHAR* ByteOrder = TEXT(">");
+#endif
+    FString TypeDescription;
+    switch (SourceLayout.ChannelType)
+    {
+        case NVPixelLayout::EChannelType::UNorm8:
+            TypeDescription = TEXT("|u1");
+            break;
+        case NVPixelLayout::EChannelType::UNorm16:
+            TypeDescription = FString(ByteOrder) + TEXT("u2");
+            break;
+        case NVPixelLayout::EChannelType::Half:
+            TypeDescription = FString(ByteOrder) + TEXT("f2");
+            break;
+        case NVPixelLayout::EChannelType::Float:
+        default:
+            TypeDescription = FString(ByteOrder) + TEXT("f4");
+            break;
+    }
+    const FString Shape = (SourceLayout.ChannelCount == 1) ? FString::Printf(TEXT("(%d, %d)"), Height, Width)
+                                                           : FString::Printf(TEXT("(%d, %d, %d)"), Height, Width, SourceLayout.ChannelCount);
+    FString Header = FString::Printf(TEXT("{'descr': '%s', 'fortran_order': False, 'shape': %s, }"), *TypeDescription, *Shape);
+
+    // NOTE: The header is padded with spaces and end with a new line so the array's data start at a multiple of 64 bytes
+    const int32 PreambleSize = 10;
+    const int32 UnpaddedSize = PreambleSize + Header.Len() + 1;
+    Header += FString::ChrN((64 - (UnpaddedSize % 64)) % 64, TEXT(' '));
+    Header += TEXT("\n");
+
+    OutData.Reserve(PreambleSize + Header.Len() + RawDataSize);
+    // Magic string then version 1.0
+    OutData.Append((const uint8*)"\x93NUMPY", 6);
+    OutData.Add(1);
+    OutData.Add(0);
+    OutData.Add(Header.Len() & 0xFF);
+    OutData.Add((Header.Len() >> 8) & 0xFF);
+    for (int32 i = 0; i < Header.Len(); i++)
+    {
+        OutData.Add((uint8)Header[i]);
+    }
+
+    const uint8* SourceData = SourcePixelData.PixelData.GetData();
+    if (!SourceLayout.bIsBGRA && (SourceRowStride == RowByteSize))
+    {
+        OutData.Append(SourceData, RawDataSize);
+    }
+    else
+    {
+        // The array's rows are packed, the padding of the source rows is skipped
+        const int32 DataOffset = OutData.AddUninitialized(RawDataSize);
+        uint8* DestData = OutData.GetData() + DataOffset;
+        for (int32 Row = 0; Row < Height; Row++)
+        {
+            const uint8* SourceRow = SourceData + Row * SourceRowStride;
+            uint8* DestRow = DestData + Row * RowByteSize;
+            if (!SourceLayout.bIsBGRA)
+            {
+                FMemory::Memcpy(DestRow, SourceRow, RowByteSize);
+                continue;
+            }
+
+            for (int32 x = 0; x < Width; x++)
+            {
+                const uint8* SourcePixel = SourceRow + x * BytesPerPixel;
+                uint8* DestPixel = DestRow + x * BytesPerPixel;
+                DestPixel[0] = SourcePixel[2];
+                DestPixel[1] = SourcePixel[1];
+                DestPixel[2] = SourcePixel[0];
+                DestPixel[3] = SourcePixel[3];
+            }
+        }
+    }
+}
+
+void FNVImageExporter::WriteImageBMP(const FNVTexturePixelData& SourcePixelData, TArray<uint8>& OutData)
+{
+    OutData.Reset();
+
+    const int32 Width = SourcePixelData.PixelSize.X;
+    const int32 Height = SourcePixelData.PixelSize.Y;
+    const uint32 SourceBytesPerPixel = sizeof(FColor);
+    const uint32 SourceRowStride = FMath::Max<uint32>(SourcePixelData.RowStride, Width * SourceBytesPerPixel);
+    if ((Width <= 0) || (Height <= 0) ||
+        (SourcePixelData.PixelData.Num() < int64(SourceRowStride) * (Height - 1) + int64(Width) * SourceBytesPerPixel))
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("Number of Pixels is 0."));
+        return;
+    }
+
+    // NOTE: The rows of the BMP are stored bottom-up and padded to a multiple of 4 bytes
+    const uint32 DestBytesPerPixel = 3;
+    const uint32 DestRowByteSize = Align(Width * DestBytesPerPixel, 4);
+    const uint32 FileHeaderSize = 14;
+    const uint32 InfoHeaderSize = 40;
+    const uint32 PixelDataOffset = FileHeaderSize + InfoHeaderSize;
+    const uint32 PixelDataSize = DestRowByteSize * Height;
+
+    OutData.SetNumZeroed(PixelDataOffset + PixelDataSize);
+    uint8* DestData = OutData.GetData();
+    auto WriteUInt16 = [&DestData](uint16 Value)
+    {
+        DestData[0] = Value & 0xFF;
+        DestData[1] = (Value >> 8) & 0xFF;
+        DestData += 2;
+    };
+    auto WriteUInt32 = [&DestData](uint32 Value)
+    {
+        for (int32 i = 0; i < 4; i++)
+        {
+            DestData[i] = (Value >> (i * 8)) & 0xFF;
+        }
+        DestData += 4;
+    };
+
+    // BITMAPFILEHEADER
+    WriteUInt16('B' + 256 * 'M');
+    WriteUInt32(PixelDataOffset + PixelDataSize);
+    WriteUInt16(0);
+    WriteUInt16(0);
+    WriteUInt32(PixelDataOffset);
+
+    // BITMAPINFOHEADER, uncompressed (BI_RGB) without palette
+    WriteUInt32(InfoHeaderSize);
+    WriteUInt32(Width);
+    WriteUInt32(Height);
+    WriteUInt16(1);
+    WriteUInt16(DestBytesPerPixel * 8);
+    WriteUInt32(0);
+    WriteUInt32(PixelDataSize);
+    WriteUInt32(0);
+    WriteUInt32(0);
+    WriteUInt32(0);
+    WriteUInt32(0);
+
+    const uint8* SourceData = SourcePixelData.PixelData.GetData();
+    for (int32 Row = 0; Row < Height; Row++)
+    {
+        const FColor* SourceRow = (const FColor*)(SourceData + (Height - 1 - Row) * SourceRowStride);
+        uint8* DestRow = OutData.GetData() + PixelDataOffset + Row * DestRowByteSize;
+        for (int32 x = 0; x < Width; x++)
+        {
+            DestRow[x * DestBytesPerPixel + 0] = SourceRow[x].B;
+            DestRow[x * DestBytesPerPixel + 1] = SourceRow[x].G;
+            DestRow[x * DestBytesPerPixel + 2] = SourceRow[x].R;
+        }
+    }
 }
 
 TArray<uint8>  FNVImageExporter::CompressImage(IImageWrapperModule* ImageWrapperModule, const FNVTexturePixelData& SourcePixelData,
         ENVImageFormat ImageFormat, uint8 CompressionQuality/*= 100*/)
 {
     TArray<uint8> CompressedData;
+    CompressImage(ImageWrapperModule, SourcePixelData, ImageFormat, CompressedData, CompressionQuality);
+    return CompressedData;
+}
+
+void FNVImageExporter::CompressImage(IImageWrapperModule* ImageWrapperModule, const FNVTexturePixelData& SourcePixelData,
+        ENVImageFormat ImageFormat, TArray<uint8>& CompressedData, uint8 CompressionQuality/*= 100*/,
+        const FNVImageCompressionSettings& CompressionSettings/*= FNVImageCompressionSettings()*/)
+{
     CompressedData.Reset();
     const auto& PixelData = SourcePixelData.PixelData;
     const uint32 PixelCount = PixelData.Num();
@@ -252,19 +1198,35 @@ TArray<uint8>  FNVImageExporter::CompressImage(IImageWrapperModule* ImageWrapper
             (ImageWrapperModule == nullptr) ||      // We need a valid image wrapper module reference
             (ImageFormat == ENVImageFormat::BMP))   // Don't handle compression for BMP format
     {
-        return CompressedData;
+        return;
     }
 
     if (ImageFormat == ENVImageFormat::PNG)
     {
-        return CompressImagePNG(SourcePixelData);
+        CompressImagePNG(SourcePixelData, CompressedData, CompressionSettings);
+        return;
+    }
+    else if (ImageFormat == ENVImageFormat::PNG16)
+    {
+        CompressImagePNG16(SourcePixelData, CompressedData, CompressionSettings);
+        return;
+    }
+    else if (ImageFormat == ENVImageFormat::EXR)
+    {
+        CompressImageEXR(SourcePixelData, CompressedData, CompressionSettings);
+        return;
+    }
+    else if (ImageFormat == ENVImageFormat::NPY)
+    {
+        WriteImageNPY(SourcePixelData, CompressedData);
+        return;
     }
 
     const EImageFormat ImageFormatType = ConvertExportFormatToImageFormat(ImageFormat);
     TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule->CreateImageWrapper(ImageFormatType);
     if (!ImageWrapper.IsValid())
     {
-        return CompressedData;
+        return;
     }
 
     EPixelFormat ImgPixelFormat = SourcePixelData.PixelFormat;
@@ -274,8 +1236,23 @@ TArray<uint8>  FNVImageExporter::CompressImage(IImageWrapperModule* ImageWrapper
 	{
 		const auto& ImageSize = SourcePixelData.PixelSize;
 
-		const void* RawData = (void*)PixelData.GetData();
-		int32 AllocatedSize = PixelData.GetAllocatedSize();
+		// NOTE: The image wrapper expect packed rows, the padding of the source rows is dropped
+		const uint32 RowByteSize = ImageSize.X * ((ImgRGBFormat == ERGBFormat::Gray) ? 1 : 4) * (ImgBitDepth / 8);
+		const uint32 SourceRowStride = FMath::Max(SourcePixelData.RowStride, RowByteSize);
+		TArray<uint8> PackedPixelData;
+		const TArray<uint8>* RawPixelData = &PixelData;
+		if ((SourceRowStride != RowByteSize) && (PixelData.Num() >= (int32)(SourceRowStride * (ImageSize.Y - 1) + RowByteSize)))
+		{
+			PackedPixelData.SetNumUninitialized(RowByteSize * ImageSize.Y);
+			for (int32 Row = 0; Row < ImageSize.Y; Row++)
+			{
+				FMemory::Memcpy(PackedPixelData.GetData() + Row * RowByteSize, PixelData.GetData() + Row * SourceRowStride, RowByteSize);
+			}
+			RawPixelData = &PackedPixelData;
+		}
+
+		const void* RawData = (void*)RawPixelData->GetData();
+		int32 AllocatedSize = RawPixelData->GetAllocatedSize();
 		ImageWrapper->SetRaw(RawData, AllocatedSize, ImageSize.X, ImageSize.Y, ImgRGBFormat, ImgBitDepth);
 		CompressedData = ImageWrapper->GetCompressed(CompressionQuality);
 
@@ -285,13 +1262,23 @@ TArray<uint8>  FNVImageExporter::CompressImage(IImageWrapperModule* ImageWrapper
 	{
 		UE_LOG(LogNVSceneCapturer, Error, TEXT("Unsupported pixel format."));
 	}
-    return CompressedData;
 }
 
 bool FNVImageExporter::ExportImage(IImageWrapperModule* ImageWrapperModule, const FNVImageExporterData& ImageExporterData)
+{
+	TArray<uint8> CompressedData;
+	return ExportImage(ImageWrapperModule, ImageExporterData, CompressedData);
+}
+
+bool FNVImageExporter::ExportImage(IImageWrapperModule* ImageWrapperModule, const FNVImageExporterData& ImageExporterData, TArray<uint8>& ScratchBuffer)
 {
 	bool bResult = false;
-	const auto& ExportedPixelData = ImageExporterData.PixelDataToBeExported;
+	if (!ImageExporterData.PixelDataToBeExported.IsValid())
+	{
+		return bResult;
+	}
+
+	const auto& ExportedPixelData = *ImageExporterData.PixelDataToBeExported;
 	const auto& PixelData = ExportedPixelData.PixelData;
 	const auto& ExportFilePath = ImageExporterData.ExportFilePath;
 	const auto& ExportImageFormat = ImageExporterData.ExportImageFormat;
@@ -299,16 +1286,33 @@ bool FNVImageExporter::ExportImage(IImageWrapperModule* ImageWrapperModule, cons
 
 	if ((PixelCount != 0) && (ImageWrapperModule != nullptr))
 	{
-		if (ExportImageFormat == ENVImageFormat::BMP)
+		const bool bHasCompressedImageCallback = !!ImageExporterData.CompressedImageCallback;
+		if ((ExportImageFormat == ENVImageFormat::BMP) && !bHasCompressedImageCallback)
 		{
 			const auto& ImageSize = ExportedPixelData.PixelSize;
 			bResult = FFileHelper::CreateBitmap(*ExportFilePath, ImageSize.X, ImageSize.Y, (FColor*)((void*)PixelData.GetData()));
 		}
 		else
 		{
-			const uint8 CompressedQuality = 100;
-			const TArray<uint8>& CompressedBitmap = CompressImage(ImageWrapperModule, ExportedPixelData, ExportImageFormat, CompressedQuality);
-			bResult = FFileHelper::SaveArrayToFile(CompressedBitmap, *ExportFilePath);
+			if (ExportImageFormat == ENVImageFormat::BMP)
+			{
+				// The callback get the same bytes CreateBitmap would have saved, e.g: to add their size and checksum to the index
+				WriteImageBMP(ExportedPixelData, ScratchBuffer);
+			}
+			else
+			{
+				const uint8 CompressedQuality = (uint8)FMath::Clamp(ImageExporterData.CompressionSettings.JpegQuality, 1, 100);
+				CompressImage(ImageWrapperModule, ExportedPixelData, ExportImageFormat, ScratchBuffer, CompressedQuality, ImageExporterData.CompressionSettings);
+			}
+
+			if (bHasCompressedImageCallback)
+			{
+				bResult = (ScratchBuffer.Num() > 0) && ImageExporterData.CompressedImageCallback(ExportFilePath, ScratchBuffer);
+			}
+			else
+			{
+				bResult = FFileHelper::SaveArrayToFile(ScratchBuffer, *ExportFilePath);
+			}
 		}
 
 		//#miker: occasionally the ndds attempts to write the same file
@@ -329,43 +1333,111 @@ bool FNVImageExporter::ExportImage(const FNVImageExporterData& ImageExporterData
 }
 
 //====================================== FNVSaveImageToFileThread ==========================================
-FNVImageExporter_Thread::FNVImageExporter_Thread(IImageWrapperModule* InImageWrapperModule)
-    : ImageWrapperModule(InImageWrapperModule)
+FNVImageExporter_Thread::FNVImageExporter_Thread(IImageWrapperModule* InImageWrapperModule, int32 InWorkerCount/*= 0*/, int32 InMaxQueuedImageCount/*= 0*/)
+    : MaxQueuedImageCount(FMath::Max(InMaxQueuedImageCount, 0)),
+    ImageWrapperModule(InImageWrapperModule)
 {
     ensure(ImageWrapperModule);
 
-    bIsRunning = false;
-
     PendingImageCounter.Reset();
-
-    ExportingImageCounterPtr = MakeShareable(new FThreadSafeCounter());
-    ExportingImageCounterPtr->Reset();
+    ExportingImageCounter.Reset();
 
     QueuedImageData.Empty();
 
-    HavePendingImageEvent = FPlatformProcess::GetSynchEventFromPool();
+    // NOTE: Auto-reset events so each trigger only wake up one waiting thread
+    HavePendingImageEvent = FPlatformProcess::GetSynchEventFromPool(false);
+    HaveFreeSlotEvent = FPlatformProcess::GetSynchEventFromPool(false);
+    ImageExportedEvent = FPlatformProcess::GetSynchEventFromPool(false);
+
+    // NOTE: By default only use half of the cores so the engine's task graph and the render thread still have room to run
+    int32 WorkerCount = InWorkerCount;
+    if (WorkerCount <= 0)
+    {
+        WorkerCount = FPlatformMisc::NumberOfCores() / 2;
+    }
+    WorkerCount = FMath::Max(WorkerCount, 1);
+
+    // NOTE: Must be set before the workers start or they will exit right away
+    bIsRunning = true;
 
     // TODO: May move this Thread to a Start function
-    // Create the thread for this task to run
+    // Create the worker threads, they all run the same Run function and share the queue
     static int32 ThreadIndex = 0;
-    const FString& ThreadName = FString::Printf(TEXT("NVSaveImageToFileThread_%d"), ++ThreadIndex);
+    ThreadIndex++;
     const uint32 ThreadStackSize = 0;
-    const EThreadPriority& ThreadPriority = EThreadPriority::TPri_TimeCritical;
+    const EThreadPriority& ThreadPriority = EThreadPriority::TPri_Normal;
     const uint64 ThreadAffinityMask = FPlatformAffinity::GetNoAffinityMask();
-    Thread = FRunnableThread::Create(this, *ThreadName, ThreadStackSize, ThreadPriority, ThreadAffinityMask);
+    WorkerThreads.Reset(WorkerCount);
+    for (int32 i = 0; i < WorkerCount; i++)
+    {
+        const FString& ThreadName = FString::Printf(TEXT("NVSaveImageToFileThread_%d_%d"), ThreadIndex, i);
+        FRunnableThread* NewThread = FRunnableThread::Create(this, *ThreadName, ThreadStackSize, ThreadPriority, ThreadAffinityMask);
+        if (NewThread)
+        {
+            WorkerThreads.Add(NewThread);
+        }
+    }
 }
 
 FNVImageExporter_Thread::~FNVImageExporter_Thread()
 {
-    ImageWrapperModule = nullptr;
     Kill();
+    ImageWrapperModule = nullptr;
+
+    if (HavePendingImageEvent)
+    {
+        FPlatformProcess::ReturnSynchEventToPool(HavePendingImageEvent);
+        HavePendingImageEvent = nullptr;
+    }
+    if (HaveFreeSlotEvent)
+    {
+        FPlatformProcess::ReturnSynchEventToPool(HaveFreeSlotEvent);
+        HaveFreeSlotEvent = nullptr;
+    }
+    if (ImageExportedEvent)
+    {
+        FPlatformProcess::ReturnSynchEventToPool(ImageExportedEvent);
+        ImageExportedEvent = nullptr;
+    }
 }
 
-bool FNVImageExporter_Thread::ExportImage(const FNVTexturePixelData& ExportPixelData, const FString& ExportFilePath, const ENVImageFormat ExportImageFormat/*= ENVImageFormat::PNG*/)
+bool FNVImageExporter_Thread::ExportImage(const FNVTexturePixelDataRef& ExportPixelData, const FString& ExportFilePath,
+        const ENVImageFormat ExportImageFormat/*= ENVImageFormat::PNG*/,
+        const FNVImageCompressionSettings& CompressionSettings/*= FNVImageCompressionSettings()*/,
+        const FNVCompressedImageCallback& CompressedImageCallback/*= nullptr*/)
 {
-    FNVImageExporterData NewImageExporterData = FNVImageExporterData(ExportPixelData, ExportFilePath, ExportImageFormat);
-    QueuedImageData.Enqueue(MoveTemp(NewImageExporterData));
-    PendingImageCounter.Increment();
+    // Back-pressure: block until a worker take an image out of the queue
+    // NOTE: The capturer should already stop feeding images when CanHandleMoreData return false so we rarely need to wait here
+    while (bIsRunning && IsQueueFull())
+    {
+        if (HaveFreeSlotEvent)
+        {
+            HaveFreeSlotEvent->Wait();
+        }
+        else
+        {
+            FPlatformProcess::Sleep(0.01f);
+        }
+    }
+
+    FNVImageExporterData NewImageExporterData = FNVImageExporterData(ExportPixelData, ExportFilePath, ExportImageFormat,
+                                                                        CompressionSettings, CompressedImageCallback);
+    {
+        // NOTE: Stop turn off bIsRunning with the same lock so no image can be queued after the workers drained the queue
+        FScopeLock ScopeLock(&EnqueueCriticalSection);
+        if (!bIsRunning)
+        {
+            // Pass the wake up from Stop on to the other producers which may be waiting for a free slot
+            if (HaveFreeSlotEvent)
+            {
+                HaveFreeSlotEvent->Trigger();
+            }
+            return false;
+        }
+
+        PendingImageCounter.Increment();
+        QueuedImageData.Enqueue(MoveTemp(NewImageExporterData));
+    }
 
     if (HavePendingImageEvent)
     {
@@ -376,45 +1448,64 @@ bool FNVImageExporter_Thread::ExportImage(const FNVTexturePixelData& ExportPixel
     return true;
 }
 
-uint32 FNVImageExporter_Thread::Run()
+bool FNVImageExporter_Thread::DequeueImageData(FNVImageExporterData& OutImageData)
 {
-    bIsRunning = true;
-
-    // How to run each exporting tasks
-    const EAsyncExecution AsyncExecution = EAsyncExecution::ThreadPool;
-
-    while (bIsRunning)
+    bool bResult = false;
     {
-        // Process all the queued frame data
-        while (!QueuedImageData.IsEmpty())
+        FScopeLock ScopeLock(&DequeueCriticalSection);
+        bResult = QueuedImageData.Dequeue(OutImageData);
+        if (bResult)
         {
-            FNVImageExporterData TmpImageData;
-            QueuedImageData.Dequeue(TmpImageData);
-
+            // NOTE: Must be counted as exporting before it's removed from the pending count
+            // so GetPendingImagesCount never miss the image
+            ExportingImageCounter.Increment();
             PendingImageCounter.Decrement();
-
-            // TODO: Limit the number of exporting threads running at the same time
-            // Need to check if ExportingImageCounterPtr < ThreadThreshold
-            ExportingImageCounterPtr->Increment();
-            auto TempExportingImageCounterPtr = ExportingImageCounterPtr;
-            auto TempImageWrapperModule = ImageWrapperModule;
-            Async<void>(AsyncExecution, [TempExportingImageCounterPtr, TempImageWrapperModule, CheckImageData = MoveTemp(TmpImageData)]
-            {
-                FNVImageExporter::ExportImage(TempImageWrapperModule, CheckImageData);
-                if (TempExportingImageCounterPtr.IsValid())
-                {
-                    TempExportingImageCounterPtr->Decrement();
-                }
-            });
         }
+    }
+
+    if (bResult && HaveFreeSlotEvent)
+    {
+        HaveFreeSlotEvent->Trigger();
+    }
+    return bResult;
+}
 
-        if (HavePendingImageEvent)
+uint32 FNVImageExporter_Thread::Run()
+{
+    // Each worker keep its own buffer for the compressed data so we don't need to reallocate it for every image
+    TArray<uint8> ScratchBuffer;
+
+    bool bKeepRunning = true;
+    while (bKeepRunning)
+    {
+        // NOTE: Read the flag before emptying the queue, once it's off no more images can be queued
+        // so the images queued before the exporter stopped are all exported before the workers exit
+        bKeepRunning = bIsRunning;
+
+        FNVImageExporterData TmpImageData;
+        while (DequeueImageData(TmpImageData))
         {
-            HavePendingImageEvent->Wait();
+            // The pool already compress an image per worker, splitting the images too would oversubscribe the cores
+            TmpImageData.CompressionSettings.bAllowParallelEncoding = false;
+            FNVImageExporter::ExportImage(ImageWrapperModule, TmpImageData, ScratchBuffer);
+            ExportingImageCounter.Decrement();
+            if (ImageExportedEvent)
+            {
+                ImageExportedEvent->Trigger();
+            }
         }
-        else
+
+        // NOTE: Wait with timeout in case the trigger was consumed by another worker
+        if (bKeepRunning)
         {
-            FPlatformProcess::Sleep(0.1f);
+            if (HavePendingImageEvent)
+            {
+                HavePendingImageEvent->Wait(100);
+            }
+            else
+            {
+                FPlatformProcess::Sleep(0.1f);
+            }
         }
     }
 
@@ -423,34 +1514,81 @@ uint32 FNVImageExporter_Thread::Run()
 
 void FNVImageExporter_Thread::Stop()
 {
-    bIsRunning = false;
-    QueuedImageData.Empty();
+    // NOTE: The queued images are not dropped, the workers export them before they exit
+    {
+        FScopeLock ScopeLock(&EnqueueCriticalSection);
+        bIsRunning = false;
+    }
+    const int32 QueuedImageCount = PendingImageCounter.GetValue();
+    if (QueuedImageCount > 0)
+    {
+        UE_LOG(LogNVSceneCapturer, Log, TEXT("The image exporter is stopping, exporting the %d images still in the queue."), QueuedImageCount);
+    }
+
+    // Trigger the events so none of the threads wait anymore
     if (HavePendingImageEvent)
     {
-        // Trigger the event so the thread doesn't wait anymore
-        HavePendingImageEvent->Trigger();
-		//#miker:
-        HavePendingImageEvent->Reset();
+        for (int32 i = 0; i < WorkerThreads.Num(); i++)
+        {
+            HavePendingImageEvent->Trigger();
+        }
+    }
+    if (HaveFreeSlotEvent)
+    {
+        HaveFreeSlotEvent->Trigger();
     }
 }
 
 void FNVImageExporter_Thread::Kill()
 {
-    if (Thread)
+    // NOTE: All the threads share this runnable so we only need to stop it once, then wait for each of them to finish the queue
+    Stop();
+    for (FRunnableThread* CheckThread : WorkerThreads)
     {
-        Thread->Kill(true);
-        Thread = nullptr;
+        if (CheckThread)
+        {
+            CheckThread->WaitForCompletion();
+            delete CheckThread;
+        }
     }
+    WorkerThreads.Reset();
 }
 
 uint32 FNVImageExporter_Thread::GetPendingImagesCount() const
 {
-    return PendingImageCounter.GetValue() + (ExportingImageCounterPtr.IsValid() ? ExportingImageCounterPtr->GetValue() : 0);
+    return PendingImageCounter.GetValue() + ExportingImageCounter.GetValue();
+}
+
+void FNVImageExporter_Thread::WaitForPendingImages()
+{
+    // NOTE: The workers export all the queued images before they exit, even when the exporter is stopped
+    while ((GetPendingImagesCount() > 0) && (WorkerThreads.Num() > 0))
+    {
+        // NOTE: Only this thread wait for the event so a trigger which happen before we wait is kept for us
+        if (ImageExportedEvent)
+        {
+            ImageExportedEvent->Wait();
+        }
+        else
+        {
+            FPlatformProcess::Sleep(0.01f);
+        }
+    }
 }
 
 bool FNVImageExporter_Thread::IsExportingImage() const
 {
-    return ExportingImageCounterPtr.IsValid() && (ExportingImageCounterPtr->GetValue() > 0);
+    return (ExportingImageCounter.GetValue() > 0);
+}
+
+bool FNVImageExporter_Thread::IsQueueFull() const
+{
+    return (MaxQueuedImageCount > 0) && (PendingImageCounter.GetValue() >= MaxQueuedImageCount);
+}
+
+int32 FNVImageExporter_Thread::GetWorkerCount() const
+{
+    return WorkerThreads.Num();
 }
 
 //====================================== FNVImageExporterData ==========================================
@@ -460,9 +1598,13 @@ FNVImageExporterData::FNVImageExporterData()
 	ExportImageFormat = ENVImageFormat::PNG;
 }
 
-FNVImageExporterData::FNVImageExporterData(const FNVTexturePixelData& InPixelDataToBeExported, const FString InExportFilePath, ENVImageFormat InExportImageFormat /*= ENVImageFormat::PNG*/)
+FNVImageExporterData::FNVImageExporterData(const FNVTexturePixelDataRef& InPixelDataToBeExported, const FString& InExportFilePath, ENVImageFormat InExportImageFormat /*= ENVImageFormat::PNG*/,
+	const FNVImageCompressionSettings& InCompressionSettings /*= FNVImageCompressionSettings()*/,
+	const FNVCompressedImageCallback& InCompressedImageCallback /*= nullptr*/)
 	: PixelDataToBeExported(InPixelDataToBeExported),
 	ExportFilePath(InExportFilePath),
-	ExportImageFormat(InExportImageFormat)
+	ExportImageFormat(InExportImageFormat),
+	CompressionSettings(InCompressionSettings),
+	CompressedImageCallback(InCompressedImageCallback)
 {
 }
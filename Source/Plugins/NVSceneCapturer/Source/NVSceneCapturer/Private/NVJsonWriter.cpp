@@ -0,0 +1,707 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVJsonWriter.h"
+#include "NVSceneCapturerUtils.h"
+#include "NVCameraSettings.h"
+#include "Dom/JsonObject.h"
+
+//====================================== FNVJsonWriter ==========================================
+FNVJsonWriter::FNVJsonWriter(TArray<uint8>& InOutputBuffer, int32 InitialIndentLevel /*= 0*/)
+    : OutputBuffer(InOutputBuffer),
+    IndentLevel(InitialIndentLevel),
+    PreviousTokenWritten(EToken::None)
+{
+}
+
+// NOTE: The layout logic below follow TJsonWriter with TPrettyJsonPrintPolicy token by token, don't change it or the exported files will change
+void FNVJsonWriter::WriteObjectStart()
+{
+    if (PreviousTokenWritten != EToken::None)
+    {
+        WriteCommaIfNeeded();
+        WriteLineTerminator();
+        WriteTabs();
+    }
+
+    WriteChar('{');
+    ++IndentLevel;
+    PreviousTokenWritten = EToken::CurlyOpen;
+}
+
+void FNVJsonWriter::WriteObjectStart(const ANSICHAR* Identifier)
+{
+    WriteIdentifier(Identifier);
+    WriteLineTerminator();
+    WriteTabs();
+    WriteChar('{');
+    ++IndentLevel;
+    PreviousTokenWritten = EToken::CurlyOpen;
+}
+
+void FNVJsonWriter::WriteObjectStart(const FString& Identifier)
+{
+    WriteIdentifier(Identifier);
+    WriteLineTerminator();
+    WriteTabs();
+    WriteChar('{');
+    ++IndentLevel;
+    PreviousTokenWritten = EToken::CurlyOpen;
+}
+
+void FNVJsonWriter::WriteObjectEnd()
+{
+    WriteLineTerminator();
+    --IndentLevel;
+    WriteTabs();
+    WriteChar('}');
+    PreviousTokenWritten = EToken::CurlyClose;
+}
+
+void FNVJsonWriter::WriteArrayStart()
+{
+    if (PreviousTokenWritten != EToken::None)
+    {
+        WriteCommaIfNeeded();
+        WriteLineTerminator();
+        WriteTabs();
+    }
+
+    WriteChar('[');
+    ++IndentLevel;
+    PreviousTokenWritten = EToken::SquareOpen;
+}
+
+void FNVJsonWriter::WriteArrayStart(const ANSICHAR* Identifier)
+{
+    WriteIdentifier(Identifier);
+    WriteChar(' ');
+    WriteChar('[');
+    ++IndentLevel;
+    PreviousTokenWritten = EToken::SquareOpen;
+}
+
+void FNVJsonWriter::WriteArrayStart(const FString& Identifier)
+{
+    WriteIdentifier(Identifier);
+    WriteChar(' ');
+    WriteChar('[');
+    ++IndentLevel;
+    PreviousTokenWritten = EToken::SquareOpen;
+}
+
+void FNVJsonWriter::WriteArrayEnd()
+{
+    --IndentLevel;
+
+    if ((PreviousTokenWritten == EToken::SquareClose) ||
+        (PreviousTokenWritten == EToken::CurlyClose) ||
+        (PreviousTokenWritten == EToken::String))
+    {
+        WriteLineTerminator();
+        WriteTabs();
+    }
+    else if (PreviousTokenWritten != EToken::SquareOpen)
+    {
+        WriteChar(' ');
+    }
+
+    WriteChar(']');
+    PreviousTokenWritten = EToken::SquareClose;
+}
+
+void FNVJsonWriter::WriteValue(double Value)
+{
+    WriteCommaIfNeeded();
+    if ((PreviousTokenWritten == EToken::SquareOpen) || IsShortValue(PreviousTokenWritten))
+    {
+        WriteChar(' ');
+    }
+    else
+    {
+        WriteLineTerminator();
+        WriteTabs();
+    }
+    PreviousTokenWritten = WriteNumberOnly(Value);
+}
+
+void FNVJsonWriter::WriteValue(bool Value)
+{
+    WriteCommaIfNeeded();
+    if ((PreviousTokenWritten == EToken::SquareOpen) || IsShortValue(PreviousTokenWritten))
+    {
+        WriteChar(' ');
+    }
+    else
+    {
+        WriteLineTerminator();
+        WriteTabs();
+    }
+    WriteAnsiString(Value ? "true" : "false", Value ? 4 : 5);
+    PreviousTokenWritten = Value ? EToken::True : EToken::False;
+}
+
+void FNVJsonWriter::WriteValue(const FString& Value)
+{
+    // NOTE: Unlike the other values, the strings in an array are always written on their own line
+    WriteCommaIfNeeded();
+    WriteLineTerminator();
+    WriteTabs();
+    WriteStringValue(Value);
+    PreviousTokenWritten = EToken::String;
+}
+
+void FNVJsonWriter::WriteNull()
+{
+    WriteCommaIfNeeded();
+    if ((PreviousTokenWritten == EToken::SquareOpen) || IsShortValue(PreviousTokenWritten))
+    {
+        WriteChar(' ');
+    }
+    else
+    {
+        WriteLineTerminator();
+        WriteTabs();
+    }
+    WriteAnsiString("null", 4);
+    PreviousTokenWritten = EToken::Null;
+}
+
+void FNVJsonWriter::WriteValue(const ANSICHAR* Identifier, double Value)
+{
+    WriteIdentifier(Identifier);
+    WriteChar(' ');
+    PreviousTokenWritten = WriteNumberOnly(Value);
+}
+
+void FNVJsonWriter::WriteValue(const ANSICHAR* Identifier, bool Value)
+{
+    WriteIdentifier(Identifier);
+    WriteChar(' ');
+    WriteAnsiString(Value ? "true" : "false", Value ? 4 : 5);
+    PreviousTokenWritten = Value ? EToken::True : EToken::False;
+}
+
+void FNVJsonWriter::WriteValue(const ANSICHAR* Identifier, const FString& Value)
+{
+    WriteIdentifier(Identifier);
+    WriteChar(' ');
+    WriteStringValue(Value);
+    PreviousTokenWritten = EToken::String;
+}
+
+void FNVJsonWriter::WriteJsonValue(const TSharedPtr<FJsonValue>& Value)
+{
+    if (!Value.IsValid())
+    {
+        return;
+    }
+
+    switch (Value->Type)
+    {
+        case EJson::Null:
+            WriteNull();
+            break;
+        case EJson::String:
+            WriteValue(Value->AsString());
+            break;
+        case EJson::Number:
+            WriteValue(Value->AsNumber());
+            break;
+        case EJson::Boolean:
+            WriteValue(Value->AsBool());
+            break;
+        case EJson::Array:
+        {
+            WriteArrayStart();
+            for (const TSharedPtr<FJsonValue>& ElementValue : Value->AsArray())
+            {
+                WriteJsonValue(ElementValue);
+            }
+            WriteArrayEnd();
+            break;
+        }
+        case EJson::Object:
+        {
+            WriteObjectStart();
+            WriteJsonObjectFields(Value->AsObject());
+            WriteObjectEnd();
+            break;
+        }
+        case EJson::None:
+        default:
+            break;
+    }
+}
+
+void FNVJsonWriter::WriteJsonValue(const FString& Identifier, const TSharedPtr<FJsonValue>& Value)
+{
+    if (!Value.IsValid())
+    {
+        return;
+    }
+
+    switch (Value->Type)
+    {
+        case EJson::Null:
+            WriteIdentifier(Identifier);
+            WriteChar(' ');
+            WriteAnsiString("null", 4);
+            PreviousTokenWritten = EToken::Null;
+            break;
+        case EJson::String:
+            WriteIdentifier(Identifier);
+            WriteChar(' ');
+            WriteStringValue(Value->AsString());
+            PreviousTokenWritten = EToken::String;
+            break;
+        case EJson::Number:
+            WriteIdentifier(Identifier);
+            WriteChar(' ');
+            PreviousTokenWritten = WriteNumberOnly(Value->AsNumber());
+            break;
+        case EJson::Boolean:
+        {
+            const bool bValue = Value->AsBool();
+            WriteIdentifier(Identifier);
+            WriteChar(' ');
+            WriteAnsiString(bValue ? "true" : "false", bValue ? 4 : 5);
+            PreviousTokenWritten = bValue ? EToken::True : EToken::False;
+            break;
+        }
+        case EJson::Array:
+        {
+            WriteArrayStart(Identifier);
+            for (const TSharedPtr<FJsonValue>& ElementValue : Value->AsArray())
+            {
+                WriteJsonValue(ElementValue);
+            }
+            WriteArrayEnd();
+            break;
+        }
+        case EJson::Object:
+        {
+            WriteObjectStart(Identifier);
+            WriteJsonObjectFields(Value->AsObject());
+            WriteObjectEnd();
+            break;
+        }
+        case EJson::None:
+        default:
+            break;
+    }
+}
+
+void FNVJsonWriter::WriteJsonObjectFields(const TSharedPtr<FJsonObject>& Object)
+{
+    if (Object.IsValid())
+    {
+        for (const auto& FieldPair : Object->Values)
+        {
+            WriteJsonValue(FieldPair.Key, FieldPair.Value);
+        }
+    }
+}
+
+void FNVJsonWriter::WriteFloat(const ANSICHAR* Identifier, float Value)
+{
+    WriteValue(Identifier, (double)NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value));
+}
+
+void FNVJsonWriter::WriteVector(const ANSICHAR* Identifier, const FVector& Value)
+{
+    WriteArrayStart(Identifier);
+    WriteValue((double)NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.X));
+    WriteValue((double)NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.Y));
+    WriteValue((double)NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.Z));
+    WriteArrayEnd();
+}
+
+void FNVJsonWriter::WriteVector(const FVector& Value)
+{
+    WriteArrayStart();
+    WriteValue((double)NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.X));
+    WriteValue((double)NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.Y));
+    WriteValue((double)NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.Z));
+    WriteArrayEnd();
+}
+
+void FNVJsonWriter::WriteVector2D(const ANSICHAR* Identifier, const FVector2D& Value)
+{
+    WriteArrayStart(Identifier);
+    WriteValue((double)NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.X));
+    WriteValue((double)NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.Y));
+    WriteArrayEnd();
+}
+
+void FNVJsonWriter::WriteVector2D(const FVector2D& Value)
+{
+    WriteArrayStart();
+    WriteValue((double)NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.X));
+    WriteValue((double)NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.Y));
+    WriteArrayEnd();
+}
+
+void FNVJsonWriter::WriteQuat(const ANSICHAR* Identifier, const FQuat& Value)
+{
+    WriteArrayStart(Identifier);
+    WriteValue((double)NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.X));
+    WriteValue((double)NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.Y));
+    WriteValue((double)NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.Z));
+    WriteValue((double)NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.W));
+    WriteArrayEnd();
+}
+
+void FNVJsonWriter::WriteMatrix(const ANSICHAR* Identifier, const FMatrix& Value)
+{
+    WriteArrayStart(Identifier);
+    for (int i = 0; i < 4; i++)
+    {
+        WriteArrayStart();
+        for (int j = 0; j < 4; j++)
+        {
+            WriteValue((double)NVSceneCapturerUtils::ConvertFloatWithPrecision4(Value.M[i][j]));
+        }
+        WriteArrayEnd();
+    }
+    WriteArrayEnd();
+}
+
+void FNVJsonWriter::WriteRotator(const ANSICHAR* Identifier, const FRotator& Value)
+{
+    // NOTE: FRotator doesn't have a shorthand format so it's converted as a normal struct
+    WriteObjectStart(Identifier);
+    WriteFloat("pitch", Value.Pitch);
+    WriteFloat("yaw", Value.Yaw);
+    WriteFloat("roll", Value.Roll);
+    WriteObjectEnd();
+}
+
+void FNVJsonWriter::SerializeCapturedSceneData(const FCapturedSceneData& SceneData, TArray<uint8>& OutJsonData)
+{
+    OutJsonData.Reset();
+    FNVJsonWriter JsonWriter(OutJsonData);
+
+    JsonWriter.WriteObjectStart();
+    JsonWriter.WriteCapturedViewpointData("camera_data", SceneData.camera_data);
+    JsonWriter.WriteArrayStart("objects");
+    for (const FCapturedObjectData& ObjectData : SceneData.Objects)
+    {
+        JsonWriter.WriteCapturedObjectData(ObjectData, SceneData.OptionalObjectFields);
+    }
+    JsonWriter.WriteArrayEnd();
+    JsonWriter.WriteObjectEnd();
+}
+
+// NOTE: The fields are written in the same order as the properties are declared in the structs
+// and their names are standardized the same way FJsonObjectConverter does: the first letter is lower case
+void FNVJsonWriter::WriteCapturedViewpointData(const ANSICHAR* Identifier, const FCapturedViewpointData& ViewpointData)
+{
+    WriteObjectStart(Identifier);
+    WriteVector("location_worldframe", ViewpointData.location_worldframe);
+    WriteQuat("quaternion_xyzw_worldframe", ViewpointData.quaternion_xyzw_worldframe);
+    WriteMatrix("projectionMatrix", ViewpointData.ProjectionMatrix);
+    WriteMatrix("viewProjectionMatrix", ViewpointData.ViewProjectionMatrix);
+    WriteCameraIntrinsicSettings("cameraSettings", ViewpointData.CameraSettings);
+    WriteFloat("fov", ViewpointData.fov);
+    WriteObjectEnd();
+}
+
+void FNVJsonWriter::WriteCameraIntrinsicSettings(const ANSICHAR* Identifier, const FCameraIntrinsicSettings& CameraSettings)
+{
+    WriteObjectStart(Identifier);
+    WriteValue("resX", (double)CameraSettings.ResX);
+    WriteValue("resY", (double)CameraSettings.ResY);
+    WriteFloat("fx", CameraSettings.Fx);
+    WriteFloat("fy", CameraSettings.Fy);
+    WriteFloat("cx", CameraSettings.Cx);
+    WriteFloat("cy", CameraSettings.Cy);
+    WriteFloat("s", CameraSettings.S);
+    WriteMatrix("intrinsicMatrix", CameraSettings.IntrinsicMatrix);
+    WriteMatrix("projectionMatrix", CameraSettings.ProjectionMatrix);
+    WriteObjectEnd();
+}
+
+void FNVJsonWriter::WriteCapturedObjectData(const FCapturedObjectData& ObjectData, uint32 OptionalObjectFields)
+{
+    WriteObjectStart();
+    WriteValue("name", ObjectData.Name);
+    WriteValue("class", ObjectData.Class);
+    WriteValue("instance_id", (double)ObjectData.instance_id);
+
+    WriteArrayStart("rgba");
+    for (const uint8 ColorValue : ObjectData.rgba)
+    {
+        WriteValue((double)ColorValue);
+    }
+    WriteArrayEnd();
+
+    WriteFloat("truncated", ObjectData.truncated);
+    WriteValue("occluded", (double)ObjectData.occluded);
+    WriteFloat("occlusion", ObjectData.occlusion);
+    WriteFloat("visibility", ObjectData.visibility);
+    if (OptionalObjectFields & ENVOptionalObjectFields::PixelCounts)
+    {
+        WriteValue("visible_pixel_count", (double)ObjectData.visible_pixel_count);
+        WriteValue("projected_pixel_count", (double)ObjectData.projected_pixel_count);
+    }
+    if (OptionalObjectFields & ENVOptionalObjectFields::TruncationFlags)
+    {
+        WriteValue("truncation_flags", (double)ObjectData.truncation_flags);
+    }
+    WriteVector("dimensions_worldspace", ObjectData.dimensions_worldspace);
+    WriteVector("location_worldspace", ObjectData.location_worldspace);
+    WriteVector("location", ObjectData.location);
+    WriteRotator("rotation_worldspace", ObjectData.rotation_worldspace);
+    WriteQuat("quaternion_worldspace", ObjectData.quaternion_worldspace);
+    WriteRotator("rotation", ObjectData.rotation);
+    WriteQuat("quaternion_xyzw", ObjectData.quaternion_xyzw);
+    WriteMatrix("actor_to_world_matrix_ue4", ObjectData.actor_to_world_matrix_ue4);
+    WriteMatrix("actor_to_world_matrix_opencv", ObjectData.actor_to_world_matrix_opencv);
+    WriteMatrix("actor_to_camera_matrix", ObjectData.actor_to_camera_matrix);
+    WriteMatrix("pose_transform", ObjectData.pose_transform);
+    WriteVector("bounding_box_center_worldspace", ObjectData.bounding_box_center_worldspace);
+    WriteVector("cuboid_centroid", ObjectData.cuboid_centroid);
+    WriteVector2D("projected_cuboid_centroid", ObjectData.projected_cuboid_centroid);
+    WriteVector("bounding_box_forward_direction", ObjectData.bounding_box_forward_direction);
+    WriteVector2D("bounding_box_forward_direction_imagespace", ObjectData.bounding_box_forward_direction_imagespace);
+    WriteFloat("viewpoint_azimuth_angle", ObjectData.viewpoint_azimuth_angle);
+    WriteFloat("viewpoint_altitude_angle", ObjectData.viewpoint_altitude_angle);
+    WriteFloat("distance_scale", ObjectData.distance_scale);
+
+    WriteObjectStart("bounding_box");
+    WriteVector2D("top_left", ObjectData.bounding_box.top_left);
+    WriteVector2D("bottom_right", ObjectData.bounding_box.bottom_right);
+    WriteObjectEnd();
+
+    if (OptionalObjectFields & ENVOptionalObjectFields::SegmentationRLE)
+    {
+        WriteObjectStart("segmentation_rle");
+        WriteArrayStart("size");
+        for (const uint32 SizeValue : ObjectData.segmentation_rle.size)
+        {
+            WriteValue((double)SizeValue);
+        }
+        WriteArrayEnd();
+        WriteArrayStart("counts");
+        for (const uint32 CountValue : ObjectData.segmentation_rle.counts)
+        {
+            WriteValue((double)CountValue);
+        }
+        WriteArrayEnd();
+        WriteObjectEnd();
+    }
+
+    if (OptionalObjectFields & ENVOptionalObjectFields::SegmentationPolygons)
+    {
+        WriteArrayStart("segmentation_polygons");
+        for (const FNVPolygon2D& Polygon : ObjectData.segmentation_polygons)
+        {
+            WriteObjectStart();
+            WriteArrayStart("points");
+            for (const FVector2D& PolygonPoint : Polygon.points)
+            {
+                WriteVector2D(PolygonPoint);
+            }
+            WriteArrayEnd();
+            WriteObjectEnd();
+        }
+        WriteArrayEnd();
+    }
+
+    WriteArrayStart("cuboid");
+    for (const FVector& CuboidVertex : ObjectData.cuboid)
+    {
+        WriteVector(CuboidVertex);
+    }
+    WriteArrayEnd();
+
+    WriteArrayStart("projected_cuboid");
+    for (const FVector2D& ProjectedCuboidVertex : ObjectData.projected_cuboid)
+    {
+        WriteVector2D(ProjectedCuboidVertex);
+    }
+    WriteArrayEnd();
+
+    WriteArrayStart("socket_data");
+    for (const FNVSocketData& SocketData : ObjectData.socket_data)
+    {
+        WriteObjectStart();
+        WriteValue("socketName", SocketData.SocketName);
+        WriteVector2D("socketLocation", SocketData.SocketLocation);
+        WriteObjectEnd();
+    }
+    WriteArrayEnd();
+
+    // The custom data is not a property, it's added after all the other fields
+    if (ObjectData.custom_data.IsValid())
+    {
+        WriteObjectStart(FString(TEXT("custom_data")));
+        WriteJsonObjectFields(ObjectData.custom_data);
+        WriteObjectEnd();
+    }
+
+    WriteObjectEnd();
+}
+
+bool FNVJsonWriter::IsShortValue(EToken Token)
+{
+    return (Token == EToken::Number) ||
+           (Token == EToken::True) ||
+           (Token == EToken::False) ||
+           (Token == EToken::Null);
+}
+
+void FNVJsonWriter::WriteCommaIfNeeded()
+{
+    if ((PreviousTokenWritten != EToken::CurlyOpen) &&
+        (PreviousTokenWritten != EToken::SquareOpen) &&
+        (PreviousTokenWritten != EToken::Identifier))
+    {
+        WriteChar(',');
+    }
+}
+
+void FNVJsonWriter::WriteIdentifier(const ANSICHAR* Identifier)
+{
+    WriteCommaIfNeeded();
+    WriteLineTerminator();
+    WriteTabs();
+    WriteStringValue(Identifier);
+    WriteChar(':');
+    PreviousTokenWritten = EToken::Identifier;
+}
+
+void FNVJsonWriter::WriteIdentifier(const FString& Identifier)
+{
+    WriteCommaIfNeeded();
+    WriteLineTerminator();
+    WriteTabs();
+    WriteStringValue(Identifier);
+    WriteChar(':');
+    PreviousTokenWritten = EToken::Identifier;
+}
+
+void FNVJsonWriter::WriteLineTerminator()
+{
+    for (const TCHAR* LineTerminatorChar = LINE_TERMINATOR; *LineTerminatorChar; ++LineTerminatorChar)
+    {
+        OutputBuffer.Add((uint8)*LineTerminatorChar);
+    }
+}
+
+void FNVJsonWriter::WriteTabs()
+{
+    if (IndentLevel > 0)
+    {
+        const int32 StartIndex = OutputBuffer.AddUninitialized(IndentLevel);
+        FMemory::Memset(OutputBuffer.GetData() + StartIndex, '\t', IndentLevel);
+    }
+}
+
+void FNVJsonWriter::WriteChar(ANSICHAR Char)
+{
+    OutputBuffer.Add((uint8)Char);
+}
+
+void FNVJsonWriter::WriteAnsiString(const ANSICHAR* String, int32 Length)
+{
+    OutputBuffer.Append((const uint8*)String, Length);
+}
+
+void FNVJsonWriter::WriteStringValue(const ANSICHAR* String)
+{
+    // NOTE: The identifiers we use are plain ASCII names so they don't need to be escaped
+    WriteChar('"');
+    WriteAnsiString(String, FCStringAnsi::Strlen(String));
+    WriteChar('"');
+}
+
+void FNVJsonWriter::WriteStringValue(const FString& String)
+{
+    WriteChar('"');
+
+    bool bIsPureAscii = true;
+    for (const TCHAR* Char = *String; *Char != TCHAR('\0'); ++Char)
+    {
+        if (*Char >= 128)
+        {
+            bIsPureAscii = false;
+            break;
+        }
+    }
+
+    // Same escaping as EscapeJsonString in JsonWriter.h
+    FString EscapedString;
+    for (const TCHAR* Char = *String; *Char != TCHAR('\0'); ++Char)
+    {
+        const TCHAR CheckChar = *Char;
+        const ANSICHAR* EscapedChars = nullptr;
+        switch (CheckChar)
+        {
+            case TCHAR('\\'): EscapedChars = "\\\\"; break;
+            case TCHAR('\n'): EscapedChars = "\\n"; break;
+            case TCHAR('\t'): EscapedChars = "\\t"; break;
+            case TCHAR('\b'): EscapedChars = "\\b"; break;
+            case TCHAR('\f'): EscapedChars = "\\f"; break;
+            case TCHAR('\r'): EscapedChars = "\\r"; break;
+            case TCHAR('\"'): EscapedChars = "\\\""; break;
+            default: break;
+        }
+
+        if (bIsPureAscii)
+        {
+            if (EscapedChars)
+            {
+                WriteAnsiString(EscapedChars, FCStringAnsi::Strlen(EscapedChars));
+            }
+            else if (CheckChar < TCHAR(32))
+            {
+                ANSICHAR EscapedControlChar[8];
+                const int32 EscapedLength = FCStringAnsi::Snprintf(EscapedControlChar, sizeof(EscapedControlChar), "\\u%04x", (uint32)CheckChar);
+                WriteAnsiString(EscapedControlChar, EscapedLength);
+            }
+            else
+            {
+                WriteChar((ANSICHAR)CheckChar);
+            }
+        }
+        else
+        {
+            if (EscapedChars)
+            {
+                EscapedString += ANSI_TO_TCHAR(EscapedChars);
+            }
+            else if (CheckChar < TCHAR(32))
+            {
+                EscapedString += FString::Printf(TEXT("\\u%04x"), CheckChar);
+            }
+            else
+            {
+                EscapedString += CheckChar;
+            }
+        }
+    }
+
+    // Only the non-ASCII strings need to go through the conversion
+    if (!bIsPureAscii)
+    {
+        FTCHARToUTF8 EscapedStringUTF8(*EscapedString);
+        WriteAnsiString((const ANSICHAR*)EscapedStringUTF8.Get(), EscapedStringUTF8.Length());
+    }
+
+    WriteChar('"');
+}
+
+FNVJsonWriter::EToken FNVJsonWriter::WriteNumberOnly(double Value)
+{
+    // NOTE: TJsonWriter write the numbers with 17 significant digits
+    ANSICHAR NumberString[64];
+    const int32 NumberLength = FCStringAnsi::Snprintf(NumberString, sizeof(NumberString), "%.17g", Value);
+    WriteAnsiString(NumberString, NumberLength);
+    return EToken::Number;
+}
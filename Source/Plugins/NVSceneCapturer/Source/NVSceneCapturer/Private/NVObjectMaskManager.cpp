@@ -7,6 +7,7 @@
 #include "NVSceneCapturerModule.h"
 #include "NVSceneCapturerUtils.h"
 #include "NVObjectMaskManager.h"
+#include "NVActorGeometryCache.h"
 #include "Components/StaticMeshComponent.h"
 #include "Engine.h"
 #if WITH_EDITOR
@@ -50,7 +51,8 @@ FString UNVObjectMaskMananger::GetActorMaskName(ENVActorMaskNameType MaskNameTyp
         {
             case ENVActorMaskNameType::UseActorTag:
             {
-				const UNVCapturableActorTag* TagComponent = Cast<UNVCapturableActorTag>(CheckActor->GetComponentByClass(UNVCapturableActorTag::StaticClass()));
+				const TSharedPtr<const FNVActorGeometryRecord> ActorGeometry = FNVActorGeometryCache::FindOrAddActorRecord(CheckActor, false);
+				const UNVCapturableActorTag* TagComponent = ActorGeometry.IsValid() ? ActorGeometry->Tag.Get() : nullptr;
 				if (TagComponent && TagComponent->IsValid())
 				{
 					ActorMaskName = TagComponent->Tag;
@@ -66,36 +68,19 @@ FString UNVObjectMaskMananger::GetActorMaskName(ENVActorMaskNameType MaskNameTyp
             }
             case ENVActorMaskNameType::UseActorMeshName:
             {
-                TArray<UActorComponent*> ActorMeshComps = CheckActor->GetComponentsByClass(UMeshComponent::StaticClass());
-                for (UActorComponent* CheckComp : ActorMeshComps)
+                // The cached mesh asset is the static or skeletal mesh which the component use
+                const TSharedPtr<const FNVActorGeometryRecord> ActorGeometry = FNVActorGeometryCache::FindOrAddActorRecord(CheckActor, false);
+                if (ActorGeometry.IsValid())
                 {
-                    UMeshComponent* CheckMeshComp = Cast<UMeshComponent>(CheckComp);
-                    if (CheckMeshComp && CheckMeshComp->IsVisible())
+                    for (const FNVMeshGeometry& MeshGeometry : ActorGeometry->Meshes)
                     {
-                        // Need to get the mesh which this component use
-                        UStaticMeshComponent* CheckStaticMeshComp = Cast<UStaticMeshComponent>(CheckMeshComp);
-                        if (CheckStaticMeshComp)
+                        const UMeshComponent* CheckMeshComp = MeshGeometry.MeshComponent.Get();
+                        const UObject* MeshAsset = MeshGeometry.MeshAsset.Get();
+                        if (CheckMeshComp && CheckMeshComp->IsVisible() && MeshAsset)
                         {
-                            UStaticMesh* StaticMesh = CheckStaticMeshComp->GetStaticMesh();
-                            if (StaticMesh)
-                            {
-                                ActorMaskName = StaticMesh->GetName();
-                                // NOTE: Only use the first mesh for the name when the actor have multiple meshes
-                                break;
-                            }
-                        }
-                        else
-                        {
-                            USkeletalMeshComponent* CheckSkeletalMeshComp = Cast<USkeletalMeshComponent>(CheckComp);
-                            if (CheckSkeletalMeshComp)
-                            {
-                                USkeletalMesh* SkeletalMesh = CheckSkeletalMeshComp->SkeletalMesh;
-                                if (SkeletalMesh)
-                                {
-                                    ActorMaskName = SkeletalMesh->GetName();
-                                    break;
-                                }
-                            }
+                            ActorMaskName = MeshAsset->GetName();
+                            // NOTE: Only use the first mesh for the name when the actor have multiple meshes
+                            break;
                         }
                     }
                 }
@@ -198,10 +183,14 @@ bool UNVObjectMaskMananger::ShouldCheckActorMask(const AActor* CheckActor) const
     check(CheckActor);
     if (CheckActor && !CheckActor->bHidden)
     {
-        TArray<UActorComponent*> ActorMeshComps = CheckActor->GetComponentsByClass(UMeshComponent::StaticClass());
-        for (UActorComponent* CheckActorComp : ActorMeshComps)
+        const TSharedPtr<const FNVActorGeometryRecord> ActorGeometry = FNVActorGeometryCache::FindOrAddActorRecord(CheckActor, false);
+        if (!ActorGeometry.IsValid())
+        {
+            return false;
+        }
+        for (const FNVMeshGeometry& MeshGeometry : ActorGeometry->Meshes)
         {
-            UMeshComponent* CheckMeshComp = Cast<UMeshComponent>(CheckActorComp);
+            const UMeshComponent* CheckMeshComp = MeshGeometry.MeshComponent.Get();
             if (CheckMeshComp && CheckMeshComp->IsVisible())
             {
                 // TODO: May need to check if the mesh component are actually hook up with a mesh asset
@@ -506,8 +495,8 @@ void UNVObjectMaskMananger_VertexColor::ScanActors(UWorld* World, uint32& vert_c
 				//#miker: need to verify that it has an	annotationTagComp
 				// another bug that crashes the engine
 				// -> "NVCapturableActorTag")	UNVCapturableActorTag 
-				UNVCapturableActorTag* tag = Cast<UNVCapturableActorTag>(CheckActor->GetComponentByClass(UNVCapturableActorTag::StaticClass()));
-				if (tag)
+				const TSharedPtr<const FNVActorGeometryRecord> ActorGeometry = FNVActorGeometryCache::FindOrAddActorRecord(CheckActor, false);
+				if (ActorGeometry.IsValid() && ActorGeometry->Tag.IsValid())
 				{
 					//UE_LOG(LogNVSceneCapturer, Warning, TEXT("#miker: annotation tag"));
 					const uint32 ActorMaskId = GetMaskId(CheckActor);
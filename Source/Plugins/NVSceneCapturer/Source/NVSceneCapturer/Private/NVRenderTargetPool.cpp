@@ -0,0 +1,272 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVRenderTargetPool.h"
+#include "Engine/Engine.h"
+
+//======================================== FNVRenderTargetDesc ========================================
+FNVRenderTargetDesc::FNVRenderTargetDesc()
+    : FNVRenderTargetDesc(FIntPoint::ZeroValue, ETextureRenderTargetFormat::RTF_RGBA8)
+{
+}
+
+FNVRenderTargetDesc::FNVRenderTargetDesc(const FIntPoint& InSize, ETextureRenderTargetFormat InRenderTargetFormat,
+        EPixelFormat InOverrideFormat /*= EPixelFormat::PF_Unknown*/, float InTargetGamma /*= 0.f*/)
+    : Size(InSize),
+      RenderTargetFormat(InRenderTargetFormat),
+      OverrideFormat(InOverrideFormat),
+      TargetGamma(InTargetGamma)
+{
+}
+
+bool FNVRenderTargetDesc::IsValid() const
+{
+    return (Size.X > 0) && (Size.Y > 0);
+}
+
+bool FNVRenderTargetDesc::operator==(const FNVRenderTargetDesc& Other) const
+{
+    return (Size == Other.Size) &&
+           (RenderTargetFormat == Other.RenderTargetFormat) &&
+           (OverrideFormat == Other.OverrideFormat) &&
+           (TargetGamma == Other.TargetGamma);
+}
+
+uint32 GetTypeHash(const FNVRenderTargetDesc& Desc)
+{
+    uint32 Hash = GetTypeHash(Desc.Size);
+    Hash = HashCombine(Hash, GetTypeHash((uint8)Desc.RenderTargetFormat));
+    Hash = HashCombine(Hash, GetTypeHash((uint8)Desc.OverrideFormat));
+    Hash = HashCombine(Hash, GetTypeHash(Desc.TargetGamma));
+    return Hash;
+}
+
+//======================================== UNVRenderTargetPool ========================================
+UNVRenderTargetPool::UNVRenderTargetPool(const FObjectInitializer& ObjectInitializer)
+    : Super(ObjectInitializer)
+{
+    MaxIdleFrames = 30;
+}
+
+UTextureRenderTarget2D* UNVRenderTargetPool::AcquireRenderTarget(const FNVRenderTargetDesc& Desc)
+{
+    ensure(Desc.IsValid());
+    if (!Desc.IsValid())
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return nullptr;
+    }
+
+    for (FNVPooledRenderTarget& CheckPooledTarget : PooledRenderTargets)
+    {
+        if (!CheckPooledTarget.bIsLeased && CheckPooledTarget.RenderTarget && (CheckPooledTarget.Desc == Desc))
+        {
+            CheckPooledTarget.bIsLeased = true;
+            return CheckPooledTarget.RenderTarget;
+        }
+    }
+
+    UTextureRenderTarget2D* NewRenderTarget = CreateRenderTarget(Desc);
+    if (NewRenderTarget)
+    {
+        FNVPooledRenderTarget& NewPooledTarget = PooledRenderTargets[PooledRenderTargets.AddDefaulted()];
+        NewPooledTarget.RenderTarget = NewRenderTarget;
+        NewPooledTarget.Desc = Desc;
+        NewPooledTarget.bIsLeased = true;
+        NewPooledTarget.LastReleasedFrame = GFrameCounter;
+    }
+    return NewRenderTarget;
+}
+
+void UNVRenderTargetPool::ReleaseRenderTarget(UTextureRenderTarget2D* RenderTarget)
+{
+    ensure(RenderTarget);
+    if (!RenderTarget)
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return;
+    }
+
+    for (FNVPooledRenderTarget& CheckPooledTarget : PooledRenderTargets)
+    {
+        if (CheckPooledTarget.RenderTarget == RenderTarget)
+        {
+            ensure(CheckPooledTarget.bIsLeased);
+            CheckPooledTarget.bIsLeased = false;
+            CheckPooledTarget.LastReleasedFrame = GFrameCounter;
+            return;
+        }
+    }
+
+    UE_LOG(LogNVSceneCapturer, Warning, TEXT("Render target %s doesn't belong to the pool."), *RenderTarget->GetName());
+}
+
+void UNVRenderTargetPool::ReserveRenderTarget(const FNVRenderTargetDesc& Desc)
+{
+    ensure(Desc.IsValid());
+    if (!Desc.IsValid())
+    {
+        UE_LOG(LogNVSceneCapturer, Error, TEXT("invalid argument."));
+        return;
+    }
+
+    int32& ReservedCount = ReservedCounts.FindOrAdd(Desc);
+    ReservedCount++;
+
+    // Create the render target up front so the users don't need to wait for it when they start capturing
+    if (GetRenderTargetCount(Desc) == 0)
+    {
+        UTextureRenderTarget2D* NewRenderTarget = CreateRenderTarget(Desc);
+        if (!NewRenderTarget)
+        {
+            return;
+        }
+
+        FNVPooledRenderTarget& NewPooledTarget = PooledRenderTargets[PooledRenderTargets.AddDefaulted()];
+        NewPooledTarget.RenderTarget = NewRenderTarget;
+        NewPooledTarget.Desc = Desc;
+        NewPooledTarget.bIsLeased = false;
+        NewPooledTarget.LastReleasedFrame = GFrameCounter;
+    }
+}
+
+void UNVRenderTargetPool::UnreserveRenderTarget(const FNVRenderTargetDesc& Desc)
+{
+    int32* ReservedCountPtr = ReservedCounts.Find(Desc);
+    if (ReservedCountPtr)
+    {
+        (*ReservedCountPtr)--;
+        if (*ReservedCountPtr <= 0)
+        {
+            ReservedCounts.Remove(Desc);
+        }
+    }
+}
+
+void UNVRenderTargetPool::TrimUnusedRenderTargets()
+{
+    TMap<FNVRenderTargetDesc, int32> KeptCounts;
+    for (int32 i = PooledRenderTargets.Num() - 1; i >= 0; i--)
+    {
+        const FNVPooledRenderTarget& CheckPooledTarget = PooledRenderTargets[i];
+        if (!CheckPooledTarget.RenderTarget)
+        {
+            PooledRenderTargets.RemoveAtSwap(i);
+            continue;
+        }
+
+        const int32* ReservedCountPtr = ReservedCounts.Find(CheckPooledTarget.Desc);
+        const int32 ReservedCount = ReservedCountPtr ? *ReservedCountPtr : 0;
+        int32& KeptCount = KeptCounts.FindOrAdd(CheckPooledTarget.Desc);
+
+        const bool bIsIdle = !CheckPooledTarget.bIsLeased &&
+                             (GFrameCounter > CheckPooledTarget.LastReleasedFrame + (uint64)MaxIdleFrames);
+        if (bIsIdle && (KeptCount >= FMath::Min(ReservedCount, 1)))
+        {
+            ReleasePooledRenderTarget(i);
+        }
+        else
+        {
+            KeptCount++;
+        }
+    }
+}
+
+void UNVRenderTargetPool::Reset()
+{
+    for (int32 i = PooledRenderTargets.Num() - 1; i >= 0; i--)
+    {
+        if (!PooledRenderTargets[i].bIsLeased)
+        {
+            ReleasePooledRenderTarget(i);
+        }
+    }
+    ReservedCounts.Reset();
+}
+
+void UNVRenderTargetPool::SetMaxIdleFrames(int32 NewMaxIdleFrames)
+{
+    MaxIdleFrames = FMath::Max(0, NewMaxIdleFrames);
+}
+
+int32 UNVRenderTargetPool::GetRenderTargetCount() const
+{
+    return PooledRenderTargets.Num();
+}
+
+int32 UNVRenderTargetPool::GetLeasedRenderTargetCount() const
+{
+    int32 LeasedCount = 0;
+    for (const FNVPooledRenderTarget& CheckPooledTarget : PooledRenderTargets)
+    {
+        if (CheckPooledTarget.bIsLeased)
+        {
+            LeasedCount++;
+        }
+    }
+    return LeasedCount;
+}
+
+int32 UNVRenderTargetPool::GetRenderTargetCount(const FNVRenderTargetDesc& Desc) const
+{
+    int32 TargetCount = 0;
+    for (const FNVPooledRenderTarget& CheckPooledTarget : PooledRenderTargets)
+    {
+        if (CheckPooledTarget.RenderTarget && (CheckPooledTarget.Desc == Desc))
+        {
+            TargetCount++;
+        }
+    }
+    return TargetCount;
+}
+
+UTextureRenderTarget2D* UNVRenderTargetPool::CreateRenderTarget(const FNVRenderTargetDesc& Desc)
+{
+    // NOTE: Use the same settings as UNVSceneCaptureComponent2D::InitTextureRenderTarget
+    const FName RenderTargetName = MakeUniqueObjectName(this, UTextureRenderTarget2D::StaticClass(), TEXT("PooledSceneCaptureTextureTarget"));
+    UTextureRenderTarget2D* NewRenderTarget = NewObject<UTextureRenderTarget2D>(this, RenderTargetName);
+    ensure(NewRenderTarget);
+    if (NewRenderTarget)
+    {
+        NewRenderTarget->TargetGamma = (Desc.TargetGamma > 0.f) ? Desc.TargetGamma : (GEngine ? GEngine->GetDisplayGamma() : 0.f);
+        NewRenderTarget->bForceLinearGamma = false;
+        NewRenderTarget->SRGB = false;
+        NewRenderTarget->bAutoGenerateMips = false;
+        NewRenderTarget->bNeedsTwoCopies = true;
+        NewRenderTarget->bGPUSharedFlag = true;
+        if (Desc.OverrideFormat == EPixelFormat::PF_Unknown)
+        {
+            NewRenderTarget->RenderTargetFormat = Desc.RenderTargetFormat;
+        }
+        else
+        {
+            NewRenderTarget->OverrideFormat = Desc.OverrideFormat;
+        }
+
+        NewRenderTarget->InitAutoFormat(Desc.Size.X, Desc.Size.Y);
+        NewRenderTarget->ClearColor = FLinearColor::Black;
+
+        // NOTE: Don't wait for the rendering thread to initialize the new resource, the readers only take its RHI texture
+        // on the rendering thread (see FNVTextureReader::SetSourceRenderTarget)
+
+        UE_LOG(LogNVSceneCapturer, Log, TEXT("Created pooled render target %dx%d, %d render targets in the pool."),
+               Desc.Size.X, Desc.Size.Y, PooledRenderTargets.Num() + 1);
+    }
+    return NewRenderTarget;
+}
+
+void UNVRenderTargetPool::ReleasePooledRenderTarget(int32 PooledIndex)
+{
+    UTextureRenderTarget2D* ReleasedRenderTarget = PooledRenderTargets[PooledIndex].RenderTarget;
+    PooledRenderTargets.RemoveAtSwap(PooledIndex);
+
+    // Free the GPU memory right away instead of waiting for the garbage collector
+    if (ReleasedRenderTarget)
+    {
+        ReleasedRenderTarget->ReleaseResource();
+    }
+}
@@ -6,6 +6,7 @@
 
 #include "NVSceneCapturerModule.h"
 #include "NVSceneCaptureComponent2D.h"
+#include "NVSceneCaptureViewExtension.h"
 
 #include "NVSceneManager.h"
 #include "Engine/TextureRenderTarget2D.h"
@@ -25,19 +26,49 @@ UNVSceneCaptureComponent2D::UNVSceneCaptureComponent2D(const FObjectInitializer&
 
     TextureTargetFormat = ETextureRenderTargetFormat::RTF_RGBA8;
     OverrideTexturePixelFormat = EPixelFormat::PF_Unknown;
+    ReadbackPixelFormat = ENVCapturedPixelFormat::NVCapturedPixelFormat_MAX;
     bIgnoreReadbackAlpha = false;
+    ReadbackTextureCount = 3;
+    ReadbackFrameLatency = 2;
+    TextureTargetGamma = 0.f;
+    RenderTargetPool = nullptr;
+    bUsePooledTextureTarget = false;
 }
 
 void UNVSceneCaptureComponent2D::BeginPlay()
 {
     Super::BeginPlay();
 
-    InitTextureRenderTarget();
+    bUsePooledTextureTarget = (RenderTargetPool && !TextureTarget);
+    if (bUsePooledTextureTarget)
+    {
+        // NOTE: The render target is only leased while capturing, see AcquirePooledTextureTarget
+        ReservedTextureTargetDesc = GetTextureTargetDesc();
+        RenderTargetPool->ReserveRenderTarget(ReservedTextureTargetDesc);
+    }
+    else
+    {
+        InitTextureRenderTarget();
+    }
     RenderTargetReader.SetTextureRenderTarget(TextureTarget);
+    RenderTargetReader.SetReadbackSettings(ReadbackTextureCount, ReadbackFrameLatency);
 }
 
 void UNVSceneCaptureComponent2D::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+    // Make sure all the pixels captured are delivered before the component goes away
+    FlushPendingReadbacks();
+
+    if (bUsePooledTextureTarget)
+    {
+        ReleasePooledTextureTarget();
+        if (RenderTargetPool)
+        {
+            RenderTargetPool->UnreserveRenderTarget(ReservedTextureTargetDesc);
+        }
+        bUsePooledTextureTarget = false;
+    }
+
     Super::EndPlay(EndPlayReason);
 }
 
@@ -46,6 +77,9 @@ void UNVSceneCaptureComponent2D::TickComponent(float DeltaTime, enum ELevelTick
     // NOTE: We don't call the Super function so we can override the conditions to whether we should capture this frame or not
     USceneCaptureComponent::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
+    // Deliver the pixels of the previous captures which the GPU finished copying
+    ProcessPendingReadbacks();
+
     if (ShouldCaptureCurrentFrame())
     {
         CaptureSceneDeferred();
@@ -81,38 +115,57 @@ void UNVSceneCaptureComponent2D::InitTextureRenderTarget()
     if (!TextureTarget)
     {
         // Automatically create a new texture if there's no valid TextureTarget specified
-        const FName TextureTargetName = MakeUniqueObjectName(this, UTextureRenderTarget2D::StaticClass(), TEXT("SceneCaptureTextureTarget"));
-        TextureTarget = NewObject<UTextureRenderTarget2D>(this, TextureTargetName);
-        ensure(TextureTarget);
-        if (TextureTarget)
-        {
-            TextureTarget->TargetGamma = GEngine ? GEngine->GetDisplayGamma() : 0.f;
-            TextureTarget->bForceLinearGamma = false;
-            TextureTarget->SRGB = false;
-            TextureTarget->bAutoGenerateMips = false;
-            TextureTarget->bNeedsTwoCopies = true;
-            TextureTarget->bGPUSharedFlag = true;
-            if (OverrideTexturePixelFormat == EPixelFormat::PF_Unknown)
-            {
-                TextureTarget->RenderTargetFormat = TextureTargetFormat;
-            }
-            else
-            {
-                TextureTarget->OverrideFormat = OverrideTexturePixelFormat;
-            }
+        TextureTarget = CreateTextureRenderTarget(TEXT("SceneCaptureTextureTarget"), TextureTargetFormat, OverrideTexturePixelFormat, TextureTargetGamma);
 
-            TextureTarget->InitAutoFormat(TextureTargetSize.Width, TextureTargetSize.Height);
-            TextureTarget->ClearColor = FLinearColor::Black;
+        // TODO: May need to keep 2 different pixel formats for the captured texture in the memory and the exported image on disk
+        //ExportPixelFormat = TextureTarget->GetFormat();
+    }
+}
 
-            // TODO: May need to keep 2 different pixel formats for the captured texture in the memory and the exported image on disk
-            //ExportPixelFormat = TextureTarget->GetFormat();
+UTextureRenderTarget2D* UNVSceneCaptureComponent2D::CreateTextureRenderTarget(const FString& BaseName, ETextureRenderTargetFormat RenderTargetFormat,
+        EPixelFormat OverridePixelFormat, float Gamma)
+{
+    const FName NewTextureTargetName = MakeUniqueObjectName(this, UTextureRenderTarget2D::StaticClass(), *BaseName);
+    UTextureRenderTarget2D* NewTextureTarget = NewObject<UTextureRenderTarget2D>(this, NewTextureTargetName);
+    ensure(NewTextureTarget);
+    if (NewTextureTarget)
+    {
+        NewTextureTarget->TargetGamma = (Gamma > 0.f) ? Gamma : (GEngine ? GEngine->GetDisplayGamma() : 0.f);
+        NewTextureTarget->bForceLinearGamma = false;
+        NewTextureTarget->SRGB = false;
+        NewTextureTarget->bAutoGenerateMips = false;
+        NewTextureTarget->bNeedsTwoCopies = true;
+        NewTextureTarget->bGPUSharedFlag = true;
+        if (OverridePixelFormat == EPixelFormat::PF_Unknown)
+        {
+            NewTextureTarget->RenderTargetFormat = RenderTargetFormat;
         }
+        else
+        {
+            NewTextureTarget->OverrideFormat = OverridePixelFormat;
+        }
+
+        NewTextureTarget->InitAutoFormat(TextureTargetSize.Width, TextureTargetSize.Height);
+        NewTextureTarget->ClearColor = FLinearColor::Black;
     }
+    return NewTextureTarget;
 }
 
 void UNVSceneCaptureComponent2D::UpdateSceneCaptureContents(FSceneInterface* Scene)
 {
+    // NOTE: The deferred captures are updated one component after another, the render target is only leased
+    // until the pixels copy commands of this capture are issued so the next component can capture to it
+    AcquirePooledTextureTarget();
+
+    // NOTE: The outputs are resolved by the view extension while the render commands issued by the Super function are executed
+    const bool bResolveCaptureOutputs = BeginResolveCaptureOutputs();
+
     Super::UpdateSceneCaptureContents(Scene);
+
+    if (bResolveCaptureOutputs)
+    {
+        CaptureOutputsViewExtension->EndResolveOutputs();
+    }
 	//#miker: at this point we now have the various images that are intended
 	// for composition with the real-world base image.
 	// ssr, ssm
@@ -236,11 +289,6 @@ void UNVSceneCaptureComponent2D::CaptureSceneToTexture()
     CaptureSceneDeferred();
 }
 
-bool UNVSceneCaptureComponent2D::ReadPixelsDataFromTexture(FNVTexturePixelData& OutPixelsData)
-{
-    return RenderTargetReader.ReadPixelsData(OutPixelsData);
-}
-
 void UNVSceneCaptureComponent2D::ReadPixelsDataFromTexture(OnFinishedCaptureScenePixelsDataCallback Callback)
 {
     ensure(Callback);
@@ -273,21 +321,228 @@ void UNVSceneCaptureComponent2D::OnSceneCaptured()
     if (ShouldReadbackPixelsData())
     {
         // NOTE: Need to check the case where we want to capture the render target but doesn't want to read back the pixels
+        ReadPixelsData(RenderTargetReader, ReadbackPixelFormat, ReadbackCallbackList);
+    }
 
-        RenderTargetReader.ReadPixelsData(
-            [this, TempCallbackList=ReadbackCallbackList](const FNVTexturePixelData& CapturedPixelData)
+    for (FNVSceneCaptureOutputData& CaptureOutput : CaptureOutputs)
+    {
+        if ((CaptureOutput.ReadbackCallbackList.Num() > 0) && CaptureOutput.RenderTargetReader.IsValid())
         {
-            // Trigger all the waiting callback, pass the captured pixel data and its context data to it
-            for (auto WaitingCallback : TempCallbackList)
+            ReadPixelsData(*CaptureOutput.RenderTargetReader, CaptureOutput.ReadbackPixelFormat, CaptureOutput.ReadbackCallbackList);
+        }
+    }
+
+    // The pixels copy commands are already issued so another component can capture to the render target now,
+    // the render thread always copies the pixels before the next capture is rendered to it
+    ReleasePooledTextureTarget();
+}
+
+void UNVSceneCaptureComponent2D::ReadPixelsData(FNVTextureRenderTargetReader& Reader, ENVCapturedPixelFormat PixelFormat,
+        TArray<OnFinishedCaptureScenePixelsDataCallback>& CallbackList)
+{
+    Reader.SetReadbackPixelFormat(PixelFormat);
+
+    // NOTE: Move the waiting callbacks to the render command instead of copying them
+    auto ReadbackCallback = [TempCallbackList = MoveTemp(CallbackList)](const FNVTexturePixelDataRef& CapturedPixelData)
+    {
+        // Trigger all the waiting callback, pass the captured pixel data and its context data to it
+        for (const auto& WaitingCallback : TempCallbackList)
+        {
+            if (WaitingCallback)
             {
-                if (WaitingCallback)
-                {
-                    WaitingCallback(CapturedPixelData);
-                }
+                WaitingCallback(CapturedPixelData);
             }
-        }, bIgnoreReadbackAlpha);
+        }
+    };
+
+    // NOTE: The batched readbacks are only copied after the viewpoint's last capture, the pooled render target
+    // must be copied right away before it's returned to the pool
+    if (ReadbackRequestHandler && !bUsePooledTextureTarget)
+    {
+        FNVTextureReadbackRequest ReadbackRequest;
+        if (Reader.BuildReadbackRequest(ReadbackCallback, bIgnoreReadbackAlpha, ReadbackRequest))
+        {
+            ReadbackRequestHandler(ReadbackRequest);
+        }
+    }
+    else
+    {
+        Reader.ReadPixelsData(ReadbackCallback, bIgnoreReadbackAlpha);
+    }
+
+    CallbackList.Reset();
+}
+
+int32 UNVSceneCaptureComponent2D::AddCaptureOutput(ENVSceneCaptureOutput Output, ENVCapturedPixelFormat PixelFormat, float OutputScale /*= 1.f*/)
+{
+    ensure(Output != ENVSceneCaptureOutput::NVSceneCaptureOutput_MAX);
+    if (Output == ENVSceneCaptureOutput::NVSceneCaptureOutput_MAX)
+    {
+        UE_LOG(LogNVSceneCapturerComponent2D, Error, TEXT("invalid argument."));
+        return INDEX_NONE;
+    }
+
+    FNVSceneCaptureOutputData NewCaptureOutput;
+    NewCaptureOutput.Output = Output;
+    NewCaptureOutput.OutputScale = OutputScale;
+    // The velocity doesn't fit any captured pixel format, read it back as is
+    const bool bIsVelocity = (Output == ENVSceneCaptureOutput::Velocity);
+    NewCaptureOutput.ReadbackPixelFormat = bIsVelocity ? ENVCapturedPixelFormat::NVCapturedPixelFormat_MAX : PixelFormat;
+    const ETextureRenderTargetFormat OutputRenderTargetFormat = bIsVelocity ? ETextureRenderTargetFormat::RTF_RG32f
+                                                                           : ConvertCapturedFormatToRenderTargetFormat(PixelFormat);
+    // NOTE: The resolved values are linear, they must not be gamma corrected
+    NewCaptureOutput.RenderTarget = CreateTextureRenderTarget(TEXT("SceneCaptureOutputTarget"), OutputRenderTargetFormat, EPixelFormat::PF_Unknown, 1.f);
+    if (!NewCaptureOutput.RenderTarget)
+    {
+        return INDEX_NONE;
+    }
 
-        ReadbackCallbackList.Reset();
+    NewCaptureOutput.RenderTargetReader = MakeShareable(new FNVTextureRenderTargetReader());
+    NewCaptureOutput.RenderTargetReader->SetTextureRenderTarget(NewCaptureOutput.RenderTarget);
+    NewCaptureOutput.RenderTargetReader->SetReadbackSettings(ReadbackTextureCount, ReadbackFrameLatency);
+
+    if (!CaptureOutputsViewExtension.IsValid())
+    {
+        CaptureOutputsViewExtension = FSceneViewExtensions::NewExtension<FNVSceneCaptureViewExtension>();
+        SceneViewExtensions.Add(CaptureOutputsViewExtension);
+    }
+
+    return CaptureOutputs.Add(NewCaptureOutput);
+}
+
+void UNVSceneCaptureComponent2D::SetCaptureOutputScale(int32 OutputIndex, float NewOutputScale)
+{
+    ensure(CaptureOutputs.IsValidIndex(OutputIndex));
+    if (!CaptureOutputs.IsValidIndex(OutputIndex))
+    {
+        UE_LOG(LogNVSceneCapturerComponent2D, Error, TEXT("invalid argument."));
+    }
+    else
+    {
+        CaptureOutputs[OutputIndex].OutputScale = NewOutputScale;
+    }
+}
+
+void UNVSceneCaptureComponent2D::CaptureOutputToPixelsData(int32 OutputIndex, UNVSceneCaptureComponent2D::OnFinishedCaptureScenePixelsDataCallback Callback)
+{
+    ensure(Callback);
+    ensure(CaptureOutputs.IsValidIndex(OutputIndex));
+    if (!Callback || !CaptureOutputs.IsValidIndex(OutputIndex))
+    {
+        UE_LOG(LogNVSceneCapturerComponent2D, Error, TEXT("invalid argument."));
+    }
+    else
+    {
+        CaptureSceneDeferred();
+        CaptureOutputs[OutputIndex].ReadbackCallbackList.Add(Callback);
+    }
+}
+
+UTextureRenderTarget2D* UNVSceneCaptureComponent2D::GetCaptureOutputRenderTarget(int32 OutputIndex) const
+{
+    return CaptureOutputs.IsValidIndex(OutputIndex) ? CaptureOutputs[OutputIndex].RenderTarget : nullptr;
+}
+
+int32 UNVSceneCaptureComponent2D::GetCaptureOutputCount() const
+{
+    return CaptureOutputs.Num();
+}
+
+bool UNVSceneCaptureComponent2D::BeginResolveCaptureOutputs()
+{
+    TArray<FNVSceneCaptureOutputTarget> OutputTargets;
+    for (const FNVSceneCaptureOutputData& CaptureOutput : CaptureOutputs)
+    {
+        // Only resolve the outputs which are going to be read back this frame
+        if ((CaptureOutput.ReadbackCallbackList.Num() > 0) && CaptureOutput.RenderTarget)
+        {
+            FNVSceneCaptureOutputTarget& NewOutputTarget = OutputTargets[OutputTargets.AddDefaulted()];
+            NewOutputTarget.Output = CaptureOutput.Output;
+            NewOutputTarget.RenderTargetResource = CaptureOutput.RenderTarget->GameThread_GetRenderTargetResource();
+            NewOutputTarget.OutputScale = CaptureOutput.OutputScale;
+        }
+    }
+
+    const bool bHasOutputTargets = CaptureOutputsViewExtension.IsValid() && (OutputTargets.Num() > 0);
+    if (bHasOutputTargets)
+    {
+        CaptureOutputsViewExtension->BeginResolveOutputs(OutputTargets);
+    }
+    return bHasOutputTargets;
+}
+
+void UNVSceneCaptureComponent2D::ProcessPendingReadbacks()
+{
+    if (RenderTargetReader.GetPendingReadbackCount() > 0)
+    {
+        RenderTargetReader.ProcessPendingReadbacks();
+    }
+    for (FNVSceneCaptureOutputData& CaptureOutput : CaptureOutputs)
+    {
+        if (CaptureOutput.RenderTargetReader.IsValid() && (CaptureOutput.RenderTargetReader->GetPendingReadbackCount() > 0))
+        {
+            CaptureOutput.RenderTargetReader->ProcessPendingReadbacks();
+        }
+    }
+}
+
+void UNVSceneCaptureComponent2D::FlushPendingReadbacks()
+{
+    if (RenderTargetReader.GetPendingReadbackCount() > 0)
+    {
+        RenderTargetReader.FlushPendingReadbacks(true);
+    }
+    for (FNVSceneCaptureOutputData& CaptureOutput : CaptureOutputs)
+    {
+        if (CaptureOutput.RenderTargetReader.IsValid() && (CaptureOutput.RenderTargetReader->GetPendingReadbackCount() > 0))
+        {
+            CaptureOutput.RenderTargetReader->FlushPendingReadbacks(true);
+        }
+    }
+}
+
+void UNVSceneCaptureComponent2D::SetReadbackRequestHandler(FNVTextureReader::OnReadbackRequestedCallback NewHandler)
+{
+    ReadbackRequestHandler = NewHandler;
+}
+
+void UNVSceneCaptureComponent2D::SetRenderTargetPool(UNVRenderTargetPool* NewRenderTargetPool)
+{
+    ensure(!HasBegunPlay());
+    RenderTargetPool = NewRenderTargetPool;
+}
+
+FNVRenderTargetDesc UNVSceneCaptureComponent2D::GetTextureTargetDesc() const
+{
+    return FNVRenderTargetDesc(FIntPoint(TextureTargetSize.Width, TextureTargetSize.Height),
+                               TextureTargetFormat, OverrideTexturePixelFormat, TextureTargetGamma);
+}
+
+void UNVSceneCaptureComponent2D::AcquirePooledTextureTarget()
+{
+    if (bUsePooledTextureTarget && RenderTargetPool && !TextureTarget)
+    {
+        // Reserve the new settings' render target if the component's settings changed since the last capture
+        const FNVRenderTargetDesc TextureTargetDesc = GetTextureTargetDesc();
+        if (TextureTargetDesc != ReservedTextureTargetDesc)
+        {
+            RenderTargetPool->UnreserveRenderTarget(ReservedTextureTargetDesc);
+            ReservedTextureTargetDesc = TextureTargetDesc;
+            RenderTargetPool->ReserveRenderTarget(ReservedTextureTargetDesc);
+        }
+
+        TextureTarget = RenderTargetPool->AcquireRenderTarget(TextureTargetDesc);
+        RenderTargetReader.SetTextureRenderTarget(TextureTarget);
+    }
+}
+
+void UNVSceneCaptureComponent2D::ReleasePooledTextureTarget()
+{
+    if (bUsePooledTextureTarget && RenderTargetPool && TextureTarget)
+    {
+        RenderTargetPool->ReleaseRenderTarget(TextureTarget);
+        TextureTarget = nullptr;
+        RenderTargetReader.SetTextureRenderTarget(nullptr);
     }
 }
 
@@ -299,6 +554,11 @@ void UNVSceneCaptureComponent2D::StartCapturing()
 void UNVSceneCaptureComponent2D::StopCapturing()
 {
     bCaptureEveryFrame = false;
+
+    // Don't leave the last captured frames waiting in the readback ring
+    FlushPendingReadbacks();
+
+    ReleasePooledTextureTarget();
 }
 
 bool UNVSceneCaptureComponent2D::ShouldCaptureCurrentFrame() const
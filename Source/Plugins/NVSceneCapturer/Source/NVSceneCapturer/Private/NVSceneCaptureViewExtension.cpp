@@ -0,0 +1,195 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVSceneCaptureViewExtension.h"
+#include "RHIStaticStates.h"
+#include "Shader.h"
+#include "GlobalShader.h"
+#include "ScreenRendering.h"
+#include "PipelineStateCache.h"
+#include "RenderingThread.h"
+#include "RendererInterface.h"
+#include "SceneView.h"
+#include "SceneRenderTargetParameters.h"
+#include "ShaderParameterUtils.h"
+#include "TextureResource.h"
+
+//======================= TNVResolveSceneOutputPS =======================//
+/// Pixel shader which resolve a buffer of the rendered scene to an output render target, see NVSceneCaptureOutputs.usf
+template<ENVSceneCaptureOutput OutputType>
+class TNVResolveSceneOutputPS : public FGlobalShader
+{
+    DECLARE_SHADER_TYPE(TNVResolveSceneOutputPS, Global);
+
+public:
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM4);
+    }
+
+    TNVResolveSceneOutputPS() {}
+
+    TNVResolveSceneOutputPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer) : FGlobalShader(Initializer)
+    {
+        SceneTextureParameters.Bind(Initializer);
+        OutputScale.Bind(Initializer.ParameterMap, TEXT("OutputScale"));
+        ViewRectMin.Bind(Initializer.ParameterMap, TEXT("ViewRectMin"));
+    }
+
+    void SetParameters(FRHICommandList& RHICmdList, const FSceneView& View, float InOutputScale)
+    {
+        const FPixelShaderRHIParamRef ShaderRHI = GetPixelShader();
+        FGlobalShader::SetParameters<FViewUniformShaderParameters>(RHICmdList, ShaderRHI, View.ViewUniformBuffer);
+        SceneTextureParameters.Set(RHICmdList, ShaderRHI, View.GetFeatureLevel(), ESceneTextureSetupMode::All);
+        SetShaderValue(RHICmdList, ShaderRHI, OutputScale, InOutputScale);
+        SetShaderValue(RHICmdList, ShaderRHI, ViewRectMin, FVector2D(View.ViewRect.Min));
+    }
+
+    virtual bool Serialize(FArchive& Ar) override
+    {
+        const bool bShaderHasOutdatedParameters = FGlobalShader::Serialize(Ar);
+        Ar << SceneTextureParameters;
+        Ar << OutputScale;
+        Ar << ViewRectMin;
+        return bShaderHasOutdatedParameters;
+    }
+
+private:
+    FSceneTextureShaderParameters SceneTextureParameters;
+    FShaderParameter OutputScale;
+    FShaderParameter ViewRectMin;
+};
+
+typedef TNVResolveSceneOutputPS<ENVSceneCaptureOutput::SceneDepth> FNVResolveSceneDepthPS;
+typedef TNVResolveSceneOutputPS<ENVSceneCaptureOutput::CustomStencil> FNVResolveCustomStencilPS;
+typedef TNVResolveSceneOutputPS<ENVSceneCaptureOutput::Velocity> FNVResolveVelocityPS;
+
+IMPLEMENT_SHADER_TYPE(template<>, FNVResolveSceneDepthPS, TEXT("/Plugin/NVSceneCapturer/Private/NVSceneCaptureOutputs.usf"), TEXT("ResolveSceneDepthPS"), SF_Pixel);
+IMPLEMENT_SHADER_TYPE(template<>, FNVResolveCustomStencilPS, TEXT("/Plugin/NVSceneCapturer/Private/NVSceneCaptureOutputs.usf"), TEXT("ResolveCustomStencilPS"), SF_Pixel);
+IMPLEMENT_SHADER_TYPE(template<>, FNVResolveVelocityPS, TEXT("/Plugin/NVSceneCapturer/Private/NVSceneCaptureOutputs.usf"), TEXT("ResolveVelocityPS"), SF_Pixel);
+
+template<typename ShaderType>
+static void DrawSceneOutput(FRHICommandListImmediate& RHICmdList, const FSceneView& View, float OutputScale, const FIntPoint& TargetSize)
+{
+    static const FName RendererModuleName("Renderer");
+    IRendererModule& RendererModule = FModuleManager::GetModuleChecked<IRendererModule>(RendererModuleName);
+
+    FGraphicsPipelineStateInitializer GraphicsPSOInit;
+    RHICmdList.ApplyCachedRenderTargets(GraphicsPSOInit);
+    GraphicsPSOInit.BlendState = TStaticBlendState<>::GetRHI();
+    GraphicsPSOInit.RasterizerState = TStaticRasterizerState<>::GetRHI();
+    GraphicsPSOInit.DepthStencilState = TStaticDepthStencilState<false, CF_Always>::GetRHI();
+
+    TShaderMap<FGlobalShaderType>* ShaderMap = GetGlobalShaderMap(View.GetFeatureLevel());
+    TShaderMapRef<FScreenVS> VertexShader(ShaderMap);
+    TShaderMapRef<ShaderType> PixelShader(ShaderMap);
+
+    GraphicsPSOInit.BoundShaderState.VertexDeclarationRHI = RendererModule.GetFilterVertexDeclaration().VertexDeclarationRHI;
+    GraphicsPSOInit.BoundShaderState.VertexShaderRHI = GETSAFERHISHADER_VERTEX(*VertexShader);
+    GraphicsPSOInit.BoundShaderState.PixelShaderRHI = GETSAFERHISHADER_PIXEL(*PixelShader);
+    GraphicsPSOInit.PrimitiveType = PT_TriangleList;
+    SetGraphicsPipelineState(RHICmdList, GraphicsPSOInit);
+
+    PixelShader->SetParameters(RHICmdList, View, OutputScale);
+
+    // NOTE: The pixel shader read the scene textures by pixel position so the UVs don't matter
+    RendererModule.DrawRectangle(
+        RHICmdList,
+        0, 0,
+        TargetSize.X, TargetSize.Y,
+        0, 0,
+        1, 1,
+        TargetSize,
+        FIntPoint(1, 1),
+        *VertexShader,
+        EDRF_Default);
+}
+
+//======================= FNVSceneCaptureOutputTarget =======================//
+FNVSceneCaptureOutputTarget::FNVSceneCaptureOutputTarget()
+{
+    Output = ENVSceneCaptureOutput::SceneDepth;
+    RenderTargetResource = nullptr;
+    OutputScale = 1.f;
+}
+
+//======================= FNVSceneCaptureViewExtension =======================//
+FNVSceneCaptureViewExtension::FNVSceneCaptureViewExtension(const FAutoRegister& AutoRegister)
+    : FSceneViewExtensionBase(AutoRegister)
+{
+}
+
+void FNVSceneCaptureViewExtension::BeginResolveOutputs(const TArray<FNVSceneCaptureOutputTarget>& OutputTargets)
+{
+    check(IsInGameThread());
+
+    TSharedPtr<FNVSceneCaptureViewExtension, ESPMode::ThreadSafe> ViewExtension = StaticCastSharedRef<FNVSceneCaptureViewExtension>(AsShared());
+    ENQUEUE_UNIQUE_RENDER_COMMAND_TWOPARAMETER(
+        BeginResolveSceneCaptureOutputs,
+        TSharedPtr<FNVSceneCaptureViewExtension, ESPMode::ThreadSafe>, InViewExtension, ViewExtension,
+        TArray<FNVSceneCaptureOutputTarget>, InOutputTargets, OutputTargets,
+    {
+        InViewExtension->ActiveOutputTargets_RenderThread = InOutputTargets;
+    });
+}
+
+void FNVSceneCaptureViewExtension::EndResolveOutputs()
+{
+    check(IsInGameThread());
+
+    TSharedPtr<FNVSceneCaptureViewExtension, ESPMode::ThreadSafe> ViewExtension = StaticCastSharedRef<FNVSceneCaptureViewExtension>(AsShared());
+    ENQUEUE_UNIQUE_RENDER_COMMAND_ONEPARAMETER(
+        EndResolveSceneCaptureOutputs,
+        TSharedPtr<FNVSceneCaptureViewExtension, ESPMode::ThreadSafe>, InViewExtension, ViewExtension,
+    {
+        InViewExtension->ActiveOutputTargets_RenderThread.Reset();
+    });
+}
+
+void FNVSceneCaptureViewExtension::PostRenderBasePass_RenderThread(FRHICommandListImmediate& RHICmdList, FSceneView& InView)
+{
+    // NOTE: The outputs are only active while the owner scene capture component's render commands are executed,
+    // the other views (e.g: the game viewport) are skipped
+    for (const FNVSceneCaptureOutputTarget& OutputTarget : ActiveOutputTargets_RenderThread)
+    {
+        ResolveOutput_RenderThread(RHICmdList, InView, OutputTarget);
+    }
+}
+
+void FNVSceneCaptureViewExtension::ResolveOutput_RenderThread(FRHICommandListImmediate& RHICmdList, const FSceneView& View, const FNVSceneCaptureOutputTarget& OutputTarget)
+{
+    check(IsInRenderingThread());
+
+    FTextureRenderTargetResource* RenderTargetResource = OutputTarget.RenderTargetResource;
+    const FTexture2DRHIRef& RenderTargetTexture = RenderTargetResource ? RenderTargetResource->GetRenderTargetTexture() : FTexture2DRHIRef();
+    if (!RenderTargetTexture)
+    {
+        return;
+    }
+
+    const FIntPoint TargetSize = RenderTargetTexture->GetSizeXY();
+    SetRenderTarget(RHICmdList, RenderTargetTexture, FTextureRHIRef());
+    RHICmdList.SetViewport(0, 0, 0.0f, TargetSize.X, TargetSize.Y, 1.0f);
+
+    switch (OutputTarget.Output)
+    {
+        case ENVSceneCaptureOutput::SceneDepth:
+            DrawSceneOutput<FNVResolveSceneDepthPS>(RHICmdList, View, OutputTarget.OutputScale, TargetSize);
+            break;
+        case ENVSceneCaptureOutput::CustomStencil:
+            DrawSceneOutput<FNVResolveCustomStencilPS>(RHICmdList, View, OutputTarget.OutputScale, TargetSize);
+            break;
+        case ENVSceneCaptureOutput::Velocity:
+            DrawSceneOutput<FNVResolveVelocityPS>(RHICmdList, View, OutputTarget.OutputScale, TargetSize);
+            break;
+        default:
+            break;
+    }
+
+    // Update the render target's shader resource too so it can be shown, e.g: by the scene data visualizer
+    RHICmdList.CopyToResolveTarget(RenderTargetTexture, RenderTargetResource->TextureRHI, FResolveParams());
+}
@@ -27,6 +27,8 @@
 
 const float MAX_StartCapturingDuration = 5.0f; // max duration to wait for ANVSceneCapturerActor::StartCapturing to successfully begin capturing before emitting warning messages
 
+//======================= ANVSceneCapturerActor =======================//
+
 ANVSceneCapturerActor::ANVSceneCapturerActor(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
     CollisionComponent = CreateDefaultSubobject<USphereComponent>(TEXT("Root"));
@@ -47,6 +49,10 @@ ANVSceneCapturerActor::ANVSceneCapturerActor(const FObjectInitializer& ObjectIni
     CurrentState = ENVSceneCapturerState::Active;
     bAutoStartCapturing = false;
     bPauseGameLogicWhenFlushing = true;
+    MaxInFlightFrames = 3;
+    bPoolRenderTargets = false;
+    MaxIdleFramesOfPooledRenderTarget = 30;
+    RenderTargetPool = nullptr;
 
     MaxNumberOfFramesToCapture = 0;
     NumberOfFramesToCapture = MaxNumberOfFramesToCapture;
@@ -76,10 +82,18 @@ void ANVSceneCapturerActor::Tick(float DeltaTime)
 {
     Super::Tick(DeltaTime);
 
+	// Free the pipeline slots of the frames handled since the last tick before deciding to capture a new one
+	RetireCapturedFrames();
+
 	StartCapturing();
 
 	CheckCaptureScene();
 
+	if (RenderTargetPool)
+	{
+		RenderTargetPool->TrimUnusedRenderTargets();
+	}
+
 }
 
 void ANVSceneCapturerActor::UpdateSettingsFromCommandLine()
@@ -171,6 +185,13 @@ void ANVSceneCapturerActor::BeginPlay()
 
 	UpdateViewpointList();
 
+	// NOTE: The pool must exist before the feature extractors create their scene capture components
+	if (bPoolRenderTargets)
+	{
+		RenderTargetPool = NewObject<UNVRenderTargetPool>(this, TEXT("RenderTargetPool"));
+		RenderTargetPool->SetMaxIdleFrames(MaxIdleFramesOfPooledRenderTarget);
+	}
+
 	// Create the feature extractors for each viewpoint
 	for (UNVSceneCapturerViewpointComponent* CheckViewpointComp : ViewpointList)
 	{
@@ -229,6 +250,13 @@ void ANVSceneCapturerActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
     GetWorldTimerManager().ClearTimer(TimeHandle_StartCapturingDelay);
 
     Super::EndPlay(EndPlayReason);
+
+    // NOTE: The scene capture components already returned their render targets when they ended play
+    if (RenderTargetPool)
+    {
+        RenderTargetPool->Reset();
+        RenderTargetPool = nullptr;
+    }
 }
 
 void ANVSceneCapturerActor::PostInitializeComponents()
@@ -308,7 +336,13 @@ void ANVSceneCapturerActor::CheckCaptureScene()
 
     if (bNeedToExportScene && bSceneIsReady )
     {
-        if (CanHandleMoreSceneData())
+        if (!CanCaptureMoreFrames())
+        {
+            // NOTE: Too many frames are still being read back, wait for the oldest one to be handled.
+            // The scene keep being simulated so the game doesn't need to be paused, bNeedToExportScene stay set so
+            // the scene is captured as soon as a frame is retired.
+        }
+        else if (CanHandleMoreSceneData())
         {
             // Must unpause the game in this frame first before resuming capturing it
             if (CurrentGameMode && CurrentGameMode->IsPaused())
@@ -357,12 +391,26 @@ void ANVSceneCapturerActor::CaptureSceneToPixelsData()
     // Let all the child exporter components know it need to export the scene
     if (!bFinishedCapturing)
     {		
+        // Snapshot the state of the scene for this frame, the capture callbacks hold it until the frame's data are handled
+        // so the settings can be randomized for the next frame while this one is still being read back
+        TSharedPtr<FNVCapturedFrameInfo, ESPMode::ThreadSafe> NewFrameInfo = MakeShareable(new FNVCapturedFrameInfo());
+        NewFrameInfo->FrameId = CurrentFrameIndex;
+        NewFrameInfo->FrameIndexForFile = FrameIndexForFile;
+        NewFrameInfo->PicksetIndex = FramePicksetForFile;
+        NewFrameInfo->PicksetSubImage = PicksetSubImage;
+        NewFrameInfo->EngineFrameNumber = GFrameCounter;
+        NewFrameInfo->CaptureTimestamp = CurrentTime;
+        NewFrameInfo->FOVAngle = CapturerSettings.FOVAngle;
+        NewFrameInfo->CapturedImageSize = CapturerSettings.CapturedImageSize;
+        const FNVCapturedFrameInfoPtr FrameInfo = NewFrameInfo;
+        InFlightFrames.Add(FrameInfo);
+
         for (UNVSceneCapturerViewpointComponent* ViewpointComp : ViewpointList)
         {
             if (ViewpointComp && ViewpointComp->IsEnabled())
             {
 			    ViewpointComp->CaptureSceneToPixelsData(
-                    [this, FrameIndexForFile,FramePicksetForFile,PicksetSubImage](const FNVTexturePixelData& CapturedPixelData, 
+                    [this, FrameInfo](const FNVTexturePixelDataRef& CapturedPixelData, 
 						UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor, 
 						UNVSceneCapturerViewpointComponent* CapturedViewpoint)
                 {
@@ -374,7 +422,7 @@ void ANVSceneCapturerActor::CaptureSceneToPixelsData()
 							SceneDataHandler->HandleScenePixelsData(CapturedPixelData,
 								CapturedFeatureExtractor,
 								CapturedViewpoint,
-								FrameIndexForFile, FramePicksetForFile,PicksetSubImage);
+								*FrameInfo);
 						}						
                     }
 					
@@ -386,14 +434,14 @@ void ANVSceneCapturerActor::CaptureSceneToPixelsData()
 							SceneDataVisualizer->HandleScenePixelsData(CapturedPixelData,
 								CapturedFeatureExtractor,
 								CapturedViewpoint,
-								FrameIndexForFile, FramePicksetForFile,PicksetSubImage);
+								*FrameInfo);
 						}
                     }
                 });
 
                 ViewpointComp->CaptureSceneAnnotationData(
-                    [this, FrameIndexForFile, FramePicksetForFile, PicksetSubImage]
-						(const TSharedPtr<FJsonObject>& CapturedData,
+                    [this, FrameInfo]
+						(const FNVSceneAnnotationData& CapturedData,
 							UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor,
 							UNVSceneCapturerViewpointComponent* CapturedViewpoint
 							)
@@ -403,7 +451,7 @@ void ANVSceneCapturerActor::CaptureSceneToPixelsData()
                         SceneDataHandler->HandleSceneAnnotationData(CapturedData,
                                 CapturedFeatureExtractor,
                                 CapturedViewpoint,
-							FrameIndexForFile, FramePicksetForFile, PicksetSubImage);
+                                *FrameInfo);
                     }
                 });
             }
@@ -421,9 +469,9 @@ void ANVSceneCapturerActor::CaptureSceneToPixelsData()
     }
     else
     {
-        bool bFinishedProcessingData = true;
-        // Make sure all the captured scene data are processed
-        if (SceneDataHandler)
+        // Make sure all the captured scene data are read back and processed
+        bool bFinishedProcessingData = (InFlightFrames.Num() == 0);
+        if (bFinishedProcessingData && SceneDataHandler)
         {
             bFinishedProcessingData = !SceneDataHandler->IsHandlingData();
         }
@@ -446,6 +494,34 @@ void ANVSceneCapturerActor::CaptureSceneToPixelsData()
     LastCaptureTimestamp = CurrentTime;
 }
 
+void ANVSceneCapturerActor::RetireCapturedFrames()
+{
+    // NOTE: The callbacks of a frame are destroyed once all its data were handled, the frame is then only referenced by this list
+    for (int32 i = InFlightFrames.Num() - 1; i >= 0; i--)
+    {
+        const FNVCapturedFrameInfoPtr& CheckFrameInfo = InFlightFrames[i];
+        if (!CheckFrameInfo.IsValid() || CheckFrameInfo.IsUnique())
+        {
+            if (CheckFrameInfo.IsValid())
+            {
+                UE_LOG(LogNVSceneCapturer, Verbose, TEXT("Captured frame %d retired after %llu frames."),
+                       CheckFrameInfo->FrameId, GFrameCounter - CheckFrameInfo->EngineFrameNumber);
+            }
+            InFlightFrames.RemoveAt(i);
+        }
+    }
+}
+
+bool ANVSceneCapturerActor::CanCaptureMoreFrames() const
+{
+    return (MaxInFlightFrames <= 0) || (InFlightFrames.Num() < MaxInFlightFrames);
+}
+
+int32 ANVSceneCapturerActor::GetInFlightFrameCount() const
+{
+    return InFlightFrames.Num();
+}
+
 void ANVSceneCapturerActor::UpdateCapturerSettings()
 {
     CapturerSettings.RandomizeSettings();
@@ -601,10 +677,19 @@ void ANVSceneCapturerActor::StopCapturing()
     GetWorldTimerManager().ClearTimer(TimeHandle_StartCapturingDelay);
     TimeHandle_StartCapturingDelay.Invalidate();
 
+    // NOTE: The viewpoints deliver the data of their frames still being read back before they stop,
+    // all the in-flight frames are handled before the data handler is stopped
     for (UNVSceneCapturerViewpointComponent* ViewpointComp : ViewpointList)
     {
         ViewpointComp->StopCapturing();
     }
+    RetireCapturedFrames();
+    if (InFlightFrames.Num() > 0)
+    {
+        UE_LOG(LogNVSceneCapturer, Warning, TEXT("%d captured frames are still in flight after the viewpoints stopped, their data are dropped."),
+               InFlightFrames.Num());
+        InFlightFrames.Reset();
+    }
 
     CurrentState = ENVSceneCapturerState::Active;
 
@@ -761,6 +846,11 @@ UNVSceneDataVisualizer* ANVSceneCapturerActor::GetSceneDataVisualizer() const
 	return SceneDataVisualizer;
 }
 
+UNVRenderTargetPool* ANVSceneCapturerActor::GetRenderTargetPool() const
+{
+	return RenderTargetPool;
+}
+
 void ANVSceneCapturerActor::UpdateViewpointList()
 {
     ensure(CurrentState != ENVSceneCapturerState::Running);
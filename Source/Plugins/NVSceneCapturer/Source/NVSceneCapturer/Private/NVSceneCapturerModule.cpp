@@ -5,6 +5,10 @@
 */
 
 #include "NVSceneCapturerModule.h"
+#include "NVActorGeometryCache.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/Paths.h"
+#include "ShaderCore.h"
 
 IMPLEMENT_MODULE(INVSceneCapturerModule, NVSceneCapturer)
 
@@ -14,9 +18,23 @@ DEFINE_LOG_CATEGORY(LogNVSceneCapturer);
 void INVSceneCapturerModule::StartupModule()
 {
     UE_LOG(LogNVSceneCapturer, Warning, TEXT("Loaded NVSceneCapturer module"));
+
+    // Let the global shaders of the plugin (e.g: the readback pixels packing) find their source files
+    // NOTE: This must be done before the shaders are compiled, that's why the module is loaded in the PostConfigInit phase
+    TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("NVSceneCapturer"));
+    if (Plugin.IsValid())
+    {
+        const FString PluginShaderDir = FPaths::Combine(Plugin->GetBaseDir(), TEXT("Shaders"));
+        AddShaderSourceDirectoryMapping(TEXT("/Plugin/NVSceneCapturer"), PluginShaderDir);
+    }
+
+    FNVActorGeometryCache::RegisterWorldDelegates();
 }
 
 void INVSceneCapturerModule::ShutdownModule()
 {
+    FNVActorGeometryCache::UnregisterWorldDelegates();
+    FNVMeshOrientedBoundsCache::Reset();
+    FNVMeshHullCache::Reset();
 }
 
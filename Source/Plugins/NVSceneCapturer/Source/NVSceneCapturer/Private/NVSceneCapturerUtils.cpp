@@ -6,6 +6,7 @@
 
 #include "NVSceneCapturerModule.h"
 #include "NVSceneCapturerUtils.h"
+#include "NVActorGeometryCache.h"
 #include "Engine.h"
 #include "EngineUtils.h"
 #include "IImageWrapper.h"
@@ -17,6 +18,7 @@
 #include "MeshVertexPainter/MeshVertexPainter.h"
 #include "SkeletalMeshRenderData.h"
 #include "SkeletalMeshLODRenderData.h"
+#include "Math/ConvexHull2d.h"
 
 //================================== FNVSceneExporterConfig ==================================
 FNVSceneExporterConfig::FNVSceneExporterConfig()
@@ -117,6 +119,36 @@ void FNVCuboidData::BuildFromOOBB(const FBox& OOBB, const FTransform& LocalTrans
     Rotation = LocalTransform.GetRotation();
 }
 
+void FNVCuboidData::BuildFromOOBB(const FBox& OOBB, const FQuat& BoxRotation, const FTransform& LocalTransform)
+{
+    BuildFromAABB(OOBB);
+
+    // NOTE: The box rotation is applied separately instead of being merged into the local transform
+    // since the transforms can't be combined exactly when the local transform have a non-uniform scale
+    for (uint8 i = 0; i < TotalVertexesCount; i++)
+    {
+        Vertexes[i] = LocalTransform.TransformPosition(BoxRotation.RotateVector(Vertexes[i]));
+    }
+
+    Center = LocalTransform.TransformPosition(BoxRotation.RotateVector(Center));
+    Rotation = LocalTransform.GetRotation() * BoxRotation;
+}
+
+//================================== FNVOrientedBounds ==================================
+FNVOrientedBounds::FNVOrientedBounds()
+    : Box(EForceInit::ForceInitToZero),
+    Rotation(FQuat::Identity),
+    MeanPoint(FVector::ZeroVector),
+    PrincipalAxis(FVector::ZeroVector)
+{
+}
+
+//================================== FCapturedSceneData ==================================
+FCapturedSceneData::FCapturedSceneData()
+    : OptionalObjectFields(ENVOptionalObjectFields::None)
+{
+}
+
 //================================== ENVImageFormat ==================================
 EImageFormat ConvertExportFormatToImageFormat(ENVImageFormat ExportFormat)
 {
@@ -129,7 +161,13 @@ EImageFormat ConvertExportFormatToImageFormat(ENVImageFormat ExportFormat)
         case ENVImageFormat::GrayscaleJPEG:
             return EImageFormat::GrayscaleJPEG;
         case ENVImageFormat::PNG:
+        case ENVImageFormat::PNG16:
             return EImageFormat::PNG;
+        case ENVImageFormat::EXR:
+            return EImageFormat::EXR;
+        case ENVImageFormat::NPY:
+            // NOTE: The image wrapper can't write numpy arrays, see FNVImageExporter::WriteImageNPY
+            return EImageFormat::Invalid;
         default:
             return EImageFormat::BMP;
     }
@@ -140,6 +178,8 @@ FString GetExportImageExtension(ENVImageFormat ExportFormat)
     static const FString BMP_Extension = TEXT(".bmp");
     static const FString JPEG_Extension = TEXT(".jpg");
     static const FString PNG_Extension = TEXT(".png");
+    static const FString EXR_Extension = TEXT(".exr");
+    static const FString NPY_Extension = TEXT(".npy");
 
     switch (ExportFormat)
     {
@@ -149,12 +189,30 @@ FString GetExportImageExtension(ENVImageFormat ExportFormat)
         case ENVImageFormat::GrayscaleJPEG:
             return JPEG_Extension;
         case ENVImageFormat::PNG:
+        case ENVImageFormat::PNG16:
             return PNG_Extension;
+        case ENVImageFormat::EXR:
+            return EXR_Extension;
+        case ENVImageFormat::NPY:
+            return NPY_Extension;
         default:
             return BMP_Extension;
     }
 }
 
+//================================== FNVImageCompressionSettings ==================================
+FNVImageCompressionSettings::FNVImageCompressionSettings()
+{
+    // NOTE: Same as the settings we used to compress the PNG images with libpng
+    PngCompressionLevel = 1;
+    PngFilterType = ENVPngFilterType::Adaptive;
+    JpegQuality = 100;
+    ExrCompression = ENVExrCompression::ZIP;
+    ExrCompressionLevel = 1;
+    ExrPixelType = ENVExrPixelType::Auto;
+    bAllowParallelEncoding = true;
+}
+
 //================================== ENVCapturedPixelFormat ==================================
 ETextureRenderTargetFormat ConvertCapturedFormatToRenderTargetFormat(ENVCapturedPixelFormat PixelFormat)
 {
@@ -165,6 +223,10 @@ ETextureRenderTargetFormat ConvertCapturedFormatToRenderTargetFormat(ENVCaptured
 	case ENVCapturedPixelFormat::R16f:
 		return ETextureRenderTargetFormat::RTF_R16f;
 	case ENVCapturedPixelFormat::R32f:
+	case ENVCapturedPixelFormat::PackedId24:
+	case ENVCapturedPixelFormat::DepthMillimeters16:
+	case ENVCapturedPixelFormat::DepthLog16:
+	case ENVCapturedPixelFormat::DepthHalf16:
 		return ETextureRenderTargetFormat::RTF_R32f;
 	case ENVCapturedPixelFormat::RGBA8:
 	default:
@@ -173,6 +235,126 @@ ETextureRenderTargetFormat ConvertCapturedFormatToRenderTargetFormat(ENVCaptured
 	}
 }
 
+//================================== ENVDepthEncoding ==================================
+ENVCapturedPixelFormat ConvertDepthEncodingToCapturedFormat(ENVDepthEncoding DepthEncoding)
+{
+	switch (DepthEncoding)
+	{
+	case ENVDepthEncoding::Millimeters16:
+		return ENVCapturedPixelFormat::DepthMillimeters16;
+	case ENVDepthEncoding::LogDepth16:
+		return ENVCapturedPixelFormat::DepthLog16;
+	case ENVDepthEncoding::Half16:
+		return ENVCapturedPixelFormat::DepthHalf16;
+	case ENVDepthEncoding::Float32:
+		return ENVCapturedPixelFormat::R32f;
+	case ENVDepthEncoding::Normalized8:
+	default:
+		return ENVCapturedPixelFormat::R8;
+	}
+}
+
+//================================ FNVTexturePixelDataPool ================================
+const int32 FNVTexturePixelDataPool::MaxFreePixelDataCount = 32;
+
+FNVTexturePixelDataPool& FNVTexturePixelDataPool::Get()
+{
+    static FNVTexturePixelDataPool Instance;
+    return Instance;
+}
+
+FNVTexturePixelDataPool::FNVTexturePixelDataPool()
+{
+    FreePixelDataList.Reset();
+}
+
+FNVTexturePixelDataPool::~FNVTexturePixelDataPool()
+{
+    Empty();
+}
+
+FNVTexturePixelDataRef FNVTexturePixelDataPool::Acquire(uint32 BufferSize)
+{
+    FNVTexturePixelData* NewPixelData = nullptr;
+    {
+        FScopeLock ScopeLock(&PoolCriticalSection);
+        // Prefer the smallest buffer which is big enough so we don't need to reallocate it
+        int32 BestIndex = INDEX_NONE;
+        for (int32 i = 0; i < FreePixelDataList.Num(); i++)
+        {
+            const uint32 CheckCapacity = FreePixelDataList[i]->PixelData.Max();
+            if ((CheckCapacity >= BufferSize) &&
+                ((BestIndex == INDEX_NONE) || (CheckCapacity < (uint32)FreePixelDataList[BestIndex]->PixelData.Max())))
+            {
+                BestIndex = i;
+            }
+        }
+        if ((BestIndex == INDEX_NONE) && (FreePixelDataList.Num() > 0))
+        {
+            BestIndex = FreePixelDataList.Num() - 1;
+        }
+        if (BestIndex != INDEX_NONE)
+        {
+            NewPixelData = FreePixelDataList[BestIndex];
+            FreePixelDataList.RemoveAtSwap(BestIndex);
+        }
+    }
+
+    if (!NewPixelData)
+    {
+        NewPixelData = new FNVTexturePixelData();
+    }
+    NewPixelData->PixelData.SetNumUninitialized(BufferSize, false);
+    NewPixelData->PixelFormat = EPixelFormat::PF_Unknown;
+    NewPixelData->RowStride = 0;
+    NewPixelData->PixelSize = FIntPoint::ZeroValue;
+
+    return MakeShareable(NewPixelData, [](FNVTexturePixelData* ReleasedPixelData)
+    {
+        FNVTexturePixelDataPool::Get().Release(ReleasedPixelData);
+    });
+}
+
+void FNVTexturePixelDataPool::Release(FNVTexturePixelData* PixelData)
+{
+    if (PixelData)
+    {
+        FScopeLock ScopeLock(&PoolCriticalSection);
+        if (FreePixelDataList.Num() < MaxFreePixelDataCount)
+        {
+            FreePixelDataList.Add(PixelData);
+            PixelData = nullptr;
+        }
+    }
+    // The pool is full, just free the buffer
+    if (PixelData)
+    {
+        delete PixelData;
+    }
+}
+
+void FNVTexturePixelDataPool::Empty()
+{
+    FScopeLock ScopeLock(&PoolCriticalSection);
+    for (FNVTexturePixelData* CheckPixelData : FreePixelDataList)
+    {
+        delete CheckPixelData;
+    }
+    FreePixelDataList.Reset();
+}
+
+//================================ FNVCapturedFrameInfo ================================
+FNVCapturedFrameInfo::FNVCapturedFrameInfo()
+{
+    FrameId = 0;
+    FrameIndexForFile = 0;
+    PicksetIndex = 0;
+    PicksetSubImage = 0;
+    EngineFrameNumber = 0;
+    CaptureTimestamp = 0.f;
+    FOVAngle = 0.f;
+}
+
 //================================ FNVFrameCounter ================================
 FNVFrameCounter::FNVFrameCounter()
 {
@@ -275,6 +457,420 @@ void FNVSceneCapturerSettings::PostEditChangeProperty(struct FPropertyChangedEve
 }
 #endif //WITH_EDITORONLY_DATA
 
+//================================== Oriented bounds helpers ==================================
+namespace
+{
+    // Diagonalize a symmetric 3x3 matrix using cyclic Jacobi rotations
+    // NOTE: The eigenvalues end up on the matrix's diagonal, the columns of OutEigenVectors are the matching eigenvectors
+    void DiagonalizeSymmetricMatrix(float InOutMatrix[3][3], float OutEigenVectors[3][3])
+    {
+        float (&A)[3][3] = InOutMatrix;
+        float (&V)[3][3] = OutEigenVectors;
+        for (int32 i = 0; i < 3; i++)
+        {
+            for (int32 j = 0; j < 3; j++)
+            {
+                V[i][j] = (i == j) ? 1.f : 0.f;
+            }
+        }
+
+        static const int32 MaxSweepCount = 32;
+        for (int32 SweepIndex = 0; SweepIndex < MaxSweepCount; SweepIndex++)
+        {
+            const float OffDiagonalNorm = FMath::Square(A[0][1]) + FMath::Square(A[0][2]) + FMath::Square(A[1][2]);
+            const float DiagonalNorm = FMath::Square(A[0][0]) + FMath::Square(A[1][1]) + FMath::Square(A[2][2]);
+            if (OffDiagonalNorm <= DiagonalNorm * 1e-12f)
+            {
+                break;
+            }
+
+            for (int32 p = 0; p < 2; p++)
+            {
+                for (int32 q = p + 1; q < 3; q++)
+                {
+                    if (A[p][q] == 0.f)
+                    {
+                        continue;
+                    }
+
+                    // Rotate the matrix in the (p, q) plane so A[p][q] become 0
+                    const float Theta = (A[q][q] - A[p][p]) / (2.f * A[p][q]);
+                    const float T = ((Theta >= 0.f) ? 1.f : -1.f) / (FMath::Abs(Theta) + FMath::Sqrt(Theta * Theta + 1.f));
+                    const float C = 1.f / FMath::Sqrt(T * T + 1.f);
+                    const float S = T * C;
+                    for (int32 k = 0; k < 3; k++)
+                    {
+                        const float Akp = A[k][p];
+                        const float Akq = A[k][q];
+                        A[k][p] = C * Akp - S * Akq;
+                        A[k][q] = S * Akp + C * Akq;
+                    }
+                    for (int32 k = 0; k < 3; k++)
+                    {
+                        const float Apk = A[p][k];
+                        const float Aqk = A[q][k];
+                        A[p][k] = C * Apk - S * Aqk;
+                        A[q][k] = S * Apk + C * Aqk;
+                    }
+                    for (int32 k = 0; k < 3; k++)
+                    {
+                        const float Vkp = V[k][p];
+                        const float Vkq = V[k][q];
+                        V[k][p] = C * Vkp - S * Vkq;
+                        V[k][q] = S * Vkp + C * Vkq;
+                    }
+                }
+            }
+        }
+    }
+
+    // Get the bounding box of the points in the space of the axes
+    FBox GetPointsBoundsInAxes(const TArray<FVector>& Points, const FVector Axes[3])
+    {
+        FVector MinPoint(BIG_NUMBER);
+        FVector MaxPoint(-BIG_NUMBER);
+        for (const FVector& CheckPoint : Points)
+        {
+            const FVector AxesPoint(CheckPoint | Axes[0], CheckPoint | Axes[1], CheckPoint | Axes[2]);
+            MinPoint = MinPoint.ComponentMin(AxesPoint);
+            MaxPoint = MaxPoint.ComponentMax(AxesPoint);
+        }
+        return FBox(MinPoint, MaxPoint);
+    }
+
+    // Find the direction of the smallest rectangle containing the 2d points
+    // NOTE: The smallest rectangle has a side collinear with one of the points' convex hull edges so only those directions are checked
+    FVector2D FindMinAreaRectangleDirection(const TArray<FVector2D>& Points, float& OutArea)
+    {
+        FVector2D BestDirection(1.f, 0.f);
+        const FBox2D PointsBounds(Points);
+        OutArea = PointsBounds.GetArea();
+
+        TArray<int32> HullIndexes;
+        ConvexHull2D::ComputeConvexHull2(Points, HullIndexes);
+        const int32 HullPointCount = HullIndexes.Num();
+        for (int32 EdgeIndex = 0; EdgeIndex < HullPointCount; EdgeIndex++)
+        {
+            const FVector2D& EdgeStart = Points[HullIndexes[EdgeIndex]];
+            const FVector2D& EdgeEnd = Points[HullIndexes[(EdgeIndex + 1) % HullPointCount]];
+            const FVector2D EdgeDirection = (EdgeEnd - EdgeStart).GetSafeNormal();
+            if (EdgeDirection.IsZero())
+            {
+                continue;
+            }
+            const FVector2D EdgeNormal(-EdgeDirection.Y, EdgeDirection.X);
+
+            FVector2D MinPoint(BIG_NUMBER, BIG_NUMBER);
+            FVector2D MaxPoint(-BIG_NUMBER, -BIG_NUMBER);
+            for (const int32 HullIndex : HullIndexes)
+            {
+                const FVector2D EdgePoint(Points[HullIndex] | EdgeDirection, Points[HullIndex] | EdgeNormal);
+                MinPoint = FVector2D::Min(MinPoint, EdgePoint);
+                MaxPoint = FVector2D::Max(MaxPoint, EdgePoint);
+            }
+
+            const float RectangleArea = (MaxPoint.X - MinPoint.X) * (MaxPoint.Y - MinPoint.Y);
+            if (RectangleArea < OutArea)
+            {
+                OutArea = RectangleArea;
+                BestDirection = EdgeDirection;
+            }
+        }
+        return BestDirection;
+    }
+
+    // Incremental 3d convex hull of a set of points (quickhull), only the vertexes of the hull are needed so the faces' adjacency isn't kept
+    class FNVQuickHull
+    {
+    public:
+        FNVQuickHull(const TArray<FVector>& InPoints, float InTolerance)
+            : Points(InPoints),
+            Tolerance(InTolerance),
+            InteriorPoint(FVector::ZeroVector)
+        {
+        }
+
+        // @return false if the points are degenerated: all on a plane, a line or at the same position
+        bool Build(int32 MaxVertexCount)
+        {
+            if (!BuildInitialSimplex())
+            {
+                return false;
+            }
+
+            int32 HullVertexCount = 4;
+            int32 FaceCursor = 0;
+            TArray<int32> VisibleFaceIndexes;
+            TSet<uint64> VisibleEdges;
+            TArray<TPair<int32, int32>> HorizonEdges;
+            TArray<int32> OrphanPoints;
+            TArray<int32> NewFaceIndexes;
+            while ((MaxVertexCount <= 0) || (HullVertexCount < MaxVertexCount))
+            {
+                // Find a face which still have points outside of it
+                while ((FaceCursor < Faces.Num()) && (Faces[FaceCursor].bRemoved || (Faces[FaceCursor].OutsidePoints.Num() == 0)))
+                {
+                    FaceCursor++;
+                }
+                if (FaceCursor >= Faces.Num())
+                {
+                    break;
+                }
+
+                // Add the point farthest from the face to the hull
+                const FFace& EyeFace = Faces[FaceCursor];
+                int32 EyePointIndex = INDEX_NONE;
+                float EyeDistance = -BIG_NUMBER;
+                for (const int32 PointIndex : EyeFace.OutsidePoints)
+                {
+                    const float PointDistance = EyeFace.GetDistance(Points[PointIndex]);
+                    if (PointDistance > EyeDistance)
+                    {
+                        EyeDistance = PointDistance;
+                        EyePointIndex = PointIndex;
+                    }
+                }
+                const FVector& EyePoint = Points[EyePointIndex];
+
+                // The faces the point can see are replaced by the faces connecting it to their horizon
+                VisibleFaceIndexes.Reset();
+                VisibleEdges.Reset();
+                for (int32 FaceIndex = 0; FaceIndex < Faces.Num(); FaceIndex++)
+                {
+                    const FFace& CheckFace = Faces[FaceIndex];
+                    if (!CheckFace.bRemoved && (CheckFace.GetDistance(EyePoint) > Tolerance))
+                    {
+                        VisibleFaceIndexes.Add(FaceIndex);
+                        for (int32 i = 0; i < 3; i++)
+                        {
+                            VisibleEdges.Add(GetEdgeKey(CheckFace.V[i], CheckFace.V[(i + 1) % 3]));
+                        }
+                    }
+                }
+
+                HorizonEdges.Reset();
+                OrphanPoints.Reset();
+                for (const int32 FaceIndex : VisibleFaceIndexes)
+                {
+                    FFace& VisibleFace = Faces[FaceIndex];
+                    for (int32 i = 0; i < 3; i++)
+                    {
+                        const int32 EdgeStart = VisibleFace.V[i];
+                        const int32 EdgeEnd = VisibleFace.V[(i + 1) % 3];
+                        if (!VisibleEdges.Contains(GetEdgeKey(EdgeEnd, EdgeStart)))
+                        {
+                            HorizonEdges.Add(TPair<int32, int32>(EdgeStart, EdgeEnd));
+                        }
+                    }
+                    for (const int32 PointIndex : VisibleFace.OutsidePoints)
+                    {
+                        if (PointIndex != EyePointIndex)
+                        {
+                            OrphanPoints.Add(PointIndex);
+                        }
+                    }
+                    VisibleFace.OutsidePoints.Empty();
+                    VisibleFace.bRemoved = true;
+                }
+
+                NewFaceIndexes.Reset();
+                for (const TPair<int32, int32>& HorizonEdge : HorizonEdges)
+                {
+                    NewFaceIndexes.Add(AddFace(HorizonEdge.Key, HorizonEdge.Value, EyePointIndex));
+                }
+                AssignOutsidePoints(OrphanPoints, NewFaceIndexes);
+
+                HullVertexCount++;
+            }
+            return true;
+        }
+
+        void GetHullVertexIndexes(TArray<int32>& OutVertexIndexes) const
+        {
+            TBitArray<> HullVertexFlags(false, Points.Num());
+            OutVertexIndexes.Reset();
+            for (const FFace& CheckFace : Faces)
+            {
+                if (!CheckFace.bRemoved)
+                {
+                    for (int32 i = 0; i < 3; i++)
+                    {
+                        if (!HullVertexFlags[CheckFace.V[i]])
+                        {
+                            HullVertexFlags[CheckFace.V[i]] = true;
+                            OutVertexIndexes.Add(CheckFace.V[i]);
+                        }
+                    }
+                }
+            }
+            OutVertexIndexes.Sort();
+        }
+
+    private:
+        struct FFace
+        {
+            int32 V[3];
+            FVector Normal;
+            float Offset;
+            TArray<int32> OutsidePoints;
+            bool bRemoved;
+
+            float GetDistance(const FVector& CheckPoint) const
+            {
+                return (Normal | CheckPoint) - Offset;
+            }
+        };
+
+        static uint64 GetEdgeKey(int32 EdgeStart, int32 EdgeEnd)
+        {
+            return ((uint64)(uint32)EdgeStart << 32) | (uint32)EdgeEnd;
+        }
+
+        bool BuildInitialSimplex()
+        {
+            const int32 PointCount = Points.Num();
+            if (PointCount < 4)
+            {
+                return false;
+            }
+
+            // Start from the 2 most distant points among the extremes of each axis
+            int32 ExtremeIndexes[6] = { 0, 0, 0, 0, 0, 0 };
+            for (int32 PointIndex = 1; PointIndex < PointCount; PointIndex++)
+            {
+                for (int32 Axis = 0; Axis < 3; Axis++)
+                {
+                    if (Points[PointIndex][Axis] < Points[ExtremeIndexes[Axis * 2]][Axis])
+                    {
+                        ExtremeIndexes[Axis * 2] = PointIndex;
+                    }
+                    if (Points[PointIndex][Axis] > Points[ExtremeIndexes[Axis * 2 + 1]][Axis])
+                    {
+                        ExtremeIndexes[Axis * 2 + 1] = PointIndex;
+                    }
+                }
+            }
+            int32 SimplexIndexes[4] = { INDEX_NONE, INDEX_NONE, INDEX_NONE, INDEX_NONE };
+            float LargestDistance = -1.f;
+            for (int32 i = 0; i < 6; i++)
+            {
+                for (int32 j = i + 1; j < 6; j++)
+                {
+                    const float PairDistance = FVector::DistSquared(Points[ExtremeIndexes[i]], Points[ExtremeIndexes[j]]);
+                    if (PairDistance > LargestDistance)
+                    {
+                        LargestDistance = PairDistance;
+                        SimplexIndexes[0] = ExtremeIndexes[i];
+                        SimplexIndexes[1] = ExtremeIndexes[j];
+                    }
+                }
+            }
+            if (LargestDistance <= FMath::Square(Tolerance))
+            {
+                return false;
+            }
+
+            // Then the point farthest from their line and the one farthest from the plane of the 3 points
+            const FVector& LineStart = Points[SimplexIndexes[0]];
+            const FVector& LineEnd = Points[SimplexIndexes[1]];
+            LargestDistance = -1.f;
+            for (int32 PointIndex = 0; PointIndex < PointCount; PointIndex++)
+            {
+                const float LineDistance = FMath::PointDistToLine(Points[PointIndex], LineEnd - LineStart, LineStart);
+                if (LineDistance > LargestDistance)
+                {
+                    LargestDistance = LineDistance;
+                    SimplexIndexes[2] = PointIndex;
+                }
+            }
+            if (LargestDistance <= Tolerance)
+            {
+                return false;
+            }
+
+            const FVector PlaneNormal = ((LineEnd - LineStart) ^ (Points[SimplexIndexes[2]] - LineStart)).GetSafeNormal();
+            LargestDistance = -1.f;
+            for (int32 PointIndex = 0; PointIndex < PointCount; PointIndex++)
+            {
+                const float PlaneDistance = FMath::Abs(PlaneNormal | (Points[PointIndex] - LineStart));
+                if (PlaneDistance > LargestDistance)
+                {
+                    LargestDistance = PlaneDistance;
+                    SimplexIndexes[3] = PointIndex;
+                }
+            }
+            if (LargestDistance <= Tolerance)
+            {
+                return false;
+            }
+
+            // NOTE: The simplex's centroid stay inside the hull while it grows, it's used to orient the new faces outward
+            InteriorPoint = (Points[SimplexIndexes[0]] + Points[SimplexIndexes[1]] + Points[SimplexIndexes[2]] + Points[SimplexIndexes[3]]) * 0.25f;
+            TArray<int32> SimplexFaceIndexes;
+            SimplexFaceIndexes.Add(AddFace(SimplexIndexes[0], SimplexIndexes[1], SimplexIndexes[2]));
+            SimplexFaceIndexes.Add(AddFace(SimplexIndexes[0], SimplexIndexes[1], SimplexIndexes[3]));
+            SimplexFaceIndexes.Add(AddFace(SimplexIndexes[0], SimplexIndexes[2], SimplexIndexes[3]));
+            SimplexFaceIndexes.Add(AddFace(SimplexIndexes[1], SimplexIndexes[2], SimplexIndexes[3]));
+
+            TArray<int32> RemainingPoints;
+            RemainingPoints.Reserve(PointCount);
+            for (int32 PointIndex = 0; PointIndex < PointCount; PointIndex++)
+            {
+                if ((PointIndex != SimplexIndexes[0]) && (PointIndex != SimplexIndexes[1]) && (PointIndex != SimplexIndexes[2]) && (PointIndex != SimplexIndexes[3]))
+                {
+                    RemainingPoints.Add(PointIndex);
+                }
+            }
+            AssignOutsidePoints(RemainingPoints, SimplexFaceIndexes);
+            return true;
+        }
+
+        int32 AddFace(int32 A, int32 B, int32 C)
+        {
+            const int32 FaceIndex = Faces.AddDefaulted();
+            FFace& NewFace = Faces[FaceIndex];
+            FVector FaceNormal = ((Points[B] - Points[A]) ^ (Points[C] - Points[A])).GetSafeNormal();
+            // Make sure the face is facing outward
+            if ((FaceNormal | (InteriorPoint - Points[A])) > 0.f)
+            {
+                Swap(B, C);
+                FaceNormal = -FaceNormal;
+            }
+            NewFace.V[0] = A;
+            NewFace.V[1] = B;
+            NewFace.V[2] = C;
+            NewFace.Normal = FaceNormal;
+            NewFace.Offset = FaceNormal | Points[A];
+            NewFace.bRemoved = false;
+            return FaceIndex;
+        }
+
+        // Give each point to a face it's outside of, the points which are inside all the faces are dropped
+        void AssignOutsidePoints(const TArray<int32>& PointIndexes, const TArray<int32>& FaceIndexes)
+        {
+            for (const int32 PointIndex : PointIndexes)
+            {
+                const FVector& CheckPoint = Points[PointIndex];
+                for (const int32 FaceIndex : FaceIndexes)
+                {
+                    FFace& CheckFace = Faces[FaceIndex];
+                    if (CheckFace.GetDistance(CheckPoint) > Tolerance)
+                    {
+                        CheckFace.OutsidePoints.Add(PointIndex);
+                        break;
+                    }
+                }
+            }
+        }
+
+    private:
+        const TArray<FVector>& Points;
+        float Tolerance;
+        FVector InteriorPoint;
+        TArray<FFace> Faces;
+    };
+}
+
 //================================== Helper functions ==================================
 namespace NVSceneCapturerUtils
 {
@@ -424,6 +1020,52 @@ namespace NVSceneCapturerUtils
         return nullptr;
     }
 
+    TSharedPtr<FJsonObject> CapturedSceneDataToJsonObject(const FCapturedSceneData& SceneData)
+    {
+        TSharedPtr<FJsonObject> SceneDataJsonObj = UStructToJsonObject(SceneData, 0, 0);
+        if (!SceneDataJsonObj.IsValid())
+        {
+            return SceneDataJsonObj;
+        }
+
+        const uint32 OptionalObjectFields = SceneData.OptionalObjectFields;
+        const TArray<TSharedPtr<FJsonValue>>& ObjectJsonValues = SceneDataJsonObj->GetArrayField(TEXT("objects"));
+        for (int32 i = 0; (i < SceneData.Objects.Num()) && (i < ObjectJsonValues.Num()); i++)
+        {
+            const TSharedPtr<FJsonObject>& ObjectJsonObj = ObjectJsonValues[i]->AsObject();
+            if (!ObjectJsonObj.IsValid())
+            {
+                continue;
+            }
+
+            // The converter write all the properties, leave out the optional ones this frame didn't calculate
+            if (!(OptionalObjectFields & ENVOptionalObjectFields::PixelCounts))
+            {
+                ObjectJsonObj->RemoveField(TEXT("visible_pixel_count"));
+                ObjectJsonObj->RemoveField(TEXT("projected_pixel_count"));
+            }
+            if (!(OptionalObjectFields & ENVOptionalObjectFields::TruncationFlags))
+            {
+                ObjectJsonObj->RemoveField(TEXT("truncation_flags"));
+            }
+            if (!(OptionalObjectFields & ENVOptionalObjectFields::SegmentationRLE))
+            {
+                ObjectJsonObj->RemoveField(TEXT("segmentation_rle"));
+            }
+            if (!(OptionalObjectFields & ENVOptionalObjectFields::SegmentationPolygons))
+            {
+                ObjectJsonObj->RemoveField(TEXT("segmentation_polygons"));
+            }
+
+            const TSharedPtr<FJsonObject>& CustomDataJsonObj = SceneData.Objects[i].custom_data;
+            if (CustomDataJsonObj.IsValid())
+            {
+                ObjectJsonObj->SetObjectField(TEXT("custom_data"), CustomDataJsonObj);
+            }
+        }
+        return SceneDataJsonObj;
+    }
+
     bool SaveJsonObjectToFile(const TSharedPtr<FJsonObject>& JsonObjData, const FString& Filename)
     {
         bool bResult = false;
@@ -505,20 +1147,20 @@ namespace NVSceneCapturerUtils
         return ValidMeshComp;
     }
 
-    TArray<FVector> GetSimpleCollisionVertexes(const class UMeshComponent* MeshComp)
+    TArray<FVector> GetSimpleCollisionVertexes(const class UMeshComponent* MeshComp, bool bInWorldSpace/*= true*/)
     {
         TArray<FVector> OutVertexes;
         OutVertexes.Reset();
 
         if (MeshComp)
         {
+            const FTransform& MeshTransform = bInWorldSpace ? MeshComp->GetComponentTransform() : FTransform::Identity;
             const UStaticMeshComponent* StaticMeshComp = Cast<UStaticMeshComponent>(MeshComp);
             if (StaticMeshComp)
             {
                 const UStaticMesh* CheckMesh = StaticMeshComp->GetStaticMesh();
                 if (CheckMesh && CheckMesh->BodySetup)
                 {
-                    const FTransform& MeshTransform = StaticMeshComp->GetComponentTransform();
                     const FKAggregateGeom& MeshGeom = CheckMesh->BodySetup->AggGeom;
 
                     for (const FKConvexElem& ConvexElem : MeshGeom.ConvexElems)
@@ -536,9 +1178,10 @@ namespace NVSceneCapturerUtils
                     const FPositionVertexBuffer& MeshVertexBuffer = CheckMesh->RenderData->LODResources[0].VertexBuffers.PositionVertexBuffer;
                     const uint32 VertexesCount = MeshVertexBuffer.GetNumVertices();
 
+                    OutVertexes.Reserve(VertexesCount);
                     for (uint32 i = 0; i < VertexesCount; i++)
                     {
-                        OutVertexes.Add(MeshVertexBuffer.VertexPosition(i));
+                        OutVertexes.Add(MeshTransform.TransformPosition(MeshVertexBuffer.VertexPosition(i)));
                     }
                 }
             }
@@ -551,7 +1194,6 @@ namespace NVSceneCapturerUtils
                     const UPhysicsAsset* MeshPhysicsAsset = SkeletalMesh->PhysicsAsset;
                     if (MeshPhysicsAsset)
                     {
-                        const FTransform& MeshTransform = SkeletalMeshComp->GetComponentTransform();
                         for (const USkeletalBodySetup* CheckSkeletalBodySetup : MeshPhysicsAsset->SkeletalBodySetups)
                         {
                             if (CheckSkeletalBodySetup)
@@ -586,6 +1228,7 @@ namespace NVSceneCapturerUtils
             case EPixelFormat::PF_B8G8R8A8:
             case EPixelFormat::PF_R8G8B8A8:
                 return 8;
+            case EPixelFormat::PF_G16:
             case EPixelFormat::PF_R16F:
             case EPixelFormat::PF_R16_SINT:
             case EPixelFormat::PF_R16_UINT:
@@ -609,6 +1252,7 @@ namespace NVSceneCapturerUtils
             case EPixelFormat::PF_A8:
             case EPixelFormat::PF_R8_UINT:
             case EPixelFormat::PF_G8:
+            case EPixelFormat::PF_G16:
             case EPixelFormat::PF_R16F:
             case EPixelFormat::PF_R16_SINT:
             case EPixelFormat::PF_R16_UINT:
@@ -692,6 +1336,12 @@ namespace NVSceneCapturerUtils
 		return OutColor;
 	}
 
+    uint32 ConvertVertexColorToInt32(const FColor& VertexColor)
+    {
+        // NOTE: The alpha isn't used by the vertex color mask
+        return ((uint32)VertexColor.R << 16) | ((uint32)VertexColor.G << 8) | (uint32)VertexColor.B;
+    }
+
 
     void SetMeshVertexColor(AActor* MeshOwnerActor, const FColor& VertexColor)
     {
@@ -804,6 +1454,292 @@ namespace NVSceneCapturerUtils
         }
     }
 
+    float CalculateClippedConvexHullArea(const TArray<FVector2D>& Points, const FBox2D& ClipRect)
+    {
+        if (Points.Num() < 3)
+        {
+            return 0.f;
+        }
+
+        TArray<int32> HullIndexes;
+        ConvexHull2D::ComputeConvexHull2(Points, HullIndexes);
+        TArray<FVector2D> Polygon;
+        Polygon.Reserve(HullIndexes.Num());
+        for (const int32 HullIndex : HullIndexes)
+        {
+            Polygon.Add(Points[HullIndex]);
+        }
+
+        // Clip the hull against each side of the rectangle in turn (Sutherland-Hodgman), the result is still convex
+        TArray<FVector2D> ClippedPolygon;
+        for (int32 SideIndex = 0; (SideIndex < 4) && (Polygon.Num() >= 3); SideIndex++)
+        {
+            const int32 Axis = SideIndex & 1;
+            const bool bIsMinSide = (SideIndex < 2);
+            const float SideValue = bIsMinSide ? ClipRect.Min[Axis] : ClipRect.Max[Axis];
+            auto IsInside = [&](const FVector2D& Point)
+            {
+                return bIsMinSide ? (Point[Axis] >= SideValue) : (Point[Axis] <= SideValue);
+            };
+
+            ClippedPolygon.Reset();
+            for (int32 i = 0; i < Polygon.Num(); i++)
+            {
+                const FVector2D& CurrentPoint = Polygon[i];
+                const FVector2D& NextPoint = Polygon[(i + 1) % Polygon.Num()];
+                const bool bCurrentInside = IsInside(CurrentPoint);
+                const bool bNextInside = IsInside(NextPoint);
+                if (bCurrentInside)
+                {
+                    ClippedPolygon.Add(CurrentPoint);
+                }
+                if (bCurrentInside != bNextInside)
+                {
+                    const float Alpha = (SideValue - CurrentPoint[Axis]) / (NextPoint[Axis] - CurrentPoint[Axis]);
+                    ClippedPolygon.Add(FMath::Lerp(CurrentPoint, NextPoint, Alpha));
+                }
+            }
+            Swap(Polygon, ClippedPolygon);
+        }
+
+        // Shoelace formula, the hull's winding doesn't matter
+        float DoubleArea = 0.f;
+        for (int32 i = 0; i < Polygon.Num(); i++)
+        {
+            const FVector2D& CurrentPoint = Polygon[i];
+            const FVector2D& NextPoint = Polygon[(i + 1) % Polygon.Num()];
+            DoubleArea += (CurrentPoint.X * NextPoint.Y) - (NextPoint.X * CurrentPoint.Y);
+        }
+        return FMath::Abs(DoubleArea) * 0.5f;
+    }
+
+    //================================== Binary masks ==================================
+    void EncodeMaskRLE(const TArray<uint8>& Mask, const FIntRect& MaskRect, const FIntPoint& ImageSize, TArray<uint32>& OutCounts)
+    {
+        OutCounts.Reset();
+
+        const int32 MaskWidth = MaskRect.Width();
+        const int32 MaskHeight = MaskRect.Height();
+        const bool bValidMask = (MaskWidth > 0) && (MaskHeight > 0) && (Mask.Num() >= MaskWidth * MaskHeight) &&
+                                (MaskRect.Min.X >= 0) && (MaskRect.Min.Y >= 0) && (MaskRect.Max.X <= ImageSize.X) && (MaskRect.Max.Y <= ImageSize.Y);
+        if (!bValidMask)
+        {
+            OutCounts.Add((uint32)FMath::Max(0, ImageSize.X * ImageSize.Y));
+            return;
+        }
+
+        uint8 CurrentValue = 0;
+        uint32 RunLength = 0;
+        auto AddPixels = [&](uint8 Value, uint32 PixelCount)
+        {
+            if (PixelCount == 0)
+            {
+                return;
+            }
+            if (Value != CurrentValue)
+            {
+                OutCounts.Add(RunLength);
+                CurrentValue = Value;
+                RunLength = 0;
+            }
+            RunLength += PixelCount;
+        };
+
+        // The pixels before the mask's first column and above its first row
+        const uint32 ImageHeight = ImageSize.Y;
+        AddPixels(0, MaskRect.Min.X * ImageHeight + MaskRect.Min.Y);
+        for (int32 X = 0; X < MaskWidth; X++)
+        {
+            for (int32 Y = 0; Y < MaskHeight; Y++)
+            {
+                AddPixels((Mask[Y * MaskWidth + X] != 0) ? 1 : 0, 1);
+            }
+
+            // The pixels below this column and above the next one
+            if (X < MaskWidth - 1)
+            {
+                AddPixels(0, ImageHeight - MaskHeight);
+            }
+        }
+        AddPixels(0, (ImageHeight - MaskRect.Max.Y) + (ImageSize.X - MaskRect.Max.X) * ImageHeight);
+
+        if (RunLength > 0)
+        {
+            OutCounts.Add(RunLength);
+        }
+    }
+
+    void TraceMaskContours(const TArray<uint8>& Mask, const FIntPoint& MaskSize, TArray<TArray<FIntPoint>>& OutContours)
+    {
+        OutContours.Reset();
+        if ((MaskSize.X <= 0) || (MaskSize.Y <= 0) || (Mask.Num() < MaskSize.X * MaskSize.Y))
+        {
+            return;
+        }
+
+        // The neighbors in clockwise order (the Y axis goes down), starting from the right one
+        static const FIntPoint NeighborOffsets[8] =
+        {
+            FIntPoint(1, 0), FIntPoint(1, 1), FIntPoint(0, 1), FIntPoint(-1, 1),
+            FIntPoint(-1, 0), FIntPoint(-1, -1), FIntPoint(0, -1), FIntPoint(1, -1)
+        };
+
+        auto IsMaskPixel = [&](const FIntPoint& Pixel)
+        {
+            return (Pixel.X >= 0) && (Pixel.Y >= 0) && (Pixel.X < MaskSize.X) && (Pixel.Y < MaskSize.Y) && (Mask[Pixel.Y * MaskSize.X + Pixel.X] != 0);
+        };
+
+        // Mark the pixels of the parts which are already traced
+        TArray<uint8> VisitedPixels;
+        VisitedPixels.SetNumZeroed(MaskSize.X * MaskSize.Y);
+        TArray<FIntPoint> PixelStack;
+
+        for (int32 Y = 0; Y < MaskSize.Y; Y++)
+        {
+            for (int32 X = 0; X < MaskSize.X; X++)
+            {
+                const int32 PixelIndex = Y * MaskSize.X + X;
+                if ((Mask[PixelIndex] == 0) || VisitedPixels[PixelIndex])
+                {
+                    continue;
+                }
+
+                // Flood the part so its other pixels don't start a new contour
+                VisitedPixels[PixelIndex] = 1;
+                PixelStack.Reset();
+                PixelStack.Add(FIntPoint(X, Y));
+                while (PixelStack.Num() > 0)
+                {
+                    const FIntPoint CurrentPixel = PixelStack.Pop(false);
+                    for (const FIntPoint& NeighborOffset : NeighborOffsets)
+                    {
+                        const FIntPoint NeighborPixel = CurrentPixel + NeighborOffset;
+                        if (IsMaskPixel(NeighborPixel))
+                        {
+                            uint8& bVisited = VisitedPixels[NeighborPixel.Y * MaskSize.X + NeighborPixel.X];
+                            if (!bVisited)
+                            {
+                                bVisited = 1;
+                                PixelStack.Add(NeighborPixel);
+                            }
+                        }
+                    }
+                }
+
+                // Moore neighbor tracing, the part is first found from its top-left pixel so its left neighbor is empty
+                TArray<FIntPoint>& Contour = OutContours[OutContours.AddDefaulted()];
+                const FIntPoint StartPixel(X, Y);
+                FIntPoint CurrentPixel = StartPixel;
+                int32 SearchDirection = 5;
+                int32 FirstDirection = INDEX_NONE;
+                // NOTE: Each border pixel is visited at most 4 times, the limit only guard against a broken mask
+                const int32 MaxStepCount = 4 * MaskSize.X * MaskSize.Y + 8;
+                for (int32 StepIndex = 0; StepIndex < MaxStepCount; StepIndex++)
+                {
+                    int32 MoveDirection = INDEX_NONE;
+                    for (int32 i = 0; i < 8; i++)
+                    {
+                        const int32 CheckDirection = (SearchDirection + i) % 8;
+                        if (IsMaskPixel(CurrentPixel + NeighborOffsets[CheckDirection]))
+                        {
+                            MoveDirection = CheckDirection;
+                            break;
+                        }
+                    }
+
+                    // Stop once the contour goes through the start pixel the same way again (Jacob's stopping criterion)
+                    if ((MoveDirection == INDEX_NONE) || ((CurrentPixel == StartPixel) && (MoveDirection == FirstDirection)))
+                    {
+                        break;
+                    }
+                    if (FirstDirection == INDEX_NONE)
+                    {
+                        FirstDirection = MoveDirection;
+                    }
+
+                    Contour.Add(CurrentPixel);
+                    CurrentPixel += NeighborOffsets[MoveDirection];
+                    // Resume the search from the empty neighbor checked just before the pixel we moved to
+                    SearchDirection = (MoveDirection + ((MoveDirection % 2 == 0) ? 7 : 6)) % 8;
+                }
+
+                if (Contour.Num() == 0)
+                {
+                    Contour.Add(StartPixel);
+                }
+            }
+        }
+    }
+
+    void SimplifyClosedPolygon(TArray<FVector2D>& InOutPoints, float Tolerance)
+    {
+        const int32 PointCount = InOutPoints.Num();
+        if (PointCount <= 3)
+        {
+            return;
+        }
+
+        // Split the polygon at its first point and the point farthest from it, then simplify both halves as open lines
+        int32 FarthestIndex = 0;
+        float FarthestDistSquared = -1.f;
+        for (int32 i = 1; i < PointCount; i++)
+        {
+            const float CheckDistSquared = FVector2D::DistSquared(InOutPoints[0], InOutPoints[i]);
+            if (CheckDistSquared > FarthestDistSquared)
+            {
+                FarthestDistSquared = CheckDistSquared;
+                FarthestIndex = i;
+            }
+        }
+
+        TArray<bool> KeptPoints;
+        KeptPoints.SetNumZeroed(PointCount);
+        KeptPoints[0] = true;
+        KeptPoints[FarthestIndex] = true;
+
+        const float ToleranceSquared = FMath::Square(FMath::Max(Tolerance, 0.f));
+        TArray<FIntPoint> Segments;
+        Segments.Add(FIntPoint(0, FarthestIndex));
+        Segments.Add(FIntPoint(FarthestIndex, PointCount));
+        while (Segments.Num() > 0)
+        {
+            const FIntPoint Segment = Segments.Pop(false);
+            const FVector2D& StartPoint = InOutPoints[Segment.X];
+            const FVector2D& EndPoint = InOutPoints[Segment.Y % PointCount];
+
+            int32 SplitIndex = INDEX_NONE;
+            float SplitDistSquared = ToleranceSquared;
+            for (int32 i = Segment.X + 1; i < Segment.Y; i++)
+            {
+                const FVector2D& CheckPoint = InOutPoints[i];
+                const FVector ClosestPoint = FMath::ClosestPointOnSegment(FVector(CheckPoint, 0.f), FVector(StartPoint, 0.f), FVector(EndPoint, 0.f));
+                const float CheckDistSquared = FVector2D::DistSquared(CheckPoint, FVector2D(ClosestPoint));
+                if (CheckDistSquared > SplitDistSquared)
+                {
+                    SplitDistSquared = CheckDistSquared;
+                    SplitIndex = i;
+                }
+            }
+
+            if (SplitIndex != INDEX_NONE)
+            {
+                KeptPoints[SplitIndex] = true;
+                Segments.Add(FIntPoint(Segment.X, SplitIndex));
+                Segments.Add(FIntPoint(SplitIndex, Segment.Y));
+            }
+        }
+
+        int32 KeptCount = 0;
+        for (int32 i = 0; i < PointCount; i++)
+        {
+            if (KeptPoints[i])
+            {
+                InOutPoints[KeptCount++] = InOutPoints[i];
+            }
+        }
+        InOutPoints.SetNum(KeptCount, false);
+    }
+
     //================================== Calculate bounding box ==================================
     // Get the mesh's bound cuboid using axis-aligned bounding box
     FNVCuboidData GetMeshCuboid_AABB(const class UMeshComponent* MeshComp)
@@ -819,16 +1755,14 @@ namespace NVSceneCapturerUtils
         return MeshAACuboid;
     }
 
-    // Get the mesh's object-oriented bounding box cuboid
-    FNVCuboidData GetMeshCuboid_OOBB_Simple(const class UMeshComponent* MeshComp, bool bInWorldSpace/*= true*/, bool bCheckMeshCollision/*= true*/)
+    // Get the bounding box of the mesh in its component's local space
+    FBox GetMeshLocalBounds(const class UMeshComponent* MeshComp, bool bCheckMeshCollision/*= true*/)
     {
-        FNVCuboidData MeshOOCuboid;
+        // The 3d bounding box of the mesh in its local component space
+        FBox LocalOOBB(EForceInit::ForceInitToZero);
 
         if (MeshComp)
         {
-            // The 3d bounding box of the mesh in its local component space
-            FBox LocalOOBB(EForceInit::ForceInitToZero);
-
             const UStaticMeshComponent* StaticMeshComp = Cast<UStaticMeshComponent>(MeshComp);
             if (StaticMeshComp)
             {
@@ -892,7 +1826,19 @@ namespace NVSceneCapturerUtils
                     }
                 }
             }
+        }
+
+        return LocalOOBB;
+    }
 
+    // Get the mesh's object-oriented bounding box cuboid
+    FNVCuboidData GetMeshCuboid_OOBB_Simple(const class UMeshComponent* MeshComp, bool bInWorldSpace/*= true*/, bool bCheckMeshCollision/*= true*/)
+    {
+        FNVCuboidData MeshOOCuboid;
+
+        if (MeshComp)
+        {
+            const FBox LocalOOBB = GetMeshLocalBounds(MeshComp, bCheckMeshCollision);
             if (LocalOOBB.IsValid)
             {
                 const FTransform& MeshCompTransform = bInWorldSpace ? MeshComp->GetComponentTransform() : FTransform::Identity;
@@ -904,71 +1850,189 @@ namespace NVSceneCapturerUtils
         return MeshOOCuboid;
     }
 
-    FNVCuboidData GetMeshCuboid_OOBB_Complex(const class UMeshComponent* MeshComp)
+    // Calculate a tight oriented bounding box of the points
+    FNVOrientedBounds CalculateOrientedBounds(const TArray<FVector>& Points, bool bMinimizeVolume/*= true*/)
     {
-        FNVCuboidData MeshOOCuboid;
+        FNVOrientedBounds OrientedBounds;
+        const int32 PointCount = Points.Num();
+        if (PointCount == 0)
+        {
+            return OrientedBounds;
+        }
 
-        if (MeshComp)
+        // Find the mean point and the covariance matrix
+        // NOTE: The sums are accumulated in double since the meshes can have a lot of vertexes
+        double MeanSum[3] = { 0.0, 0.0, 0.0 };
+        for (const FVector& CheckPoint : Points)
         {
-            // List of the vertexes used to calculate the OOBB
-            TArray<FVector> BoundingVertexes;
-            BoundingVertexes.Reset();
+            MeanSum[0] += CheckPoint.X;
+            MeanSum[1] += CheckPoint.Y;
+            MeanSum[2] += CheckPoint.Z;
+        }
+        const FVector MeanPoint((float)(MeanSum[0] / PointCount), (float)(MeanSum[1] / PointCount), (float)(MeanSum[2] / PointCount));
 
-            const FTransform& MeshTransform = MeshComp->GetComponentTransform();
-            const UStaticMeshComponent* StaticMeshComp = Cast<UStaticMeshComponent>(MeshComp);
-            if (StaticMeshComp)
+        double CovarianceSum[3][3] = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+        for (const FVector& CheckPoint : Points)
+        {
+            const FVector Offset = CheckPoint - MeanPoint;
+            for (int32 i = 0; i < 3; i++)
             {
-                const UStaticMesh* StaticMesh = StaticMeshComp->GetStaticMesh();
-                if (StaticMesh)
+                for (int32 j = i; j < 3; j++)
                 {
-                    // If the static mesh have body setup with its convex collision then use it
-                    if (StaticMesh->BodySetup)
-                    {
-                        const FKAggregateGeom& MeshGeom = StaticMesh->BodySetup->AggGeom;
-                        for (const FKConvexElem& ConvexElem : MeshGeom.ConvexElems)
-                        {
-                            BoundingVertexes.Append(ConvexElem.VertexData);
-                        }
-                    }
-                    // Otherwise use the mesh's raw triangle vertexes
-                    else if (StaticMesh->RenderData)
-                    {
-                        const FPositionVertexBuffer& MeshVertexBuffer = StaticMesh->RenderData->LODResources[0].VertexBuffers.PositionVertexBuffer;
-                        const uint32 VertexesCount = MeshVertexBuffer.GetNumVertices();
-                        BoundingVertexes.Reserve(BoundingVertexes.Num() + VertexesCount);
-                        for (uint32 i = 0; i < VertexesCount; i++)
-                        {
-                            const FVector& VertexPosition = MeshVertexBuffer.VertexPosition(i);
-                            BoundingVertexes.Add(VertexPosition);
-                        }
-                    }
+                    CovarianceSum[i][j] += Offset[i] * Offset[j];
                 }
             }
-            else
+        }
+        float Covariance[3][3];
+        for (int32 i = 0; i < 3; i++)
+        {
+            for (int32 j = i; j < 3; j++)
             {
-                const USkeletalMeshComponent* SkeletalMeshComp = Cast<USkeletalMeshComponent>(MeshComp);
-                const USkeletalMesh* SkeletalMesh = SkeletalMeshComp ? SkeletalMeshComp->SkeletalMesh : nullptr;
-                if (SkeletalMesh)
+                Covariance[i][j] = Covariance[j][i] = (float)(CovarianceSum[i][j] / PointCount);
+            }
+        }
+
+        // The eigenvectors of the covariance matrix are the principal axes, sorted by decreasing variance
+        float EigenVectors[3][3];
+        DiagonalizeSymmetricMatrix(Covariance, EigenVectors);
+        int32 AxisOrder[3] = { 0, 1, 2 };
+        auto SortAxisPair = [&Covariance, &AxisOrder](int32 i, int32 j)
+        {
+            if (Covariance[AxisOrder[i]][AxisOrder[i]] < Covariance[AxisOrder[j]][AxisOrder[j]])
+            {
+                Swap(AxisOrder[i], AxisOrder[j]);
+            }
+        };
+        SortAxisPair(0, 1);
+        SortAxisPair(1, 2);
+        SortAxisPair(0, 1);
+
+        FVector BoxAxes[3];
+        for (int32 i = 0; i < 3; i++)
+        {
+            BoxAxes[i] = FVector(EigenVectors[0][AxisOrder[i]], EigenVectors[1][AxisOrder[i]], EigenVectors[2][AxisOrder[i]]).GetSafeNormal();
+        }
+        // Make sure the axes are orthonormal and right-handed
+        BoxAxes[2] = (BoxAxes[0] ^ BoxAxes[1]).GetSafeNormal();
+        BoxAxes[1] = BoxAxes[2] ^ BoxAxes[0];
+
+        OrientedBounds.MeanPoint = MeanPoint;
+        // NOTE: The sign of an eigenvector is arbitrary, keep the principal axis on the +Z side so it doesn't flip between meshes and runs
+        // (the same direction the power iteration starting from +Z used to converge to)
+        OrientedBounds.PrincipalAxis = ((BoxAxes[0] | FVector::UpVector) >= 0.f) ? BoxAxes[0] : -BoxAxes[0];
+
+        if (bMinimizeVolume)
+        {
+            // The PCA box can be quite loose when the vertexes are not evenly distributed on the mesh's surface
+            // => try to keep each principal axis and rotate the 2 others to the smallest rectangle around the projected points
+            FVector PCAAxes[3] = { BoxAxes[0], BoxAxes[1], BoxAxes[2] };
+            float SmallestVolume = GetPointsBoundsInAxes(Points, PCAAxes).GetVolume();
+
+            TArray<FVector2D> ProjectedPoints;
+            ProjectedPoints.SetNumUninitialized(PointCount);
+            for (int32 FixedAxisIndex = 0; FixedAxisIndex < 3; FixedAxisIndex++)
+            {
+                const FVector& FixedAxis = PCAAxes[FixedAxisIndex];
+                const FVector& AxisU = PCAAxes[(FixedAxisIndex + 1) % 3];
+                const FVector& AxisV = PCAAxes[(FixedAxisIndex + 2) % 3];
+
+                float MinFixed = BIG_NUMBER;
+                float MaxFixed = -BIG_NUMBER;
+                for (int32 i = 0; i < PointCount; i++)
                 {
-                    UPhysicsAsset* MeshPhysicsAsset = SkeletalMesh->PhysicsAsset;
-                    if (MeshPhysicsAsset)
-                    {
-                        // TODO: Collect all the vertexes from the skeletal's body setups
-                        //MeshPhysicsAsset->SkeletalBodySetups
-                    }
-                    else
-                    {
-                        // TODO: Check the skeletal's vertexes location using its render data similar to how we did with the static mesh?
-                    }
+                    const FVector& CheckPoint = Points[i];
+                    ProjectedPoints[i] = FVector2D(CheckPoint | AxisU, CheckPoint | AxisV);
+                    const float FixedValue = CheckPoint | FixedAxis;
+                    MinFixed = FMath::Min(MinFixed, FixedValue);
+                    MaxFixed = FMath::Max(MaxFixed, FixedValue);
                 }
+
+                float RectangleArea = 0.f;
+                const FVector2D RectangleDirection = FindMinAreaRectangleDirection(ProjectedPoints, RectangleArea);
+                const float BoxVolume = RectangleArea * (MaxFixed - MinFixed);
+                if (BoxVolume < SmallestVolume)
+                {
+                    SmallestVolume = BoxVolume;
+                    BoxAxes[FixedAxisIndex] = FixedAxis;
+                    BoxAxes[(FixedAxisIndex + 1) % 3] = AxisU * RectangleDirection.X + AxisV * RectangleDirection.Y;
+                    BoxAxes[(FixedAxisIndex + 2) % 3] = AxisV * RectangleDirection.X - AxisU * RectangleDirection.Y;
+                }
+            }
+        }
+
+        // The principal axes don't keep the direction of the mesh (front-face may be different)
+        // => match each box axis with the closest axis of the points' space so the box keep the same front, right and top sides whenever it can
+        static const int32 AxisPermutations[6][3] = { { 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 } };
+        int32 BestPermutationIndex = 0;
+        float BestAlignment = -1.f;
+        for (int32 PermutationIndex = 0; PermutationIndex < 6; PermutationIndex++)
+        {
+            const int32 (&Permutation)[3] = AxisPermutations[PermutationIndex];
+            const float Alignment = FMath::Abs(BoxAxes[Permutation[0]].X) + FMath::Abs(BoxAxes[Permutation[1]].Y) + FMath::Abs(BoxAxes[Permutation[2]].Z);
+            if (Alignment > BestAlignment)
+            {
+                BestAlignment = Alignment;
+                BestPermutationIndex = PermutationIndex;
             }
+        }
+        const int32 (&BestPermutation)[3] = AxisPermutations[BestPermutationIndex];
+        FVector AlignedAxes[3];
+        AlignedAxes[0] = BoxAxes[BestPermutation[0]];
+        AlignedAxes[0] = (AlignedAxes[0].X < 0.f) ? -AlignedAxes[0] : AlignedAxes[0];
+        AlignedAxes[1] = BoxAxes[BestPermutation[1]];
+        AlignedAxes[1] = (AlignedAxes[1].Y < 0.f) ? -AlignedAxes[1] : AlignedAxes[1];
+        AlignedAxes[2] = AlignedAxes[0] ^ AlignedAxes[1];
+
+        OrientedBounds.Rotation = FQuat(FMatrix(AlignedAxes[0], AlignedAxes[1], AlignedAxes[2], FVector::ZeroVector));
+        OrientedBounds.Box = GetPointsBoundsInAxes(Points, AlignedAxes);
+        return OrientedBounds;
+    }
 
-            if (BoundingVertexes.Num() > 0)
+    // Find the vertexes of the points' convex hull
+    void ComputeConvexHullVertexes(const TArray<FVector>& Points, int32 MaxVertexCount, TArray<FVector>& OutHullVertexes)
+    {
+        OutHullVertexes.Reset();
+
+        // NOTE: The points closer to the hull's faces than the tolerance are treated as inside it
+        const FBox PointsBounds(Points);
+        const float Tolerance = FMath::Max(PointsBounds.GetExtent().GetMax() * 1e-5f, SMALL_NUMBER);
+        FNVQuickHull QuickHull(Points, Tolerance);
+        if (QuickHull.Build(MaxVertexCount))
+        {
+            TArray<int32> HullVertexIndexes;
+            QuickHull.GetHullVertexIndexes(HullVertexIndexes);
+            OutHullVertexes.Reserve(HullVertexIndexes.Num());
+            for (const int32 VertexIndex : HullVertexIndexes)
+            {
+                OutHullVertexes.Add(Points[VertexIndex]);
+            }
+        }
+        else
+        {
+            // The points are flat so they don't have a 3d hull, keep all of them
+            OutHullVertexes = Points;
+        }
+    }
+
+    // Get the mesh's tight object-oriented bounding box cuboid
+    FNVCuboidData GetMeshCuboid_OOBB_Complex(const class UMeshComponent* MeshComp)
+    {
+        FNVCuboidData MeshOOCuboid;
+
+        if (MeshComp)
+        {
+            const UStaticMeshComponent* StaticMeshComp = Cast<UStaticMeshComponent>(MeshComp);
+            const UStaticMesh* StaticMesh = StaticMeshComp ? StaticMeshComp->GetStaticMesh() : nullptr;
+            const FNVOrientedBounds MeshBounds = FNVMeshOrientedBoundsCache::FindOrAdd(StaticMesh);
+            if (MeshBounds.IsValid())
+            {
+                MeshOOCuboid.BuildFromOOBB(MeshBounds.Box, MeshBounds.Rotation, MeshComp->GetComponentTransform());
+            }
+            else
             {
-                // TODO:
-                // NOTE: This 'complex' approach calculate the OOBB base on 'Principal Component Analysis':
-                // http://www.inf.fu-berlin.de/users/rote/Papers/pdf/On+the+bounding+boxes+obtained+by+principal+component+analysis.pdf
-                // We may not want this approach since it doesn't maintain the direction of the cuboid (front-face may be different)
+                // TODO: Calculate the tight bounds of the skeletal meshes too, their vertexes depend on their current pose so they can't be cached per mesh
+                // NOTE: Check all the mesh's vertexes instead of its collision, same as the VE_OOBB bounds
+                MeshOOCuboid = GetMeshCuboid_OOBB_Simple(MeshComp, true, false);
             }
         }
 
@@ -8,6 +8,8 @@
 #include "NVSceneCapturerUtils.h"
 #include "NVSceneCapturerViewpointComponent.h"
 #include "NVSceneFeatureExtractor.h"
+#include "NVSceneFeatureExtractor_ImageExport.h"
+#include "NVSceneFeatureExtractor_DataExport.h"
 #include "NVSceneCapturerActor.h"
 #include "NVSceneManager.h"
 
@@ -33,6 +35,13 @@ UNVSceneCapturerViewpointComponent::UNVSceneCapturerViewpointComponent(const FOb
 #endif
 
     bAutoActivate = true;
+
+    // NOTE: The viewpoint only tick to finish the batched pixels readbacks
+    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.bStartWithTickEnabled = true;
+
+    ExpectedBatchReadbackCount = 0;
+    BatchReadbackFrameNumber = 0;
 }
 
 /*
@@ -111,6 +120,19 @@ const TArray<FNVFeatureExtractorSettings>& UNVSceneCapturerViewpointComponent::G
     return OwnerSceneCapturer->FeatureExtractorSettings;
 }
 
+UNVSceneFeatureExtractor_PixelData* UNVSceneCapturerViewpointComponent::GetInstanceMaskFeatureExtractor() const
+{
+    for (UNVSceneFeatureExtractor* CheckFeatureExtractor : FeatureExtractorList)
+    {
+        UNVSceneFeatureExtractor_VertexColorMask* InstanceMaskFeatureExtractor = Cast<UNVSceneFeatureExtractor_VertexColorMask>(CheckFeatureExtractor);
+        if (InstanceMaskFeatureExtractor && InstanceMaskFeatureExtractor->IsEnabled())
+        {
+            return InstanceMaskFeatureExtractor;
+        }
+    }
+    return nullptr;
+}
+
 bool UNVSceneCapturerViewpointComponent::IsEnabled() const
 {
     return Settings.bIsEnabled;
@@ -124,7 +146,7 @@ FString UNVSceneCapturerViewpointComponent::GetDisplayName() const
 //#miker: 
 /*
 Callback function called after the scene capture component finished capturing scene and read back its pixels data
-FNVTexturePixelData - The struct contain the captured scene's pixels data
+FNVTexturePixelDataRef - Reference to the struct contain the captured scene's pixels data
 UNVSceneFeatureExtractor_PixelData* - Reference to the feature extractor that captured the scene pixels data
 UNVSceneCapturerViewpointComponent* - Reference to the viewpoint that captured the scene pixels data
 */
@@ -141,16 +163,64 @@ bool UNVSceneCapturerViewpointComponent::CaptureSceneToPixelsData(UNVSceneCaptur
     else
     {
         bResults = true;
+
+        const bool bBatchReadback = Settings.bBatchPixelsDataReadback;
+        FNVTextureReader::OnReadbackRequestedCallback BatchReadbackHandler = nullptr;
+        if (bBatchReadback)
+        {
+            BatchReadbackHandler = [this](FNVTextureReadbackRequest& ReadbackRequest)
+            {
+                OnBatchReadbackRequested(ReadbackRequest);
+            };
+            ExpectedBatchReadbackCount = 0;
+        }
+
+        // The annotation feature extractors which complete their data from this frame's instance mask
+        const UNVSceneFeatureExtractor_PixelData* InstanceMaskFeatureExtractor = GetInstanceMaskFeatureExtractor();
+        TArray<TSharedPtr<FNVInstanceMaskQueue, ESPMode::ThreadSafe>> InstanceMaskQueues;
+        if (InstanceMaskFeatureExtractor)
+        {
+            for (auto SceneFeatureExtractor : FeatureExtractorList)
+            {
+                const UNVSceneFeatureExtractor_AnnotationData* FeatureExtractorAnnotationData = Cast<UNVSceneFeatureExtractor_AnnotationData>(SceneFeatureExtractor);
+                const TSharedPtr<FNVInstanceMaskQueue, ESPMode::ThreadSafe> InstanceMaskQueue =
+                    FeatureExtractorAnnotationData ? FeatureExtractorAnnotationData->GetInstanceMaskQueue() : nullptr;
+                if (InstanceMaskQueue.IsValid())
+                {
+                    InstanceMaskQueues.Add(InstanceMaskQueue);
+                }
+            }
+        }
+
         for (auto SceneFeatureExtractor : FeatureExtractorList)
         {
 		    UNVSceneFeatureExtractor_PixelData* FeatureExtractorScenePixels = 
 				Cast<UNVSceneFeatureExtractor_PixelData>(SceneFeatureExtractor);
             if (FeatureExtractorScenePixels)
             {
+                FeatureExtractorScenePixels->SetReadbackRequestHandler(BatchReadbackHandler);
+                if (bBatchReadback)
+                {
+                    ExpectedBatchReadbackCount += FeatureExtractorScenePixels->GetBatchedReadbackCount();
+                }
+
+                // NOTE: The queues are thread-safe, the pixels can be read back on the rendering thread
+                TArray<TSharedPtr<FNVInstanceMaskQueue, ESPMode::ThreadSafe>> MaskQueues;
+                if (FeatureExtractorScenePixels == InstanceMaskFeatureExtractor)
+                {
+                    MaskQueues = InstanceMaskQueues;
+                }
+
+                // The masks are matched with the annotation data captured in the same tick
+                const uint64 CaptureFrameNumber = GFrameCounter;
                 bResults = bResults && FeatureExtractorScenePixels->CaptureSceneToPixelsData(
-                               [this, Callback = ViewpointCallback](const FNVTexturePixelData& CapturedPixelData,
+                               [this, Callback = ViewpointCallback, MaskQueues, CaptureFrameNumber](const FNVTexturePixelDataRef& CapturedPixelData,
 								   UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor)
                 {
+                    for (const auto& MaskQueue : MaskQueues)
+                    {
+                        MaskQueue->AddInstanceMask(CaptureFrameNumber, CapturedPixelData);
+                    }
                     Callback(CapturedPixelData, CapturedFeatureExtractor, this);
                 });
             }
@@ -178,7 +248,7 @@ bool UNVSceneCapturerViewpointComponent::CaptureSceneAnnotationData(UNVSceneCapt
             if (FeatureExtractorAnnotationData)
             {
 				bResults = bResults && FeatureExtractorAnnotationData->CaptureSceneAnnotationData(
-                               [this, Callback = ViewpointCallback](TSharedPtr<FJsonObject> CapturedData, UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor)
+                               [this, Callback = ViewpointCallback](const FNVSceneAnnotationData& CapturedData, UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor)
                 {
                     Callback(CapturedData, CapturedFeatureExtractor, this);
                 });
@@ -201,6 +271,20 @@ void UNVSceneCapturerViewpointComponent::StartCapturing()
 
 void UNVSceneCapturerViewpointComponent::StopCapturing()
 {
+    // NOTE: The last captured frames must be delivered before the feature extractors stop,
+    // the annotation data waiting for their instance mask are dropped when they do
+    FlushPendingReadbacks();
+    for (auto SceneFeatureExtractor : FeatureExtractorList)
+    {
+        const UNVSceneFeatureExtractor_AnnotationData* FeatureExtractorAnnotationData = Cast<UNVSceneFeatureExtractor_AnnotationData>(SceneFeatureExtractor);
+        const TSharedPtr<FNVInstanceMaskQueue, ESPMode::ThreadSafe> InstanceMaskQueue =
+            FeatureExtractorAnnotationData ? FeatureExtractorAnnotationData->GetInstanceMaskQueue() : nullptr;
+        if (InstanceMaskQueue.IsValid())
+        {
+            InstanceMaskQueue->Drain();
+        }
+    }
+
     for (auto SceneFeatureExtractor : FeatureExtractorList)
     {
         if (SceneFeatureExtractor)
@@ -210,6 +294,66 @@ void UNVSceneCapturerViewpointComponent::StopCapturing()
     }
 }
 
+void UNVSceneCapturerViewpointComponent::FlushPendingReadbacks()
+{
+    // Don't leave the last captured frames waiting in the batch
+    SubmitBatchReadback();
+    if (BatchPixelsReader.GetPendingReadbackCount() > 0)
+    {
+        BatchPixelsReader.FlushPendingReadbacks(true);
+    }
+
+    for (auto SceneFeatureExtractor : FeatureExtractorList)
+    {
+        UNVSceneFeatureExtractor_PixelData* FeatureExtractorScenePixels = Cast<UNVSceneFeatureExtractor_PixelData>(SceneFeatureExtractor);
+        if (FeatureExtractorScenePixels)
+        {
+            FeatureExtractorScenePixels->FlushPendingReadbacks();
+        }
+    }
+}
+
+void UNVSceneCapturerViewpointComponent::OnBatchReadbackRequested(FNVTextureReadbackRequest& ReadbackRequest)
+{
+    BatchReadbackRequests.Add(MoveTemp(ReadbackRequest));
+    BatchReadbackFrameNumber = GFrameCounter;
+
+    // NOTE: The scene capture components issue their readback one by one after their capture commands,
+    // the batch can only be read back after the last one so all the captures are rendered before we copy them
+    if (BatchReadbackRequests.Num() >= ExpectedBatchReadbackCount)
+    {
+        SubmitBatchReadback();
+    }
+}
+
+void UNVSceneCapturerViewpointComponent::SubmitBatchReadback()
+{
+    if (BatchReadbackRequests.Num() > 0)
+    {
+        BatchPixelsReader.ReadPixelsDataBatch(BatchReadbackRequests);
+        BatchReadbackRequests.Reset();
+    }
+}
+
+void UNVSceneCapturerViewpointComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    // Some scene capture components didn't capture in the frame the batch was requested, read back the ones which did
+    if ((BatchReadbackRequests.Num() > 0) && (BatchReadbackFrameNumber != GFrameCounter))
+    {
+        UE_LOG(LogNVSceneCapturerViewpointComponent, Verbose, TEXT("Only %d of %d scene capture components requested a batched readback."),
+            BatchReadbackRequests.Num(), ExpectedBatchReadbackCount);
+        SubmitBatchReadback();
+    }
+
+    // Deliver the pixels of the previous batches which the GPU finished copying
+    if (BatchPixelsReader.GetPendingReadbackCount() > 0)
+    {
+        BatchPixelsReader.ProcessPendingReadbacks();
+    }
+}
+
 #if WITH_EDITOR
 bool UNVSceneCapturerViewpointComponent::GetEditorPreviewInfo(float DeltaTime, FMinimalViewInfo& ViewOut)
 {
@@ -243,6 +387,13 @@ void UNVSceneCapturerViewpointComponent::BeginPlay()
 
 void UNVSceneCapturerViewpointComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+    // Make sure all the pixels captured are delivered before the viewpoint goes away
+    SubmitBatchReadback();
+    if (BatchPixelsReader.GetPendingReadbackCount() > 0)
+    {
+        BatchPixelsReader.FlushPendingReadbacks(true);
+    }
+
     Super::EndPlay(EndPlayReason);
 }
 
@@ -405,4 +556,6 @@ FNVSceneCapturerViewpointSettings::FNVSceneCapturerViewpointSettings()
 {
     bIsEnabled = true;
     DisplayName = TEXT("Viewpoint");
+    bBatchPixelsDataReadback = false;
+    bShareSceneCapture = false;
 }
\ No newline at end of file
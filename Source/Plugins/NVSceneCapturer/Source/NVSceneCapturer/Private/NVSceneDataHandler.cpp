@@ -14,6 +14,7 @@
 #include "NVSceneCapturerActor.h"
 #include "NVAnnotatedActor.h"
 #include "NVSceneManager.h"
+#include "NVAnnotationBinaryFormat.h"
 #include "Engine.h"
 #include "JsonObjectConverter.h"
 #if WITH_EDITOR
@@ -26,6 +27,7 @@
 //================================== UNVSceneDataExporter ==================================//
 DEFINE_LOG_CATEGORY(LogNVSceneDataHandler);
 const FString UNVSceneDataExporter::DefaultDataOutputFolder = TEXT("NVCapturedData/");
+const FString UNVSceneDataExporter::DatasetIndexFileName = TEXT("_index.bin");
 
 UNVSceneDataExporter::UNVSceneDataExporter() : Super(),
     ImageWrapperModule(&FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper")))
@@ -36,11 +38,14 @@ UNVSceneDataExporter::UNVSceneDataExporter() : Super(),
     bUseMapNameForCapturedDirectory = true;
     bAutoOpenExportedDirectory = false;
     MaxSaveImageAsyncCount = 100;
+    ImageExporterWorkerCount = 0;
+    bExportDatasetIndex = true;
+    bAnnotationSchemaExported = false;
 }
 
 bool UNVSceneDataExporter::CanHandleMoreData() const
 {
-	return  ImageExporterThread &&
+	return  ImageExporterThread && !ImageExporterThread->IsQueueFull() &&
             ((MaxSaveImageAsyncCount <= 0) || (ImageExporterThread->GetPendingImagesCount() <= MaxSaveImageAsyncCount / 2));
 }
 
@@ -50,11 +55,14 @@ bool UNVSceneDataExporter::IsHandlingData() const
 }
 
 //#miker: export to png
-bool UNVSceneDataExporter::HandleScenePixelsData(const FNVTexturePixelData& CapturedPixelData,
+bool UNVSceneDataExporter::HandleScenePixelsData(const FNVTexturePixelDataRef& CapturedPixelData,
 	UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor,
 	UNVSceneCapturerViewpointComponent* CapturedViewpoint,
-	int32 FrameIndex, int32 PicksetIndex, int32 PicksetSubImage)
+	const FNVCapturedFrameInfo& FrameInfo)
 {
+    const int32 FrameIndex = FrameInfo.FrameIndexForFile;
+    const int32 PicksetIndex = FrameInfo.PicksetIndex;
+    const int32 PicksetSubImage = FrameInfo.PicksetSubImage;
 	bool bResult = false;
 	//FString fe_name = CapturedFeatureExtractor->GetDisplayName();
 	//const FString miker = FString::Printf(TEXT("#mikerdog: handleScenePixelsData1:  %s %d "), *fe_name, CapturedFeatureExtractor->IsEnabled());
@@ -63,12 +71,35 @@ bool UNVSceneDataExporter::HandleScenePixelsData(const FNVTexturePixelData& Capt
 	if (ImageExporterThread && CapturedFeatureExtractor &&
 		CapturedViewpoint && CapturedFeatureExtractor->IsEnabled())
 	{
-		ENVImageFormat ExportImageFormat = ENVImageFormat::PNG;
+		// Each feature extractor can use its own format, e.g: fast JPEG for the colors while the masks stay lossless
+		const ENVImageFormat ExportImageFormat = CapturedFeatureExtractor->GetExportImageFormat();
 
 		const FString NewExportFilePath = GetExportFilePath(CapturedFeatureExtractor, CapturedViewpoint,
 										FrameIndex, PicksetIndex,
 										PicksetSubImage, GetExportImageExtension(ExportImageFormat));
-		ImageExporterThread->ExportImage(CapturedPixelData, NewExportFilePath, ExportImageFormat);
+		// Let the workers save the image themselves so they can add it to the index with its size and checksum
+		// NOTE: The BMP images are passed to the callback uncompressed, with the same bytes as the saved file
+		FNVCompressedImageCallback CompressedImageCallback = nullptr;
+		if (IndexWriter.IsValid())
+		{
+			TSharedPtr<FNVDatasetIndexWriter, ESPMode::ThreadSafe> CurrentIndexWriter = IndexWriter;
+			const FNVDatasetIndexRecord IndexRecord = MakeIndexRecord(CapturedFeatureExtractor, CapturedViewpoint,
+																	  FrameIndex, PicksetIndex, PicksetSubImage,
+																	  GetExportImageExtension(ExportImageFormat),
+																	  ENVDatasetIndexEntryType::Image);
+			CompressedImageCallback = [CurrentIndexWriter, IndexRecord](const FString& ExportFilePath, const TArray<uint8>& CompressedData)
+			{
+				const bool bSaved = FFileHelper::SaveArrayToFile(CompressedData, *ExportFilePath);
+				if (bSaved)
+				{
+					CurrentIndexWriter->AddRecord(IndexRecord, CompressedData.GetData(), CompressedData.Num());
+				}
+				return bSaved;
+			};
+		}
+
+		ImageExporterThread->ExportImage(CapturedPixelData, NewExportFilePath, ExportImageFormat,
+										 CapturedFeatureExtractor->GetCompressionSettings(), CompressedImageCallback);
 		//#miker: what the hell?!?
 		//ImageExporterThread->ExportImage(CapturedPixelData, NewExportFilePath, ExportImageFormat);
 		bResult = true;
@@ -97,24 +128,38 @@ bool UNVSceneDataExporter::HandleScenePixelsData(const FNVTexturePixelData& Capt
     return bResult;
 }
 
-bool UNVSceneDataExporter::HandleSceneAnnotationData(const TSharedPtr<FJsonObject>& CapturedData,
+bool UNVSceneDataExporter::HandleSceneAnnotationData(const FNVSceneAnnotationData& CapturedData,
 	class UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor,
 	class UNVSceneCapturerViewpointComponent* CapturedViewpoint,
-	int32 FrameIndex, int32 PicksetIndex, int32 PicksetSubImage)
+	const FNVCapturedFrameInfo& FrameInfo)
 {
+    const int32 FrameIndex = FrameInfo.FrameIndexForFile;
+    const int32 PicksetIndex = FrameInfo.PicksetIndex;
+    const int32 PicksetSubImage = FrameInfo.PicksetSubImage;
     bool bResult = false;
 	//#miker: added the check if it's enabled
 	// otherwise it *always* dumps the od json...
     if (CapturedFeatureExtractor && CapturedFeatureExtractor->IsEnabled()
 		&& CapturedViewpoint)
     {
-        static const FString JsonExtension = TEXT(".json");
+        ExportAnnotationSchemaIfNeeded(CapturedData);
 
         const FString NewExportFilePath = GetExportFilePath(CapturedFeatureExtractor, CapturedViewpoint,
 													FrameIndex, PicksetIndex,
-													PicksetSubImage, JsonExtension);
-        return NVSceneCapturerUtils::SaveJsonObjectToFile(CapturedData, NewExportFilePath);
-        bResult = true;
+													PicksetSubImage, CapturedData.FileExtension);
+        bResult = FFileHelper::SaveArrayToFile(CapturedData.SerializedData, *NewExportFilePath);
+        if (!bResult)
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("Unable to open file for writing.  Check permissions. File is %s"), *NewExportFilePath);
+        }
+        else if (IndexWriter.IsValid())
+        {
+            FNVDatasetIndexRecord IndexRecord = MakeIndexRecord(CapturedFeatureExtractor, CapturedViewpoint,
+                                                                FrameIndex, PicksetIndex, PicksetSubImage,
+                                                                CapturedData.FileExtension, ENVDatasetIndexEntryType::Annotation);
+            IndexRecord.ObjectCount = CapturedData.ObjectCount;
+            IndexWriter->AddRecord(IndexRecord, CapturedData.SerializedData.GetData(), CapturedData.SerializedData.Num());
+        }
     }
     return bResult;
 }
@@ -137,7 +182,9 @@ void UNVSceneDataExporter::OnStartCapturingSceneData()
 
     if (!ImageExporterThread.IsValid())
     {
-        ImageExporterThread = TUniquePtr<FNVImageExporter_Thread>(new FNVImageExporter_Thread(ImageWrapperModule));
+        ImageExporterThread = TUniquePtr<FNVImageExporter_Thread>(new FNVImageExporter_Thread(ImageWrapperModule,
+                                                                                              ImageExporterWorkerCount,
+                                                                                              MaxSaveImageAsyncCount));
     }
 
     // Prepare the output directory before capturing
@@ -169,6 +216,39 @@ void UNVSceneDataExporter::OnStartCapturingSceneData()
     }
 
     ExportCapturerSettings();
+    bAnnotationSchemaExported = false;
+
+    CloseIndexWriter();
+    if (bExportDatasetIndex)
+    {
+        // NOTE: When the data go to the simulation's directory, each capturing session add its records to the same index
+        const FString IndexFilePath = FPaths::Combine(GetDataOutputDirectoryPath(), DatasetIndexFileName);
+        IndexWriter = MakeShareable(new FNVDatasetIndexWriter(IndexFilePath, m_useBGTargetOverride));
+    }
+}
+
+void UNVSceneDataExporter::CloseIndexWriter()
+{
+    if (IndexWriter.IsValid())
+    {
+        // NOTE: The workers which are still exporting images keep the index alive, it's closed when the last of them release it
+        IndexWriter->Flush();
+        IndexWriter.Reset();
+    }
+}
+
+void UNVSceneDataExporter::ExportAnnotationSchemaIfNeeded(const FNVSceneAnnotationData& CapturedData)
+{
+    if (!bAnnotationSchemaExported && (CapturedData.DataFormat == ENVAnnotationDataFormat::Binary))
+    {
+        const FString SchemaFilePath = FPaths::Combine(GetDataOutputDirectoryPath(), FNVAnnotationBinaryWriter::SchemaFileName);
+        if (!FFileHelper::SaveStringToFile(FNVAnnotationBinaryWriter::GetSchemaText(), *SchemaFilePath))
+        {
+            UE_LOG(LogNVSceneCapturer, Error, TEXT("Unable to open file for writing.  Check permissions. File is %s"), *SchemaFilePath);
+        }
+        // NOTE: Don't retry every frame if the schema can't be written
+        bAnnotationSchemaExported = true;
+    }
 }
 
 void UNVSceneDataExporter::ExportCapturerSettings()
@@ -345,6 +425,7 @@ void UNVSceneDataExporter::OnStopCapturingSceneData()
 	{
 		ImageExporterThread->Stop();
 	}
+	CloseIndexWriter();
 }
 
 void UNVSceneDataExporter::OnCapturingCompleted()
@@ -355,6 +436,8 @@ void UNVSceneDataExporter::OnCapturingCompleted()
     ANVSceneManager* SceneManager = ANVSceneManager::GetANVSceneManagerPtr();
     const bool bIsSceneCompleted = !SceneManager || SceneManager->GetState() == ENVSceneManagerState::Captured;
 
+    CloseIndexWriter();
+
     if (bIsSceneCompleted && bAutoOpenExportedDirectory)
     {
         // Open the output path when the capturing process is completed
@@ -438,8 +521,47 @@ FString UNVSceneDataExporter::GetExportFilePath(UNVSceneFeatureExtractor* Captur
 
 	FString fe_name = CapturedFeatureExtractor->GetDisplayName();
 	
-    const FString OutputFolderPath = GetFullOutputDirectoryPath();
     FString OutputFileName = FString::Printf(TEXT("%06i.%06i.%06i"), FrameIndex,PicksetIndex, PicksetSubImage);
+    OutputFileName += GetExportFileNamePostfix(CapturedFeatureExtractor, CapturedViewpoint);
+
+    OutputFileName += FileExtension;
+
+	const FString ExportFilePath = FPaths::Combine(GetDataOutputDirectoryPath(), OutputFileName);
+    return ExportFilePath;
+}
+
+FString UNVSceneDataExporter::GetDataOutputDirectoryPath() const
+{
+	//#miker: sim reconstruction step,
+	// target should NOT be the scene capturers folder
+	return m_useBGTargetOverride ? m_simulationSave : GetFullOutputDirectoryPath();
+}
+
+FNVDatasetIndexRecord UNVSceneDataExporter::MakeIndexRecord(UNVSceneFeatureExtractor* CapturedFeatureExtractor,
+        UNVSceneCapturerViewpointComponent* CapturedViewpoint,
+        int32 FrameIndex, int32 PicksetIndex, int32 PicksetSubImage,
+        const FString& FileExtension, ENVDatasetIndexEntryType EntryType) const
+{
+    FNVDatasetIndexRecord IndexRecord;
+    IndexRecord.FrameIndex = FrameIndex;
+    IndexRecord.PicksetIndex = PicksetIndex;
+    IndexRecord.PicksetSubImage = PicksetSubImage;
+    IndexRecord.EntryType = (uint16)EntryType;
+
+    ensure(IndexWriter.IsValid());
+    if (IndexWriter.IsValid() && CapturedFeatureExtractor && CapturedViewpoint)
+    {
+        IndexRecord.ViewpointNameId = IndexWriter->GetNameId(CapturedViewpoint->GetDisplayName());
+        IndexRecord.FeatureExtractorNameId = IndexWriter->GetNameId(CapturedFeatureExtractor->GetDisplayName());
+        IndexRecord.FileNamePostfixId = IndexWriter->GetNameId(GetExportFileNamePostfix(CapturedFeatureExtractor, CapturedViewpoint) + FileExtension);
+    }
+    return IndexRecord;
+}
+
+FString UNVSceneDataExporter::GetExportFileNamePostfix(UNVSceneFeatureExtractor* CapturedFeatureExtractor,
+        UNVSceneCapturerViewpointComponent* CapturedViewpoint) const
+{
+    FString OutputFileName;
     const auto& ViewpointSettings = CapturedViewpoint->GetSettings();
     if (!ViewpointSettings.ExportFileNamePostfix.IsEmpty())
     {
@@ -473,18 +595,143 @@ FString UNVSceneDataExporter::GetExportFilePath(UNVSceneFeatureExtractor* Captur
 	//	GLog->Log(miker);
 	//}
 
-    OutputFileName += FileExtension;
+    return OutputFileName;
+}
+
+//=================================== UNVSceneDataShardExporter ===================================
+UNVSceneDataShardExporter::UNVSceneDataShardExporter() : Super()
+{
+    ShardNamePrefix = TEXT("shard");
+    MaxShardSizeMB = 1024;
+    FlushEveryNumEntries = 256;
+}
 
-	FString ExportFilePath = FPaths::Combine(OutputFolderPath, OutputFileName);
+bool UNVSceneDataShardExporter::HandleScenePixelsData(const FNVTexturePixelDataRef& CapturedPixelData,
+    UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor,
+    UNVSceneCapturerViewpointComponent* CapturedViewpoint,
+    const FNVCapturedFrameInfo& FrameInfo)
+{
+    const int32 FrameIndex = FrameInfo.FrameIndexForFile;
+    const int32 PicksetIndex = FrameInfo.PicksetIndex;
+    const int32 PicksetSubImage = FrameInfo.PicksetSubImage;
+    bool bResult = false;
+    if (ImageExporterThread && ShardWriter.IsValid() && CapturedFeatureExtractor &&
+        CapturedViewpoint && CapturedFeatureExtractor->IsEnabled())
+    {
+        // NOTE: The shards only store compressed images, the BMP images are compressed to PNG instead
+        const ENVImageFormat FeatureExtractorImageFormat = CapturedFeatureExtractor->GetExportImageFormat();
+        const ENVImageFormat ExportImageFormat = (FeatureExtractorImageFormat == ENVImageFormat::BMP) ? ENVImageFormat::PNG : FeatureExtractorImageFormat;
+        const FString EntryName = GetShardEntryName(CapturedFeatureExtractor, CapturedViewpoint,
+                                                    FrameIndex, PicksetIndex, PicksetSubImage,
+                                                    GetExportImageExtension(ExportImageFormat));
+
+        const FNVDatasetIndexRecord IndexRecord = IndexWriter.IsValid() ?
+            MakeIndexRecord(CapturedFeatureExtractor, CapturedViewpoint, FrameIndex, PicksetIndex, PicksetSubImage,
+                            GetExportImageExtension(ExportImageFormat), ENVDatasetIndexEntryType::Image) :
+            FNVDatasetIndexRecord();
+
+        // The workers compress the image then append it to the shard instead of saving it to its own file
+        TSharedPtr<FNVDatasetShardWriter, ESPMode::ThreadSafe> CurrentShardWriter = ShardWriter;
+        TSharedPtr<FNVDatasetIndexWriter, ESPMode::ThreadSafe> CurrentIndexWriter = IndexWriter;
+        bResult = ImageExporterThread->ExportImage(CapturedPixelData, EntryName, ExportImageFormat,
+                                                   CapturedFeatureExtractor->GetCompressionSettings(),
+                                                   [CurrentShardWriter, CurrentIndexWriter, IndexRecord](const FString& CompressedEntryName, const TArray<uint8>& CompressedData)
+                                                   {
+                                                       FNVDatasetIndexRecord EntryIndexRecord = IndexRecord;
+                                                       const bool bAdded = CurrentShardWriter->AddEntry(CompressedEntryName, CompressedData,
+                                                                                                        &EntryIndexRecord.ShardIndex, &EntryIndexRecord.DataOffset);
+                                                       if (bAdded && CurrentIndexWriter.IsValid())
+                                                       {
+                                                           CurrentIndexWriter->AddRecord(EntryIndexRecord, CompressedData.GetData(), CompressedData.Num());
+                                                       }
+                                                       return bAdded;
+                                                   });
+    }
+    return bResult;
+}
 
-	//#miker: sim reconstruction step,
-	// target should NOT be the scene capturers folder
-	if (m_useBGTargetOverride)
-	{
-		ExportFilePath = FPaths::Combine(m_simulationSave, OutputFileName);
-	}
-    
-    return ExportFilePath;
+bool UNVSceneDataShardExporter::HandleSceneAnnotationData(const FNVSceneAnnotationData& CapturedData,
+    class UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor,
+    class UNVSceneCapturerViewpointComponent* CapturedViewpoint,
+    const FNVCapturedFrameInfo& FrameInfo)
+{
+    const int32 FrameIndex = FrameInfo.FrameIndexForFile;
+    const int32 PicksetIndex = FrameInfo.PicksetIndex;
+    const int32 PicksetSubImage = FrameInfo.PicksetSubImage;
+    bool bResult = false;
+    if (ShardWriter.IsValid() && CapturedFeatureExtractor && CapturedFeatureExtractor->IsEnabled() && CapturedViewpoint)
+    {
+        ExportAnnotationSchemaIfNeeded(CapturedData);
+
+        const FString EntryName = GetShardEntryName(CapturedFeatureExtractor, CapturedViewpoint,
+                                                    FrameIndex, PicksetIndex, PicksetSubImage, CapturedData.FileExtension);
+        const TArray<uint8>& SerializedData = CapturedData.SerializedData;
+
+        FNVDatasetIndexRecord IndexRecord = IndexWriter.IsValid() ?
+            MakeIndexRecord(CapturedFeatureExtractor, CapturedViewpoint, FrameIndex, PicksetIndex, PicksetSubImage,
+                            CapturedData.FileExtension, ENVDatasetIndexEntryType::Annotation) :
+            FNVDatasetIndexRecord();
+        bResult = ShardWriter->AddEntry(EntryName, SerializedData, &IndexRecord.ShardIndex, &IndexRecord.DataOffset);
+        if (bResult && IndexWriter.IsValid())
+        {
+            IndexRecord.ObjectCount = CapturedData.ObjectCount;
+            IndexWriter->AddRecord(IndexRecord, SerializedData.GetData(), SerializedData.Num());
+        }
+    }
+    return bResult;
+}
+
+void UNVSceneDataShardExporter::OnStartCapturingSceneData()
+{
+    // Finish the shards of the previous session before the output directory is prepared again
+    CloseShardWriter();
+
+    Super::OnStartCapturingSceneData();
+
+    const FString ShardDirectoryPath = GetDataOutputDirectoryPath();
+    const int64 MaxShardSize = int64(FMath::Max(MaxShardSizeMB, 0)) * 1024 * 1024;
+    ShardWriter = MakeShareable(new FNVDatasetShardWriter(ShardDirectoryPath, ShardNamePrefix, MaxShardSize, FlushEveryNumEntries));
+}
+
+void UNVSceneDataShardExporter::OnStopCapturingSceneData()
+{
+    // NOTE: Stopping the image exporter doesn't drop the queued images, they are still added to the shard before it's closed
+    Super::OnStopCapturingSceneData();
+    CloseShardWriter();
+}
+
+void UNVSceneDataShardExporter::OnCapturingCompleted()
+{
+    CloseShardWriter();
+    Super::OnCapturingCompleted();
+}
+
+void UNVSceneDataShardExporter::CloseShardWriter()
+{
+    if (!ShardWriter.IsValid())
+    {
+        return;
+    }
+
+    if (ImageExporterThread)
+    {
+        ImageExporterThread->WaitForPendingImages();
+    }
+
+    ShardWriter->Close();
+    ShardWriter.Reset();
+}
+
+FString UNVSceneDataShardExporter::GetShardEntryName(UNVSceneFeatureExtractor* CapturedFeatureExtractor,
+        UNVSceneCapturerViewpointComponent* CapturedViewpoint,
+        int32 FrameIndex, int32 PicksetIndex, int32 PicksetSubImage,
+        const FString& FileExtension) const
+{
+    // NOTE: WebDataset use everything before the first '.' as the sample's key so the frame indexes are joined with '_' instead
+    FString EntryName = FString::Printf(TEXT("%06i_%06i_%06i"), FrameIndex, PicksetIndex, PicksetSubImage);
+    EntryName += GetExportFileNamePostfix(CapturedFeatureExtractor, CapturedViewpoint);
+    EntryName += FileExtension;
+    return EntryName;
 }
 
 //=================================== UNVSceneDataVisualizer ===================================
@@ -534,10 +781,10 @@ bool UNVSceneDataVisualizer::IsHandlingData() const
     return false;
 }
 
-bool UNVSceneDataVisualizer::HandleScenePixelsData(const FNVTexturePixelData& CapturedPixelData,
+bool UNVSceneDataVisualizer::HandleScenePixelsData(const FNVTexturePixelDataRef& CapturedPixelData,
 	UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor,
 	UNVSceneCapturerViewpointComponent* CapturedViewpoint, 
-	int32 FrameIndex, int32 PicksetIndex, int32 PicksetSubImage)
+	const FNVCapturedFrameInfo& FrameInfo)
 {
     if (!CapturedFeatureExtractor || !CapturedViewpoint)
     {
@@ -549,10 +796,10 @@ bool UNVSceneDataVisualizer::HandleScenePixelsData(const FNVTexturePixelData& Ca
     return true;
 }
 
-bool UNVSceneDataVisualizer::HandleSceneAnnotationData(const TSharedPtr<FJsonObject>& CapturedData,
+bool UNVSceneDataVisualizer::HandleSceneAnnotationData(const FNVSceneAnnotationData& CapturedData,
 	class UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor,
 	class UNVSceneCapturerViewpointComponent* CapturedViewpoint, 
-	int32 FrameIndex, int32 PicksetIndex, int32 PicksetSubImage)
+	const FNVCapturedFrameInfo& FrameInfo)
 {
     // TODO: Need to handle general data, annotation, not just the pixels data
     return false;
@@ -7,6 +7,8 @@
 #include "NVSceneCapturerModule.h"
 #include "NVSceneCapturerUtils.h"
 #include "NVSceneFeatureExtractor_DataExport.h"
+#include "NVJsonWriter.h"
+#include "NVAnnotationBinaryFormat.h"
 #include "NVSceneCapturerActor.h"
 #include "NVSceneCaptureComponent2D.h"
 #include "NVAnnotatedActor.h"
@@ -23,10 +25,13 @@
 #include "PhysicsEngine/BodySetup.h"
 #include "PhysicsEngine/PhysicsAsset.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "Async/ParallelFor.h"
+#include "Async/Async.h"
 
 //========================================== UNVSceneFeatureExtractor_DataExport ==========================================
 UNVSceneFeatureExtractor_AnnotationData::UNVSceneFeatureExtractor_AnnotationData(const FObjectInitializer& ObjectInitializer)
-    : Super(ObjectInitializer)
+    : Super(ObjectInitializer),
+    bAnalyzeInstanceMask(false)
 {
     Description = TEXT("Calculate the annotation data of the objects in the scene, e.g: location, rotation, bounding box ...");
 }
@@ -35,6 +40,29 @@ void UNVSceneFeatureExtractor_AnnotationData::StartCapturing()
 {
     Super::StartCapturing();
     ProtectedDataExportSettings = DataExportSettings;
+
+    InstanceMaskQueue.Reset();
+    if (ProtectedDataExportSettings.UseInstanceMask())
+    {
+        InstanceMaskQueue = MakeShareable(new FNVInstanceMaskQueue());
+        if (!OwnerViewpoint || !OwnerViewpoint->GetInstanceMaskFeatureExtractor())
+        {
+            UE_LOG(LogNVSceneCapturer, Warning, TEXT("%s calculate some of its data from the instance mask but its viewpoint doesn't capture it, the traced visibility and the projected bounding box are exported instead."),
+                   *GetDisplayName());
+        }
+    }
+}
+
+void UNVSceneFeatureExtractor_AnnotationData::StopCapturing()
+{
+    Super::StopCapturing();
+
+    // NOTE: The viewpoint drain the queue before stopping its feature extractors, what's left can't be completed anymore
+    if (InstanceMaskQueue.IsValid())
+    {
+        InstanceMaskQueue->Reset();
+        InstanceMaskQueue.Reset();
+    }
 }
 
 void UNVSceneFeatureExtractor_AnnotationData::UpdateSettings()
@@ -49,72 +77,206 @@ bool UNVSceneFeatureExtractor_AnnotationData::CaptureSceneAnnotationData(UNVScen
 {
     if (Callback)
     {
-        TSharedPtr<FJsonObject> CapturedData = CaptureSceneAnnotationData();
-        if (CapturedData.IsValid())
+        // The viewpoint already requested this frame's instance mask if any data is calculated from it
+        bAnalyzeInstanceMask = ShouldAnalyzeInstanceMask();
+        const bool bWaitForInstanceMask = bAnalyzeInstanceMask;
+
+        FCapturedSceneData SceneData;
+        const bool bGatheredSceneData = GatherSceneData(SceneData);
+        bAnalyzeInstanceMask = false;
+
+        if (bGatheredSceneData)
         {
-            Callback(CapturedData, this);
+            if (bWaitForInstanceMask)
+            {
+                // The data is serialized and handed to the callback once it's completed from the mask
+                // NOTE: The viewpoint tag the mask with the same frame, both are captured in the same tick
+                FNVPendingInstanceMaskFramePtr PendingFrame = MakeShareable(new FNVPendingInstanceMaskFrame());
+                PendingFrame->FrameNumber = GFrameCounter;
+                PendingFrame->SceneData = MoveTemp(SceneData);
+                PendingFrame->DataFormat = ProtectedDataExportSettings.AnnotationDataFormat;
+                PendingFrame->AnalysisOptions = GetInstanceMaskAnalysisOptions();
+                PendingFrame->FeatureExtractor = this;
+                PendingFrame->Callback = Callback;
+                InstanceMaskQueue->AddFrame(PendingFrame);
+                return true;
+            }
+
+            // Encode the data straight to the reused buffer instead of building a FJsonObject tree then converting it to string
+            // NOTE: NVSceneCapturer.JsonWriter.Benchmark measure how fast the objects are serialized
+            SerializeSceneData(SceneData, ProtectedDataExportSettings.AnnotationDataFormat, CapturedAnnotationData);
+
+            Callback(CapturedAnnotationData, this);
             return true;
         }
     }
     return false;
 }
 
+TSharedPtr<FNVInstanceMaskQueue, ESPMode::ThreadSafe> UNVSceneFeatureExtractor_AnnotationData::GetInstanceMaskQueue() const
+{
+    return ShouldAnalyzeInstanceMask() ? InstanceMaskQueue : nullptr;
+}
+
+bool UNVSceneFeatureExtractor_AnnotationData::ShouldAnalyzeInstanceMask() const
+{
+    return InstanceMaskQueue.IsValid() && OwnerViewpoint && OwnerViewpoint->GetInstanceMaskFeatureExtractor();
+}
+
+FNVInstanceMaskAnalysisOptions UNVSceneFeatureExtractor_AnnotationData::GetInstanceMaskAnalysisOptions() const
+{
+    FNVInstanceMaskAnalysisOptions AnalysisOptions;
+    AnalysisOptions.bMeasureVisibility = ProtectedDataExportSettings.bComputeVisibilityFromInstanceMask;
+    AnalysisOptions.bCalculateBoundingBox = (ProtectedDataExportSettings.BoundingBox2dType == ENVBoundBox2dGenerationType::FromInstanceMask);
+    AnalysisOptions.bEncodeRLE = ProtectedDataExportSettings.bExportInstanceMaskRLE;
+    AnalysisOptions.bTracePolygons = ProtectedDataExportSettings.bExportInstanceMaskPolygons;
+    AnalysisOptions.PolygonSimplificationTolerance = ProtectedDataExportSettings.PolygonSimplificationTolerance;
+    AnalysisOptions.bExportImageCoordinateInPixel = ProtectedDataExportSettings.bExportImageCoordinateInPixel;
+    return AnalysisOptions;
+}
+
+void UNVSceneFeatureExtractor_AnnotationData::SerializeSceneData(const FCapturedSceneData& SceneData, ENVAnnotationDataFormat DataFormat,
+        FNVSceneAnnotationData& OutAnnotationData)
+{
+    static const FString JsonExtension = TEXT(".json");
+
+    OutAnnotationData.DataFormat = DataFormat;
+    if (DataFormat == ENVAnnotationDataFormat::Binary)
+    {
+        FNVAnnotationBinaryWriter::SerializeCapturedSceneData(SceneData, OutAnnotationData.SerializedData);
+        OutAnnotationData.FileExtension = FNVAnnotationBinaryWriter::FileExtension;
+    }
+    else
+    {
+        FNVJsonWriter::SerializeCapturedSceneData(SceneData, OutAnnotationData.SerializedData);
+        OutAnnotationData.FileExtension = JsonExtension;
+    }
+    OutAnnotationData.ObjectCount = SceneData.Objects.Num();
+}
+
+void UNVSceneFeatureExtractor_AnnotationData::FinishPendingInstanceMaskFrame(const FNVPendingInstanceMaskFrame& Frame)
+{
+    check(IsInGameThread());
+
+    if (Frame.Callback)
+    {
+        Frame.Callback(Frame.AnnotationData, this);
+    }
+}
+
 TSharedPtr<FJsonObject> UNVSceneFeatureExtractor_AnnotationData::CaptureSceneAnnotationData()
 {
     TSharedPtr<FJsonObject> SceneDataJsonObj = nullptr;
-    if (OwnerViewpoint)
+    FCapturedSceneData SceneData;
+    if (GatherSceneData(SceneData))
     {
-        const auto& CapturerSettings = OwnerViewpoint->GetCapturerSettings();
-        const float FOVAngle = CapturerSettings.GetFOVAngle();
-        const FTransform& ViewTransform = OwnerViewpoint->GetComponentTransform();
+        SceneDataJsonObj = NVSceneCapturerUtils::CapturedSceneDataToJsonObject(SceneData);
+    }
+    return SceneDataJsonObj;
+}
 
-        FCapturedSceneData SceneData;
+bool UNVSceneFeatureExtractor_AnnotationData::GatherSceneData(FCapturedSceneData& OutSceneData)
+{
+    if (!OwnerViewpoint)
+    {
+        return false;
+    }
 
-        FCapturedViewpointData& ViewpointData = SceneData.camera_data;
-        const FVector& ViewLocation = ViewTransform.GetLocation();
-        const FQuat& ViewRotation = ViewTransform.GetRotation();
-        ViewpointData.fov = FOVAngle;
-        ViewpointData.location_worldframe = ViewLocation;
-        ViewpointData.quaternion_xyzw_worldframe = ViewRotation;
-        ViewpointData.CameraSettings = CapturerSettings.GetCameraIntrinsicSettings();
-
-        UpdateProjectionMatrix();
-        ViewpointData.ProjectionMatrix = ProjectionMatrix;
-        ViewpointData.ViewProjectionMatrix = ViewProjectionMatrix;
-
-        UWorld* World = GetWorld();
-        ensure(World);
-        if (World)
-        {
-            // TODO: Should create a TrainingActor class to handle actors we want to export
-            // Let those actor register with the exporter so we don't need to do a loop through all the actor like this every time we export
-            // NOTE: Can keep 1 relevant actor list on the exporter actor and all the exporter components can use it too
-            for (TActorIterator<AActor> ActorIt(World); ActorIt; ++ActorIt)
+    const auto& CapturerSettings = OwnerViewpoint->GetCapturerSettings();
+    const float FOVAngle = CapturerSettings.GetFOVAngle();
+    const FTransform& ViewTransform = OwnerViewpoint->GetComponentTransform();
+
+    FCapturedViewpointData& ViewpointData = OutSceneData.camera_data;
+    const FVector& ViewLocation = ViewTransform.GetLocation();
+    const FQuat& ViewRotation = ViewTransform.GetRotation();
+    ViewpointData.fov = FOVAngle;
+    ViewpointData.location_worldframe = ViewLocation;
+    ViewpointData.quaternion_xyzw_worldframe = ViewRotation;
+    ViewpointData.CameraSettings = CapturerSettings.GetCameraIntrinsicSettings();
+
+    UpdateProjectionMatrix();
+    ViewpointData.ProjectionMatrix = ProjectionMatrix;
+    ViewpointData.ViewProjectionMatrix = ViewProjectionMatrix;
+
+    OutSceneData.Objects.Reset();
+    UWorld* World = GetWorld();
+    ensure(World);
+    if (World)
+    {
+        // TODO: Should create a TrainingActor class to handle actors we want to export
+        // Let those actor register with the exporter so we don't need to do a loop through all the actor like this every time we export
+        // NOTE: Can keep 1 relevant actor list on the exporter actor and all the exporter components can use it too
+        // The actors' geometry is looked up (and rebuilt if it changed) on the game thread, the worker threads only read it
+        FNVActorGeometryCache* GeometryCache = FNVActorGeometryCache::Get(World);
+        TArray<const AActor*> FilteredActors;
+        TArray<FBoxSphereBounds> FilteredBounds;
+        for (TActorIterator<AActor> ActorIt(World); ActorIt; ++ActorIt)
+        {
+            const AActor* CheckActor = *ActorIt;
+            // Reject the actors which can't be exported (hidden, untagged, no mesh...) before touching their components' bounds
+            const TSharedPtr<const FNVActorGeometryRecord> ActorGeometry = (CheckActor && GeometryCache) ? GeometryCache->FindOrAddRecord(CheckActor, false) : nullptr;
+            if (ActorGeometry.IsValid() && PassesActorFilters(CheckActor, *ActorGeometry))
             {
-                const AActor* CheckActor = *ActorIt;
-                FCapturedObjectData ActorData;
-                if (GatherActorData(CheckActor, ActorData))
+                FilteredActors.Add(CheckActor);
+                FilteredBounds.Add(FBoxSphereBounds(CheckActor->GetComponentsBoundingBox(true)));
+            }
+        }
+
+        // Cull the packed bounds against the viewpoint's frustum in one pass, only the surviving actors need their hull geometry
+        TArray<const AActor*> CandidateActors;
+        TArray<TSharedPtr<const FNVActorGeometryRecord>> CandidateGeometryList;
+        for (int32 FilteredIndex = 0; FilteredIndex < FilteredActors.Num(); FilteredIndex++)
+        {
+            if (ShouldExportActorBounds(FilteredBounds[FilteredIndex]))
+            {
+                const AActor* CheckActor = FilteredActors[FilteredIndex];
+                CandidateActors.Add(CheckActor);
+                CandidateGeometryList.Add(GeometryCache->FindOrAddRecord(CheckActor, true));
+            }
+        }
+
+        // Calculate the tight bounds of the meshes which weren't used before all at once instead of in each actor's task
+        if (ProtectedDataExportSettings.BoundsType == ENVBoundsGenerationType::VE_TightOOBB)
+        {
+            TArray<const UStaticMesh*> CandidateMeshes;
+            for (const TSharedPtr<const FNVActorGeometryRecord>& CandidateGeometry : CandidateGeometryList)
+            {
+                const FNVMeshGeometry* PrimaryMesh = CandidateGeometry->GetPrimaryMesh();
+                const UStaticMesh* PrimaryStaticMesh = PrimaryMesh ? Cast<const UStaticMesh>(PrimaryMesh->MeshAsset.Get()) : nullptr;
+                if (PrimaryStaticMesh)
                 {
-                    SceneData.Objects.Add(ActorData);
+                    CandidateMeshes.AddUnique(PrimaryStaticMesh);
                 }
             }
+            FNVMeshOrientedBoundsCache::Prefetch(CandidateMeshes);
         }
 
-        SceneDataJsonObj = NVSceneCapturerUtils::UStructToJsonObject(SceneData, 0, 0);
-        // TODO: This code is a bit messy. Should implement a ToJsonObject function in the FCapturedSceneData struct
-        for (int i = 0; i < SceneData.Objects.Num(); i++)
+        // The math and the scene queries of each actor are independent so they are done in parallel,
+        // each actor only write to its own slot so the objects are still merged in the actor iteration order
+        const int32 CandidateCount = CandidateActors.Num();
+        TArray<FCapturedObjectData> CandidateDataList;
+        CandidateDataList.SetNum(CandidateCount);
+        TArray<bool> CandidateValidList;
+        CandidateValidList.Init(false, CandidateCount);
+        const bool bForceSingleThread = !ProtectedDataExportSettings.bGatherActorDataInParallel || (CandidateCount <= 1);
+        ParallelFor(CandidateCount, [&](int32 CandidateIndex)
         {
-            const FCapturedObjectData& CheckObjectData = SceneData.Objects[i];
-            const TArray< TSharedPtr<FJsonValue> >& JsonObjectArrayData = SceneDataJsonObj->GetArrayField(TEXT("objects"));
-            const TSharedPtr<FJsonObject>& JsonObjectData = JsonObjectArrayData[i]->AsObject();
-            const TSharedPtr<FJsonObject>& CustomDataJsonObj = CheckObjectData.custom_data;
-            if (CustomDataJsonObj.IsValid() && JsonObjectData.IsValid())
+            CandidateValidList[CandidateIndex] = GatherActorData_AnyThread(CandidateActors[CandidateIndex], *CandidateGeometryList[CandidateIndex],
+                                                                           CandidateDataList[CandidateIndex]);
+        }, bForceSingleThread);
+
+        OutSceneData.Objects.Reserve(CandidateCount);
+        for (int32 CandidateIndex = 0; CandidateIndex < CandidateCount; CandidateIndex++)
+        {
+            if (CandidateValidList[CandidateIndex])
             {
-                JsonObjectData->SetObjectField(TEXT("custom_data"), CustomDataJsonObj);
+                FCapturedObjectData& ActorData = CandidateDataList[CandidateIndex];
+                GatherActorData_GameThread(CandidateActors[CandidateIndex], ActorData);
+                OutSceneData.Objects.Add(MoveTemp(ActorData));
             }
         }
     }
-    return SceneDataJsonObj;
+    return true;
 }
 
 void UNVSceneFeatureExtractor_AnnotationData::UpdateProjectionMatrix()
@@ -139,16 +301,63 @@ void UNVSceneFeatureExtractor_AnnotationData::UpdateProjectionMatrix()
         {
             ViewProjectionMatrix = UNVSceneCaptureComponent2D::BuildViewProjectionMatrix(ViewTransform, CaptureImageSize, ProjectionMode, FOVAngle, OrthoWidth, ProjectionMatrix);
         }
+
+        // The frustum planes only change with the view so they are built once here instead of for every actor
+        GetViewFrustumBounds(ViewFrustum, ViewProjectionMatrix, true);
     }
 }
 
 bool UNVSceneFeatureExtractor_AnnotationData::GatherActorData(const AActor* CheckActor, FCapturedObjectData& ActorData)
 {
-    if (!OwnerViewpoint || !CheckActor || !ShouldExportActor(CheckActor))
+    if (!OwnerViewpoint || !CheckActor)
+    {
+        return false;
+    }
+
+    const TSharedPtr<const FNVActorGeometryRecord> ActorGeometry = FNVActorGeometryCache::FindOrAddActorRecord(CheckActor, true);
+    if (!ActorGeometry.IsValid() || !ShouldExportActor(CheckActor, *ActorGeometry))
     {
         return false;
     }
 
+    if (!GatherActorData_AnyThread(CheckActor, *ActorGeometry, ActorData))
+    {
+        return false;
+    }
+    GatherActorData_GameThread(CheckActor, ActorData);
+    return true;
+}
+
+void UNVSceneFeatureExtractor_AnnotationData::GatherActorData_GameThread(const AActor* CheckActor, FCapturedObjectData& ActorData) const
+{
+    ActorData.rgba.Init(0, 4);
+
+    //#miker:
+    ANVSceneManager* NVSceneManagerPtr = ANVSceneManager::GetANVSceneManagerPtr();
+    if (NVSceneManagerPtr)
+    {
+        ActorData.instance_id = NVSceneManagerPtr->ObjectInstanceSegmentation.GetInstanceId(CheckActor);
+        const FColor& MaskVertexColor = NVSceneCapturerUtils::ConvertInt32ToVertexColor(ActorData.instance_id);
+        ActorData.rgba[0] = MaskVertexColor.R;
+        ActorData.rgba[1] = MaskVertexColor.G;
+        ActorData.rgba[2] = MaskVertexColor.B;
+        ActorData.rgba[3] = MaskVertexColor.A;
+    }
+    else
+    {
+        ActorData.instance_id = 0;
+    }
+
+    // NOTE: The custom data is implemented by the annotated actor's sub classes so we can't expect it to be thread-safe
+    const ANVAnnotatedActor* AnnotatedActor = Cast<ANVAnnotatedActor>(CheckActor);
+    if (AnnotatedActor)
+    {
+        ActorData.custom_data = AnnotatedActor->GetCustomAnnotatedData();
+    }
+}
+
+bool UNVSceneFeatureExtractor_AnnotationData::GatherActorData_AnyThread(const AActor* CheckActor, const FNVActorGeometryRecord& ActorGeometry, FCapturedObjectData& ActorData) const
+{
     const FString& ObjectName = CheckActor->GetName();
 
     UWorld* World = GetWorld();
@@ -176,29 +385,11 @@ bool UNVSceneFeatureExtractor_AnnotationData::GatherActorData(const AActor* Chec
         ActorData.location_worldspace = NVSceneCapturerUtils::UE4ToOpenCVMatrix.TransformPosition(ActorLocation);
         ActorData.location = WorldToCameraMatrix_OpenCV.TransformPosition(ActorLocation);
 
-        const UNVCapturableActorTag* Tag = Cast<UNVCapturableActorTag>(CheckActor->GetComponentByClass(UNVCapturableActorTag::StaticClass()));
+        const UNVCapturableActorTag* Tag = ActorGeometry.Tag.Get();
         // Fill in actor's data
         ActorData.Name = ObjectName;
         ActorData.Class = Tag ? Tag->Tag : ObjectName;
-        ANVSceneManager* NVSceneManagerPtr = ANVSceneManager::GetANVSceneManagerPtr();
 
-		for (int i = 0; i < 4; ++i)
-			ActorData.rgba.Add(0);
-
-		//#miker:
-        if (NVSceneManagerPtr)
-        {
-            ActorData.instance_id = NVSceneManagerPtr->ObjectInstanceSegmentation.GetInstanceId(CheckActor);
-			const FColor& MaskVertexColor = NVSceneCapturerUtils::ConvertInt32ToVertexColor(ActorData.instance_id);
-			ActorData.rgba[0] = MaskVertexColor.R;
-			ActorData.rgba[1] = MaskVertexColor.G;
-			ActorData.rgba[2] = MaskVertexColor.B;
-			ActorData.rgba[3] = MaskVertexColor.A;
-        }
-        else
-        {
-            ActorData.instance_id = 0;
-        }
         const FQuat& ActorQuaternion_UE4 = ActorToWorldTransform.GetRotation();
         const FRotator& ActorRotator_UE4 = ActorToWorldTransform.Rotator();
 
@@ -216,8 +407,9 @@ bool UNVSceneFeatureExtractor_AnnotationData::GatherActorData(const AActor* Chec
         ActorData.actor_to_world_matrix_ue4 = ActorToWorldMatrix_UE4;
         ActorData.actor_to_world_matrix_opencv = ActorToWorldMatrix_OpenCV;
 
-        UMeshComponent* ValidMeshComp = NVSceneCapturerUtils::GetFirstValidMeshComponent(CheckActor);
-        if (!ValidMeshComp)
+        const FNVMeshGeometry* PrimaryMesh = ActorGeometry.GetPrimaryMesh();
+        const UMeshComponent* ValidMeshComp = ActorGeometry.GetPrimaryMeshComponent();
+        if (!PrimaryMesh || !ValidMeshComp)
         {
             return false;
         }
@@ -229,10 +421,18 @@ bool UNVSceneFeatureExtractor_AnnotationData::GatherActorData(const AActor* Chec
             case ENVBoundsGenerationType::VE_OOBB:
                 // TODO: Right now some of the mesh's collision components are quite different from its mesh => just don't use the collision component for now
                 // May be later we can just use the cuboid from the AAnnotatedActor which are only calculated once
-                ActorCuboid = NVSceneCapturerUtils::GetActorCuboid_OOBB_Simple(CheckActor, false);
+                if (PrimaryMesh->LocalBounds.IsValid)
+                {
+                    ActorCuboid.BuildFromOOBB(PrimaryMesh->LocalBounds, ValidMeshComp->GetComponentTransform());
+                }
+                else
+                {
+                    ActorCuboid = NVSceneCapturerUtils::GetMeshCuboid_OOBB_Simple(ValidMeshComp, true, false);
+                }
                 break;
             case ENVBoundsGenerationType::VE_TightOOBB:
-                ActorCuboid = NVSceneCapturerUtils::GetActorCuboid_OOBB_Complex(CheckActor);
+                // NOTE: The tight bounds of the static meshes are calculated once per mesh, see FNVMeshOrientedBoundsCache
+                ActorCuboid = NVSceneCapturerUtils::GetMeshCuboid_OOBB_Complex(ValidMeshComp);
                 break;
             default:
             case ENVBoundsGenerationType::VE_AABB:
@@ -284,7 +484,9 @@ bool UNVSceneFeatureExtractor_AnnotationData::GatherActorData(const AActor* Chec
             ActorData.distance_scale = (ActorDistanceToViewpoint >= MaxDist) ? 1.f : 0.f;
         }
 
-        FBox2D ActorBB2D = GetBoundingBox2D(CheckActor, false);
+        // NOTE: The box of the visible pixels replace the projected one once the mask is analyzed, the vertexes don't need to be projected
+        const bool bBoundingBoxFromMask = bAnalyzeInstanceMask && (ProtectedDataExportSettings.BoundingBox2dType == ENVBoundBox2dGenerationType::FromInstanceMask);
+        FBox2D ActorBB2D = bBoundingBoxFromMask ? FBox2D(EForceInit::ForceInitToZero) : GetBoundingBox2D(ActorGeometry, false);
         // Calculate Truncated
         FBox2D ClampedActorBB2D = ActorBB2D;
         ClampedActorBB2D.Min.X = FMath::Clamp(ActorBB2D.Min.X, 0.f, 1.f);
@@ -293,116 +495,23 @@ bool UNVSceneFeatureExtractor_AnnotationData::GatherActorData(const AActor* Chec
         ClampedActorBB2D.Max.Y = FMath::Clamp(ActorBB2D.Max.Y, 0.f, 1.f);
         ActorData.bounding_box = ActorBB2D;
 
-        // Calculate Occluded
-        // count how many of the points are occluded
-        int OccludedPointsCount = 0;    // how many bbox corners were occluded by a ray trace?
-        for (FVector CheckVertex : ActorCuboid.Vertexes)
-        {
-            FHitResult TraceHitResult;
-            FCollisionObjectQueryParams objectQueryParams = FCollisionObjectQueryParams::DefaultObjectQueryParam;
-            FCollisionQueryParams queryParams = FCollisionQueryParams::DefaultQueryParam;
-            queryParams.AddIgnoredActor(CheckActor);
-
-            if (World->LineTraceSingleByObjectType(TraceHitResult, ViewLocation, CheckVertex, objectQueryParams, queryParams))
-            {
-                OccludedPointsCount++;  // keep track of how many of the bound corners are blocked.
-            }
-        }
-
-        ActorData.occluded = 0;
-        if (OccludedPointsCount > 0)
+        ActorData.visible_pixel_count = 0;
+        ActorData.projected_pixel_count = 0;
+        ActorData.truncation_flags = ENVTruncationFlags::None;
+        if (bAnalyzeInstanceMask && ProtectedDataExportSettings.bComputeVisibilityFromInstanceMask)
         {
-            // more than half means "largely occluded"
-            // TODO: Create enum for 'occluded type' instead of using number directly like this
-            ActorData.occluded = (OccludedPointsCount > 4) ? 2 : 1;
-        }
-
-        // TODO: Trace against a 3d voxelized volume of the target actor
-        // Find the 3d bounding box in the camera coordinate
-        const UMeshComponent* ActorMesh = NVSceneCapturerUtils::GetFirstValidMeshComponent(CheckActor);
-        TArray<FVector> MeshBoundVertexes = NVSceneCapturerUtils::GetSimpleCollisionVertexes(ActorMesh);
-        FBox CameraSpaceBoundingBox(EForceInit::ForceInitToZero);
-        const FTransform& CameraTransform = OwnerViewpoint->GetComponentTransform();
-        // Find the nearest and farthest vertexes
-        for (const FVector& CheckVertex : MeshBoundVertexes)
-        {
-            const FVector VertexCameraSpace = CameraTransform.InverseTransformPosition(CheckVertex);
-            CameraSpaceBoundingBox += VertexCameraSpace;
-        }
-        const FVector& CamSpaceBBSize = CameraSpaceBoundingBox.GetSize();
-
-        ActorData.occlusion = 0.f;
-        //FHitResult LastBlockedHitResult;
-        if (CameraSpaceBoundingBox.IsValid)
-        {
-            // Calculate the sampling rate in each direction
-            static const int BB2dOcclusionSamplingRes = 10;
-            FVector VoxelSamplingRate;
-            // Use higher sampling rate for the image space X, Z
-            // Use a lower sampling rate for the depth X
-            VoxelSamplingRate.X = FMath::Min(BB2dOcclusionSamplingRes / 2, FMath::RoundToInt(CamSpaceBBSize.X));
-            VoxelSamplingRate.Z = FMath::Min(BB2dOcclusionSamplingRes, FMath::RoundToInt(CamSpaceBBSize.Z));
-            VoxelSamplingRate.Y = FMath::Min(BB2dOcclusionSamplingRes, FMath::RoundToInt(CamSpaceBBSize.Y));
-            FVector VoxelSamplingStep(1.f / VoxelSamplingRate.X, 1.f / VoxelSamplingRate.Y, 1.f / VoxelSamplingRate.Z);
-
-            int TotalSampledCellCount = 0;
-            int OccludedCellCount = 0;
-            // Loop through all the cell in the 3d voxel grid
-            for (int y = 0; y < VoxelSamplingRate.Y; y++)
-            {
-                for (int z = 0; z < VoxelSamplingRate.Y; z++)
-                {
-                    for (int x = 0; x < VoxelSamplingRate.X; x++)
-                    {
-                        FVector CellCenterCameraSpace;
-                        CellCenterCameraSpace.X = FMath::Lerp(CameraSpaceBoundingBox.Min.X, CameraSpaceBoundingBox.Max.X, (x + 0.5f) * VoxelSamplingStep.X);
-                        CellCenterCameraSpace.Y = FMath::Lerp(CameraSpaceBoundingBox.Min.Y, CameraSpaceBoundingBox.Max.Y, (y + 0.5f) * VoxelSamplingStep.Y);
-                        CellCenterCameraSpace.Z = FMath::Lerp(CameraSpaceBoundingBox.Min.Z, CameraSpaceBoundingBox.Max.Z, (z + 0.5f) * VoxelSamplingStep.Z);
-
-                        const FVector& CellCenterWorld = CameraTransform.TransformPosition(CellCenterCameraSpace);
-
-                        const FVector& TraceStart = ViewLocation;
-                        const FVector& TraceEnd = CellCenterWorld;
-
-                        FHitResult TraceHitResult;
-                        const FCollisionResponseParams& ResponseParam = FCollisionResponseParams::DefaultResponseParam;
-                        FCollisionQueryParams QueryParams = FCollisionQueryParams::DefaultQueryParam;
-                        //QueryParams.AddIgnoredActor(CheckActor);
-
-                        if (World->LineTraceSingleByChannel(TraceHitResult, TraceStart, TraceEnd, ECC_Visibility, QueryParams, ResponseParam))
-                        {
-                            // Only care about the cell that actually have something there
-                            TotalSampledCellCount++;
-
-                            // If the trace hit other actor instead the target one then it mean it's occluded
-                            if (TraceHitResult.Actor.IsValid() && (TraceHitResult.Actor != CheckActor))
-                            {
-								const FString& name = TraceHitResult.Actor->GetName();
-								if (!name.Contains("prep")) //#miker: generalize for all totes.
-								{
-									OccludedCellCount++;
-								}
-                            }
-
-                            // No need to go deeper when we already hit something
-                            break;
-                        }
-                    }
-                }
-            }
-
-            if (TotalSampledCellCount > 0)
-            {
-                ActorData.occlusion = float(OccludedCellCount) / TotalSampledCellCount;
-            }
+            // The occlusion is measured from the frame's instance mask once it's read back, see FNVInstanceMaskQueue
+            ActorData.projected_pixel_count = CalculateProjectedPixelCount(ActorGeometry);
+            ActorData.occluded = 0;
+            ActorData.occlusion = 0.f;
+            ActorData.visibility = 0.f;
         }
         else
         {
-            ActorData.occlusion = 1.f;
+            TraceActorOcclusion(CheckActor, ActorGeometry, ActorCuboid, ActorData);
         }
 
-        ActorData.visibility = FMath::Clamp(1.f - ActorData.occlusion, 0.f, 1.f);
-
+        // NOTE: Without the projected box, the truncation is set from the borders the visible pixels touch once the mask is analyzed
         const float ClampedArea = ClampedActorBB2D.GetArea();
         const float FullArea = ActorBB2D.GetArea();
         ActorData.truncated = (FullArea > 0.f) ? (1.f - (ClampedArea / FullArea)) : 1.f;
@@ -410,14 +519,12 @@ bool UNVSceneFeatureExtractor_AnnotationData::GatherActorData(const AActor* Chec
         // Gather the socket data
         if (Tag)
         {
-            TArray<UMeshComponent*> MeshComponents;
-            CheckActor->GetComponents(MeshComponents);
-
             bool bNeedExportSockets = Tag->bExportAllMeshSocketInfo || (Tag->SocketNameToExportList.Num() > 0);
             if (bNeedExportSockets)
             {
-                for (UMeshComponent* CheckMeshComp : MeshComponents)
+                for (const FNVMeshGeometry& MeshGeometry : ActorGeometry.Meshes)
                 {
+                    const UMeshComponent* CheckMeshComp = MeshGeometry.MeshComponent.Get();
                     if (CheckMeshComp)
                     {
                         const TArray<FName>& AllSocketNames = CheckMeshComp->GetAllSocketNames();
@@ -441,109 +548,250 @@ bool UNVSceneFeatureExtractor_AnnotationData::GatherActorData(const AActor* Chec
                 }
             }
         }
-
-        const ANVAnnotatedActor* AnnotatedActor = Cast<ANVAnnotatedActor>(CheckActor);
-        if (AnnotatedActor)
-        {
-            ActorData.custom_data = AnnotatedActor->GetCustomAnnotatedData();
-        }
     }
     return true;
 }
 
-bool UNVSceneFeatureExtractor_AnnotationData::ShouldExportActor(const AActor* CheckActor) const
+void UNVSceneFeatureExtractor_AnnotationData::TraceActorOcclusion(const AActor* CheckActor, const FNVActorGeometryRecord& ActorGeometry,
+        const FNVCuboidData& ActorCuboid, FCapturedObjectData& ActorData) const
 {
-    bool bShouldExport = false;
-    const auto& CapturerSettings = OwnerViewpoint->GetCapturerSettings();
+    UWorld* World = GetWorld();
+    const FNVMeshGeometry* PrimaryMesh = ActorGeometry.GetPrimaryMesh();
+    const UMeshComponent* ValidMeshComp = ActorGeometry.GetPrimaryMeshComponent();
+    if (!World || !PrimaryMesh || !ValidMeshComp)
+    {
+        return;
+    }
+    const FVector& ViewLocation = OwnerViewpoint->GetComponentLocation();
 
-    // Only care about valid actor
-    if (CheckActor)
+    // Calculate Occluded
+    // count how many of the points are occluded
+    int OccludedPointsCount = 0;    // how many bbox corners were occluded by a ray trace?
+    for (FVector CheckVertex : ActorCuboid.Vertexes)
     {
-        if (ProtectedDataExportSettings.bIgnoreHiddenActor)
+        FHitResult TraceHitResult;
+        FCollisionObjectQueryParams objectQueryParams = FCollisionObjectQueryParams::DefaultObjectQueryParam;
+        FCollisionQueryParams queryParams = FCollisionQueryParams::DefaultQueryParam;
+        queryParams.AddIgnoredActor(CheckActor);
+
+        if (World->LineTraceSingleByObjectType(TraceHitResult, ViewLocation, CheckVertex, objectQueryParams, queryParams))
         {
-            FConvexVolume ViewFrustum;
-            GetViewFrustumBounds(ViewFrustum, ViewProjectionMatrix, true);
+            OccludedPointsCount++;  // keep track of how many of the bound corners are blocked.
+        }
+    }
+
+    ActorData.occluded = 0;
+    if (OccludedPointsCount > 0)
+    {
+        // more than half means "largely occluded"
+        // TODO: Create enum for 'occluded type' instead of using number directly like this
+        ActorData.occluded = (OccludedPointsCount > 4) ? 2 : 1;
+    }
 
-            // The actor is considered as hidden if it's not rendered in the game
-            // or it doesn't appear on the viewport
-            if (CheckActor->bHidden || !IsActorInViewFrustum(ViewFrustum, CheckActor))
+    // TODO: Trace against a 3d voxelized volume of the target actor
+    // Find the 3d bounding box in the camera coordinate
+    const FTransform& CameraTransform = OwnerViewpoint->GetComponentTransform();
+    // Find the nearest and farthest vertexes
+    const FMatrix& MeshToCameraMatrix = ValidMeshComp->GetComponentTransform().ToMatrixWithScale() * CameraTransform.ToInverseMatrixWithScale();
+    const FBox CameraSpaceBoundingBox = PrimaryMesh->Hull.IsValid() ? PrimaryMesh->Hull->GetTransformedBounds(MeshToCameraMatrix) : FBox(EForceInit::ForceInitToZero);
+    const FVector& CamSpaceBBSize = CameraSpaceBoundingBox.GetSize();
+
+    ActorData.occlusion = 0.f;
+    //FHitResult LastBlockedHitResult;
+    if (CameraSpaceBoundingBox.IsValid)
+    {
+        // Calculate the sampling rate in each direction
+        static const int BB2dOcclusionSamplingRes = 10;
+        FVector VoxelSamplingRate;
+        // Use higher sampling rate for the image space X, Z
+        // Use a lower sampling rate for the depth X
+        VoxelSamplingRate.X = FMath::Min(BB2dOcclusionSamplingRes / 2, FMath::RoundToInt(CamSpaceBBSize.X));
+        VoxelSamplingRate.Z = FMath::Min(BB2dOcclusionSamplingRes, FMath::RoundToInt(CamSpaceBBSize.Z));
+        VoxelSamplingRate.Y = FMath::Min(BB2dOcclusionSamplingRes, FMath::RoundToInt(CamSpaceBBSize.Y));
+        FVector VoxelSamplingStep(1.f / VoxelSamplingRate.X, 1.f / VoxelSamplingRate.Y, 1.f / VoxelSamplingRate.Z);
+
+        int TotalSampledCellCount = 0;
+        int OccludedCellCount = 0;
+        // Loop through all the cell in the 3d voxel grid
+        for (int y = 0; y < VoxelSamplingRate.Y; y++)
+        {
+            for (int z = 0; z < VoxelSamplingRate.Z; z++)
             {
-                return bShouldExport;
+                for (int x = 0; x < VoxelSamplingRate.X; x++)
+                {
+                    FVector CellCenterCameraSpace;
+                    CellCenterCameraSpace.X = FMath::Lerp(CameraSpaceBoundingBox.Min.X, CameraSpaceBoundingBox.Max.X, (x + 0.5f) * VoxelSamplingStep.X);
+                    CellCenterCameraSpace.Y = FMath::Lerp(CameraSpaceBoundingBox.Min.Y, CameraSpaceBoundingBox.Max.Y, (y + 0.5f) * VoxelSamplingStep.Y);
+                    CellCenterCameraSpace.Z = FMath::Lerp(CameraSpaceBoundingBox.Min.Z, CameraSpaceBoundingBox.Max.Z, (z + 0.5f) * VoxelSamplingStep.Z);
+
+                    const FVector& CellCenterWorld = CameraTransform.TransformPosition(CellCenterCameraSpace);
+
+                    const FVector& TraceStart = ViewLocation;
+                    const FVector& TraceEnd = CellCenterWorld;
+
+                    FHitResult TraceHitResult;
+                    const FCollisionResponseParams& ResponseParam = FCollisionResponseParams::DefaultResponseParam;
+                    FCollisionQueryParams QueryParams = FCollisionQueryParams::DefaultQueryParam;
+                    //QueryParams.AddIgnoredActor(CheckActor);
+
+                    if (World->LineTraceSingleByChannel(TraceHitResult, TraceStart, TraceEnd, ECC_Visibility, QueryParams, ResponseParam))
+                    {
+                        // Only care about the cell that actually have something there
+                        TotalSampledCellCount++;
+
+                        // If the trace hit other actor instead the target one then it mean it's occluded
+                        if (TraceHitResult.Actor.IsValid() && (TraceHitResult.Actor != CheckActor))
+                        {
+								const FString& name = TraceHitResult.Actor->GetName();
+								if (!name.Contains("prep")) //#miker: generalize for all totes.
+								{
+									OccludedCellCount++;
+								}
+                        }
+
+                        // No need to go deeper when we already hit something
+                        break;
+                    }
+                }
             }
         }
 
-        //Check if it's flagged
-        //TODO (OS): Implement ENVIncludeObjects::MatchesTag
-        UNVCapturableActorTag* Tag = Cast<UNVCapturableActorTag>(CheckActor->GetComponentByClass(UNVCapturableActorTag::StaticClass()));
-        bShouldExport |= (!ProtectedDataExportSettings.bIgnoreHiddenActor) && (!CheckActor->bHidden);
-        bShouldExport |= ((ProtectedDataExportSettings.IncludeObjectsType == ENVIncludeObjects::AllTaggedObjects) && Tag && (Tag->bIncludeMe /* || IncludeAll*/));
+        if (TotalSampledCellCount > 0)
+        {
+            ActorData.occlusion = float(OccludedCellCount) / TotalSampledCellCount;
+        }
+    }
+    else
+    {
+        ActorData.occlusion = 1.f;
+    }
+
+    ActorData.visibility = FMath::Clamp(1.f - ActorData.occlusion, 0.f, 1.f);
+}
 
-        if (bShouldExport)
+uint32 UNVSceneFeatureExtractor_AnnotationData::CalculateProjectedPixelCount(const FNVActorGeometryRecord& ActorGeometry) const
+{
+    const FNVImageSize& CaptureImageSize = OwnerViewpoint->GetCapturerSettings().CapturedImageSize;
+    const FVector2D ImageSize(CaptureImageSize.Width, CaptureImageSize.Height);
+    // The projected positions are in ratio of the image size unless the coordinates are exported in pixel
+    const FVector2D PixelScale = ProtectedDataExportSettings.bExportImageCoordinateInPixel ? FVector2D(1.f, 1.f) : ImageSize;
+
+    TArray<FVector2D> ProjectedVertexes;
+    TArray<float> ClipPositions;
+    for (const FNVMeshGeometry& MeshGeometry : ActorGeometry.Meshes)
+    {
+        const UMeshComponent* CheckMeshComp = MeshGeometry.MeshComponent.Get();
+        if (CheckMeshComp && (MeshGeometry.GetHullVertexCount() > 0))
         {
-            bShouldExport = false;
-            // Ensure the actor have a mesh
-            TArray<UMeshComponent*> MeshComponents;
-            CheckActor->GetComponents(MeshComponents);
-            if (MeshComponents.Num() != 0)
+            const FNVMeshHull& MeshHull = *MeshGeometry.Hull;
+            MeshHull.TransformVertexesToClipSpace(CheckMeshComp->GetComponentTransform().ToMatrixWithScale() * ViewProjectionMatrix, ClipPositions);
+            const float* ClipX = ClipPositions.GetData();
+            const float* ClipY = ClipX + MeshHull.PaddedVertexCount;
+            const float* ClipW = ClipY + MeshHull.PaddedVertexCount;
+            for (int32 i = 0; i < MeshHull.VertexCount; i++)
             {
-                // Check if the actor actually have a valid bound
-                const FBox ActorBounds = CheckActor->GetComponentsBoundingBox(true); // true means all subcomponents
-                const FVector BoxExtent = ActorBounds.GetExtent();
-                if (!BoxExtent.IsZero())
+                // NOTE: The vertexes behind the camera don't have a valid projection
+                if (ClipW[i] > 0.f)
                 {
-                    bShouldExport = true;
+                    ProjectedVertexes.Add(ConvertClipPositionToImagePosition(ClipX[i], ClipY[i], ClipW[i]) * PixelScale);
                 }
             }
         }
     }
 
-    return bShouldExport;
+    const float ProjectedArea = NVSceneCapturerUtils::CalculateClippedConvexHullArea(ProjectedVertexes, FBox2D(FVector2D::ZeroVector, ImageSize));
+    return (uint32)FMath::RoundToInt(ProjectedArea);
+}
+
+bool UNVSceneFeatureExtractor_AnnotationData::ShouldExportActor(const AActor* CheckActor, const FNVActorGeometryRecord& ActorGeometry) const
+{
+    if (!PassesActorFilters(CheckActor, ActorGeometry))
+    {
+        return false;
+    }
+
+    const FBox ActorBounds = CheckActor->GetComponentsBoundingBox(true); // true means all subcomponents
+    return ShouldExportActorBounds(FBoxSphereBounds(ActorBounds));
 }
 
-bool UNVSceneFeatureExtractor_AnnotationData::IsActorInViewFrustum(const FConvexVolume& ViewFrustum, const AActor* CheckActor) const
+bool UNVSceneFeatureExtractor_AnnotationData::PassesActorFilters(const AActor* CheckActor, const FNVActorGeometryRecord& ActorGeometry) const
 {
+    // Only care about valid actor
     if (!CheckActor)
     {
         return false;
     }
 
-    //Check if Bounds are > 0
-    const FBox ActorBounds = CheckActor->GetComponentsBoundingBox(true); //true means all non-colliding subcomponents
-    const FVector Origin = ActorBounds.GetCenter();
-    const FVector BoxExtent = ActorBounds.GetExtent();
+    // The actor is considered as hidden if it's not rendered in the game
+    if (ProtectedDataExportSettings.bIgnoreHiddenActor && CheckActor->bHidden)
+    {
+        return false;
+    }
+
+    //Check if it's flagged
+    //TODO (OS): Implement ENVIncludeObjects::MatchesTag
+    const UNVCapturableActorTag* Tag = ActorGeometry.Tag.Get();
+    bool bShouldExport = false;
+    bShouldExport |= (!ProtectedDataExportSettings.bIgnoreHiddenActor) && (!CheckActor->bHidden);
+    bShouldExport |= ((ProtectedDataExportSettings.IncludeObjectsType == ENVIncludeObjects::AllTaggedObjects) && Tag && (Tag->bIncludeMe /* || IncludeAll*/));
 
+    // Ensure the actor have a mesh
+    return bShouldExport && (ActorGeometry.Meshes.Num() != 0);
+}
+
+bool UNVSceneFeatureExtractor_AnnotationData::ShouldExportActorBounds(const FBoxSphereBounds& ActorBounds) const
+{
+    // Check if the actor actually have a valid bound
+    if (ActorBounds.BoxExtent.IsZero())
+    {
+        return false;
+    }
+
+    // The actor is considered as hidden if it doesn't appear on the viewport
+    return !ProtectedDataExportSettings.bIgnoreHiddenActor || IsBoundsInViewFrustum(ActorBounds);
+}
+
+bool UNVSceneFeatureExtractor_AnnotationData::IsBoundsInViewFrustum(const FBoxSphereBounds& ActorBounds) const
+{
     //Skip 0-extent objects
+    const FVector& BoxExtent = ActorBounds.BoxExtent;
     if (BoxExtent.X == 0.f || BoxExtent.Y == 0.f || BoxExtent.Z == 0.f)
     {
         return false;
     }
 
-    // NOTE: The Frustum's intersect test may not be too cheap, can just get the cuboid of the actor and project them into the 2d image to see if any of them in range
+    // NOTE: Both tests test all the planes at once with SIMD. The sphere test is cheaper and reject most of the actors
+    // outside of the view, the box test only refine the ones it let through.
     // NOTE: this test is conservative.  If any part of the box extents intersect the frustum, actor is considered as in the view frustum
-    return ViewFrustum.IntersectBox(Origin, BoxExtent);
+    return ViewFrustum.IntersectSphere(ActorBounds.Origin, ActorBounds.SphereRadius)
+        && ViewFrustum.IntersectBox(ActorBounds.Origin, BoxExtent);
 }
 
 FVector UNVSceneFeatureExtractor_AnnotationData::ProjectWorldPositionToImagePosition(const FVector& WorldPosition) const
 {
     // This Plane calculation is from FSceneView::Project
-    FPlane ProjectedPlane = ViewProjectionMatrix.TransformFVector4(FVector4(WorldPosition, 1));
-    if (ProjectedPlane.W == 0)
+    const FPlane ProjectedPlane = ViewProjectionMatrix.TransformFVector4(FVector4(WorldPosition, 1));
+    const FVector2D ImagePos2D = ConvertClipPositionToImagePosition(ProjectedPlane.X, ProjectedPlane.Y, ProjectedPlane.W);
+
+    FVector ImagePos(ImagePos2D.X, ImagePos2D.Y, 0.f);
+    if (ProjectedPlane.W > 0.f)
     {
-        ProjectedPlane.W = KINDA_SMALL_NUMBER;
+        ImagePos.Z = ProjectedPlane.Z * (1.0f / ProjectedPlane.W);
     }
-    const float RHW = 1.0f / ProjectedPlane.W;
-    ProjectedPlane.X *= RHW;
-    ProjectedPlane.Y *= RHW;
-    ProjectedPlane.Z *= RHW;
+    return ImagePos;
+}
 
-    FVector PlanePos = FVector(ProjectedPlane);
-    if (ProjectedPlane.W <= 0.f)
+FVector2D UNVSceneFeatureExtractor_AnnotationData::ConvertClipPositionToImagePosition(float ClipX, float ClipY, float ClipW) const
+{
+    if (ClipW == 0)
     {
-        PlanePos.Z = 0.f;
+        ClipW = KINDA_SMALL_NUMBER;
     }
+    const float RHW = 1.0f / ClipW;
+    const FVector2D PlanePos(ClipX * RHW, ClipY * RHW);
 
     // Convert the position to be in range of [0, 1] from [-1, 1]
-    FVector ImagePos = PlanePos;
+    FVector2D ImagePos;
     ImagePos.X = 0.5f * (PlanePos.X + 1.f);
     ImagePos.Y = 0.5f * (-PlanePos.Y + 1.f);
 
@@ -558,26 +806,17 @@ FVector UNVSceneFeatureExtractor_AnnotationData::ProjectWorldPositionToImagePosi
     return ImagePos;
 }
 
-FBox2D UNVSceneFeatureExtractor_AnnotationData::GetBoundingBox2D(const AActor* CheckActor, bool bClampToImage /*= true*/) const
+FBox2D UNVSceneFeatureExtractor_AnnotationData::GetBoundingBox2D(const FNVActorGeometryRecord& ActorGeometry, bool bClampToImage /*= true*/) const
 {
     FBox2D ActorBB2D(EForceInit::ForceInitToZero);
 
-    if (CheckActor)
+    for (const FNVMeshGeometry& MeshGeometry : ActorGeometry.Meshes)
     {
-        TArray<UMeshComponent*> MeshComponents;
-        CheckActor->GetComponents(MeshComponents);
-
-        for (const UMeshComponent* MeshComp : MeshComponents)
-        {
-            if (MeshComp)
-            {
-                ActorBB2D += Calculate2dAABB_MeshComplexCollision(MeshComp, bClampToImage);
-            }
-        }
-
-        // TODO: Fallback to use the actor's cuboid vertexes in case the mesh doesn't have valid collision body set up
+        ActorBB2D += Calculate2dAABB_MeshComplexCollision(MeshGeometry, bClampToImage);
     }
 
+    // TODO: Fallback to use the actor's cuboid vertexes in case the mesh doesn't have valid collision body set up
+
     // Mark the bounding box as invalid if its area is empty
     if (ActorBB2D.GetArea() <= 0.f)
     {
@@ -587,7 +826,7 @@ FBox2D UNVSceneFeatureExtractor_AnnotationData::GetBoundingBox2D(const AActor* C
     return ActorBB2D;
 }
 
-FBox2D UNVSceneFeatureExtractor_AnnotationData::Calculate2dAABB(TArray<FVector> Vertexes, bool bClampToImage /*= true*/) const
+FBox2D UNVSceneFeatureExtractor_AnnotationData::Calculate2dAABB(const TArray<FVector>& Vertexes, bool bClampToImage /*= true*/) const
 {
     FBox2D BBox2D(EForceInit::ForceInitToZero);
 
@@ -606,82 +845,524 @@ FBox2D UNVSceneFeatureExtractor_AnnotationData::Calculate2dAABB(TArray<FVector>
     return BBox2D;
 }
 
-FBox2D UNVSceneFeatureExtractor_AnnotationData::Calculate2dAABB_MeshComplexCollision(const class UMeshComponent* CheckMeshComp, bool bClampToImage /*= true*/) const
+FBox2D UNVSceneFeatureExtractor_AnnotationData::Calculate2dAABB_MeshComplexCollision(const FNVMeshGeometry& MeshGeometry, bool bClampToImage /*= true*/) const
 {
     FBox2D BBox2D(EForceInit::ForceInitToZero);
 
-    TArray<FVector> BoundVertexes;
+    // The hull is cached in the mesh's local space, only its current transform need to be applied
+    // NOTE: The extremes of the projected mesh are always on its convex hull so the box is the same as projecting all the mesh's vertexes
+    const UMeshComponent* CheckMeshComp = MeshGeometry.MeshComponent.Get();
+    if (CheckMeshComp && (MeshGeometry.GetHullVertexCount() > 0))
+    {
+        // The hull's vertexes are transformed straight to the clip space, 4 at a time
+        const FNVMeshHull& MeshHull = *MeshGeometry.Hull;
+        TArray<float> ClipPositions;
+        MeshHull.TransformVertexesToClipSpace(CheckMeshComp->GetComponentTransform().ToMatrixWithScale() * ViewProjectionMatrix, ClipPositions);
+        const float* ClipX = ClipPositions.GetData();
+        const float* ClipY = ClipX + MeshHull.PaddedVertexCount;
+        const float* ClipW = ClipY + MeshHull.PaddedVertexCount;
+        for (int32 i = 0; i < MeshHull.VertexCount; i++)
+        {
+            FVector2D ProjectedVertexLoc = ConvertClipPositionToImagePosition(ClipX[i], ClipY[i], ClipW[i]);
+            if (bClampToImage)
+            {
+                ProjectedVertexLoc.X = FMath::Clamp(ProjectedVertexLoc.X, 0.f, 1.f);
+                ProjectedVertexLoc.Y = FMath::Clamp(ProjectedVertexLoc.Y, 0.f, 1.f);
+            }
 
-    const UStaticMeshComponent* StaticMeshComp = Cast<UStaticMeshComponent>(CheckMeshComp);
-    if (StaticMeshComp)
+            BBox2D += ProjectedVertexLoc;
+        }
+    }
+
+    return BBox2D;
+}
+
+//=========================================== FNVInstanceMaskQueue ===========================================
+namespace
+{
+    /// A horizontal run of an object's pixels in the instance mask, EndX is excluded
+    struct FNVInstanceMaskRun
+    {
+        int32 Y;
+        int32 StartX;
+        int32 EndX;
+    };
+
+    /// What the scan of the instance mask found about an object
+    struct FNVInstanceMaskObjectStats
     {
-        const FTransform& MeshTransform = StaticMeshComp->GetComponentTransform();
-        const UStaticMesh* CheckMesh = StaticMeshComp->GetStaticMesh();
-        if (CheckMesh && CheckMesh->BodySetup)
+    public:
+        FNVInstanceMaskObjectStats()
+            : PixelCount(0),
+            TruncationFlags(ENVTruncationFlags::None),
+            MinPixel(MAX_int32, MAX_int32),
+            MaxPixel(MIN_int32, MIN_int32)
         {
-            const FKAggregateGeom& MeshGeom = CheckMesh->BodySetup->AggGeom;
+        }
 
-            for (const FKConvexElem& ConvexElem : MeshGeom.ConvexElems)
+        void AddRun(int32 Y, int32 StartX, int32 EndX, const FIntPoint& ImageSize, bool bKeepRun)
+        {
+            PixelCount += EndX - StartX;
+            MinPixel = FIntPoint(FMath::Min(MinPixel.X, StartX), FMath::Min(MinPixel.Y, Y));
+            MaxPixel = FIntPoint(FMath::Max(MaxPixel.X, EndX - 1), FMath::Max(MaxPixel.Y, Y));
+
+            TruncationFlags |= (StartX == 0) ? ENVTruncationFlags::Left : 0;
+            TruncationFlags |= (EndX == ImageSize.X) ? ENVTruncationFlags::Right : 0;
+            TruncationFlags |= (Y == 0) ? ENVTruncationFlags::Top : 0;
+            TruncationFlags |= (Y == ImageSize.Y - 1) ? ENVTruncationFlags::Bottom : 0;
+
+            if (bKeepRun)
             {
-                for (const FVector& CheckVertex : ConvexElem.VertexData)
-                {
-                    const FVector& VertexWorldLocation = MeshTransform.TransformPosition(CheckVertex);
-                    BoundVertexes.Add(VertexWorldLocation);
-                }
+                const FNVInstanceMaskRun NewRun = { Y, StartX, EndX };
+                Runs.Add(NewRun);
             }
         }
 
-        bool bHaveBodyVertexData = (BoundVertexes.Num() > 0);
-        // Fallback to use the mesh's render data if it doesn't have a valid body setup
-        if (!bHaveBodyVertexData && CheckMesh && CheckMesh->RenderData)
+        /// NOTE: The stats of the rows below must be merged after the ones above so the runs stay sorted
+        void Merge(const FNVInstanceMaskObjectStats& OtherStats)
+        {
+            PixelCount += OtherStats.PixelCount;
+            TruncationFlags |= OtherStats.TruncationFlags;
+            MinPixel = FIntPoint(FMath::Min(MinPixel.X, OtherStats.MinPixel.X), FMath::Min(MinPixel.Y, OtherStats.MinPixel.Y));
+            MaxPixel = FIntPoint(FMath::Max(MaxPixel.X, OtherStats.MaxPixel.X), FMath::Max(MaxPixel.Y, OtherStats.MaxPixel.Y));
+            Runs.Append(OtherStats.Runs);
+        }
+
+    public:
+        uint32 PixelCount;
+        uint32 TruncationFlags;
+        /// The object's pixels with the smallest and largest coordinates, both are included
+        FIntPoint MinPixel;
+        FIntPoint MaxPixel;
+        /// Only kept when the object's pixels need to be rebuilt
+        TArray<FNVInstanceMaskRun> Runs;
+    };
+}
+
+FNVInstanceMaskAnalysisOptions::FNVInstanceMaskAnalysisOptions()
+{
+    bMeasureVisibility = false;
+    bCalculateBoundingBox = false;
+    bEncodeRLE = false;
+    bTracePolygons = false;
+    PolygonSimplificationTolerance = 0.f;
+    bExportImageCoordinateInPixel = true;
+}
+
+uint32 FNVInstanceMaskAnalysisOptions::GetAnalyzedObjectFields() const
+{
+    // The borders the objects' pixels touch are found whatever the options are, but the pixel counts only mean something
+    // when the visibility is measured: the projected pixel count is only estimated for it and 0 would read as fully occluded
+    uint32 AnalyzedFields = ENVOptionalObjectFields::TruncationFlags;
+    if (bMeasureVisibility)
+    {
+        AnalyzedFields |= ENVOptionalObjectFields::PixelCounts;
+    }
+    if (bEncodeRLE)
+    {
+        AnalyzedFields |= ENVOptionalObjectFields::SegmentationRLE;
+    }
+    if (bTracePolygons)
+    {
+        AnalyzedFields |= ENVOptionalObjectFields::SegmentationPolygons;
+    }
+    return AnalyzedFields;
+}
+
+void FNVInstanceMaskQueue::AddFrame(const FNVPendingInstanceMaskFramePtr& Frame)
+{
+    if (!Frame.IsValid())
+    {
+        return;
+    }
+
+    FNVTexturePixelDataRef MaskPixelData;
+    {
+        FScopeLock ScopeLock(&QueueCriticalSection);
+        // The masks captured before this frame won't get their frame anymore
+        DropMasksBefore(Frame->FrameNumber);
+
+        const int32 MaskIndex = PendingMasks.IndexOfByPredicate([Frame](const FNVPendingInstanceMask& CheckMask)
+        {
+            return (CheckMask.FrameNumber == Frame->FrameNumber);
+        });
+        if (MaskIndex == INDEX_NONE)
+        {
+            PendingFrames.Add(Frame);
+            return;
+        }
+        MaskPixelData = PendingMasks[MaskIndex].PixelData;
+        PendingMasks.RemoveAt(MaskIndex);
+    }
+    LaunchAnalysisTask(Frame, MaskPixelData);
+}
+
+void FNVInstanceMaskQueue::AddInstanceMask(uint64 FrameNumber, const FNVTexturePixelDataRef& MaskPixelData)
+{
+    if (!MaskPixelData.IsValid())
+    {
+        return;
+    }
+
+    FNVPendingInstanceMaskFramePtr Frame;
+    {
+        FScopeLock ScopeLock(&QueueCriticalSection);
+        // The masks are read back in order so the frames captured before this mask won't get theirs anymore
+        DropFramesBefore(FrameNumber);
+
+        const int32 FrameIndex = PendingFrames.IndexOfByPredicate([FrameNumber](const FNVPendingInstanceMaskFramePtr& CheckFrame)
+        {
+            return (CheckFrame->FrameNumber == FrameNumber);
+        });
+        if (FrameIndex == INDEX_NONE)
+        {
+            // NOTE: The mask is usually read back after the annotation data is gathered but nothing guarantee it
+            FNVPendingInstanceMask NewMask;
+            NewMask.FrameNumber = FrameNumber;
+            NewMask.PixelData = MaskPixelData;
+            PendingMasks.Add(NewMask);
+            return;
+        }
+        Frame = PendingFrames[FrameIndex];
+        PendingFrames.RemoveAt(FrameIndex);
+    }
+    LaunchAnalysisTask(Frame, MaskPixelData);
+}
+
+void FNVInstanceMaskQueue::Drain()
+{
+    check(IsInGameThread());
+
+    FGraphEventArray RunningTasks;
+    {
+        FScopeLock ScopeLock(&QueueCriticalSection);
+        RunningTasks = MoveTemp(AnalysisTasks);
+        AnalysisTasks.Reset();
+    }
+    if (RunningTasks.Num() > 0)
+    {
+        FTaskGraphInterface::Get().WaitUntilTasksComplete(RunningTasks, ENamedThreads::GameThread);
+    }
+    FinishAnalyzedFrames();
+
+    // All the masks were read back, the frames still waiting won't get theirs
+    FScopeLock ScopeLock(&QueueCriticalSection);
+    DropFramesBefore(MAX_uint64);
+    DropMasksBefore(MAX_uint64);
+}
+
+void FNVInstanceMaskQueue::Reset()
+{
+    FScopeLock ScopeLock(&QueueCriticalSection);
+    PendingFrames.Reset();
+    PendingMasks.Reset();
+    AnalyzedFrames.Reset();
+    AnalysisTasks.Reset();
+}
+
+void FNVInstanceMaskQueue::DropFramesBefore(uint64 FrameNumber)
+{
+    // NOTE: The frames are added in the order they were captured
+    int32 DroppedFrameCount = 0;
+    while ((DroppedFrameCount < PendingFrames.Num()) && (PendingFrames[DroppedFrameCount]->FrameNumber < FrameNumber))
+    {
+        UE_LOG(LogNVSceneCapturer, Warning, TEXT("The instance mask of frame %llu was never read back, its annotation data is dropped."),
+               PendingFrames[DroppedFrameCount]->FrameNumber);
+        DroppedFrameCount++;
+    }
+    PendingFrames.RemoveAt(0, DroppedFrameCount, false);
+}
+
+void FNVInstanceMaskQueue::DropMasksBefore(uint64 FrameNumber)
+{
+    // NOTE: The masks are read back in the order they were captured
+    int32 DroppedMaskCount = 0;
+    while ((DroppedMaskCount < PendingMasks.Num()) && (PendingMasks[DroppedMaskCount].FrameNumber < FrameNumber))
+    {
+        UE_LOG(LogNVSceneCapturer, Warning, TEXT("No annotation data was captured for the instance mask of frame %llu, the mask is dropped."),
+               PendingMasks[DroppedMaskCount].FrameNumber);
+        DroppedMaskCount++;
+    }
+    PendingMasks.RemoveAt(0, DroppedMaskCount, false);
+}
+
+void FNVInstanceMaskQueue::LaunchAnalysisTask(const FNVPendingInstanceMaskFramePtr& Frame, const FNVTexturePixelDataRef& MaskPixelData)
+{
+    const TWeakPtr<FNVInstanceMaskQueue, ESPMode::ThreadSafe> WeakQueue = AsShared();
+    FGraphEventRef AnalysisTask = FFunctionGraphTask::CreateAndDispatchWhenReady([WeakQueue, Frame, MaskPixelData]()
+    {
+        AnalyzeInstanceMask(*MaskPixelData, Frame->AnalysisOptions, Frame->SceneData.Objects);
+        Frame->SceneData.OptionalObjectFields |= Frame->AnalysisOptions.GetAnalyzedObjectFields();
+
+        UNVSceneFeatureExtractor_AnnotationData::SerializeSceneData(Frame->SceneData, Frame->DataFormat, Frame->AnnotationData);
+        Frame->bIsAnalyzed = true;
+
+        TSharedPtr<FNVInstanceMaskQueue, ESPMode::ThreadSafe> Queue = WeakQueue.Pin();
+        if (Queue.IsValid())
         {
-            const FPositionVertexBuffer& MeshVertexBuffer = CheckMesh->RenderData->LODResources[0].VertexBuffers.PositionVertexBuffer;
-            const uint32 VertexesCount = MeshVertexBuffer.GetNumVertices();
-            for (uint32 i = 0; i < VertexesCount; i++)
             {
-                const FVector& VertexPosition = MeshTransform.TransformPosition(MeshVertexBuffer.VertexPosition(i));
-                BoundVertexes.Add(VertexPosition);
+                FScopeLock ScopeLock(&Queue->QueueCriticalSection);
+                Queue->AnalyzedFrames.Add(Frame);
             }
+
+            // The data handlers expect the annotation data on the game thread
+            AsyncTask(ENamedThreads::GameThread, [WeakQueue]()
+            {
+                TSharedPtr<FNVInstanceMaskQueue, ESPMode::ThreadSafe> GameThreadQueue = WeakQueue.Pin();
+                if (GameThreadQueue.IsValid())
+                {
+                    GameThreadQueue->FinishAnalyzedFrames();
+                }
+            });
         }
+    }, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
+
+    FScopeLock ScopeLock(&QueueCriticalSection);
+    // Only keep the tasks Drain may need to wait for
+    AnalysisTasks.RemoveAll([](const FGraphEventRef& CheckTask)
+    {
+        return CheckTask->IsComplete();
+    });
+    AnalysisTasks.Add(AnalysisTask);
+}
+
+void FNVInstanceMaskQueue::FinishAnalyzedFrames()
+{
+    check(IsInGameThread());
+
+    TArray<FNVPendingInstanceMaskFramePtr> FinishedFrames;
+    {
+        FScopeLock ScopeLock(&QueueCriticalSection);
+        FinishedFrames = MoveTemp(AnalyzedFrames);
+        AnalyzedFrames.Reset();
     }
-    else
+
+    // The frames can be analyzed out of order, hand them in the order they were captured
+    FinishedFrames.Sort([](const FNVPendingInstanceMaskFramePtr& A, const FNVPendingInstanceMaskFramePtr& B)
+    {
+        return (A->FrameNumber < B->FrameNumber);
+    });
+    for (const FNVPendingInstanceMaskFramePtr& Frame : FinishedFrames)
+    {
+        UNVSceneFeatureExtractor_AnnotationData* FeatureExtractor = Frame->FeatureExtractor.Get();
+        if (FeatureExtractor)
+        {
+            FeatureExtractor->FinishPendingInstanceMaskFrame(*Frame);
+        }
+    }
+}
+
+void FNVInstanceMaskQueue::AnalyzeInstanceMask(const FNVTexturePixelData& MaskPixelData, const FNVInstanceMaskAnalysisOptions& Options,
+        TArray<FCapturedObjectData>& Objects)
+{
+    // Same categories as the traced estimation: 0 - visible, 1 - partly occluded, 2 - more than half occluded
+    static const float PartlyOccludedThreshold = 0.1f;
+    static const float LargelyOccludedThreshold = 0.5f;
+
+    const int32 ObjectCount = Objects.Num();
+    if (ObjectCount == 0)
+    {
+        return;
+    }
+
+    const bool bIsBGRA = (MaskPixelData.PixelFormat == EPixelFormat::PF_B8G8R8A8);
+    const bool bIsRGBA = (MaskPixelData.PixelFormat == EPixelFormat::PF_R8G8B8A8);
+    const int32 Width = MaskPixelData.PixelSize.X;
+    const int32 Height = MaskPixelData.PixelSize.Y;
+    const uint32 RowStride = (MaskPixelData.RowStride > 0) ? MaskPixelData.RowStride : (uint32)Width * 4;
+    if ((!bIsBGRA && !bIsRGBA) || (Width <= 0) || (Height <= 0) || (MaskPixelData.PixelData.Num() < (int32)(RowStride * (Height - 1)) + Width * 4))
+    {
+        UE_LOG(LogNVSceneCapturer, Warning, TEXT("The instance mask can't be analyzed, its pixel format must be 8 bits RGBA."));
+        return;
+    }
+
+    TMap<uint32, int32> InstanceIdToObjectIndex;
+    InstanceIdToObjectIndex.Reserve(ObjectCount);
+    for (int32 ObjectIndex = 0; ObjectIndex < ObjectCount; ObjectIndex++)
     {
-        const USkeletalMeshComponent* SkeletalMeshComp = Cast<USkeletalMeshComponent>(CheckMeshComp);
-        if (SkeletalMeshComp)
+        // NOTE: Id 0 means the actor doesn't have a mask
+        if (Objects[ObjectIndex].instance_id != 0)
         {
-            const USkeletalMesh* SkeletalMesh = SkeletalMeshComp ? SkeletalMeshComp->SkeletalMesh : nullptr;
-            if (SkeletalMesh)
+            InstanceIdToObjectIndex.Add(Objects[ObjectIndex].instance_id, ObjectIndex);
+        }
+    }
+
+    // Each stripe of rows collect the runs of pixels into its own stats so they don't need to be synchronized
+    static const int32 MinRowsPerStripe = 32;
+    const int32 MaxStripeCount = FMath::Max(1, FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+    const int32 StripeCount = FMath::Clamp(Height / MinRowsPerStripe, 1, MaxStripeCount);
+    const int32 RowsPerStripe = FMath::DivideAndRoundUp(Height, StripeCount);
+    const FIntPoint ImageSize(Width, Height);
+    const bool bKeepRuns = Options.bEncodeRLE || Options.bTracePolygons;
+    TArray<FNVInstanceMaskObjectStats> StripeStats;
+    StripeStats.SetNum(StripeCount * ObjectCount);
+
+    const uint8* MaskData = MaskPixelData.PixelData.GetData();
+    ParallelFor(StripeCount, [&](int32 StripeIndex)
+    {
+        FNVInstanceMaskObjectStats* ObjectStats = StripeStats.GetData() + StripeIndex * ObjectCount;
+        const int32 StartRow = StripeIndex * RowsPerStripe;
+        const int32 EndRow = FMath::Min(StartRow + RowsPerStripe, Height);
+
+        // Most pixels belong to the same object as their left neighbor, cache its look up
+        uint32 LastInstanceId = 0;
+        int32 LastObjectIndex = INDEX_NONE;
+        for (int32 Y = StartRow; Y < EndRow; Y++)
+        {
+            const uint8* RowData = MaskData + (SIZE_T)Y * RowStride;
+            int32 RunObjectIndex = INDEX_NONE;
+            int32 RunStartX = 0;
+            // NOTE: The extra pixel past the end of the row close its last run
+            for (int32 X = 0; X <= Width; X++)
             {
-                const UPhysicsAsset* MeshPhysicsAsset = SkeletalMesh->PhysicsAsset;
-                if (MeshPhysicsAsset)
+                int32 PixelObjectIndex = INDEX_NONE;
+                if (X < Width)
                 {
-                    const FTransform& MeshTransform = SkeletalMeshComp->GetComponentTransform();
-                    for (const USkeletalBodySetup* CheckSkeletalBodySetup : MeshPhysicsAsset->SkeletalBodySetups)
+                    const uint8* Pixel = RowData + X * 4;
+                    const FColor PixelColor = bIsBGRA ? FColor(Pixel[2], Pixel[1], Pixel[0]) : FColor(Pixel[0], Pixel[1], Pixel[2]);
+                    const uint32 InstanceId = NVSceneCapturerUtils::ConvertVertexColorToInt32(PixelColor);
+                    if (InstanceId != 0)
                     {
-                        if (CheckSkeletalBodySetup)
+                        if (InstanceId != LastInstanceId)
                         {
-                            const FKAggregateGeom& MeshGeom = CheckSkeletalBodySetup->AggGeom;
-                            for (const FKConvexElem& ConvexElem : MeshGeom.ConvexElems)
-                            {
-                                for (const FVector& CheckVertex : ConvexElem.VertexData)
-                                {
-                                    const FVector& VertexWorldLocation = MeshTransform.TransformPosition(CheckVertex);
-                                    BoundVertexes.Add(VertexWorldLocation);
-                                }
-                            }
+                            const int32* ObjectIndexPtr = InstanceIdToObjectIndex.Find(InstanceId);
+                            LastInstanceId = InstanceId;
+                            LastObjectIndex = ObjectIndexPtr ? *ObjectIndexPtr : INDEX_NONE;
                         }
+                        PixelObjectIndex = LastObjectIndex;
+                    }
+                }
+
+                if (PixelObjectIndex != RunObjectIndex)
+                {
+                    if (RunObjectIndex != INDEX_NONE)
+                    {
+                        ObjectStats[RunObjectIndex].AddRun(Y, RunStartX, X, ImageSize, bKeepRuns);
                     }
+                    RunObjectIndex = PixelObjectIndex;
+                    RunStartX = X;
                 }
             }
         }
-    }
+    });
 
-    if (BoundVertexes.Num() > 0)
+    // Merge the stripes into the first one
+    for (int32 StripeIndex = 1; StripeIndex < StripeCount; StripeIndex++)
     {
-        BBox2D = Calculate2dAABB(BoundVertexes, bClampToImage);
+        for (int32 ObjectIndex = 0; ObjectIndex < ObjectCount; ObjectIndex++)
+        {
+            StripeStats[ObjectIndex].Merge(StripeStats[StripeIndex * ObjectCount + ObjectIndex]);
+        }
     }
 
-    return BBox2D;
+    const FVector2D CoordinateScale = Options.bExportImageCoordinateInPixel ? FVector2D(1.f, 1.f) : FVector2D(1.f / Width, 1.f / Height);
+    ParallelFor(ObjectCount, [&](int32 ObjectIndex)
+    {
+        const FNVInstanceMaskObjectStats& ObjectStats = StripeStats[ObjectIndex];
+        FCapturedObjectData& ObjectData = Objects[ObjectIndex];
+        ObjectData.visible_pixel_count = ObjectStats.PixelCount;
+        ObjectData.truncation_flags = ObjectStats.TruncationFlags;
+
+        if (Options.bMeasureVisibility)
+        {
+            // The projected area is estimated from the collision hulls so it can be a bit smaller than the visible pixels
+            if (ObjectData.projected_pixel_count > 0)
+            {
+                ObjectData.visibility = FMath::Clamp((float)ObjectData.visible_pixel_count / ObjectData.projected_pixel_count, 0.f, 1.f);
+            }
+            else
+            {
+                ObjectData.visibility = (ObjectData.visible_pixel_count > 0) ? 1.f : 0.f;
+            }
+            ObjectData.occlusion = 1.f - ObjectData.visibility;
+
+            ObjectData.occluded = 0;
+            if (ObjectData.occlusion > LargelyOccludedThreshold)
+            {
+                ObjectData.occluded = 2;
+            }
+            else if (ObjectData.occlusion > PartlyOccludedThreshold)
+            {
+                ObjectData.occluded = 1;
+            }
+        }
+
+        const bool bHasPixels = (ObjectStats.PixelCount > 0);
+        // The mask's pixels are from MinPixel to MaxPixel included
+        const FIntRect PixelRect(ObjectStats.MinPixel, ObjectStats.MaxPixel + FIntPoint(1, 1));
+        if (Options.bCalculateBoundingBox)
+        {
+            // The box go around the edges of the object's pixels
+            FBox2D VisibleBB2D(EForceInit::ForceInitToZero);
+            if (bHasPixels)
+            {
+                VisibleBB2D = FBox2D(FVector2D(PixelRect.Min.X, PixelRect.Min.Y) * CoordinateScale, FVector2D(PixelRect.Max.X, PixelRect.Max.Y) * CoordinateScale);
+            }
+            ObjectData.bounding_box = VisibleBB2D;
+            // NOTE: Only the visible pixels are known, the object is either cut by the image borders or not
+            ObjectData.truncated = (ObjectStats.TruncationFlags != ENVTruncationFlags::None) ? 1.f : 0.f;
+        }
+
+        ObjectData.segmentation_rle.size.Reset();
+        ObjectData.segmentation_rle.counts.Reset();
+        ObjectData.segmentation_polygons.Reset();
+        if (Options.bEncodeRLE)
+        {
+            ObjectData.segmentation_rle.size.Add(Height);
+            ObjectData.segmentation_rle.size.Add(Width);
+            if (!bHasPixels)
+            {
+                ObjectData.segmentation_rle.counts.Add(Width * Height);
+            }
+        }
+        if (!bKeepRuns || !bHasPixels)
+        {
+            return;
+        }
+
+        // Rebuild the object's own mask around its pixels
+        const FIntPoint PixelRectSize = PixelRect.Size();
+        TArray<uint8> ObjectMask;
+        ObjectMask.SetNumZeroed(PixelRectSize.X * PixelRectSize.Y);
+        for (const FNVInstanceMaskRun& Run : ObjectStats.Runs)
+        {
+            uint8* RunStart = ObjectMask.GetData() + (Run.Y - PixelRect.Min.Y) * PixelRectSize.X + (Run.StartX - PixelRect.Min.X);
+            FMemory::Memset(RunStart, 1, Run.EndX - Run.StartX);
+        }
+
+        if (Options.bEncodeRLE)
+        {
+            NVSceneCapturerUtils::EncodeMaskRLE(ObjectMask, PixelRect, ImageSize, ObjectData.segmentation_rle.counts);
+        }
+
+        if (Options.bTracePolygons)
+        {
+            TArray<TArray<FIntPoint>> Contours;
+            NVSceneCapturerUtils::TraceMaskContours(ObjectMask, PixelRectSize, Contours);
+            for (const TArray<FIntPoint>& Contour : Contours)
+            {
+                TArray<FVector2D> PolygonPoints;
+                PolygonPoints.Reserve(Contour.Num());
+                for (const FIntPoint& ContourPixel : Contour)
+                {
+                    PolygonPoints.Add(FVector2D(PixelRect.Min.X + ContourPixel.X + 0.5f, PixelRect.Min.Y + ContourPixel.Y + 0.5f));
+                }
+                // NOTE: The tolerance is in pixel so the polygon is simplified before it's scaled
+                NVSceneCapturerUtils::SimplifyClosedPolygon(PolygonPoints, Options.PolygonSimplificationTolerance);
+
+                // The parts too thin to have an area don't make a valid polygon
+                if (PolygonPoints.Num() >= 3)
+                {
+                    for (FVector2D& PolygonPoint : PolygonPoints)
+                    {
+                        PolygonPoint *= CoordinateScale;
+                    }
+                    FNVPolygon2D& NewPolygon = ObjectData.segmentation_polygons[ObjectData.segmentation_polygons.AddDefaulted()];
+                    NewPolygon.points = MoveTemp(PolygonPoints);
+                }
+            }
+        }
+    });
 }
 
 //=========================================== FNVDataExportSettings ===========================================
@@ -694,4 +1375,18 @@ FNVDataExportSettings::FNVDataExportSettings()
     bOutputEvenIfNoObjectsAreInView = true;
     DistanceScaleRange = FFloatInterval(100.f, 1000.f);
     bExportImageCoordinateInPixel = true;
+    bGatherActorDataInParallel = true;
+    AnnotationDataFormat = ENVAnnotationDataFormat::Json;
+    bComputeVisibilityFromInstanceMask = false;
+    bExportInstanceMaskRLE = false;
+    bExportInstanceMaskPolygons = false;
+    PolygonSimplificationTolerance = 1.f;
+}
+
+bool FNVDataExportSettings::UseInstanceMask() const
+{
+    return bComputeVisibilityFromInstanceMask ||
+           (BoundingBox2dType == ENVBoundBox2dGenerationType::FromInstanceMask) ||
+           bExportInstanceMaskRLE ||
+           bExportInstanceMaskPolygons;
 }
@@ -37,13 +37,73 @@ UNVSceneFeatureExtractor_PixelData::UNVSceneFeatureExtractor_PixelData(const FOb
     PostProcessBlendWeight = 1.f;
     CaptureSource = ESceneCaptureSource::SCS_FinalColorLDR;
     SceneCaptureComponent = nullptr;
+    SharedSceneCaptureComponent = nullptr;
+    SharedCaptureOutputIndex = INDEX_NONE;
 }
 
 void UNVSceneFeatureExtractor_PixelData::UpdateSettings()
 {
     UpdateMaterial();
 
-    SceneCaptureComponent = CreateSceneCaptureComponent2d(PostProcessMaterialInstance);
+    if (!AttachToSharedSceneCapture())
+    {
+        SceneCaptureComponent = CreateSceneCaptureComponent2d(PostProcessMaterialInstance);
+    }
+}
+
+bool UNVSceneFeatureExtractor_PixelData::GetSharedCaptureOutput(ENVSceneCaptureOutput& OutOutput, float& OutOutputScale) const
+{
+    return false;
+}
+
+ENVCapturedPixelFormat UNVSceneFeatureExtractor_PixelData::GetEffectiveCapturedPixelFormat() const
+{
+    return CapturedPixelFormat;
+}
+
+bool UNVSceneFeatureExtractor_PixelData::CanHostSharedSceneCapture() const
+{
+    return (SceneCaptureComponent != nullptr) && UseDefaultSceneView();
+}
+
+bool UNVSceneFeatureExtractor_PixelData::UseDefaultSceneView() const
+{
+    return !bOnlyShowTrainingActors && !bOverrideShowFlagSettings && (IgnoreActors.Num() == 0);
+}
+
+bool UNVSceneFeatureExtractor_PixelData::AttachToSharedSceneCapture()
+{
+    SharedSceneCaptureComponent = nullptr;
+    SharedCaptureOutputIndex = INDEX_NONE;
+
+    ENVSceneCaptureOutput SharedOutput = ENVSceneCaptureOutput::NVSceneCaptureOutput_MAX;
+    float SharedOutputScale = 1.f;
+    const bool bCanShareSceneCapture = OwnerViewpoint && OwnerViewpoint->GetSettings().bShareSceneCapture &&
+                                       !bUpdateContinuously && UseDefaultSceneView() &&
+                                       GetSharedCaptureOutput(SharedOutput, SharedOutputScale);
+    if (bCanShareSceneCapture)
+    {
+        // NOTE: The viewpoint's feature extractors are initialized in order, only the ones before this one already have their scene capture
+        for (UNVSceneFeatureExtractor* CheckFeatureExtractor : OwnerViewpoint->FeatureExtractorList)
+        {
+            UNVSceneFeatureExtractor_PixelData* CheckPixelDataExtractor = Cast<UNVSceneFeatureExtractor_PixelData>(CheckFeatureExtractor);
+            if (CheckPixelDataExtractor && (CheckPixelDataExtractor != this) && CheckPixelDataExtractor->CanHostSharedSceneCapture())
+            {
+                UNVSceneCaptureComponent2D* HostSceneCaptureComponent = CheckPixelDataExtractor->SceneCaptureComponent;
+                const int32 NewOutputIndex = HostSceneCaptureComponent->AddCaptureOutput(SharedOutput, GetEffectiveCapturedPixelFormat(), SharedOutputScale);
+                if (NewOutputIndex != INDEX_NONE)
+                {
+                    SharedSceneCaptureComponent = HostSceneCaptureComponent;
+                    SharedCaptureOutputIndex = NewOutputIndex;
+                    UE_LOG(LogNVSceneCapturer, Log, TEXT("Feature extractor %s use the scene capture of %s."),
+                           *GetDisplayName(), *CheckPixelDataExtractor->GetDisplayName());
+                }
+                break;
+            }
+        }
+    }
+
+    return (SharedSceneCaptureComponent != nullptr);
 }
 
 UNVSceneCaptureComponent2D* UNVSceneFeatureExtractor_PixelData::CreateSceneCaptureComponent2d(UMaterialInstance* PostProcessingMaterial, const FString& ComponentName)
@@ -81,7 +141,10 @@ UNVSceneCaptureComponent2D* UNVSceneFeatureExtractor_PixelData::CreateSceneCaptu
             }
 
             NewSceneCaptureComp2D->OverrideTexturePixelFormat = OverrideTexturePixelFormat;
-			NewSceneCaptureComp2D->TextureTargetFormat = ConvertCapturedFormatToRenderTargetFormat(CapturedPixelFormat);
+            const ENVCapturedPixelFormat EffectiveCapturedPixelFormat = GetEffectiveCapturedPixelFormat();
+			NewSceneCaptureComp2D->TextureTargetFormat = ConvertCapturedFormatToRenderTargetFormat(EffectiveCapturedPixelFormat);
+            // Only read back the captured format even when the texture target use a larger override format
+            NewSceneCaptureComp2D->ReadbackPixelFormat = EffectiveCapturedPixelFormat;
 
             NewSceneCaptureComp2D->CaptureSource = CaptureSource;
 
@@ -127,14 +190,33 @@ UNVSceneCaptureComponent2D* UNVSceneFeatureExtractor_PixelData::CreateSceneCaptu
             NewSceneCaptureCompData.ComponentName = ComponentName;
             SceneCaptureComp2DDataList.Add(NewSceneCaptureCompData);
 
+            // NOTE: The pool must be set before the component is registered, it decide whether to use it when it begin play
+            if (OwnerCapturer)
+            {
+                NewSceneCaptureComp2D->SetRenderTargetPool(OwnerCapturer->GetRenderTargetPool());
+            }
+
             NewSceneCaptureComp2D->RegisterComponent();
         }
     }
     return NewSceneCaptureComp2D;
 }
 
+ENVImageFormat UNVSceneFeatureExtractor_PixelData::GetExportImageFormat() const
+{
+    if (bOverrideExportImageType)
+    {
+        return ExportImageFormat;
+    }
+    return OwnerViewpoint ? OwnerViewpoint->GetCapturerSettings().ExportImageFormat : ENVImageFormat::PNG;
+}
+
 UTextureRenderTarget2D* UNVSceneFeatureExtractor_PixelData::GetRenderTarget() const
 {
+    if (SharedSceneCaptureComponent)
+    {
+        return SharedSceneCaptureComponent->GetCaptureOutputRenderTarget(SharedCaptureOutputIndex);
+    }
     return SceneCaptureComponent ? SceneCaptureComponent->TextureTarget : nullptr;
 }
 
@@ -151,7 +233,17 @@ bool UNVSceneFeatureExtractor_PixelData::CaptureSceneToPixelsData(UNVSceneFeatur
 {
     bool bIsSucceeded = false;
 
-    if (InCallback)
+    if (InCallback && SharedSceneCaptureComponent)
+    {
+        // The buffer is resolved from the same scene render as the host feature extractor's captured image
+        SharedSceneCaptureComponent->CaptureOutputToPixelsData(SharedCaptureOutputIndex,
+            [this, Callback = InCallback](const FNVTexturePixelDataRef& CapturedPixelData)
+        {
+            Callback(CapturedPixelData, this);
+        });
+        bIsSucceeded = true;
+    }
+    else if (InCallback)
     {
         for (auto& SceneCaptureComp2DData : SceneCaptureComp2DDataList)
         {
@@ -159,7 +251,7 @@ bool UNVSceneFeatureExtractor_PixelData::CaptureSceneToPixelsData(UNVSceneFeatur
             if (CheckSceneCaptureComp2D)
             {
                 CheckSceneCaptureComp2D->CaptureSceneToPixelsData(
-                    [this, Callback = InCallback](const FNVTexturePixelData& CapturedPixelData)
+                    [this, Callback = InCallback](const FNVTexturePixelDataRef& CapturedPixelData)
                 {
                     Callback(CapturedPixelData, this);
                 });
@@ -170,6 +262,47 @@ bool UNVSceneFeatureExtractor_PixelData::CaptureSceneToPixelsData(UNVSceneFeatur
     return bIsSucceeded;
 }
 
+void UNVSceneFeatureExtractor_PixelData::SetReadbackRequestHandler(FNVTextureReader::OnReadbackRequestedCallback NewHandler)
+{
+    for (auto& SceneCaptureComp2DData : SceneCaptureComp2DDataList)
+    {
+        if (SceneCaptureComp2DData.SceneCaptureComp2D)
+        {
+            SceneCaptureComp2DData.SceneCaptureComp2D->SetReadbackRequestHandler(NewHandler);
+        }
+    }
+    // NOTE: The host feature extractor belong to the same viewpoint so it use the same handler
+    if (SharedSceneCaptureComponent)
+    {
+        SharedSceneCaptureComponent->SetReadbackRequestHandler(NewHandler);
+    }
+}
+
+int32 UNVSceneFeatureExtractor_PixelData::GetBatchedReadbackCount() const
+{
+    int32 ComponentCount = (SharedSceneCaptureComponent && !SharedSceneCaptureComponent->UsePooledTextureTarget()) ? 1 : 0;
+    for (const auto& SceneCaptureComp2DData : SceneCaptureComp2DDataList)
+    {
+        if (SceneCaptureComp2DData.SceneCaptureComp2D && !SceneCaptureComp2DData.SceneCaptureComp2D->UsePooledTextureTarget())
+        {
+            ComponentCount++;
+        }
+    }
+    return ComponentCount;
+}
+
+void UNVSceneFeatureExtractor_PixelData::FlushPendingReadbacks()
+{
+    // NOTE: The shared scene capture component is flushed by the feature extractor hosting it
+    for (auto& SceneCaptureComp2DData : SceneCaptureComp2DDataList)
+    {
+        if (SceneCaptureComp2DData.SceneCaptureComp2D)
+        {
+            SceneCaptureComp2DData.SceneCaptureComp2D->FlushPendingReadbacks();
+        }
+    }
+}
+
 void UNVSceneFeatureExtractor_PixelData::UpdateCapturerSettings()
 {
     if (OwnerViewpoint)
@@ -180,6 +313,11 @@ void UNVSceneFeatureExtractor_PixelData::UpdateCapturerSettings()
             if (SceneCaptureComp2D)
             {
                 SceneCaptureComp2D->FOVAngle = OwnerViewpoint->GetCapturerSettings().FOVAngle;
+                // The pooled render target is leased again for every capture so it can follow the captured image size
+                if (SceneCaptureComp2D->UsePooledTextureTarget())
+                {
+                    SceneCaptureComp2D->TextureTargetSize = OwnerViewpoint->GetCapturerSettings().CapturedImageSize;
+                }
             }
         }
     }
@@ -222,17 +360,38 @@ UNVSceneFeatureExtractor_SceneDepth::UNVSceneFeatureExtractor_SceneDepth(const F
 {
     DisplayName = TEXT("Depth");
     MaxDepthDistance = 3000.f;
+    DepthEncoding = ENVDepthEncoding::Normalized8;
 	CapturedPixelFormat = ENVCapturedPixelFormat::R8;
 }
 
+bool UNVSceneFeatureExtractor_SceneDepth::GetSharedCaptureOutput(ENVSceneCaptureOutput& OutOutput, float& OutOutputScale) const
+{
+    // Quantize the depth the same way as the depth post process material
+    OutOutput = ENVSceneCaptureOutput::SceneDepth;
+    OutOutputScale = (UseNormalizedDepth() && (MaxDepthDistance > 0.f)) ? (1.f / MaxDepthDistance) : 1.f;
+    return true;
+}
+
+bool UNVSceneFeatureExtractor_SceneDepth::UseNormalizedDepth() const
+{
+    return (DepthEncoding == ENVDepthEncoding::Normalized8);
+}
+
+ENVCapturedPixelFormat UNVSceneFeatureExtractor_SceneDepth::GetEffectiveCapturedPixelFormat() const
+{
+    // NOTE: The user's CapturedPixelFormat is kept so it's used again when switching back to Normalized8
+    return UseNormalizedDepth() ? Super::GetEffectiveCapturedPixelFormat() : ConvertDepthEncodingToCapturedFormat(DepthEncoding);
+}
+
 void UNVSceneFeatureExtractor_SceneDepth::UpdateMaterial()
 {
     Super::UpdateMaterial();
 
     if (PostProcessMaterialInstance)
     {
+        // The material divide the depth by the max distance, the encodings other than Normalized8 need the raw depth in cm
         static const FName MaxDepthParamName = FName(TEXT("MaxDepthDistance"));
-        PostProcessMaterialInstance->SetScalarParameterValue(MaxDepthParamName, MaxDepthDistance);
+        PostProcessMaterialInstance->SetScalarParameterValue(MaxDepthParamName, UseNormalizedDepth() ? MaxDepthDistance : 1.f);
     }
 }
 
@@ -242,6 +401,19 @@ UNVSceneFeatureExtractor_ScenePixelVelocity::UNVSceneFeatureExtractor_ScenePixel
     DisplayName = TEXT("PixelVelocity");
 }
 
+bool UNVSceneFeatureExtractor_ScenePixelVelocity::GetSharedCaptureOutput(ENVSceneCaptureOutput& OutOutput, float& OutOutputScale) const
+{
+    OutOutput = ENVSceneCaptureOutput::Velocity;
+    OutOutputScale = 1.f;
+    return true;
+}
+
+bool UNVSceneFeatureExtractor_ScenePixelVelocity::CanHostSharedSceneCapture() const
+{
+    // NOTE: The velocity scene capture doesn't render the scene color
+    return false;
+}
+
 void UNVSceneFeatureExtractor_ScenePixelVelocity::UpdateSettings()
 {
     Super::UpdateSettings();
@@ -255,6 +427,8 @@ void UNVSceneFeatureExtractor_ScenePixelVelocity::UpdateSettings()
             SceneCaptureComp2D->CaptureSource = ESceneCaptureSource::SCS_PixelVelocity;
 #endif // UE_SUPPORT_PIXEL_VELOCTY
             SceneCaptureComp2D->TextureTargetFormat = ETextureRenderTargetFormat::RTF_RG32f;
+            // The velocity doesn't fit any captured pixel format, read it back as is
+            SceneCaptureComp2D->ReadbackPixelFormat = ENVCapturedPixelFormat::NVCapturedPixelFormat_MAX;
         }
     }
 }
@@ -266,6 +440,14 @@ UNVSceneFeatureExtractor_StencilMask::UNVSceneFeatureExtractor_StencilMask(const
 	CapturedPixelFormat = ENVCapturedPixelFormat::R8;
 }
 
+bool UNVSceneFeatureExtractor_StencilMask::GetSharedCaptureOutput(ENVSceneCaptureOutput& OutOutput, float& OutOutputScale) const
+{
+    // Store the raw stencil value in the 8 bits channel
+    OutOutput = ENVSceneCaptureOutput::CustomStencil;
+    OutOutputScale = 1.f / 255.f;
+    return true;
+}
+
 void UNVSceneFeatureExtractor_StencilMask::UpdateSettings()
 {
     Super::UpdateSettings();
@@ -284,6 +466,12 @@ UNVSceneFeatureExtractor_VertexColorMask::UNVSceneFeatureExtractor_VertexColorMa
     DisplayName = TEXT("VertexColorMask");
 }
 
+bool UNVSceneFeatureExtractor_VertexColorMask::CanHostSharedSceneCapture() const
+{
+    // NOTE: The vertex color scene capture override the show flags so its depth and velocity don't match the normal view
+    return false;
+}
+
 void UNVSceneFeatureExtractor_VertexColorMask::UpdateSettings()
 {
     Super::UpdateSettings();
@@ -312,6 +500,7 @@ void UNVSceneFeatureExtractor_VertexColorMask::UpdateSettings()
         OverrideShowFlags.SetTonemapper(false);
         OverrideShowFlags.SetColorGrading(false);
 
+        SceneCaptureComponent->TextureTargetGamma = 1.f;
         if (SceneCaptureComponent->TextureTarget)
         {
             SceneCaptureComponent->TextureTarget->TargetGamma = 1.f;
@@ -15,31 +15,449 @@
 #include "RenderingThread.h"
 #include "RendererInterface.h"
 #include "StaticBoundShaderState.h"
+#include "ShaderParameterUtils.h"
 #include "Engine/TextureRenderTarget2D.h"
+#include "Async/Async.h"
 
 DEFINE_LOG_CATEGORY(LogNVTextureReader);
 
+// Number of times the rendering commands were flushed to finish a readback, see FNVTextureReader::GetSyncFlushCount
+static FThreadSafeCounter GNVReadbackSyncFlushCounter;
+
+//======================= TNVPackPixelsPS =======================//
+/// Pixel shader which convert the pixels of the source texture to the layout they are read back in, see NVPackPixels.usf
+template<ENVPixelPackMode PackModeType>
+class TNVPackPixelsPS : public FGlobalShader
+{
+    DECLARE_SHADER_TYPE(TNVPackPixelsPS, Global);
+
+public:
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM4);
+    }
+
+    TNVPackPixelsPS() {}
+
+    TNVPackPixelsPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer) : FGlobalShader(Initializer)
+    {
+        InTexture.Bind(Initializer.ParameterMap, TEXT("InTexture"), SPF_Mandatory);
+        InTextureSampler.Bind(Initializer.ParameterMap, TEXT("InTextureSampler"));
+    }
+
+    void SetParameters(FRHICommandList& RHICmdList, FTextureRHIParamRef Texture)
+    {
+        // NOTE: The ids and depths can't be interpolated, always use point sampling
+        SetTextureParameter(RHICmdList, GetPixelShader(), InTexture, InTextureSampler, TStaticSamplerState<SF_Point>::GetRHI(), Texture);
+    }
+
+    virtual bool Serialize(FArchive& Ar) override
+    {
+        const bool bShaderHasOutdatedParameters = FGlobalShader::Serialize(Ar);
+        Ar << InTexture;
+        Ar << InTextureSampler;
+        return bShaderHasOutdatedParameters;
+    }
+
+private:
+    FShaderResourceParameter InTexture;
+    FShaderResourceParameter InTextureSampler;
+};
+
+typedef TNVPackPixelsPS<ENVPixelPackMode::PackId24> FNVPackId24PS;
+typedef TNVPackPixelsPS<ENVPixelPackMode::EncodeDepthMillimeters16> FNVEncodeDepthMillimeters16PS;
+typedef TNVPackPixelsPS<ENVPixelPackMode::EncodeDepthLog16> FNVEncodeDepthLog16PS;
+typedef TNVPackPixelsPS<ENVPixelPackMode::EncodeDepthHalf16> FNVEncodeDepthHalf16PS;
+
+IMPLEMENT_SHADER_TYPE(template<>, FNVPackId24PS, TEXT("/Plugin/NVSceneCapturer/Private/NVPackPixels.usf"), TEXT("PackId24PS"), SF_Pixel);
+IMPLEMENT_SHADER_TYPE(template<>, FNVEncodeDepthMillimeters16PS, TEXT("/Plugin/NVSceneCapturer/Private/NVPackPixels.usf"), TEXT("EncodeDepthMillimeters16PS"), SF_Pixel);
+IMPLEMENT_SHADER_TYPE(template<>, FNVEncodeDepthLog16PS, TEXT("/Plugin/NVSceneCapturer/Private/NVPackPixels.usf"), TEXT("EncodeDepthLog16PS"), SF_Pixel);
+IMPLEMENT_SHADER_TYPE(template<>, FNVEncodeDepthHalf16PS, TEXT("/Plugin/NVSceneCapturer/Private/NVPackPixels.usf"), TEXT("EncodeDepthHalf16PS"), SF_Pixel);
+
+// Helpers to bind the pack shader of a pack mode, see FNVTextureReader::CopyTexture2d
+template<typename ShaderType>
+static FPixelShaderRHIParamRef GetPackPixelsShader(TShaderMap<FGlobalShaderType>* ShaderMap)
+{
+    TShaderMapRef<ShaderType> PackPixelShader(ShaderMap);
+    return GETSAFERHISHADER_PIXEL(*PackPixelShader);
+}
+
+template<typename ShaderType>
+static void SetPackPixelsShaderParameters(FRHICommandList& RHICmdList, TShaderMap<FGlobalShaderType>* ShaderMap, FTextureRHIParamRef SourceTexture)
+{
+    TShaderMapRef<ShaderType> PackPixelShader(ShaderMap);
+    PackPixelShader->SetParameters(RHICmdList, SourceTexture);
+}
+
+//======================= FNVTextureReadbackRing =======================//
+FNVTextureReadbackRing::FNVReadbackSlot::FNVReadbackSlot()
+{
+    ReadbackTexture = nullptr;
+    ReadbackFence = nullptr;
+    PixelFormat = EPixelFormat::PF_Unknown;
+    TextureSize = FIntPoint::ZeroValue;
+    QueuedFrameNumber = 0;
+    bIsPending = false;
+}
+
+FNVTextureReadbackRing::FNVTextureReadbackRing()
+{
+    MaxReadbackTextureCount = 3;
+    MaxFrameLatency = 2;
+}
+
+FNVTextureReadbackRing::~FNVTextureReadbackRing()
+{
+    ReadbackSlots.Reset();
+    PendingSlotIndexes.Reset();
+}
+
+void FNVTextureReadbackRing::SetSettings(int32 NewMaxReadbackTextureCount, int32 NewMaxFrameLatency)
+{
+    MaxReadbackTextureCount = FMath::Max(NewMaxReadbackTextureCount, 1);
+    MaxFrameLatency = FMath::Max(NewMaxFrameLatency, 0);
+}
+
+FTexture2DRHIRef FNVTextureReadbackRing::AcquireReadbackTexture(FRHICommandListImmediate& RHICmdList, EPixelFormat PixelFormat,
+                                                                const FIntPoint& TextureSize, int32& OutSlotIndex)
+{
+    check(IsInRenderingThread());
+
+    // Prefer a free texture which already has the same size and format so we don't need to recreate it
+    OutSlotIndex = INDEX_NONE;
+    for (int32 i = 0; i < ReadbackSlots.Num(); i++)
+    {
+        const FNVReadbackSlot& CheckSlot = ReadbackSlots[i];
+        if (!CheckSlot.bIsPending)
+        {
+            if ((CheckSlot.PixelFormat == PixelFormat) && (CheckSlot.TextureSize == TextureSize) && CheckSlot.ReadbackTexture)
+            {
+                OutSlotIndex = i;
+                break;
+            }
+            else if (OutSlotIndex == INDEX_NONE)
+            {
+                OutSlotIndex = i;
+            }
+        }
+    }
+
+    if ((OutSlotIndex == INDEX_NONE) && (ReadbackSlots.Num() < MaxReadbackTextureCount))
+    {
+        OutSlotIndex = ReadbackSlots.Add(FNVReadbackSlot());
+    }
+
+    // All the textures are in use, finish the oldest readback to free its texture
+    if ((OutSlotIndex == INDEX_NONE) && (PendingSlotIndexes.Num() > 0))
+    {
+        OutSlotIndex = PendingSlotIndexes[0];
+        FinishReadback(RHICmdList, OutSlotIndex);
+    }
+
+    check(ReadbackSlots.IsValidIndex(OutSlotIndex));
+    FNVReadbackSlot& ReadbackSlot = ReadbackSlots[OutSlotIndex];
+    if (!ReadbackSlot.ReadbackTexture || (ReadbackSlot.PixelFormat != PixelFormat) || (ReadbackSlot.TextureSize != TextureSize))
+    {
+        FRHIResourceCreateInfo CreateInfo(FClearValueBinding::None);
+        ReadbackSlot.ReadbackTexture.SafeRelease();
+        ReadbackSlot.ReadbackTexture = RHICreateTexture2D(
+                                           TextureSize.X,
+                                           TextureSize.Y,
+                                           PixelFormat,
+                                           1,
+                                           1,
+                                           TexCreate_CPUReadback,
+                                           CreateInfo
+                                       );
+        ReadbackSlot.PixelFormat = PixelFormat;
+        ReadbackSlot.TextureSize = TextureSize;
+    }
+
+    return ReadbackSlot.ReadbackTexture;
+}
+
+void FNVTextureReadbackRing::QueueReadback(FRHICommandListImmediate& RHICmdList, int32 SlotIndex, OnFinishedReadingRawPixelsCallback Callback)
+{
+    check(IsInRenderingThread());
+
+    ensure(ReadbackSlots.IsValidIndex(SlotIndex));
+    if (!ReadbackSlots.IsValidIndex(SlotIndex))
+    {
+        UE_LOG(LogNVTextureReader, Error, TEXT("invalid argument."));
+        // The readback was counted when it was requested but it will never finish
+        PendingReadbackCounter.Decrement();
+    }
+    else
+    {
+        FNVReadbackSlot& ReadbackSlot = ReadbackSlots[SlotIndex];
+        ReadbackSlot.Callback = MoveTemp(Callback);
+        ReadbackSlot.QueuedFrameNumber = GFrameNumberRenderThread;
+        ReadbackSlot.bIsPending = true;
+
+        // The fence is signaled when the GPU finished all the commands before it, including the copy to the readback texture
+        ReadbackSlot.ReadbackFence = RHICreateGPUFence(TEXT("NVReadbackFence"));
+        if (ReadbackSlot.ReadbackFence)
+        {
+            RHICmdList.WriteGPUFence(ReadbackSlot.ReadbackFence);
+        }
+
+        PendingSlotIndexes.Add(SlotIndex);
+    }
+}
+
+bool FNVTextureReadbackRing::IsReadbackReady(const FNVReadbackSlot& CheckSlot) const
+{
+    if (!CheckSlot.bIsPending)
+    {
+        return false;
+    }
+
+    // Don't wait for too long, mapping the texture will just block until the GPU finished copying it
+    const uint32 WaitedFrameCount = GFrameNumberRenderThread - CheckSlot.QueuedFrameNumber;
+    if (WaitedFrameCount >= (uint32)MaxFrameLatency)
+    {
+        return true;
+    }
+
+    return CheckSlot.ReadbackFence && CheckSlot.ReadbackFence->Poll();
+}
+
+void FNVTextureReadbackRing::FinishReadback(FRHICommandListImmediate& RHICmdList, int32 SlotIndex)
+{
+    FNVReadbackSlot& ReadbackSlot = ReadbackSlots[SlotIndex];
+    if (ReadbackSlot.bIsPending)
+    {
+        // Stage the texture to read back its pixels data
+        FIntPoint PixelSize = FIntPoint::ZeroValue;
+        void* PixelDataBuffer = nullptr;
+        RHICmdList.MapStagingSurface(ReadbackSlot.ReadbackTexture, PixelDataBuffer, PixelSize.X, PixelSize.Y);
+
+        if (PixelDataBuffer && ReadbackSlot.Callback)
+        {
+            ReadbackSlot.Callback((uint8*)PixelDataBuffer, ReadbackSlot.PixelFormat, PixelSize);
+        }
+
+        RHICmdList.UnmapStagingSurface(ReadbackSlot.ReadbackTexture);
+    }
+
+    if (ReadbackSlot.bIsPending)
+    {
+        PendingReadbackCounter.Decrement();
+    }
+    ReadbackSlot.Callback = nullptr;
+    ReadbackSlot.ReadbackFence.SafeRelease();
+    ReadbackSlot.bIsPending = false;
+    PendingSlotIndexes.Remove(SlotIndex);
+}
+
+void FNVTextureReadbackRing::ProcessPendingReadbacks(FRHICommandListImmediate& RHICmdList, bool bFlushAll/*= false*/)
+{
+    check(IsInRenderingThread());
+
+    // NOTE: Only finish the readbacks in the order they were queued so the callbacks are always called in order
+    while (PendingSlotIndexes.Num() > 0)
+    {
+        const int32 CheckSlotIndex = PendingSlotIndexes[0];
+        if (!bFlushAll && !IsReadbackReady(ReadbackSlots[CheckSlotIndex]))
+        {
+            break;
+        }
+        FinishReadback(RHICmdList, CheckSlotIndex);
+    }
+}
+
+void FNVTextureReadbackRing::ReserveReadbackTextures(int32 ReadbackCountPerFrame)
+{
+    // The textures of the last MaxFrameLatency frames can still be waiting for the GPU
+    MaxReadbackTextureCount = FMath::Max(MaxReadbackTextureCount, ReadbackCountPerFrame * (MaxFrameLatency + 1));
+}
+
+void FNVTextureReadbackRing::Release()
+{
+    check(IsInRenderingThread());
+
+    for (FNVReadbackSlot& CheckSlot : ReadbackSlots)
+    {
+        CheckSlot.ReadbackTexture.SafeRelease();
+        CheckSlot.ReadbackFence.SafeRelease();
+        CheckSlot.Callback = nullptr;
+    }
+    ReadbackSlots.Reset();
+    PendingSlotIndexes.Reset();
+    PendingReadbackCounter.Reset();
+}
+
+//======================= FNVTextureReadbackRequest =======================//
+FNVTextureReadbackRequest::FNVTextureReadbackRequest()
+{
+    SourceTexture = nullptr;
+    SourceRenderTargetResource = nullptr;
+    SourceRect = FIntRect();
+    ReadbackPixelFormat = EPixelFormat::PF_Unknown;
+    ReadbackSize = FIntPoint::ZeroValue;
+    PackMode = ENVPixelPackMode::None;
+    bIgnoreAlpha = false;
+}
+
+FTexture2DRHIRef FNVTextureReadbackRequest::GetSourceTexture_RenderThread() const
+{
+    return FNVTextureReader::ResolveSourceTexture_RenderThread(SourceTexture, SourceRenderTargetResource);
+}
+
 //======================= FNVTextureReader =======================//
 FNVTextureReader::FNVTextureReader()
 {
     SourceTexture = nullptr;
+    SourceRenderTargetResource = nullptr;
+    OverrideReadbackPixelFormat = EPixelFormat::PF_Unknown;
+    PackMode = ENVPixelPackMode::None;
+    ReadbackRing = MakeShareable(new FNVTextureReadbackRing());
 }
 
 FNVTextureReader::~FNVTextureReader()
 {
     SourceTexture = nullptr;
+    SourceRenderTargetResource = nullptr;
+
+    // NOTE: The ring may still have pending readbacks, the render command keep it alive until they are released
+    if (ReadbackRing.IsValid())
+    {
+        ENQUEUE_UNIQUE_RENDER_COMMAND_ONEPARAMETER(
+            ReleaseReadbackRing,
+            TSharedPtr<FNVTextureReadbackRing, ESPMode::ThreadSafe>, InReadbackRing, ReadbackRing,
+        {
+            InReadbackRing->Release();
+        });
+        ReadbackRing.Reset();
+    }
+}
+
+void FNVTextureReader::SetReadbackSettings(int32 ReadbackTextureCount, int32 MaxFrameLatency)
+{
+    if (ReadbackRing.IsValid())
+    {
+        ENQUEUE_UNIQUE_RENDER_COMMAND_THREEPARAMETER(
+            SetReadbackRingSettings,
+            TSharedPtr<FNVTextureReadbackRing, ESPMode::ThreadSafe>, InReadbackRing, ReadbackRing,
+            int32, InReadbackTextureCount, ReadbackTextureCount,
+            int32, InMaxFrameLatency, MaxFrameLatency,
+        {
+            InReadbackRing->SetSettings(InReadbackTextureCount, InMaxFrameLatency);
+        });
+    }
+}
+
+void FNVTextureReader::ProcessPendingReadbacks()
+{
+    if (ReadbackRing.IsValid())
+    {
+        ENQUEUE_UNIQUE_RENDER_COMMAND_ONEPARAMETER(
+            ProcessPendingReadbacks,
+            TSharedPtr<FNVTextureReadbackRing, ESPMode::ThreadSafe>, InReadbackRing, ReadbackRing,
+        {
+            InReadbackRing->ProcessPendingReadbacks(RHICmdList, false);
+        });
+    }
+}
+
+void FNVTextureReader::FlushPendingReadbacks(bool bWaitForCompletion/*= false*/)
+{
+    if (ReadbackRing.IsValid())
+    {
+        ENQUEUE_UNIQUE_RENDER_COMMAND_ONEPARAMETER(
+            FlushPendingReadbacks,
+            TSharedPtr<FNVTextureReadbackRing, ESPMode::ThreadSafe>, InReadbackRing, ReadbackRing,
+        {
+            InReadbackRing->ProcessPendingReadbacks(RHICmdList, true);
+        });
+
+        if (bWaitForCompletion)
+        {
+            FlushRenderingCommandsForReadback(TEXT("FlushPendingReadbacks"), true);
+        }
+    }
+}
+
+int32 FNVTextureReader::GetPendingReadbackCount() const
+{
+    return ReadbackRing.IsValid() ? ReadbackRing->GetPendingReadbackCount() : 0;
+}
+
+int32 FNVTextureReader::GetSyncFlushCount()
+{
+    return GNVReadbackSyncFlushCounter.GetValue();
+}
+
+void FNVTextureReader::FlushRenderingCommandsForReadback(const TCHAR* Reason, bool bIsExpected)
+{
+    const int32 SyncFlushCount = GNVReadbackSyncFlushCounter.Increment();
+    if (bIsExpected)
+    {
+        UE_LOG(LogNVTextureReader, Log, TEXT("%s flushed the rendering commands, %d sync flushes so far."), Reason, SyncFlushCount);
+    }
+    else
+    {
+        UE_LOG(LogNVTextureReader, Warning, TEXT("%s blocked the game thread to flush the rendering commands, use the async readback instead. %d sync flushes so far."),
+            Reason, SyncFlushCount);
+    }
+
+    FlushRenderingCommands();
 }
 
 FNVTextureReader& FNVTextureReader::operator=(const FNVTextureReader& OtherReader)
 {
     SourceTexture = OtherReader.SourceTexture;
+    SourceRenderTargetResource = OtherReader.SourceRenderTargetResource;
     SourceRect = OtherReader.SourceRect;
     ReadbackPixelFormat = OtherReader.ReadbackPixelFormat;
     ReadbackSize = OtherReader.ReadbackSize;
+    OverrideReadbackPixelFormat = OtherReader.OverrideReadbackPixelFormat;
+    PackMode = OtherReader.PackMode;
+    // NOTE: Don't share the readback ring, each reader keep its own readback textures
 
     return (*this);
 }
 
+void FNVTextureReader::SetReadbackPixelFormat(ENVCapturedPixelFormat NewCapturedPixelFormat)
+{
+    PackMode = ENVPixelPackMode::None;
+    switch (NewCapturedPixelFormat)
+    {
+        case ENVCapturedPixelFormat::R8:
+            OverrideReadbackPixelFormat = EPixelFormat::PF_G8;
+            break;
+        case ENVCapturedPixelFormat::RGBA8:
+            OverrideReadbackPixelFormat = EPixelFormat::PF_B8G8R8A8;
+            break;
+        case ENVCapturedPixelFormat::R16f:
+            OverrideReadbackPixelFormat = EPixelFormat::PF_R16F;
+            break;
+        case ENVCapturedPixelFormat::R32f:
+            OverrideReadbackPixelFormat = EPixelFormat::PF_R32_FLOAT;
+            break;
+        case ENVCapturedPixelFormat::PackedId24:
+            OverrideReadbackPixelFormat = EPixelFormat::PF_B8G8R8A8;
+            PackMode = ENVPixelPackMode::PackId24;
+            break;
+        // NOTE: The encoded depths are written to a 16 bit normalized channel, the shader scale them so the read back bytes are the integer values
+        case ENVCapturedPixelFormat::DepthMillimeters16:
+            OverrideReadbackPixelFormat = EPixelFormat::PF_G16;
+            PackMode = ENVPixelPackMode::EncodeDepthMillimeters16;
+            break;
+        case ENVCapturedPixelFormat::DepthLog16:
+            OverrideReadbackPixelFormat = EPixelFormat::PF_G16;
+            PackMode = ENVPixelPackMode::EncodeDepthLog16;
+            break;
+        case ENVCapturedPixelFormat::DepthHalf16:
+            OverrideReadbackPixelFormat = EPixelFormat::PF_G16;
+            PackMode = ENVPixelPackMode::EncodeDepthHalf16;
+            break;
+        default:
+            OverrideReadbackPixelFormat = EPixelFormat::PF_Unknown;
+            break;
+    }
+}
+
 void FNVTextureReader::SetSourceTexture(FTexture2DRHIRef NewSourceTexture,
                                         const FIntRect& NewSourceRect /*= FIntRect()*/,
                                         EPixelFormat NewReadbackPixelFormat /*= EPixelFormat::PF_Unknown*/,
@@ -48,46 +466,77 @@ void FNVTextureReader::SetSourceTexture(FTexture2DRHIRef NewSourceTexture,
     // SourceTexture can be null by design.
     // so we don't check NewSourceTexture here.
     SourceTexture = NewSourceTexture;
+    SourceRenderTargetResource = nullptr;
     SourceRect = NewSourceRect;
     ReadbackPixelFormat = NewReadbackPixelFormat;
     ReadbackSize = NewReadbackSize;
 
     if (SourceTexture)
     {
-        if (ReadbackSize == FIntPoint::ZeroValue)
-        {
-            ReadbackSize = SourceTexture->GetSizeXY();
-        }
-        if (ReadbackPixelFormat == EPixelFormat::PF_Unknown)
-        {
-            ReadbackPixelFormat = SourceTexture->GetFormat();
+        UpdateReadbackSettings(SourceTexture->GetSizeXY(), SourceTexture->GetFormat());
+    }
+}
+
+void FNVTextureReader::SetSourceRenderTarget(FTextureRenderTargetResource* NewRenderTargetResource, const FIntPoint& TextureSize, EPixelFormat TextureFormat)
+{
+    SourceTexture = nullptr;
+    SourceRenderTargetResource = NewRenderTargetResource;
+    SourceRect = FIntRect();
+    ReadbackPixelFormat = EPixelFormat::PF_Unknown;
+    ReadbackSize = FIntPoint::ZeroValue;
+
+    if (SourceRenderTargetResource)
+    {
+        UpdateReadbackSettings(TextureSize, TextureFormat);
+    }
+}
+
+void FNVTextureReader::UpdateReadbackSettings(const FIntPoint& TextureSize, EPixelFormat TextureFormat)
+{
+    if (ReadbackSize == FIntPoint::ZeroValue)
+    {
+        ReadbackSize = TextureSize;
+    }
+    if (ReadbackPixelFormat == EPixelFormat::PF_Unknown)
+    {
+        ReadbackPixelFormat = (OverrideReadbackPixelFormat != EPixelFormat::PF_Unknown) ? OverrideReadbackPixelFormat : TextureFormat;
 
-            if (GDynamicRHI)
+        if (GDynamicRHI)
+        {
+            const FString RHIName = GDynamicRHI->GetName();
+            // NOTE: UE4's D3D11 implement of the RHI doesn't support all the pixel formats so we must change it to be another format with the same pixel size
+            if (RHIName.Contains(TEXT("D3D11")))
             {
-                const FString RHIName = GDynamicRHI->GetName();
-                // NOTE: UE4's D3D11 implement of the RHI doesn't support all the pixel formats so we must change it to be another format with the same pixel size
-                if (RHIName.Contains(TEXT("D3D11")))
+                if ((ReadbackPixelFormat == PF_R16F) || (ReadbackPixelFormat == PF_R16_UINT))
                 {
-                    if ((ReadbackPixelFormat == PF_R16F) || (ReadbackPixelFormat == PF_R16_UINT))
-                    {
-                        ReadbackPixelFormat = PF_ShadowDepth;
-                    }
-                }
-                // TODO: Should we ignore non-supported pixel format?
-				// NOTE: Since we read back the pixel in bytes, we need to change the format to be uint mode instead of float
-                if (ReadbackPixelFormat == PF_R32_FLOAT)
-                {
-                    ReadbackPixelFormat = PF_R32_UINT;
+                    ReadbackPixelFormat = PF_ShadowDepth;
                 }
             }
+            // TODO: Should we ignore non-supported pixel format?
+			// NOTE: Since we read back the pixel in bytes, we need to change the format to be uint mode instead of float
+            if (ReadbackPixelFormat == PF_R32_FLOAT)
+            {
+                ReadbackPixelFormat = PF_R32_UINT;
+            }
         }
-        if (SourceRect.IsEmpty())
-        {
-            SourceRect = FIntRect(FIntPoint::ZeroValue, SourceTexture->GetSizeXY());
-        }
+    }
+    if (SourceRect.IsEmpty())
+    {
+        SourceRect = FIntRect(FIntPoint::ZeroValue, TextureSize);
     }
 }
 
+FTexture2DRHIRef FNVTextureReader::ResolveSourceTexture_RenderThread(const FTexture2DRHIRef& SourceTexture, const FTextureRenderTargetResource* SourceRenderTargetResource)
+{
+    check(IsInRenderingThread());
+
+    if (SourceRenderTargetResource)
+    {
+        return SourceRenderTargetResource->GetRenderTargetTexture();
+    }
+    return SourceTexture;
+}
+
 // Read back the pixels data from the current source texture
 // NOTE: This function is sync, the pixels data is returned right away but it may cause the game to hitches since it flush the rendering commands
 bool FNVTextureReader::ReadPixelsData(FNVTexturePixelData& OutPixelsData)
@@ -113,7 +562,7 @@ bool FNVTextureReader::ReadPixelsData(FNVTexturePixelData& OutPixelsData)
                 InRenderCommand(RHICmdList);
             });
 
-        FlushRenderingCommands();
+        FlushRenderingCommandsForReadback(TEXT("ReadPixelsData"), false);
         bResult = true;
     }
     return bResult; 
@@ -143,19 +592,81 @@ bool FNVTextureReader::ReadPixelsData(OnFinishedReadingPixelsDataCallback Callba
     }
     else
     {
-        if (SourceTexture)
+        if (HasSourceTexture())
         {
-            bResult = ReadPixelsRaw(SourceTexture,
-                SourceRect, ReadbackPixelFormat, ReadbackSize, bIgnoreAlpha,
-                [=](uint8* PixelData, EPixelFormat PixelFormat, FIntPoint PixelSize)
+            if (ReadbackRing.IsValid())
             {
-                Callback(BuildPixelData(PixelData, PixelFormat, PixelSize, ReadbackSize));
-            });
+                ReadbackRing->OnReadbackRequested();
+            }
+            bResult = ReadPixelsRaw(SourceTexture, SourceRenderTargetResource,
+                SourceRect, ReadbackPixelFormat, ReadbackSize, bIgnoreAlpha, PackMode,
+                [Callback = MoveTemp(Callback), TargetSize = ReadbackSize](uint8* PixelData, EPixelFormat PixelFormat, FIntPoint PixelSize)
+            {
+                Callback(BuildPixelData(PixelData, PixelFormat, PixelSize, TargetSize));
+            }, ReadbackRing);
+            // Nothing was enqueued, don't leave the readback counted as pending forever
+            if (!bResult && ReadbackRing.IsValid())
+            {
+                ReadbackRing->OnReadbackCanceled();
+            }
         }
     }
     return bResult;
 }
 
+namespace
+{
+    /// Promise of the pixels data read back by ReadPixelsDataAsync
+    /// NOTE: The ring drop the callbacks of the readbacks it can't finish (e.g: when it's released or the texture can't be mapped),
+    /// the future get a null pixels data when the promise is destroyed with them instead of waiting forever
+    struct FNVPixelsDataPromise
+    {
+    public:
+        FNVPixelsDataPromise() : bIsSet(false) {}
+        ~FNVPixelsDataPromise()
+        {
+            if (!bIsSet)
+            {
+                Promise.SetValue(nullptr);
+            }
+        }
+
+        TFuture<FNVTexturePixelDataRef> GetFuture()
+        {
+            return Promise.GetFuture();
+        }
+
+        void SetValue(const FNVTexturePixelDataRef& PixelsData)
+        {
+            bIsSet = true;
+            Promise.SetValue(PixelsData);
+        }
+
+    protected:
+        TPromise<FNVTexturePixelDataRef> Promise;
+        bool bIsSet;
+    };
+}
+
+TFuture<FNVTexturePixelDataRef> FNVTextureReader::ReadPixelsDataAsync(bool bIgnoreAlpha/*= false*/)
+{
+    TSharedRef<FNVPixelsDataPromise, ESPMode::ThreadSafe> PixelsDataPromise = MakeShareable(new FNVPixelsDataPromise());
+    TFuture<FNVTexturePixelDataRef> PixelsDataFuture = PixelsDataPromise->GetFuture();
+
+    // NOTE: If nothing is read back, the callback is released right away and the future get a null pixels data
+    ReadPixelsData([PixelsDataPromise](const FNVTexturePixelDataRef& PixelsData)
+    {
+        // NOTE: The pixels are copied on the rendering thread while the readback texture is mapped,
+        // hand them over to a worker thread so whatever wait for the future doesn't run on the rendering thread
+        AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [PixelsDataPromise, PixelsData]()
+        {
+            PixelsDataPromise->SetValue(PixelsData);
+        });
+    }, bIgnoreAlpha);
+
+    return PixelsDataFuture;
+}
+
 bool FNVTextureReader::ReadPixelsData(OnFinishedReadingPixelsDataCallback Callback,
                                       const FTexture2DRHIRef& NewSourceTexture,
                                       const FIntRect& NewSourceRect /*= FIntRect()*/,
@@ -168,17 +679,178 @@ bool FNVTextureReader::ReadPixelsData(OnFinishedReadingPixelsDataCallback Callba
     return ReadPixelsData(Callback, bIgnoreAlpha);
 }
 
-bool FNVTextureReader::ReadPixelsRaw(const FTexture2DRHIRef& NewSourceTexture, const FIntRect& SourceRect,
-                                     EPixelFormat TargetPixelFormat, const FIntPoint& TargetSize, bool bIgnoreAlpha, OnFinishedReadingRawPixelsCallback Callback)
+bool FNVTextureReader::BuildReadbackRequest(OnFinishedReadingPixelsDataCallback Callback, bool bIgnoreAlpha, FNVTextureReadbackRequest& OutRequest)
+{
+    bool bResult = false;
+
+    ensure(Callback);
+    if (!Callback)
+    {
+        UE_LOG(LogNVTextureReader, Error, TEXT("invalid argument."));
+    }
+    else if (HasSourceTexture())
+    {
+        OutRequest.SourceTexture = SourceTexture;
+        OutRequest.SourceRenderTargetResource = SourceRenderTargetResource;
+        OutRequest.SourceRect = SourceRect;
+        OutRequest.ReadbackPixelFormat = ReadbackPixelFormat;
+        OutRequest.ReadbackSize = ReadbackSize;
+        OutRequest.PackMode = PackMode;
+        OutRequest.bIgnoreAlpha = bIgnoreAlpha;
+        OutRequest.Callback = MoveTemp(Callback);
+        bResult = true;
+    }
+    return bResult;
+}
+
+bool FNVTextureReader::ReadPixelsDataBatch(TArray<FNVTextureReadbackRequest>& Requests)
+{
+    bool bResult = false;
+
+    ensure(ReadbackRing.IsValid());
+    if (!ReadbackRing.IsValid())
+    {
+        UE_LOG(LogNVTextureReader, Error, TEXT("invalid argument."));
+    }
+    else if (Requests.Num() > 0)
+    {
+        // The requests packed in 1 readback texture, stacked from top to bottom
+        struct FNVReadbackAtlas
+        {
+            EPixelFormat PixelFormat;
+            FIntPoint AtlasSize;
+            TArray<FNVTextureReadbackRequest> Requests;
+            TArray<int32> RowOffsets;
+        };
+        TArray<FNVReadbackAtlas> ReadbackAtlases;
+
+        // NOTE: Textures with different pixel formats can't share a readback texture
+        const int32 MaxAtlasHeight = (GMaxTextureDimensions > 0) ? (int32)GMaxTextureDimensions : MAX_int32;
+        for (FNVTextureReadbackRequest& CheckRequest : Requests)
+        {
+            const bool bHasSourceTexture = CheckRequest.SourceTexture.IsValid() || (CheckRequest.SourceRenderTargetResource != nullptr);
+            ensure(bHasSourceTexture);
+            ensure(CheckRequest.Callback);
+            if (!bHasSourceTexture
+                    || (CheckRequest.SourceRect.Area() == 0)
+                    || (CheckRequest.ReadbackSize == FIntPoint::ZeroValue)
+                    || (!CheckRequest.Callback))
+            {
+                UE_LOG(LogNVTextureReader, Error, TEXT("invalid argument."));
+                continue;
+            }
+
+            FNVReadbackAtlas* ReadbackAtlas = ReadbackAtlases.FindByPredicate([&CheckRequest, MaxAtlasHeight](const FNVReadbackAtlas& CheckAtlas)
+            {
+                return (CheckAtlas.PixelFormat == CheckRequest.ReadbackPixelFormat)
+                    && (CheckAtlas.AtlasSize.Y + CheckRequest.ReadbackSize.Y <= MaxAtlasHeight);
+            });
+            if (!ReadbackAtlas)
+            {
+                ReadbackAtlas = &ReadbackAtlases[ReadbackAtlases.AddDefaulted()];
+                ReadbackAtlas->PixelFormat = CheckRequest.ReadbackPixelFormat;
+                ReadbackAtlas->AtlasSize = FIntPoint::ZeroValue;
+            }
+
+            ReadbackAtlas->RowOffsets.Add(ReadbackAtlas->AtlasSize.Y);
+            ReadbackAtlas->AtlasSize.X = FMath::Max(ReadbackAtlas->AtlasSize.X, CheckRequest.ReadbackSize.X);
+            ReadbackAtlas->AtlasSize.Y += CheckRequest.ReadbackSize.Y;
+            ReadbackAtlas->Requests.Add(MoveTemp(CheckRequest));
+        }
+        UE_LOG(LogNVTextureReader, Verbose, TEXT("Batch read back %d textures using %d readback textures."), Requests.Num(), ReadbackAtlases.Num());
+        Requests.Reset();
+
+        if (ReadbackAtlases.Num() > 0)
+        {
+            const int32 ReadbackCount = ReadbackAtlases.Num();
+
+            static const FName RendererModuleName("Renderer");
+            // Load the renderer module on the main thread, as the module manager is not thread-safe
+            IRendererModule* RendererModule = &FModuleManager::GetModuleChecked<IRendererModule>(RendererModuleName);
+            check(RendererModule);
+
+            auto RenderCommand = [RendererModule, InReadbackRing = ReadbackRing, InReadbackAtlases = MoveTemp(ReadbackAtlases)](FRHICommandListImmediate& RHICmdList)
+            {
+                InReadbackRing->ReserveReadbackTextures(InReadbackAtlases.Num());
+
+                for (const FNVReadbackAtlas& ReadbackAtlas : InReadbackAtlases)
+                {
+                    int32 SlotIndex = INDEX_NONE;
+                    FTexture2DRHIRef ReadbackTexture = InReadbackRing->AcquireReadbackTexture(RHICmdList, ReadbackAtlas.PixelFormat, ReadbackAtlas.AtlasSize, SlotIndex);
+
+                    // Only keep what we need to split the pixels, the source textures don't need to stay alive until the readback is finished
+                    TArray<OnFinishedReadingPixelsDataCallback> Callbacks;
+                    TArray<FIntPoint> ReadbackSizes;
+                    for (int32 i = 0; i < ReadbackAtlas.Requests.Num(); i++)
+                    {
+                        const FNVTextureReadbackRequest& CheckRequest = ReadbackAtlas.Requests[i];
+                        const FIntPoint TargetMin(0, ReadbackAtlas.RowOffsets[i]);
+                        const FIntRect TargetRect(TargetMin, TargetMin + CheckRequest.ReadbackSize);
+                        const FTexture2DRHIRef SourceTexture = CheckRequest.GetSourceTexture_RenderThread();
+                        if (SourceTexture)
+                        {
+                            CopyTexture2d(RendererModule, RHICmdList, SourceTexture, CheckRequest.SourceRect, ReadbackTexture, TargetRect,
+                                !CheckRequest.bIgnoreAlpha, CheckRequest.PackMode);
+                        }
+                        else
+                        {
+                            UE_LOG(LogNVTextureReader, Error, TEXT("The source render target of a batched readback doesn't have a texture, its pixels are undefined."));
+                        }
+
+                        Callbacks.Add(CheckRequest.Callback);
+                        ReadbackSizes.Add(CheckRequest.ReadbackSize);
+                    }
+
+                    InReadbackRing->QueueReadback(RHICmdList, SlotIndex,
+                        [Callbacks = MoveTemp(Callbacks), ReadbackSizes = MoveTemp(ReadbackSizes), RowOffsets = ReadbackAtlas.RowOffsets]
+                        (uint8* PixelData, EPixelFormat PixelFormat, FIntPoint PixelSize)
+                    {
+                        // NOTE: PixelSize.X is the row pitch of the mapped texture, it can be larger than the atlas' width
+                        const SIZE_T RowByteSize = (SIZE_T)PixelSize.X * NVSceneCapturerUtils::GetPixelByteSize(PixelFormat);
+                        for (int32 i = 0; i < Callbacks.Num(); i++)
+                        {
+                            uint8* RegionPixelData = PixelData + RowOffsets[i] * RowByteSize;
+                            const FIntPoint RegionSize(PixelSize.X, FMath::Min(ReadbackSizes[i].Y, PixelSize.Y - RowOffsets[i]));
+                            Callbacks[i](BuildPixelData(RegionPixelData, PixelFormat, RegionSize, ReadbackSizes[i]));
+                        }
+                    });
+                }
+
+                InReadbackRing->ProcessPendingReadbacks(RHICmdList);
+            };
+
+            // NOTE: Only count the readbacks which are actually enqueued, the ring uncount them when they finish or fail to be queued
+            for (int32 i = 0; i < ReadbackCount; i++)
+            {
+                ReadbackRing->OnReadbackRequested();
+            }
+            ENQUEUE_UNIQUE_RENDER_COMMAND_ONEPARAMETER(
+                ReadPixelsBatchFromTextures,
+                TFunction<void(FRHICommandListImmediate&)>, InRenderCommand, RenderCommand,
+            {
+                InRenderCommand(RHICmdList);
+            });
+            bResult = true;
+        }
+    }
+    return bResult;
+}
+
+bool FNVTextureReader::ReadPixelsRaw(const FTexture2DRHIRef& NewSourceTexture, FTextureRenderTargetResource* SourceRenderTargetResource,
+                                     const FIntRect& SourceRect,
+                                     EPixelFormat TargetPixelFormat, const FIntPoint& TargetSize, bool bIgnoreAlpha, ENVPixelPackMode PackMode,
+                                     OnFinishedReadingRawPixelsCallback Callback,
+                                     TSharedPtr<FNVTextureReadbackRing, ESPMode::ThreadSafe> ReadbackRing/*= nullptr*/)
 {
     bool bResult = false;
 
     // Make sure the source render target and area settings are valid
-    ensure(NewSourceTexture);
+    const bool bHasSourceTexture = NewSourceTexture.IsValid() || (SourceRenderTargetResource != nullptr);
+    ensure(bHasSourceTexture);
     ensure(SourceRect.Area() != 0);
     ensure(TargetSize != FIntPoint::ZeroValue);
     ensure(Callback);
-    if (!NewSourceTexture
+    if (!bHasSourceTexture
             || (SourceRect.Area() == 0)
             || (TargetSize == FIntPoint::ZeroValue)
             || (!Callback))
@@ -200,9 +872,30 @@ bool FNVTextureReader::ReadPixelsRaw(const FTexture2DRHIRef& NewSourceTexture, c
         // of a viewport
         auto RenderCommand = [=](FRHICommandListImmediate& RHICmdList)
         {
+            const FTexture2DRHIRef SourceTexture = ResolveSourceTexture_RenderThread(NewSourceTexture, SourceRenderTargetResource);
+            if (!SourceTexture)
+            {
+                UE_LOG(LogNVTextureReader, Error, TEXT("The source render target doesn't have a texture, nothing is read back."));
+                if (ReadbackRing.IsValid())
+                {
+                    ReadbackRing->OnReadbackCanceled();
+                }
+                return;
+            }
+
+            const bool bOverwriteAlpha = !bIgnoreAlpha;
+            if (ReadbackRing.IsValid())
+            {
+                // Copy to a persistent texture from the ring and only map it after the GPU finished copying
+                int32 SlotIndex = INDEX_NONE;
+                FTexture2DRHIRef ReadbackTexture = ReadbackRing->AcquireReadbackTexture(RHICmdList, TargetPixelFormat, TargetSize, SlotIndex);
+                CopyTexture2d(RendererModule, RHICmdList, SourceTexture, SourceRect, ReadbackTexture, FIntRect(FIntPoint::ZeroValue, TargetSize), bOverwriteAlpha, PackMode);
+                ReadbackRing->QueueReadback(RHICmdList, SlotIndex, Callback);
+                ReadbackRing->ProcessPendingReadbacks(RHICmdList);
+                return;
+            }
+
             FRHIResourceCreateInfo CreateInfo(FClearValueBinding::None);
-            // TODO: Can cache the ReadbackTexture and reuse it if the format and size doesn't change instead of creating it everytime we read like this
-            // Need to be careful with reusing the ReadbackTexture: need to make sure the texture is already finished reading
             FTexture2DRHIRef ReadbackTexture = RHICreateTexture2D(
                                                    TargetSize.X,
                                                    TargetSize.Y,
@@ -213,9 +906,8 @@ bool FNVTextureReader::ReadPixelsRaw(const FTexture2DRHIRef& NewSourceTexture, c
                                                    CreateInfo
                                                );
 
-            bool bOverwriteAlpha = !bIgnoreAlpha;
             // Copy the source texture to the readback texture so we can read it back later even after the source texture is modified
-            CopyTexture2d(RendererModule, RHICmdList, NewSourceTexture, SourceRect, ReadbackTexture, FIntRect(FIntPoint::ZeroValue, TargetSize), bOverwriteAlpha);
+            CopyTexture2d(RendererModule, RHICmdList, SourceTexture, SourceRect, ReadbackTexture, FIntRect(FIntPoint::ZeroValue, TargetSize), bOverwriteAlpha, PackMode);
 
             // Stage the texture to read back its pixels data
             FIntPoint PixelSize = FIntPoint::ZeroValue;
@@ -246,7 +938,8 @@ bool FNVTextureReader::ReadPixelsRaw(const FTexture2DRHIRef& NewSourceTexture, c
 
 void FNVTextureReader::CopyTexture2d(class IRendererModule* RendererModule, FRHICommandListImmediate& RHICmdList,
                                      const FTexture2DRHIRef& NewSourceTexture, const FIntRect& SourceRect,
-                                     FTexture2DRHIRef& ReadbackTexture, const FIntRect& TargetRect, bool bOverwriteAlpha/*= true*/)
+                                     FTexture2DRHIRef& ReadbackTexture, const FIntRect& TargetRect, bool bOverwriteAlpha/*= true*/,
+                                     ENVPixelPackMode PackMode/*= ENVPixelPackMode::None*/)
 {
     ensure(RendererModule);
     ensure(NewSourceTexture);
@@ -255,6 +948,14 @@ void FNVTextureReader::CopyTexture2d(class IRendererModule* RendererModule, FRHI
     {
         UE_LOG(LogNVTextureReader, Error, TEXT("invalid argument."));
     }
+    else if (CanCopyTextureDirectly(NewSourceTexture, SourceRect, ReadbackTexture, TargetRect, bOverwriteAlpha, PackMode))
+    {
+        // The source pixels can be used as is, copy them straight to the target instead of drawing them on a temporary render target first
+        FResolveParams ResolveParams;
+        ResolveParams.Rect = FResolveRect(SourceRect.Min.X, SourceRect.Min.Y, SourceRect.Max.X, SourceRect.Max.Y);
+        ResolveParams.DestRect = FResolveRect(TargetRect.Min.X, TargetRect.Min.Y, TargetRect.Max.X, TargetRect.Max.Y);
+        RHICmdList.CopyToResolveTarget(NewSourceTexture, ReadbackTexture, ResolveParams);
+    }
     else
     {
         const FIntPoint TargetSize = TargetRect.Size();
@@ -301,7 +1002,25 @@ void FNVTextureReader::CopyTexture2d(class IRendererModule* RendererModule, FRHI
 
         GraphicsPSOInit.BoundShaderState.VertexDeclarationRHI = RendererModule->GetFilterVertexDeclaration().VertexDeclarationRHI;
         GraphicsPSOInit.BoundShaderState.VertexShaderRHI = GETSAFERHISHADER_VERTEX(*VertexShader);
-        GraphicsPSOInit.BoundShaderState.PixelShaderRHI = GETSAFERHISHADER_PIXEL(*PixelShader);
+        // NOTE: The pixels are converted while they are drawn on the target so the readback texture only contain the bytes we need
+        switch (PackMode)
+        {
+            case ENVPixelPackMode::PackId24:
+                GraphicsPSOInit.BoundShaderState.PixelShaderRHI = GetPackPixelsShader<FNVPackId24PS>(ShaderMap);
+                break;
+            case ENVPixelPackMode::EncodeDepthMillimeters16:
+                GraphicsPSOInit.BoundShaderState.PixelShaderRHI = GetPackPixelsShader<FNVEncodeDepthMillimeters16PS>(ShaderMap);
+                break;
+            case ENVPixelPackMode::EncodeDepthLog16:
+                GraphicsPSOInit.BoundShaderState.PixelShaderRHI = GetPackPixelsShader<FNVEncodeDepthLog16PS>(ShaderMap);
+                break;
+            case ENVPixelPackMode::EncodeDepthHalf16:
+                GraphicsPSOInit.BoundShaderState.PixelShaderRHI = GetPackPixelsShader<FNVEncodeDepthHalf16PS>(ShaderMap);
+                break;
+            default:
+                GraphicsPSOInit.BoundShaderState.PixelShaderRHI = GETSAFERHISHADER_PIXEL(*PixelShader);
+                break;
+        }
         GraphicsPSOInit.PrimitiveType = PT_TriangleList;
 
         SetGraphicsPipelineState(RHICmdList, GraphicsPSOInit);
@@ -313,7 +1032,23 @@ void FNVTextureReader::CopyTexture2d(class IRendererModule* RendererModule, FRHI
         ensure(FullSourceSize != FIntPoint::ZeroValue);
         ensure(SourceSize != FIntPoint::ZeroValue);
 
-        if (TargetSize == SourceSize)
+        if (PackMode == ENVPixelPackMode::PackId24)
+        {
+            SetPackPixelsShaderParameters<FNVPackId24PS>(RHICmdList, ShaderMap, NewSourceTexture);
+        }
+        else if (PackMode == ENVPixelPackMode::EncodeDepthMillimeters16)
+        {
+            SetPackPixelsShaderParameters<FNVEncodeDepthMillimeters16PS>(RHICmdList, ShaderMap, NewSourceTexture);
+        }
+        else if (PackMode == ENVPixelPackMode::EncodeDepthLog16)
+        {
+            SetPackPixelsShaderParameters<FNVEncodeDepthLog16PS>(RHICmdList, ShaderMap, NewSourceTexture);
+        }
+        else if (PackMode == ENVPixelPackMode::EncodeDepthHalf16)
+        {
+            SetPackPixelsShaderParameters<FNVEncodeDepthHalf16PS>(RHICmdList, ShaderMap, NewSourceTexture);
+        }
+        else if (TargetSize == SourceSize)
         {
             PixelShader->SetParameters(RHICmdList, TStaticSamplerState<SF_Point>::GetRHI(), NewSourceTexture);
         }
@@ -343,7 +1078,13 @@ void FNVTextureReader::CopyTexture2d(class IRendererModule* RendererModule, FRHI
 
         // Asynchronously copy render target from GPU to CPU
         const bool bKeepOriginalSurface = false;
-        const FResolveParams ResolveParams;
+        FResolveParams ResolveParams;
+        // The target region doesn't start at the origin when several textures are stacked in the target texture
+        if (TargetRect.Min != FIntPoint::ZeroValue)
+        {
+            ResolveParams.Rect = FResolveRect(0, 0, TargetSize.X, TargetSize.Y);
+            ResolveParams.DestRect = FResolveRect(TargetRect.Min.X, TargetRect.Min.Y, TargetRect.Max.X, TargetRect.Max.Y);
+        }
         RHICmdList.CopyToResolveTarget(
             DestRenderTarget.TargetableTexture,
             ReadbackTexture,
@@ -351,10 +1092,33 @@ void FNVTextureReader::CopyTexture2d(class IRendererModule* RendererModule, FRHI
     }
 }
 
-FNVTexturePixelData FNVTextureReader::BuildPixelData(uint8* PixelsData, EPixelFormat PixelFormat, const FIntPoint& ImageSize, const FIntPoint& TargetSize)
+bool FNVTextureReader::CanCopyTextureDirectly(const FTexture2DRHIRef& NewSourceTexture, const FIntRect& SourceRect,
+                                              const FTexture2DRHIRef& TargetTexture, const FIntRect& TargetRect, bool bOverwriteAlpha, ENVPixelPackMode PackMode)
 {
-    FNVTexturePixelData NewPixelData;
-    BuildPixelData(NewPixelData, PixelsData, PixelFormat, ImageSize, TargetSize);
+    if (!NewSourceTexture || !TargetTexture)
+    {
+        return false;
+    }
+
+    // NOTE: When the alpha is ignored or the pixels are packed, the pixel shader must change the pixels
+    if (!bOverwriteAlpha || (PackMode != ENVPixelPackMode::None))
+    {
+        return false;
+    }
+
+    // NOTE: Only the draw can resample the pixels or convert them to another format
+    // The formats must match exactly, e.g: PF_R32_FLOAT can't be copied to PF_R32_UINT even if their pixels have the same size
+    return (SourceRect.Size() == TargetRect.Size())
+        && (NewSourceTexture->GetFormat() == TargetTexture->GetFormat())
+        && (NewSourceTexture->GetNumSamples() == 1);
+}
+
+FNVTexturePixelDataRef FNVTextureReader::BuildPixelData(uint8* PixelsData, EPixelFormat PixelFormat, const FIntPoint& ImageSize, const FIntPoint& TargetSize)
+{
+    // NOTE: This is the only copy of the pixels, the rest of the pipeline just pass the reference around
+    const uint32 PixelBufferSize = NVSceneCapturerUtils::GetPixelByteSize(PixelFormat) * TargetSize.X * TargetSize.Y;
+    FNVTexturePixelDataRef NewPixelData = FNVTexturePixelDataPool::Get().Acquire(PixelBufferSize);
+    BuildPixelData(*NewPixelData, PixelsData, PixelFormat, ImageSize, TargetSize);
 
     return NewPixelData;
 }
@@ -376,7 +1140,8 @@ void FNVTextureReader::BuildPixelData(FNVTexturePixelData& OutPixelsData, uint8*
         // NOTE: We don't support pixel format that use less than 1 byte for now, e.g: grayscale 1, 2 or 4 bit
         const uint8 PixelByteSize = NVSceneCapturerUtils::GetPixelByteSize(PixelFormat);
         const uint32 PixelBufferSize = PixelByteSize * PixelCount;
-        OutPixelsData.PixelData.InsertUninitialized(0, PixelBufferSize);
+        // NOTE: Keep the existing allocation if the buffer is reused
+        OutPixelsData.PixelData.SetNumUninitialized(PixelBufferSize, false);
 
         uint8* SrcPixelBuffer = RawPixelsData;
         uint8* Dest = &OutPixelsData.PixelData[0];
@@ -384,15 +1149,30 @@ void FNVTextureReader::BuildPixelData(FNVTexturePixelData& OutPixelsData, uint8*
         // So we must make sure to only copy the minimum part of it
         const int32 MinWidth = FMath::Min(TargetSize.X, ImageSize.X);
         const int32 MinHeight = FMath::Min(TargetSize.Y, ImageSize.Y);
-        const int32 TargetWidthByteSize = MinWidth * PixelByteSize;
+        const int32 CopiedWidthByteSize = MinWidth * PixelByteSize;
+        const int32 TargetWidthByteSize = TargetSize.X * PixelByteSize;
         const int32 SourceWidthByteSize = ImageSize.X * PixelByteSize;
+        // The rows always cover the whole target size, the part which isn't read back is black
         OutPixelsData.RowStride = TargetWidthByteSize;
-        for (int32 Row = 0; Row < MinHeight; ++Row)
+        if ((MinWidth < TargetSize.X) || (MinHeight < TargetSize.Y))
         {
-            FMemory::Memcpy(Dest, SrcPixelBuffer, TargetWidthByteSize);
+            FMemory::Memzero(Dest, PixelBufferSize);
+        }
 
-            SrcPixelBuffer += SourceWidthByteSize;
-            Dest += TargetWidthByteSize;
+        if ((TargetWidthByteSize == SourceWidthByteSize) && (CopiedWidthByteSize == TargetWidthByteSize))
+        {
+            // The rows are tightly packed in both buffers so we can copy them all at once
+            FMemory::Memcpy(Dest, SrcPixelBuffer, TargetWidthByteSize * MinHeight);
+        }
+        else
+        {
+            for (int32 Row = 0; Row < MinHeight; ++Row)
+            {
+                FMemory::Memcpy(Dest, SrcPixelBuffer, CopiedWidthByteSize);
+
+                SrcPixelBuffer += SourceWidthByteSize;
+                Dest += TargetWidthByteSize;
+            }
         }
     }
 }
@@ -423,25 +1203,33 @@ bool FNVTextureRenderTargetReader::ReadPixelsData(OnFinishedReadingPixelsDataCal
     return FNVTextureReader::ReadPixelsData(Callback, bIgnoreAlpha);
 }
 
+bool FNVTextureRenderTargetReader::BuildReadbackRequest(OnFinishedReadingPixelsDataCallback Callback, bool bIgnoreAlpha, FNVTextureReadbackRequest& OutRequest)
+{
+    UpdateTextureFromRenderTarget();
+    return FNVTextureReader::BuildReadbackRequest(Callback, bIgnoreAlpha, OutRequest);
+}
+
 bool FNVTextureRenderTargetReader::ReadPixelsData(FNVTexturePixelData& OutPixelsData)
 {
+    UpdateTextureFromRenderTarget();
+
     auto RenderCommand = [this, &OutPixelsData = OutPixelsData](FRHICommandListImmediate& RHICmdList)
     {
         const FTextureRenderTargetResource* RenderTargetResource = SourceRenderTarget->GetRenderTargetResource();
         ensure(RenderTargetResource);
         if (RenderTargetResource)
         {
-            SourceTexture = RenderTargetResource->GetRenderTargetTexture();
-            ensure(SourceTexture);
-            if (SourceTexture)
+            const FTexture2DRHIRef RenderTargetTexture = RenderTargetResource->GetRenderTargetTexture();
+            ensure(RenderTargetTexture);
+            if (RenderTargetTexture)
             {
                 void* PixelDataBuffer = nullptr;
                 FIntPoint PixelSize = FIntPoint::ZeroValue;
-                RHICmdList.MapStagingSurface(SourceTexture, PixelDataBuffer, PixelSize.X, PixelSize.Y);
+                RHICmdList.MapStagingSurface(RenderTargetTexture, PixelDataBuffer, PixelSize.X, PixelSize.Y);
 
                 BuildPixelData(OutPixelsData, (uint8*)PixelDataBuffer, ReadbackPixelFormat, PixelSize, ReadbackSize);
 
-                RHICmdList.UnmapStagingSurface(SourceTexture);
+                RHICmdList.UnmapStagingSurface(RenderTargetTexture);
             }
         }
     };
@@ -453,7 +1241,7 @@ bool FNVTextureRenderTargetReader::ReadPixelsData(FNVTexturePixelData& OutPixels
         InRenderCommand(RHICmdList);
     });
 
-    FlushRenderingCommands();
+    FlushRenderingCommandsForReadback(TEXT("ReadPixelsData"), false);
 
     return true;
 }
@@ -464,12 +1252,18 @@ void FNVTextureRenderTargetReader::UpdateTextureFromRenderTarget()
     // NOTE: Should check if the texture still belong to the render target before updating its reference
     if (SourceRenderTarget)
     {
-        // NOTE: Because function GameThread_GetRenderTargetResource is not marked as const, we can't have SourceRenderTarget as const either
-        const FTextureRenderTargetResource* RenderTargetResource = IsInGameThread() ? SourceRenderTarget->GameThread_GetRenderTargetResource()
-                : SourceRenderTarget->GetRenderTargetResource();
-        if (RenderTargetResource)
+        if (IsInGameThread())
+        {
+            // NOTE: The render target's RHI texture is only valid after the rendering thread initialized its resource,
+            // it's taken from the resource when the pixels are copied so we never need to wait for it here
+            // NOTE: Because function GameThread_GetRenderTargetResource is not marked as const, we can't have SourceRenderTarget as const either
+            FTextureRenderTargetResource* RenderTargetResource = SourceRenderTarget->GameThread_GetRenderTargetResource();
+            SetSourceRenderTarget(RenderTargetResource, FIntPoint(SourceRenderTarget->SizeX, SourceRenderTarget->SizeY), SourceRenderTarget->GetFormat());
+        }
+        else
         {
-            SetSourceTexture(RenderTargetResource->GetRenderTargetTexture());
+            const FTextureRenderTargetResource* RenderTargetResource = SourceRenderTarget->GetRenderTargetResource();
+            SetSourceTexture(RenderTargetResource ? RenderTargetResource->GetRenderTargetTexture() : FTexture2DRHIRef());
         }
     }
     else
@@ -0,0 +1,112 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVSceneCapturerUtils.h"
+#include "NVAnnotationBinaryFormat.h"
+#include "NVJsonWriter.h"
+#include "Tests/NVSceneCapturerTestUtils.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+    /// Check the json converted from the binary data of the scene data is the same as the one the json exporter write
+    bool TestSameJsonAfterRoundTrip(FAutomationTestBase& Test, const FString& What, const FCapturedSceneData& SceneData)
+    {
+        TArray<uint8> ExpectedJsonData;
+        FNVJsonWriter::SerializeCapturedSceneData(SceneData, ExpectedJsonData);
+
+        TArray<uint8> BinaryData;
+        FNVAnnotationBinaryWriter::SerializeCapturedSceneData(SceneData, BinaryData);
+
+        TArray<uint8> JsonData;
+        if (!Test.TestTrue(FString::Printf(TEXT("%s: the binary data is converted"), *What), FNVAnnotationBinaryReader::ConvertToJson(BinaryData, JsonData)))
+        {
+            return false;
+        }
+
+        const int32 DifferenceIndex = NVSceneCapturerTestUtils::FindFirstDifference(JsonData, ExpectedJsonData);
+        if (DifferenceIndex != INDEX_NONE)
+        {
+            Test.AddError(FString::Printf(TEXT("%s: the converted json differ from the exported json at byte %d (%d bytes, expected %d bytes)."), *What,
+                                          DifferenceIndex, JsonData.Num(), ExpectedJsonData.Num()));
+            return false;
+        }
+        return true;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNVAnnotationBinaryFormatRoundTripTest, "NVSceneCapturer.AnnotationBinaryFormat.RoundTrip",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FNVAnnotationBinaryFormatRoundTripTest::RunTest(const FString& Parameters)
+{
+    // The test data has the RLE, the polygons, the sockets and the custom data of all its objects
+    FCapturedSceneData SceneData = NVSceneCapturerTestUtils::MakeTestSceneData(3);
+    TestSameJsonAfterRoundTrip(*this, TEXT("All the fields"), SceneData);
+
+    // The optional fields the frame has must survive the round trip too
+    SceneData.OptionalObjectFields = ENVOptionalObjectFields::TruncationFlags | ENVOptionalObjectFields::SegmentationPolygons;
+    SceneData.Objects[1].custom_data.Reset();
+    SceneData.Objects[2].socket_data.Reset();
+    SceneData.Objects[2].segmentation_polygons.Reset();
+    TestSameJsonAfterRoundTrip(*this, TEXT("Some optional fields, no custom data or sockets"), SceneData);
+
+    FCapturedSceneData EmptySceneData;
+    TestSameJsonAfterRoundTrip(*this, TEXT("No objects"), EmptySceneData);
+
+    TArray<uint8> InvalidBinaryData;
+    InvalidBinaryData.SetNumZeroed(16);
+    TArray<uint8> JsonData;
+    TestFalse(TEXT("Invalid binary data is converted"), FNVAnnotationBinaryReader::ConvertToJson(InvalidBinaryData, JsonData));
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNVAnnotationBinaryFormatConvertDirectoryTest, "NVSceneCapturer.AnnotationBinaryFormat.ConvertDirectory",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FNVAnnotationBinaryFormatConvertDirectoryTest::RunTest(const FString& Parameters)
+{
+    const FString TestDirectory = FPaths::AutomationTransientDir() / TEXT("NVAnnotationBinaryFormat");
+    const FString BinaryDirectory = TestDirectory / TEXT("Binary");
+    const FString JsonDirectory = TestDirectory / TEXT("Json");
+    IFileManager::Get().DeleteDirectory(*TestDirectory, false, true);
+
+    const FCapturedSceneData SceneData = NVSceneCapturerTestUtils::MakeTestSceneData(2);
+    TArray<uint8> BinaryData;
+    FNVAnnotationBinaryWriter::SerializeCapturedSceneData(SceneData, BinaryData);
+    TArray<uint8> ExpectedJsonData;
+    FNVJsonWriter::SerializeCapturedSceneData(SceneData, ExpectedJsonData);
+
+    // The viewpoints export their data to their own subdirectories
+    const TArray<FString> RelativeFilePaths = { TEXT("000000"), TEXT("Viewpoint/000001") };
+    for (const FString& RelativeFilePath : RelativeFilePaths)
+    {
+        FFileHelper::SaveArrayToFile(BinaryData, *(BinaryDirectory / RelativeFilePath + FNVAnnotationBinaryWriter::FileExtension));
+    }
+
+    TestEqual(TEXT("Converted file count"), FNVAnnotationBinaryReader::ConvertDirectoryToJson(BinaryDirectory, JsonDirectory), RelativeFilePaths.Num());
+    for (const FString& RelativeFilePath : RelativeFilePaths)
+    {
+        TArray<uint8> JsonData;
+        const FString JsonFilePath = JsonDirectory / RelativeFilePath + TEXT(".json");
+        if (TestTrue(FString::Printf(TEXT("%s exists"), *JsonFilePath), FFileHelper::LoadFileToArray(JsonData, *JsonFilePath)))
+        {
+            TestTrue(FString::Printf(TEXT("%s is the same as the exported json"), *JsonFilePath), JsonData == ExpectedJsonData);
+        }
+    }
+
+    IFileManager::Get().DeleteDirectory(*TestDirectory, false, true);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,138 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVSceneCapturerUtils.h"
+#include "NVImageExporter.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Misc/AutomationTest.h"
+#include "Modules/ModuleManager.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_UNREALPNG
+
+namespace
+{
+    /// Big enough to be split into several stripes, see NVPngEncoder::MinStripeByteSize
+    const FIntPoint TestImageSize(1024, 768);
+    /// The rows of the captured pixels can be padded, the encoder must skip the padding
+    const uint32 TestRowPadding = 64;
+
+    /// Make a BGRA image with the kinds of content we export: smooth gradients (color images),
+    /// noise (textures) and flat areas with sharp edges (segmentation masks)
+    FNVTexturePixelData MakeTestImage()
+    {
+        FNVTexturePixelData TestImage;
+        TestImage.PixelFormat = EPixelFormat::PF_B8G8R8A8;
+        TestImage.PixelSize = TestImageSize;
+        TestImage.RowStride = TestImageSize.X * 4 + TestRowPadding;
+        TestImage.PixelData.SetNumZeroed(TestImage.RowStride * TestImageSize.Y);
+
+        FRandomStream RandomStream(1234);
+        for (int32 Y = 0; Y < TestImageSize.Y; Y++)
+        {
+            for (int32 X = 0; X < TestImageSize.X; X++)
+            {
+                FColor PixelColor;
+                if (Y < TestImageSize.Y / 3)
+                {
+                    PixelColor = FColor(X & 0xFF, Y & 0xFF, (X + Y) & 0xFF, 255);
+                }
+                else if (Y < 2 * TestImageSize.Y / 3)
+                {
+                    PixelColor = FColor(RandomStream.RandHelper(256), RandomStream.RandHelper(256), RandomStream.RandHelper(256), RandomStream.RandHelper(256));
+                }
+                else
+                {
+                    const uint32 InstanceId = ((X / 100) % 3) + ((Y / 50) % 2) * 3;
+                    PixelColor = NVSceneCapturerUtils::ConvertInt32ToVertexColor(InstanceId);
+                    PixelColor.A = 255;
+                }
+
+                uint8* Pixel = TestImage.PixelData.GetData() + Y * TestImage.RowStride + X * 4;
+                Pixel[0] = PixelColor.B;
+                Pixel[1] = PixelColor.G;
+                Pixel[2] = PixelColor.R;
+                Pixel[3] = PixelColor.A;
+            }
+        }
+        return TestImage;
+    }
+
+    /// Check the decoded BGRA pixels are the same as the test image's ones
+    bool IsSameImage(const FNVTexturePixelData& TestImage, const TArray<uint8>& DecodedPixels)
+    {
+        const uint32 BytesPerRow = TestImage.PixelSize.X * 4;
+        if ((uint32)DecodedPixels.Num() != BytesPerRow * TestImage.PixelSize.Y)
+        {
+            return false;
+        }
+
+        for (int32 Y = 0; Y < TestImage.PixelSize.Y; Y++)
+        {
+            if (FMemory::Memcmp(TestImage.PixelData.GetData() + Y * TestImage.RowStride, DecodedPixels.GetData() + Y * BytesPerRow, BytesPerRow) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNVImageExporterPngStripesTest, "NVSceneCapturer.ImageExporter.PngStripes",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FNVImageExporterPngStripesTest::RunTest(const FString& Parameters)
+{
+    IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+    const FNVTexturePixelData TestImage = MakeTestImage();
+    const double RawSizeMB = (TestImageSize.X * TestImageSize.Y * 4) / (1024.0 * 1024.0);
+
+    const int32 CompressionLevels[] = { 1, 6, 9 };
+    TArray<uint8> CompressedData;
+    for (const int32 CompressionLevel : CompressionLevels)
+    {
+        for (int32 FilterIndex = 0; FilterIndex < (int32)ENVPngFilterType::NVPngFilterType_MAX; FilterIndex++)
+        {
+            for (const bool bAllowParallelEncoding : { false, true })
+            {
+                FNVImageCompressionSettings CompressionSettings;
+                CompressionSettings.PngCompressionLevel = CompressionLevel;
+                CompressionSettings.PngFilterType = (ENVPngFilterType)FilterIndex;
+                CompressionSettings.bAllowParallelEncoding = bAllowParallelEncoding;
+                const FString SettingsName = FString::Printf(TEXT("level: %d, filter: %d, stripes: %s"), CompressionLevel, FilterIndex,
+                                                             bAllowParallelEncoding ? TEXT("on") : TEXT("off"));
+
+                const double StartTime = FPlatformTime::Seconds();
+                FNVImageExporter::CompressImagePNG(TestImage, CompressedData, CompressionSettings);
+                const double EncodeDuration = FPlatformTime::Seconds() - StartTime;
+                if (!TestTrue(FString::Printf(TEXT("%s: the image is encoded"), *SettingsName), CompressedData.Num() > 0))
+                {
+                    continue;
+                }
+
+                TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+                const TArray<uint8>* DecodedPixels = nullptr;
+                const bool bDecoded = ImageWrapper.IsValid() && ImageWrapper->SetCompressed(CompressedData.GetData(), CompressedData.Num()) &&
+                                      ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, DecodedPixels) && DecodedPixels;
+                if (TestTrue(FString::Printf(TEXT("%s: the image is decoded"), *SettingsName), bDecoded))
+                {
+                    TestEqual(FString::Printf(TEXT("%s: width"), *SettingsName), ImageWrapper->GetWidth(), TestImageSize.X);
+                    TestEqual(FString::Printf(TEXT("%s: height"), *SettingsName), ImageWrapper->GetHeight(), TestImageSize.Y);
+                    TestTrue(FString::Printf(TEXT("%s: the decoded pixels match"), *SettingsName), IsSameImage(TestImage, *DecodedPixels));
+                }
+
+                AddInfo(FString::Printf(TEXT("PNG %dx%d - %s - %.1f MB/s, %d bytes (%.1f%% of the raw size)"), TestImageSize.X, TestImageSize.Y,
+                                        *SettingsName, (EncodeDuration > 0.0) ? RawSizeMB / EncodeDuration : 0.0,
+                                        CompressedData.Num(), (CompressedData.Num() * 100.0) / (TestImageSize.X * TestImageSize.Y * 4)));
+            }
+        }
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS && WITH_UNREALPNG
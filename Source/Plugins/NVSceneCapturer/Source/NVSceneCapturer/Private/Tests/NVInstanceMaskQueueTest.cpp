@@ -0,0 +1,96 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVSceneCapturerUtils.h"
+#include "NVSceneFeatureExtractor_DataExport.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+    const uint32 TestInstanceId = 1;
+    const FIntPoint TestMaskSize(8, 8);
+    /// The object's pixels in the test mask, both corners are included
+    const FIntPoint TestObjectMin(2, 4);
+    const FIntPoint TestObjectMax(3, 6);
+
+    FNVPendingInstanceMaskFramePtr MakeTestFrame(uint64 FrameNumber)
+    {
+        FNVPendingInstanceMaskFramePtr Frame = MakeShareable(new FNVPendingInstanceMaskFrame());
+        Frame->FrameNumber = FrameNumber;
+        Frame->AnalysisOptions.bCalculateBoundingBox = true;
+
+        FCapturedObjectData ObjectData;
+        ObjectData.instance_id = TestInstanceId;
+        Frame->SceneData.Objects.Add(ObjectData);
+        return Frame;
+    }
+
+    FNVTexturePixelDataRef MakeTestMask()
+    {
+        FNVTexturePixelDataRef MaskPixelData = MakeShareable(new FNVTexturePixelData());
+        MaskPixelData->PixelFormat = EPixelFormat::PF_B8G8R8A8;
+        MaskPixelData->PixelSize = TestMaskSize;
+        MaskPixelData->RowStride = TestMaskSize.X * 4;
+        MaskPixelData->PixelData.SetNumZeroed(TestMaskSize.X * TestMaskSize.Y * 4);
+
+        const FColor ObjectColor = NVSceneCapturerUtils::ConvertInt32ToVertexColor(TestInstanceId);
+        for (int32 Y = TestObjectMin.Y; Y <= TestObjectMax.Y; Y++)
+        {
+            for (int32 X = TestObjectMin.X; X <= TestObjectMax.X; X++)
+            {
+                uint8* Pixel = MaskPixelData->PixelData.GetData() + Y * MaskPixelData->RowStride + X * 4;
+                Pixel[0] = ObjectColor.B;
+                Pixel[1] = ObjectColor.G;
+                Pixel[2] = ObjectColor.R;
+                Pixel[3] = 255;
+            }
+        }
+        return MaskPixelData;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNVInstanceMaskQueueFrameWithoutMaskTest, "NVSceneCapturer.InstanceMaskQueue.FrameWithoutMask",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FNVInstanceMaskQueueFrameWithoutMaskTest::RunTest(const FString& Parameters)
+{
+    const TSharedRef<FNVInstanceMaskQueue, ESPMode::ThreadSafe> InstanceMaskQueue = MakeShareable(new FNVInstanceMaskQueue());
+
+    // The mask of the first frame is lost, the second frame must still get its own mask
+    const FNVPendingInstanceMaskFramePtr FrameWithoutMask = MakeTestFrame(10);
+    const FNVPendingInstanceMaskFramePtr FrameWithMask = MakeTestFrame(11);
+    AddExpectedError(TEXT("instance mask of frame 10 was never read back"), EAutomationExpectedErrorFlags::Contains, 1);
+    InstanceMaskQueue->AddFrame(FrameWithoutMask);
+    InstanceMaskQueue->AddFrame(FrameWithMask);
+    InstanceMaskQueue->AddInstanceMask(11, MakeTestMask());
+
+    // A mask without annotation data is dropped when the next frame is added, then that frame never get its mask
+    const FNVPendingInstanceMaskFramePtr LastFrame = MakeTestFrame(13);
+    AddExpectedError(TEXT("instance mask of frame 12, the mask is dropped"), EAutomationExpectedErrorFlags::Contains, 1);
+    AddExpectedError(TEXT("instance mask of frame 13 was never read back"), EAutomationExpectedErrorFlags::Contains, 1);
+    InstanceMaskQueue->AddInstanceMask(12, MakeTestMask());
+    InstanceMaskQueue->AddFrame(LastFrame);
+    InstanceMaskQueue->Drain();
+
+    TestFalse(TEXT("The frame without mask is analyzed"), FrameWithoutMask->bIsAnalyzed);
+    TestFalse(TEXT("The frame after the dropped mask is analyzed"), LastFrame->bIsAnalyzed);
+    TestTrue(TEXT("The frame with mask is analyzed"), FrameWithMask->bIsAnalyzed);
+
+    const FCapturedObjectData& ObjectData = FrameWithMask->SceneData.Objects[0];
+    const FIntPoint ObjectSize = TestObjectMax - TestObjectMin + FIntPoint(1, 1);
+    TestEqual(TEXT("visible_pixel_count"), ObjectData.visible_pixel_count, (uint32)(ObjectSize.X * ObjectSize.Y));
+    TestEqual(TEXT("truncation_flags"), ObjectData.truncation_flags, (uint32)ENVTruncationFlags::None);
+    // NOTE: FNVBox2D swap the X and Y axes
+    TestEqual(TEXT("bounding_box.top_left"), ObjectData.bounding_box.top_left, FVector2D(TestObjectMin.Y, TestObjectMin.X));
+    TestEqual(TEXT("bounding_box.bottom_right"), ObjectData.bounding_box.bottom_right, FVector2D(TestObjectMax.Y + 1, TestObjectMax.X + 1));
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,115 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#include "NVSceneCapturerModule.h"
+#include "NVSceneCapturerUtils.h"
+#include "NVJsonWriter.h"
+#include "Tests/NVSceneCapturerTestUtils.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+    const int32 BenchmarkObjectCount = 100;
+    const int32 BenchmarkFrameCount = 50;
+
+    /// Check the json FNVJsonWriter write for the scene data is byte-identical to the one written with FJsonObjectConverter
+    bool TestSameJsonAsConverter(FAutomationTestBase& Test, const FString& What, const FCapturedSceneData& SceneData)
+    {
+        const TArray<uint8> ExpectedJsonData = NVSceneCapturerTestUtils::StringToUtf8Bytes(NVSceneCapturerTestUtils::SerializeWithJsonObjectConverter(SceneData));
+
+        TArray<uint8> JsonData;
+        FNVJsonWriter::SerializeCapturedSceneData(SceneData, JsonData);
+
+        const int32 DifferenceIndex = NVSceneCapturerTestUtils::FindFirstDifference(JsonData, ExpectedJsonData);
+        if (DifferenceIndex != INDEX_NONE)
+        {
+            // Show the text around the first difference, the whole json is too long to be read in the log
+            const int32 ContextStart = FMath::Max(DifferenceIndex - 64, 0);
+            auto GetContext = [ContextStart](const TArray<uint8>& Utf8Bytes)
+            {
+                const int32 ContextLength = FMath::Min(128, Utf8Bytes.Num() - ContextStart);
+                return NVSceneCapturerTestUtils::Utf8BytesToString(TArray<uint8>(Utf8Bytes.GetData() + ContextStart, FMath::Max(ContextLength, 0)));
+            };
+            Test.AddError(FString::Printf(TEXT("%s: the json differ at byte %d (%d bytes, expected %d bytes).\nWritten:  %s\nExpected: %s"), *What,
+                                          DifferenceIndex, JsonData.Num(), ExpectedJsonData.Num(), *GetContext(JsonData), *GetContext(ExpectedJsonData)));
+            return false;
+        }
+        return true;
+    }
+
+    /// Serialize the scene data several times with a serialization function
+    /// @return The number of objects serialized per second
+    template<typename SerializeFuncType>
+    double MeasureObjectsPerSecond(const FCapturedSceneData& SceneData, SerializeFuncType SerializeFunc)
+    {
+        // Warm up, e.g: the writer's buffer is reused between frames
+        SerializeFunc(SceneData);
+
+        const double StartTime = FPlatformTime::Seconds();
+        for (int32 i = 0; i < BenchmarkFrameCount; i++)
+        {
+            SerializeFunc(SceneData);
+        }
+        const double Duration = FPlatformTime::Seconds() - StartTime;
+        return (Duration > 0.0) ? (SceneData.Objects.Num() * BenchmarkFrameCount) / Duration : 0.0;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNVJsonWriterMatchJsonObjectConverterTest, "NVSceneCapturer.JsonWriter.MatchJsonObjectConverter",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FNVJsonWriterMatchJsonObjectConverterTest::RunTest(const FString& Parameters)
+{
+    FCapturedSceneData SceneData = NVSceneCapturerTestUtils::MakeTestSceneData(3);
+    TestSameJsonAsConverter(*this, TEXT("All the fields"), SceneData);
+
+    // The frames which weren't completed from the instance mask don't have any of the optional fields
+    SceneData.OptionalObjectFields = ENVOptionalObjectFields::None;
+    TestSameJsonAsConverter(*this, TEXT("No optional fields"), SceneData);
+
+    SceneData.OptionalObjectFields = ENVOptionalObjectFields::TruncationFlags | ENVOptionalObjectFields::SegmentationRLE;
+    SceneData.Objects[1].custom_data.Reset();
+    SceneData.Objects[2].socket_data.Reset();
+    SceneData.Objects[2].segmentation_rle = FNVInstanceMaskRLE();
+    TestSameJsonAsConverter(*this, TEXT("Some optional fields, no custom data or sockets"), SceneData);
+
+    FCapturedSceneData EmptySceneData;
+    TestSameJsonAsConverter(*this, TEXT("No objects"), EmptySceneData);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNVJsonWriterBenchmarkTest, "NVSceneCapturer.JsonWriter.Benchmark",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FNVJsonWriterBenchmarkTest::RunTest(const FString& Parameters)
+{
+    const FCapturedSceneData SceneData = NVSceneCapturerTestUtils::MakeTestSceneData(BenchmarkObjectCount);
+
+    const double ConverterObjectsPerSecond = MeasureObjectsPerSecond(SceneData, [](const FCapturedSceneData& CheckSceneData)
+    {
+        const FString JsonString = NVSceneCapturerTestUtils::SerializeWithJsonObjectConverter(CheckSceneData);
+        FTCHARToUTF8 JsonStringUTF8(*JsonString);
+    });
+
+    TArray<uint8> JsonData;
+    const double WriterObjectsPerSecond = MeasureObjectsPerSecond(SceneData, [&JsonData](const FCapturedSceneData& CheckSceneData)
+    {
+        FNVJsonWriter::SerializeCapturedSceneData(CheckSceneData, JsonData);
+    });
+
+    AddInfo(FString::Printf(TEXT("FJsonObjectConverter: %.0f objects/sec."), ConverterObjectsPerSecond));
+    AddInfo(FString::Printf(TEXT("FNVJsonWriter: %.0f objects/sec (x%.1f), %d bytes per frame of %d objects."), WriterObjectsPerSecond,
+                            (ConverterObjectsPerSecond > 0.0) ? (WriterObjectsPerSecond / ConverterObjectsPerSecond) : 0.0,
+                            JsonData.Num(), BenchmarkObjectCount));
+
+    TestTrue(TEXT("Objects serialized by FNVJsonWriter"), WriterObjectsPerSecond > 0.0);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
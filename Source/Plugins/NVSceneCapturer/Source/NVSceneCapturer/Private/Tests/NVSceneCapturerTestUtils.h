@@ -0,0 +1,174 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NVSceneCapturerUtils.h"
+#include "NVCameraSettings.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/// Shared data of the automation tests of the annotation data exporters
+namespace NVSceneCapturerTestUtils
+{
+    /// Make a matrix whose elements are all different and not exactly representable, so any rounding difference shows up
+    inline FMatrix MakeTestMatrix(float Seed)
+    {
+        FMatrix TestMatrix;
+        for (int32 Row = 0; Row < 4; Row++)
+        {
+            for (int32 Column = 0; Column < 4; Column++)
+            {
+                TestMatrix.M[Row][Column] = Seed * (Row * 4 + Column + 1) / 3.f - 7.123456f;
+            }
+        }
+        return TestMatrix;
+    }
+
+    /// Make the annotation data of a frame using all the fields the exporters write:
+    /// the matrixes, the sockets, the optional instance mask fields, the custom data and a non-ASCII name which need to be escaped
+    inline FCapturedSceneData MakeTestSceneData(int32 ObjectCount)
+    {
+        FCapturedSceneData SceneData;
+        SceneData.OptionalObjectFields = ENVOptionalObjectFields::PixelCounts | ENVOptionalObjectFields::TruncationFlags |
+                                         ENVOptionalObjectFields::SegmentationRLE | ENVOptionalObjectFields::SegmentationPolygons;
+
+        FCapturedViewpointData& CameraData = SceneData.camera_data;
+        CameraData.location_worldframe = FVector(120.123456f, -45.5f, 300.f);
+        CameraData.quaternion_xyzw_worldframe = FQuat(FRotator(-15.f, 30.5f, 0.25f));
+        CameraData.ProjectionMatrix = MakeTestMatrix(1.1f);
+        CameraData.ViewProjectionMatrix = MakeTestMatrix(2.3f);
+        CameraData.CameraSettings = FCameraIntrinsicSettings(640, 480, 90.f);
+        CameraData.fov = 90.f;
+
+        for (int32 i = 0; i < ObjectCount; i++)
+        {
+            const float Seed = i + 1.f;
+
+            FCapturedObjectData ObjectData;
+            ObjectData.Name = FString::Printf(TEXT("Caf\u00E9_\u7269\u4F53_\"%d\"\t"), i);
+            ObjectData.Class = TEXT("StaticMeshActor");
+            ObjectData.instance_id = 1000 + i;
+            ObjectData.rgba = { (uint8)i, 2, 3, 255 };
+            ObjectData.truncated = 0.25f;
+            ObjectData.occluded = 1;
+            ObjectData.occlusion = 0.333333f;
+            ObjectData.visibility = 0.666667f;
+            ObjectData.visible_pixel_count = 1234 + i;
+            ObjectData.projected_pixel_count = 2345 + i;
+            ObjectData.truncation_flags = ENVTruncationFlags::Left | ENVTruncationFlags::Bottom;
+            ObjectData.dimensions_worldspace = FVector(10.1f, 20.2f, 30.3f) * Seed;
+            ObjectData.location_worldspace = FVector(-1.23456789f, 2.5f, 1e5f) * Seed;
+            ObjectData.location = FVector(0.1f, -0.2f, 0.3f) * Seed;
+            ObjectData.rotation_worldspace = FRotator(10.f * Seed, -20.f, 33.333f);
+            ObjectData.quaternion_worldspace = FQuat(ObjectData.rotation_worldspace);
+            ObjectData.rotation = FRotator(-5.5f, 90.f, 180.f);
+            ObjectData.quaternion_xyzw = FQuat(ObjectData.rotation);
+            ObjectData.actor_to_world_matrix_ue4 = MakeTestMatrix(Seed);
+            ObjectData.actor_to_world_matrix_opencv = MakeTestMatrix(Seed * 2.f);
+            ObjectData.actor_to_camera_matrix = MakeTestMatrix(Seed * 3.f);
+            ObjectData.pose_transform = MakeTestMatrix(Seed * 4.f);
+            ObjectData.bounding_box_center_worldspace = FVector(1.f, 2.f, 3.f) * Seed;
+            ObjectData.cuboid_centroid = FVector(4.f, 5.f, 6.f) / Seed;
+            ObjectData.projected_cuboid_centroid = FVector2D(320.5f, 240.25f);
+            ObjectData.bounding_box_forward_direction = FVector::ForwardVector;
+            ObjectData.bounding_box_forward_direction_imagespace = FVector2D(0.707107f, -0.707107f);
+            ObjectData.viewpoint_azimuth_angle = 45.678f;
+            ObjectData.viewpoint_altitude_angle = -12.345f;
+            ObjectData.distance_scale = 0.98765f;
+            ObjectData.bounding_box = FNVBox2D(FBox2D(FVector2D(10.5f, 20.25f), FVector2D(110.75f, 220.125f)));
+
+            ObjectData.segmentation_rle.size = { 480, 640 };
+            ObjectData.segmentation_rle.counts = { 1000u + i, 25, 615, 25, 305535 };
+
+            FNVPolygon2D Polygon;
+            Polygon.points = { FVector2D(10.5f, 20.5f), FVector2D(110.5f, 20.5f), FVector2D(60.25f, 220.75f) };
+            ObjectData.segmentation_polygons.Add(Polygon);
+            ObjectData.segmentation_polygons.Add(Polygon);
+
+            for (int32 VertexIndex = 0; VertexIndex < (int32)ENVCuboidVertexType::CuboidVertexType_MAX; VertexIndex++)
+            {
+                ObjectData.cuboid.Add(FVector(VertexIndex * 1.5f, -VertexIndex * 0.3f, Seed));
+                ObjectData.projected_cuboid.Add(FVector2D(VertexIndex * 10.1f, VertexIndex * 20.2f));
+            }
+
+            FNVSocketData SocketData;
+            SocketData.SocketName = TEXT("Grip\u00F1");
+            SocketData.SocketLocation = FVector2D(12.34f, 56.78f);
+            ObjectData.socket_data.Add(SocketData);
+            SocketData.SocketName = TEXT("Tip");
+            SocketData.SocketLocation = FVector2D(-1.f, 0.5f);
+            ObjectData.socket_data.Add(SocketData);
+
+            ObjectData.custom_data = MakeShareable(new FJsonObject());
+            ObjectData.custom_data->SetStringField(TEXT("label"), TEXT("\u30DE\u30B0\u30AB\u30C3\u30D7"));
+            ObjectData.custom_data->SetNumberField(TEXT("weight"), 0.1 * Seed);
+            ObjectData.custom_data->SetBoolField(TEXT("is_graspable"), true);
+            ObjectData.custom_data->SetField(TEXT("material"), MakeShareable(new FJsonValueNull()));
+            TArray<TSharedPtr<FJsonValue>> TagJsonValues;
+            TagJsonValues.Add(MakeShareable(new FJsonValueString(TEXT("kitchen"))));
+            TagJsonValues.Add(MakeShareable(new FJsonValueNumber(42)));
+            ObjectData.custom_data->SetArrayField(TEXT("tags"), TagJsonValues);
+            TSharedPtr<FJsonObject> NestedJsonObj = MakeShareable(new FJsonObject());
+            NestedJsonObj->SetNumberField(TEXT("scale"), 1.5);
+            ObjectData.custom_data->SetObjectField(TEXT("nested"), NestedJsonObj);
+
+            SceneData.Objects.Add(ObjectData);
+        }
+
+        return SceneData;
+    }
+
+    /// Serialize the scene data the way it was exported before FNVJsonWriter: converting it to a json object tree
+    /// with FJsonObjectConverter and NVSceneCapturerUtils::CustomPropertyToJsonValueFunc, then pretty printing the tree
+    inline FString SerializeWithJsonObjectConverter(const FCapturedSceneData& SceneData)
+    {
+        FString JsonString;
+        const TSharedPtr<FJsonObject> SceneDataJsonObj = NVSceneCapturerUtils::CapturedSceneDataToJsonObject(SceneData);
+        if (SceneDataJsonObj.IsValid())
+        {
+            TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&JsonString, 0);
+            FJsonSerializer::Serialize(SceneDataJsonObj.ToSharedRef(), JsonWriter);
+            JsonWriter->Close();
+        }
+        return JsonString;
+    }
+
+    /// Get the UTF-8 bytes of a json text, the way FNVJsonWriter encode it
+    inline TArray<uint8> StringToUtf8Bytes(const FString& JsonString)
+    {
+        FTCHARToUTF8 ConvertedString(*JsonString);
+        return TArray<uint8>((const uint8*)ConvertedString.Get(), ConvertedString.Length());
+    }
+
+    /// Get the text from a UTF-8 buffer, e.g: to log the serialized json when it doesn't match
+    inline FString Utf8BytesToString(const TArray<uint8>& Utf8Bytes)
+    {
+        FUTF8ToTCHAR ConvertedString((const ANSICHAR*)Utf8Bytes.GetData(), Utf8Bytes.Num());
+        return FString(ConvertedString.Length(), ConvertedString.Get());
+    }
+
+    /// Find the first byte which differ between 2 buffers
+    /// @return INDEX_NONE if both buffers are the same
+    inline int32 FindFirstDifference(const TArray<uint8>& A, const TArray<uint8>& B)
+    {
+        const int32 CommonLength = FMath::Min(A.Num(), B.Num());
+        for (int32 i = 0; i < CommonLength; i++)
+        {
+            if (A[i] != B[i])
+            {
+                return i;
+            }
+        }
+        return (A.Num() == B.Num()) ? INDEX_NONE : CommonLength;
+    }
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,222 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+#include "NVSceneCapturerUtils.h"
+
+class AActor;
+class UWorld;
+class UMeshComponent;
+class UStaticMesh;
+class UNVCapturableActorTag;
+
+/// The convex hull of a mesh asset's simple collision vertexes (or its LOD0 vertexes if it doesn't have collision)
+/// in the mesh's local space, see FNVMeshHullCache
+struct NVSCENECAPTURER_API FNVMeshHull
+{
+public:
+    FNVMeshHull();
+
+    /// Keep the convex hull of the source vertexes
+    /// NOTE: The hull keep all its extreme vertexes, leaving any of them out could shrink the projected bounding boxes
+    void Build(const TArray<FVector>& SourceVertexes);
+
+    /// Transform the vertexes from the mesh's local space, e.g: using the component's local-to-world matrix
+    void TransformVertexes(const FMatrix& LocalToTargetMatrix, TArray<FVector>& OutVertexes) const;
+    /// Get the bounding box of the vertexes after transforming them from the mesh's local space
+    FBox GetTransformedBounds(const FMatrix& LocalToTargetMatrix) const;
+    /// Transform the vertexes to the clip space, e.g: using the component's local-to-world matrix times the view-projection matrix
+    /// NOTE: The vertexes are transformed 4 at a time with the vector intrinsics, the clip positions are packed
+    /// the same way as the vertexes: all the X, then all the Y, then all the W (the clip Z isn't needed for the image positions)
+    void TransformVertexesToClipSpace(const FMatrix& LocalToClipMatrix, TArray<float>& OutClipPositions) const;
+
+public:
+    /// NOTE: The vertexes are packed as structure of arrays: all the X, then all the Y, then all the Z
+    /// Each array is padded to a multiple of 4 vertexes by repeating the last vertex
+    TArray<float> Vertexes;
+    int32 VertexCount;
+    /// Number of vertexes in each array of Vertexes
+    int32 PaddedVertexCount;
+    /// Number of vertexes the hull was built from
+    int32 SourceVertexCount;
+};
+
+/// The cached geometry of one mesh component of an actor
+struct NVSCENECAPTURER_API FNVMeshGeometry
+{
+public:
+    FNVMeshGeometry();
+
+    int32 GetHullVertexCount() const;
+
+public:
+    TWeakObjectPtr<UMeshComponent> MeshComponent;
+    /// The static or skeletal mesh the component used when it was cached, null if it didn't use any
+    TWeakObjectPtr<const UObject> MeshAsset;
+
+    /// The convex hull of the mesh, shared by all the components using the same mesh
+    TSharedPtr<const FNVMeshHull, ESPMode::ThreadSafe> Hull;
+
+    /// Bounding box of the mesh's render vertexes in the component's local space
+    /// NOTE: Only valid for static meshes, a skeletal mesh's bounds depend on its current pose
+    FBox LocalBounds;
+};
+
+/// The cached geometry of an actor, see FNVActorGeometryCache
+struct NVSCENECAPTURER_API FNVActorGeometryRecord
+{
+public:
+    FNVActorGeometryRecord();
+
+    /// Get the geometry of the first mesh component which have a valid mesh, same as NVSceneCapturerUtils::GetFirstValidMeshComponent
+    const FNVMeshGeometry* GetPrimaryMesh() const;
+    UMeshComponent* GetPrimaryMeshComponent() const;
+
+public:
+    TWeakObjectPtr<UNVCapturableActorTag> Tag;
+    /// All the mesh components of the actor, in the actor's components order
+    TArray<FNVMeshGeometry> Meshes;
+    /// Index of the primary mesh in Meshes, INDEX_NONE if the actor doesn't have any valid mesh
+    int32 PrimaryMeshIndex;
+    /// Number of components the actor had when it was cached, used to detect added or removed components
+    int32 ComponentCount;
+    /// Whether the meshes' hulls and local bounds were cached, the mask passes only need the tag and the meshes
+    bool bHasHullGeometry;
+};
+
+///
+/// FNVActorGeometryCache - keep the geometry of the actors in a world which doesn't change between frames
+/// (their tag, meshes, collision hulls and local bounding boxes) so the annotation and mask passes only need to apply
+/// the current transforms instead of walking the components and the mesh data of every actor every frame
+/// NOTE: The cache can only be accessed on the game thread, the records it returns are read-only and
+/// can be used from other threads while the game thread is waiting for them
+///
+class NVSCENECAPTURER_API FNVActorGeometryCache
+{
+public:
+    ~FNVActorGeometryCache();
+
+    /// Get the geometry cache of a world, it's created the first time it's used
+    static FNVActorGeometryCache* Get(UWorld* World);
+    /// Shorthand to get the record of an actor from its world's cache
+    static TSharedPtr<const FNVActorGeometryRecord> FindOrAddActorRecord(const AActor* CheckActor, bool bNeedHullGeometry = true);
+
+    /// Get the cached geometry of an actor, the record is rebuilt if the actor's meshes changed since it was cached
+    /// @param bNeedHullGeometry If true, the record also contain the meshes' hull vertexes and local bounds
+    TSharedPtr<const FNVActorGeometryRecord> FindOrAddRecord(const AActor* CheckActor, bool bNeedHullGeometry = true);
+
+    /// Force an actor's record to be rebuilt the next time it's used, e.g: after changing its collision
+    void InvalidateActor(const AActor* CheckActor);
+    /// Force all the records to be rebuilt
+    void Invalidate();
+
+    int32 GetRecordCount() const;
+
+    static void RegisterWorldDelegates();
+    static void UnregisterWorldDelegates();
+
+protected:
+    explicit FNVActorGeometryCache(UWorld* InWorld);
+
+    static void BuildRecord(const AActor* CheckActor, bool bBuildHullGeometry, FNVActorGeometryRecord& OutRecord);
+    static bool IsRecordOutdated(const AActor* CheckActor, const FNVActorGeometryRecord& CheckRecord);
+
+    void OnActorSpawned(AActor* SpawnedActor);
+    void RemoveDestroyedActors();
+
+    static void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+
+protected:
+    TWeakObjectPtr<UWorld> OwnerWorld;
+    FDelegateHandle ActorSpawnedHandle;
+    /// Set when actors were spawned since the last time the records of the destroyed actors were removed
+    bool bHasSpawnedActors;
+    TMap<TWeakObjectPtr<const AActor>, TSharedPtr<FNVActorGeometryRecord>> Records;
+
+    static TMap<TWeakObjectPtr<UWorld>, TSharedPtr<FNVActorGeometryCache>> WorldCaches;
+    static FDelegateHandle WorldCleanupHandle;
+};
+
+///
+/// FNVMeshOrientedBoundsCache - keep the tight oriented bounding box of the static mesh assets (see NVSceneCapturerUtils::CalculateOrientedBounds)
+/// The box go through all the convex collision vertexes of the mesh (or its LOD0 vertexes if it doesn't have any)
+/// so it's only calculated the first time the mesh is used,
+/// all the components and actors using the same mesh share the result
+/// NOTE: Unlike FNVActorGeometryCache, this cache can be used from any thread
+///
+class NVSCENECAPTURER_API FNVMeshOrientedBoundsCache
+{
+public:
+    /// Get the oriented bounds of a mesh in its local space, they are calculated on the calling thread if the mesh isn't cached yet
+    /// @return Invalid bounds if the mesh doesn't have any vertex
+    static FNVOrientedBounds FindOrAdd(const UStaticMesh* StaticMesh);
+    /// Calculate the bounds of the meshes which aren't cached yet in parallel, e.g: before they are used by the worker threads
+    static void Prefetch(const TArray<const UStaticMesh*>& StaticMeshes);
+    /// Get the principal component analysis of all the mesh's LOD0 vertexes in its local space, e.g: to orient ANVAnnotatedActor's coordinate
+    /// NOTE: Only the MeanPoint and PrincipalAxis of the result are meant to be used, they are kept apart from the tight bounds
+    /// since a few collision vertexes (e.g: the 8 corners of a box collision) don't have a meaningful principal axis
+    static FNVOrientedBounds FindOrAddRenderVertexesPCA(const UStaticMesh* StaticMesh);
+    /// Remove all the cached bounds
+    static void Reset();
+
+protected:
+    struct FCachedMeshBounds
+    {
+        /// The render data the bounds were calculated from, the mesh need to be calculated again when it's rebuilt (e.g: reimported)
+        const void* RenderDataKey;
+        FNVOrientedBounds Bounds;
+    };
+    typedef TMap<TWeakObjectPtr<const UStaticMesh>, FCachedMeshBounds> FCachedMeshBoundsMap;
+
+protected:
+    static FNVOrientedBounds CalculateMeshBounds(const UStaticMesh* StaticMesh);
+    static FNVOrientedBounds CalculateRenderVertexesPCA(const UStaticMesh* StaticMesh);
+    static const void* GetMeshRenderDataKey(const UStaticMesh* StaticMesh);
+    /// NOTE: The caller must hold the cache's lock
+    static const FNVOrientedBounds* FindCachedBounds(const FCachedMeshBoundsMap& CachedMap, const UStaticMesh* StaticMesh);
+    static void AddCachedBounds(FCachedMeshBoundsMap& CachedMap, const UStaticMesh* StaticMesh, const FNVOrientedBounds& MeshBounds);
+
+protected:
+    static FCriticalSection CacheCriticalSection;
+    static FCachedMeshBoundsMap CachedMeshBounds;
+    static FCachedMeshBoundsMap CachedRenderVertexesPCAs;
+};
+
+///
+/// FNVMeshHullCache - keep the convex hull of the mesh assets so the 2d bounding boxes only need to project the hull's vertexes
+/// The hull of a mesh is only built the first time it's used, e.g: a scanned mesh without collision can have 50k vertexes
+/// while its hull only keep a few hundreds of them. The 2d bounding box of the hull is the same as the mesh's one
+/// since the extremes of the projected positions are always on the hull
+/// NOTE: The cache can be used from any thread
+///
+class NVSCENECAPTURER_API FNVMeshHullCache
+{
+public:
+    /// Get the convex hull of the mesh a component is using, it's built on the calling thread if the mesh isn't cached yet
+    /// @return null if the component doesn't use any mesh
+    static TSharedPtr<const FNVMeshHull, ESPMode::ThreadSafe> FindOrAdd(const UMeshComponent* MeshComp);
+    /// Force the hull of a mesh to be rebuilt the next time it's used, e.g: after changing its collision
+    static void Invalidate(const UObject* MeshAsset);
+    /// Remove all the cached hulls
+    static void Reset();
+
+protected:
+    /// Get the data the hull of a mesh is built from, the hull need to be rebuilt when it change (e.g: the mesh is reimported)
+    static const void* GetMeshSourceKey(const UMeshComponent* MeshComp);
+
+protected:
+    struct FCachedMeshHull
+    {
+        const void* SourceKey;
+        TSharedPtr<const FNVMeshHull, ESPMode::ThreadSafe> Hull;
+    };
+
+    static FCriticalSection CacheCriticalSection;
+    static TMap<TWeakObjectPtr<const UObject>, FCachedMeshHull> CachedMeshHulls;
+};
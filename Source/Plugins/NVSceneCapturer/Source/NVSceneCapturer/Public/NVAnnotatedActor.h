@@ -52,9 +52,6 @@ protected:
 
     FMatrix GetMeshInitialMatrix() const;
 
-    FMatrix CalculatePCA(const class UStaticMesh* Mesh);
-    FVector ComputeEigenVector(const FMatrix& Mat);
-
 public: // Editor properties
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
     class UNVCapturableActorTag* AnnotationTag;
@@ -0,0 +1,215 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FCapturedSceneData;
+
+///
+/// Binary encoding of the captured annotation data (FCapturedSceneData), it's exported to ".nvab" files
+/// instead of ".json" when the annotation feature extractor use the binary format
+///
+/// Layout of the file, all values are little-endian:
+///     FNVAnnotationBinaryHeader       - HeaderSize bytes
+///     FNVAnnotationBinaryViewpoint    - ViewpointSize bytes
+///     FNVAnnotationBinaryObject[]     - ObjectSize bytes each, ObjectCount records
+///     Variable data                   - the strings and arrays the objects point to, each item start at a 4 bytes boundary
+/// Everything up to the variable data has a fixed size so a reader can map the records straight to its structs,
+/// e.g: numpy.frombuffer with the dtype described in the schema file ("_annotation_schema.json")
+/// NOTE: Unlike the json, the float values are not rounded, the converter round them when it rebuild the json
+///
+
+/// Location of an array in the variable data
+struct FNVAnnotationBinarySpan
+{
+    /// Offset in bytes from the start of the file
+    uint32 Offset;
+    /// Number of elements, strings are UTF-8 and their element is a byte
+    uint32 Count;
+};
+static_assert(sizeof(FNVAnnotationBinarySpan) == 8, "FNVAnnotationBinarySpan must match the documented file layout.");
+
+struct FNVAnnotationBinaryHeader
+{
+    /// Always "NVAB"
+    uint8 Magic[4];
+    uint32 Version;
+    uint32 HeaderSize;
+    uint32 ViewpointSize;
+    uint32 ObjectSize;
+    uint32 ObjectCount;
+    /// Size in bytes of the whole file
+    uint32 TotalSize;
+    /// The optional fields the objects have, combination of ENVOptionalObjectFields
+    /// NOTE: The object records always have room for them, the fields which aren't set are zero and left out of the converted json
+    uint32 OptionalObjectFields;
+};
+static_assert(sizeof(FNVAnnotationBinaryHeader) == 32, "FNVAnnotationBinaryHeader must match the documented file layout.");
+
+/// FCapturedViewpointData
+struct FNVAnnotationBinaryViewpoint
+{
+    float LocationWorldframe[3];
+    float QuaternionXYZWWorldframe[4];
+    float ProjectionMatrix[16];
+    float ViewProjectionMatrix[16];
+
+    // FCameraIntrinsicSettings
+    int32 ResX;
+    int32 ResY;
+    float Fx;
+    float Fy;
+    float Cx;
+    float Cy;
+    float S;
+    float IntrinsicMatrix[16];
+    float CameraProjectionMatrix[16];
+
+    float Fov;
+};
+static_assert(sizeof(FNVAnnotationBinaryViewpoint) == 316, "FNVAnnotationBinaryViewpoint must match the documented file layout.");
+
+/// FCapturedObjectData
+/// NOTE: The rotators are stored as [pitch, yaw, roll], the quaternions as [x, y, z, w] and the matrixes row by row
+struct FNVAnnotationBinaryObject
+{
+    uint32 InstanceId;
+    uint32 Occluded;
+    float Truncated;
+    float Occlusion;
+    float Visibility;
+    uint32 VisiblePixelCount;
+    uint32 ProjectedPixelCount;
+    uint32 TruncationFlags;
+
+    float DimensionsWorldspace[3];
+    float LocationWorldspace[3];
+    float Location[3];
+    float RotationWorldspace[3];
+    float QuaternionWorldspace[4];
+    float Rotation[3];
+    float QuaternionXYZW[4];
+
+    float ActorToWorldMatrixUE4[16];
+    float ActorToWorldMatrixOpenCV[16];
+    float ActorToCameraMatrix[16];
+    float PoseTransform[16];
+
+    float BoundingBoxCenterWorldspace[3];
+    float CuboidCentroid[3];
+    float ProjectedCuboidCentroid[2];
+    float BoundingBoxForwardDirection[3];
+    float BoundingBoxForwardDirectionImagespace[2];
+    float ViewpointAzimuthAngle;
+    float ViewpointAltitudeAngle;
+    float DistanceScale;
+    float BoundingBoxTopLeft[2];
+    float BoundingBoxBottomRight[2];
+    /// [height, width] of the run-length encoded mask, 0 if it's not exported
+    uint32 SegmentationRleSize[2];
+
+    /// UTF-8 strings
+    FNVAnnotationBinarySpan Name;
+    FNVAnnotationBinarySpan Class;
+    /// uint8 values
+    FNVAnnotationBinarySpan Rgba;
+    /// float[3] values
+    FNVAnnotationBinarySpan Cuboid;
+    /// float[2] values
+    FNVAnnotationBinarySpan ProjectedCuboid;
+    /// uint32 values
+    FNVAnnotationBinarySpan SegmentationRleCounts;
+    /// FNVAnnotationBinaryPolygon values
+    FNVAnnotationBinarySpan SegmentationPolygons;
+    /// FNVAnnotationBinarySocket values
+    FNVAnnotationBinarySpan SocketData;
+    /// The custom data as condensed UTF-8 json text, empty if the object doesn't have any
+    FNVAnnotationBinarySpan CustomData;
+};
+static_assert(sizeof(FNVAnnotationBinaryObject) == 540, "FNVAnnotationBinaryObject must match the documented file layout.");
+
+/// FNVPolygon2D
+struct FNVAnnotationBinaryPolygon
+{
+    /// float[2] values
+    FNVAnnotationBinarySpan Points;
+};
+static_assert(sizeof(FNVAnnotationBinaryPolygon) == 8, "FNVAnnotationBinaryPolygon must match the documented file layout.");
+
+/// FNVSocketData
+struct FNVAnnotationBinarySocket
+{
+    /// UTF-8 string
+    FNVAnnotationBinarySpan SocketName;
+    float SocketLocation[2];
+};
+static_assert(sizeof(FNVAnnotationBinarySocket) == 16, "FNVAnnotationBinarySocket must match the documented file layout.");
+
+///
+/// FNVAnnotationBinaryWriter - encode the captured scene data to the binary format
+///
+struct NVSCENECAPTURER_API FNVAnnotationBinaryWriter
+{
+public:
+    /// @param OutBinaryData   The buffer to write the encoded data to, its content is replaced but its allocated memory is kept
+    static void SerializeCapturedSceneData(const FCapturedSceneData& SceneData, TArray<uint8>& OutBinaryData);
+
+    /// Get the schema of the binary format as json text, it describe the fields of the fixed size records
+    static FString GetSchemaText();
+
+    /// Extension of the binary annotation files
+    static const FString FileExtension;
+    /// Name of the schema file which is exported next to the binary annotation files
+    static const FString SchemaFileName;
+};
+
+///
+/// FNVAnnotationBinaryReader - random access to the data encoded in the binary format
+/// NOTE: The reader doesn't copy the data, the data must stay alive while the reader is used
+///
+struct NVSCENECAPTURER_API FNVAnnotationBinaryReader
+{
+public:
+    FNVAnnotationBinaryReader();
+
+    /// Validate the data and set up the reader to access it
+    bool Open(const uint8* InData, int64 InDataSize);
+    bool IsOpen() const;
+
+    const FNVAnnotationBinaryViewpoint& GetViewpoint() const;
+    int32 GetObjectCount() const;
+    const FNVAnnotationBinaryObject& GetObject(int32 ObjectIndex) const;
+
+    FString GetString(const FNVAnnotationBinarySpan& StringSpan) const;
+    /// Get the pointer to the first element of an array, the caller need to use the span's Count
+    template<typename ElementType> const ElementType* GetArray(const FNVAnnotationBinarySpan& ArraySpan) const
+    {
+        return (const ElementType*)(Data + ArraySpan.Offset);
+    }
+
+    /// Decode the whole data back to the captured scene data struct
+    void ReadCapturedSceneData(FCapturedSceneData& OutSceneData) const;
+
+    /// Convert the binary data to the same json text the json exporter would have written for the same frame
+    static bool ConvertToJson(const TArray<uint8>& BinaryData, TArray<uint8>& OutJsonData);
+    /// Convert a binary annotation file to a json file
+    static bool ConvertFileToJson(const FString& BinaryFilePath, const FString& JsonFilePath);
+    /// Convert all the binary annotation files in a directory and its subdirectories to json files
+    /// NOTE: The console command "NVSceneCapturer.ConvertAnnotationsToJson <BinaryDirectory> [JsonDirectory]" call it
+    /// @param JsonDirectory    The directory to write the json files to, keeping the same relative paths; the binary files' directory if empty
+    /// @return The number of files converted
+    static int32 ConvertDirectoryToJson(const FString& BinaryDirectory, const FString& JsonDirectory = TEXT(""));
+
+protected:
+    bool IsValidSpan(const FNVAnnotationBinarySpan& CheckSpan, uint32 ElementSize) const;
+
+protected:
+    const uint8* Data;
+    int64 DataSize;
+    const FNVAnnotationBinaryHeader* Header;
+};
@@ -0,0 +1,145 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Async/MappedFileHandle.h"
+
+///
+/// Binary index of the exported dataset, it's written next to the exported data while capturing
+///
+/// Layout of the index file ("_index.bin"), all values are little-endian:
+///     FNVDatasetIndexHeader   - 16 bytes
+///     FNVDatasetIndexRecord[] - RecordSize bytes each, the record count is (FileSize - HeaderSize) / RecordSize
+/// The names used by the records (viewpoints, feature extractors and file name postfixes) are kept in the names file ("_index.names"),
+/// one UTF-8 name per line, the line number (starting from 0) is the name's id
+/// NOTE: Both files are append-only so the index is still readable if the capture is interrupted
+///
+
+/// Type of the data an index record points to
+enum class ENVDatasetIndexEntryType : uint16
+{
+    Image = 0,
+    Annotation = 1,
+};
+
+struct FNVDatasetIndexHeader
+{
+    /// Always "NVDI"
+    uint8 Magic[4];
+    uint32 Version;
+    uint32 HeaderSize;
+    uint32 RecordSize;
+};
+static_assert(sizeof(FNVDatasetIndexHeader) == 16, "FNVDatasetIndexHeader must match the documented file layout.");
+
+struct FNVDatasetIndexRecord
+{
+    /// Offset of the data in its shard file, 0 when the data is saved to its own file
+    int64 DataOffset;
+    /// Size of the data in bytes
+    int64 DataSize;
+
+    int32 FrameIndex;
+    int32 PicksetIndex;
+    int32 PicksetSubImage;
+    /// Index of the shard file which contain the data, -1 when the data is saved to its own file
+    int32 ShardIndex;
+
+    /// Ids of the names in the names file
+    uint16 ViewpointNameId;
+    uint16 FeatureExtractorNameId;
+    /// The data's file name is the frame indexes followed by this postfix, e.g: "000001.000000.000000" + ".depth.png"
+    /// NOTE: In the shards the frame indexes are joined with '_' instead of '.'
+    uint16 FileNamePostfixId;
+    /// ENVDatasetIndexEntryType
+    uint16 EntryType;
+
+    /// Number of annotated objects in the frame, only used by annotation records
+    uint32 ObjectCount;
+    /// FCrc::MemCrc32 of the data
+    uint32 Checksum;
+
+public:
+    FNVDatasetIndexRecord()
+    {
+        FMemory::Memzero(*this);
+        ShardIndex = -1;
+    }
+};
+static_assert(sizeof(FNVDatasetIndexRecord) == 48, "FNVDatasetIndexRecord must match the documented file layout.");
+
+///
+/// FNVDatasetIndexWriter - append index records to the index file
+/// NOTE: The writer is thread-safe, the image exporter's worker threads add the records of the images they exported
+///
+struct NVSCENECAPTURER_API FNVDatasetIndexWriter
+{
+public:
+    /// @param InIndexFilePath          Path to the index file, the names file is put next to it
+    /// @param bAppendToExistingIndex   If true and the index file already exist, new records are added after the existing ones
+    /// @param InSyncEveryNumRecords    Flush the index to disk after this many records, 0 means only flush when the index is closed
+    FNVDatasetIndexWriter(const FString& InIndexFilePath, bool bAppendToExistingIndex = false, int32 InSyncEveryNumRecords = 256);
+    ~FNVDatasetIndexWriter();
+
+    /// Get the id of a name, the name is added to the names file if it's new
+    uint16 GetNameId(const FString& Name);
+
+    bool AddRecord(const FNVDatasetIndexRecord& Record);
+    /// Add a record for the data, its size and checksum are filled in from the data
+    bool AddRecord(const FNVDatasetIndexRecord& Record, const uint8* Data, int64 DataSize);
+
+    void Flush();
+    void Close();
+
+    int64 GetRecordCount() const;
+
+    static FString GetNamesFilePath(const FString& IndexFilePath);
+
+protected:
+    bool Open(bool bAppendToExistingIndex);
+
+protected:
+    FString IndexFilePath;
+    int32 SyncEveryNumRecords;
+
+    mutable FCriticalSection WriterCriticalSection;
+    IFileHandle* IndexFileHandle;
+    IFileHandle* NamesFileHandle;
+    TMap<FString, uint16> NameIdMap;
+    int64 RecordCount;
+    int32 UnsyncedRecordCount;
+};
+
+///
+/// FNVDatasetIndexReader - map an index file to memory for random access to its records
+///
+struct NVSCENECAPTURER_API FNVDatasetIndexReader
+{
+public:
+    FNVDatasetIndexReader();
+    ~FNVDatasetIndexReader();
+
+    bool Open(const FString& IndexFilePath);
+    void Close();
+    bool IsOpen() const;
+
+    int64 Num() const;
+    const FNVDatasetIndexRecord& GetRecord(int64 RecordIndex) const;
+    FString GetName(uint16 NameId) const;
+
+protected:
+    IMappedFileHandle* MappedFileHandle;
+    IMappedFileRegion* MappedFileRegion;
+    /// NOTE: Only used when the file can't be memory mapped
+    TArray<uint8> LoadedFileData;
+
+    const FNVDatasetIndexRecord* Records;
+    int64 RecordCount;
+    TArray<FString> Names;
+};
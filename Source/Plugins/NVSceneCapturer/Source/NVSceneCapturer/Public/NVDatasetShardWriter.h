@@ -0,0 +1,78 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformFilemanager.h"
+
+///
+/// FNVDatasetShardWriter - append named entries into big sequential tar (ustar) shard files
+/// The shards can be read by any tar reader and by WebDataset style loaders (entries of the same sample share the same key before the first '.')
+/// NOTE: The writer is thread-safe, all the image exporter's worker threads can add entries at the same time
+///
+struct NVSCENECAPTURER_API FNVDatasetShardWriter
+{
+public:
+    /// @param InOutputDirectoryPath    The directory to write the shard files to
+    /// @param InShardNamePrefix        Name of the shard files, they are named "<prefix>-<shard index>.tar"
+    /// @param InMaxShardSize           A new shard is started when the current one would grow bigger than this (in bytes), 0 means no limit
+    /// @param InFlushEveryNumEntries   Flush the shard file after this many entries, 0 means only flush when the shard is closed
+    /// NOTE: Flushing hand the written data over to the OS, it doesn't wait for the data to be stored on the disk
+    FNVDatasetShardWriter(const FString& InOutputDirectoryPath, const FString& InShardNamePrefix,
+                          int64 InMaxShardSize, int32 InFlushEveryNumEntries);
+    ~FNVDatasetShardWriter();
+
+    /// Append an entry to the current shard
+    /// @param EntryName     Name of the entry inside the shard, must be less than 100 characters
+    /// @param Data          The content of the entry
+    /// @param DataSize      Number of bytes in Data
+    /// @param OutShardIndex Index of the shard the entry is written to
+    /// @param OutDataOffset Offset of the entry's content in the shard file
+    /// result               True if the entry is written
+    /// NOTE: If the entry can't be fully written, it's removed from the shard and the writer is closed
+    bool AddEntry(const FString& EntryName, const uint8* Data, int64 DataSize,
+                  int32* OutShardIndex = nullptr, int64* OutDataOffset = nullptr);
+    bool AddEntry(const FString& EntryName, const TArray<uint8>& Data,
+                  int32* OutShardIndex = nullptr, int64* OutDataOffset = nullptr);
+
+    /// Flush all the written entries to the OS
+    void Flush();
+
+    /// Finish the current shard and stop accepting new entries
+    void Close();
+
+    bool IsClosed() const;
+    int32 GetShardCount() const;
+    int64 GetEntryCount() const;
+    int64 GetTotalWrittenSize() const;
+
+protected:
+    bool OpenNextShard();
+    void CloseCurrentShard();
+
+    /// Fill in a 512 bytes ustar header block for an entry
+    static bool BuildEntryHeader(const FString& EntryName, int64 DataSize, uint8* OutHeaderBlock);
+
+protected:
+    /// The tar format work with blocks of 512 bytes
+    static const int32 TarBlockSize = 512;
+
+    FString OutputDirectoryPath;
+    FString ShardNamePrefix;
+    int64 MaxShardSize;
+    int32 FlushEveryNumEntries;
+
+    /// Guard all the states below, the entries are written one after another
+    mutable FCriticalSection WriterCriticalSection;
+    IFileHandle* ShardFileHandle;
+    int32 ShardCount;
+    int64 CurrentShardSize;
+    int32 UnflushedEntryCount;
+    int64 EntryCount;
+    int64 TotalWrittenSize;
+    bool bIsClosed;
+};
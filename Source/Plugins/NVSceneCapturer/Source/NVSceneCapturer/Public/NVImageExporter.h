@@ -13,14 +13,20 @@
 #include "IImageWrapperModule.h"
 #include "NVImageExporter.generated.h"
 
+/// Callback to take the compressed image instead of saving it to its own file
+/// @param ExportFilePath    The path the image was queued with
+/// @param CompressedData    The compressed image, only valid during the call
+/// NOTE: It's called on the image exporter's worker threads
+typedef TFunction<bool(const FString& ExportFilePath, const TArray<uint8>& CompressedData)> FNVCompressedImageCallback;
+
 USTRUCT()
 struct NVSCENECAPTURER_API FNVImageExporterData
 {
     GENERATED_BODY()
 
 public:
-    UPROPERTY()
-    FNVTexturePixelData PixelDataToBeExported;
+    /// NOTE: This is just a reference to the captured pixels data, the data itself is not copied
+    FNVTexturePixelDataRef PixelDataToBeExported;
 
     UPROPERTY()
     FString ExportFilePath;
@@ -28,11 +34,19 @@ public:
 	UPROPERTY()
 	ENVImageFormat ExportImageFormat;
 
+	UPROPERTY()
+	FNVImageCompressionSettings CompressionSettings;
+
+    /// If set, the compressed image is passed to this callback instead of being saved to ExportFilePath
+    FNVCompressedImageCallback CompressedImageCallback;
+
 public:
 	FNVImageExporterData();
-    FNVImageExporterData(const FNVTexturePixelData& InPixelDataToBeExported,
-						const FString InExportFilePath,
-						ENVImageFormat InExportImageFormat = ENVImageFormat::PNG);
+    FNVImageExporterData(const FNVTexturePixelDataRef& InPixelDataToBeExported,
+						const FString& InExportFilePath,
+						ENVImageFormat InExportImageFormat = ENVImageFormat::PNG,
+						const FNVImageCompressionSettings& InCompressionSettings = FNVImageCompressionSettings(),
+						const FNVCompressedImageCallback& InCompressedImageCallback = nullptr);
 };
 
 struct NVSCENECAPTURER_API FNVImageExporter
@@ -42,10 +56,37 @@ public:
     ~FNVImageExporter();
 
     /// Compress a source image data to PNG format
-    /// NOTE: PNG is lossless compression so we can't change the compression quality
-    /// This function always use Z_BEST_SPEED, may be we want to customize the compression level
+    /// NOTE: PNG is lossless compression so we can't change the compression quality, only the zlib level and the row filter
+    /// Big images are split into stripes of rows which are compressed in parallel then joined into a single IDAT stream,
+    /// unless CompressionSettings.bAllowParallelEncoding is off
+    /// The automation test NVSceneCapturer.ImageExporter.PngStripes check the output and report the throughput and size of each setting
+    /// @param CompressionSettings   The zlib level and row filter to use
     /// result   The compressed data in bytes
-    static TArray<uint8> CompressImagePNG(const FNVTexturePixelData& SourcePixelData);
+    static TArray<uint8> CompressImagePNG(const FNVTexturePixelData& SourcePixelData,
+                                          const FNVImageCompressionSettings& CompressionSettings = FNVImageCompressionSettings());
+    static void CompressImagePNG(const FNVTexturePixelData& SourcePixelData, TArray<uint8>& OutCompressedData,
+                                 const FNVImageCompressionSettings& CompressionSettings = FNVImageCompressionSettings());
+
+    /// Compress a source image data to PNG format with 16 bits per channel
+    /// The 8 bits channels are widened, the floating point channels are clamped to [0, 1] and the 2 channels images are written as RGB
+    static void CompressImagePNG16(const FNVTexturePixelData& SourcePixelData, TArray<uint8>& OutCompressedData,
+                                   const FNVImageCompressionSettings& CompressionSettings = FNVImageCompressionSettings());
+
+    /// Compress a source image data to OpenEXR format (scanline image, half or float channels)
+    /// The 1 channel images are written to the Y channel, the others to the R, G, B, A channels
+    /// The fixed point channels are normalized to [0, 1], the floating point channels are kept as is
+    /// Blocks of scanlines are compressed in parallel
+    /// @param CompressionSettings   The EXR compression, pixel type and zlib level to use
+    static void CompressImageEXR(const FNVTexturePixelData& SourcePixelData, TArray<uint8>& OutCompressedData,
+                                 const FNVImageCompressionSettings& CompressionSettings = FNVImageCompressionSettings());
+
+    /// Write a source image data as a numpy array (.npy) of shape (height, width) or (height, width, channels)
+    /// The pixels are stored as is in their own type (uint8, uint16, float16 or float32), the BGRA pixels are reordered to RGBA
+    static void WriteImageNPY(const FNVTexturePixelData& SourcePixelData, TArray<uint8>& OutData);
+
+    /// Write a source image data as an uncompressed 24 bits BMP file, the same file FFileHelper::CreateBitmap write
+    /// NOTE: Same as FFileHelper::CreateBitmap, the pixels are read as FColor and their alpha is left out
+    static void WriteImageBMP(const FNVTexturePixelData& SourcePixelData, TArray<uint8>& OutData);
 
     /// Compress a source image to a certain image type
     /// @param ImageWrapperModule    Reference to the ImageWrapper module
@@ -58,41 +99,92 @@ public:
                                        ENVImageFormat ImageFormat,
                                        uint8 CompressionQuality = 100);
 
+    /// Compress a source image to a certain image type
+    /// NOTE: Same as the function above but write to an existing buffer so the caller can reuse its memory
+    /// @param OutCompressedData     The buffer to write the compressed data to, its allocated memory is kept
+    /// @param CompressionSettings   The settings used for the lossless formats
+    static void CompressImage(IImageWrapperModule* ImageWrapperModule,
+                              const FNVTexturePixelData& SourcePixelData,
+                              ENVImageFormat ImageFormat,
+                              TArray<uint8>& OutCompressedData,
+                              uint8 CompressionQuality = 100,
+                              const FNVImageCompressionSettings& CompressionSettings = FNVImageCompressionSettings());
+
     /// Export an in-memory image to file on disk
     static bool ExportImage(IImageWrapperModule* ImageWrapperModule, const FNVImageExporterData& ImageExporterData);
 
+    /// Export an in-memory image to file on disk
+    /// @param ScratchBuffer    Buffer used to keep the compressed data, reused between images to avoid reallocating
+    static bool ExportImage(IImageWrapperModule* ImageWrapperModule, const FNVImageExporterData& ImageExporterData, TArray<uint8>& ScratchBuffer);
+
 	bool ExportImage(const FNVImageExporterData& ImageExporterData);
 
 protected:
     IImageWrapperModule* ImageWrapperModule;
 };
 
+///
+/// FNVImageExporter_Thread - a fixed pool of worker threads which compress and save the queued images to disk
+/// NOTE: The queue is bounded, when it's full the producer will wait for a free slot instead of growing the queue
+/// Each worker compress its images on its own thread, the images aren't split into parallel tasks (see FNVImageCompressionSettings::bAllowParallelEncoding)
+/// Stopping the exporter doesn't drop the queued images, Kill wait for the workers to export them
+///
 struct NVSCENECAPTURER_API FNVImageExporter_Thread : public FRunnable
 {
 public:
-    FNVImageExporter_Thread(IImageWrapperModule* InImageWrapperModule);
+    /// @param InImageWrapperModule  Reference to the ImageWrapper module
+    /// @param InWorkerCount         Number of worker threads to spin up, 0 means pick the count based on the machine's cores
+    /// @param InMaxQueuedImageCount Maximum number of images waiting in the queue, 0 means the queue is unbounded
+    FNVImageExporter_Thread(IImageWrapperModule* InImageWrapperModule, int32 InWorkerCount = 0, int32 InMaxQueuedImageCount = 0);
     ~FNVImageExporter_Thread();
 
-    bool ExportImage(const FNVTexturePixelData& ExportPixelData,
+    /// Queue an image to be compressed and exported by the workers
+    /// @param CompressedImageCallback   If set, the compressed image (or the uncompressed BMP file) is passed to it instead of being saved to ExportFilePath
+    bool ExportImage(const FNVTexturePixelDataRef& ExportPixelData,
                      const FString& ExportFilePath,
-					 const ENVImageFormat ExportImageFormat = ENVImageFormat::PNG);
+					 const ENVImageFormat ExportImageFormat = ENVImageFormat::PNG,
+					 const FNVImageCompressionSettings& CompressionSettings = FNVImageCompressionSettings(),
+					 const FNVCompressedImageCallback& CompressedImageCallback = nullptr);
 
+    /// NOTE: This function is run by all the worker threads at the same time
     virtual uint32 Run();
     virtual void Stop() override;
     void Kill();
 
+    /// Number of images which are either waiting in the queue or being exported
     uint32 GetPendingImagesCount() const;
+    /// Block the calling thread until all the queued images are exported
+    /// NOTE: The producers must not queue more images while waiting, e.g: wait after the exporter is stopped
+    void WaitForPendingImages();
     bool IsExportingImage() const;
 
+    /// Check whether the queue reached its capacity - the producer should stop feeding more images when it's full
+    bool IsQueueFull() const;
+
+    int32 GetWorkerCount() const;
+
 protected:
-    FRunnableThread* Thread;
+    /// Pop the next queued image, return false if there are no images left
+    bool DequeueImageData(FNVImageExporterData& OutImageData);
+
+protected:
+    TArray<FRunnableThread*> WorkerThreads;
     FThreadSafeBool bIsRunning;
 
+    /// NOTE: TQueue only support 1 producer and 1 consumer at the same time so we guard each side with its own lock
     TQueue<FNVImageExporterData> QueuedImageData;
+    FCriticalSection EnqueueCriticalSection;
+    FCriticalSection DequeueCriticalSection;
+    int32 MaxQueuedImageCount;
 
     IImageWrapperModule* ImageWrapperModule;
 
+    /// Triggered when there are new images in the queue
     FEvent* HavePendingImageEvent;
+    /// Triggered when a worker take an image out of the queue
+    FEvent* HaveFreeSlotEvent;
+    /// Triggered when a worker finished exporting an image
+    FEvent* ImageExportedEvent;
     FThreadSafeCounter PendingImageCounter;
-    TSharedPtr<FThreadSafeCounter, ESPMode::ThreadSafe> ExportingImageCounterPtr;
-};
\ No newline at end of file
+    FThreadSafeCounter ExportingImageCounter;
+};
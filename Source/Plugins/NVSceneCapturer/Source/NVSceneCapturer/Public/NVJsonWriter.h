@@ -0,0 +1,115 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonValue.h"
+
+struct FCapturedSceneData;
+struct FCapturedViewpointData;
+struct FCapturedObjectData;
+struct FCameraIntrinsicSettings;
+
+///
+/// FNVJsonWriter - write pretty printed json as UTF-8 text straight into a byte buffer
+/// NOTE: The output is byte-identical to building the same FJsonObject tree and serializing it with TJsonWriter's pretty print policy,
+/// so the files we export don't change, but we don't need to allocate a FJsonValue for every value
+/// The automation tests NVSceneCapturer.JsonWriter.* check the output match and measure how fast the objects are serialized
+///
+struct NVSCENECAPTURER_API FNVJsonWriter
+{
+public:
+    /// @param InOutputBuffer    The buffer to append the json text to, the caller can reuse it between frames to keep its memory
+    FNVJsonWriter(TArray<uint8>& InOutputBuffer, int32 InitialIndentLevel = 0);
+
+    void WriteObjectStart();
+    void WriteObjectStart(const ANSICHAR* Identifier);
+    void WriteObjectStart(const FString& Identifier);
+    void WriteObjectEnd();
+
+    void WriteArrayStart();
+    void WriteArrayStart(const ANSICHAR* Identifier);
+    void WriteArrayStart(const FString& Identifier);
+    void WriteArrayEnd();
+
+    void WriteValue(double Value);
+    void WriteValue(bool Value);
+    void WriteValue(const FString& Value);
+    void WriteNull();
+
+    void WriteValue(const ANSICHAR* Identifier, double Value);
+    void WriteValue(const ANSICHAR* Identifier, bool Value);
+    void WriteValue(const ANSICHAR* Identifier, const FString& Value);
+
+    /// Write a generic json value, e.g: the custom data of the annotated actors
+    void WriteJsonValue(const TSharedPtr<FJsonValue>& Value);
+    void WriteJsonValue(const FString& Identifier, const TSharedPtr<FJsonValue>& Value);
+    void WriteJsonObjectFields(const TSharedPtr<FJsonObject>& Object);
+
+    //================ Shorthand format used by the captured data, see NVSceneCapturerUtils::CustomPropertyToJsonValueFunc ================
+    /// Floats are rounded to 4 decimal places
+    void WriteFloat(const ANSICHAR* Identifier, float Value);
+    /// Vectors are written as arrays: [x, y, z]
+    void WriteVector(const ANSICHAR* Identifier, const FVector& Value);
+    void WriteVector(const FVector& Value);
+    void WriteVector2D(const ANSICHAR* Identifier, const FVector2D& Value);
+    void WriteVector2D(const FVector2D& Value);
+    /// Quaternions are written as arrays: [x, y, z, w]
+    void WriteQuat(const ANSICHAR* Identifier, const FQuat& Value);
+    /// Matrixes are written as arrays of rows
+    void WriteMatrix(const ANSICHAR* Identifier, const FMatrix& Value);
+    /// Rotators are written as objects: {"pitch", "yaw", "roll"}
+    void WriteRotator(const ANSICHAR* Identifier, const FRotator& Value);
+
+    //================ Captured data ================
+    /// Serialize the captured scene data the same way as converting it with NVSceneCapturerUtils::CapturedSceneDataToJsonObject then serializing the json object
+    /// @param OutJsonData   The buffer to write the json text to, its content is replaced but its allocated memory is kept
+    static void SerializeCapturedSceneData(const FCapturedSceneData& SceneData, TArray<uint8>& OutJsonData);
+
+    void WriteCapturedViewpointData(const ANSICHAR* Identifier, const FCapturedViewpointData& ViewpointData);
+    void WriteCameraIntrinsicSettings(const ANSICHAR* Identifier, const FCameraIntrinsicSettings& CameraSettings);
+    /// @param OptionalObjectFields  The optional fields the object has, see FCapturedSceneData::OptionalObjectFields
+    void WriteCapturedObjectData(const FCapturedObjectData& ObjectData, uint32 OptionalObjectFields);
+
+protected:
+    enum class EToken : uint8
+    {
+        None,
+        CurlyOpen,
+        CurlyClose,
+        SquareOpen,
+        SquareClose,
+        Identifier,
+        String,
+        Number,
+        True,
+        False,
+        Null,
+    };
+
+    static bool IsShortValue(EToken Token);
+
+    void WriteCommaIfNeeded();
+    void WriteIdentifier(const ANSICHAR* Identifier);
+    void WriteIdentifier(const FString& Identifier);
+    void WriteLineTerminator();
+    void WriteTabs();
+    void WriteChar(ANSICHAR Char);
+    void WriteAnsiString(const ANSICHAR* String, int32 Length);
+
+    /// Write a quoted, escaped string
+    void WriteStringValue(const ANSICHAR* String);
+    void WriteStringValue(const FString& String);
+
+    /// Write a number without any separator before it, numbers use the same "%.17g" format as TJsonWriter
+    EToken WriteNumberOnly(double Value);
+
+protected:
+    TArray<uint8>& OutputBuffer;
+    int32 IndentLevel;
+    EToken PreviousTokenWritten;
+};
@@ -0,0 +1,107 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "NVRenderTargetPool.generated.h"
+
+/// Settings of the render targets which can be shared in the pool
+/// NOTE: The other settings (mips, sRGB, shared flags...) are the same for all the scene capture render targets
+struct NVSCENECAPTURER_API FNVRenderTargetDesc
+{
+public:
+    FNVRenderTargetDesc();
+    FNVRenderTargetDesc(const FIntPoint& InSize, ETextureRenderTargetFormat InRenderTargetFormat,
+                        EPixelFormat InOverrideFormat = EPixelFormat::PF_Unknown, float InTargetGamma = 0.f);
+
+    bool IsValid() const;
+
+    bool operator==(const FNVRenderTargetDesc& Other) const;
+    bool operator!=(const FNVRenderTargetDesc& Other) const
+    {
+        return !(*this == Other);
+    }
+
+    friend uint32 GetTypeHash(const FNVRenderTargetDesc& Desc);
+
+public:
+    FIntPoint Size;
+    ETextureRenderTargetFormat RenderTargetFormat;
+    /// If it's not PF_Unknown, this format is used instead of RenderTargetFormat
+    EPixelFormat OverrideFormat;
+    /// NOTE: 0 means use the display gamma
+    float TargetGamma;
+};
+
+/// A render target owned by the pool
+USTRUCT()
+struct FNVPooledRenderTarget
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(Transient)
+    UTextureRenderTarget2D* RenderTarget;
+
+    FNVRenderTargetDesc Desc;
+    bool bIsLeased;
+    /// Frame number (GFrameCounter) when the render target was last returned to the pool
+    uint64 LastReleasedFrame;
+};
+
+///
+/// UNVRenderTargetPool - share the scene capture render targets between the feature extractors of all the viewpoints of a capturer
+/// The scene capture components lease a render target matching their settings only while they are capturing,
+/// so components which don't capture at the same time reuse the same GPU textures
+/// NOTE: The pool can only be accessed on the game thread
+///
+UCLASS(Transient)
+class NVSCENECAPTURER_API UNVRenderTargetPool : public UObject
+{
+    GENERATED_BODY()
+
+public:
+    UNVRenderTargetPool(const FObjectInitializer& ObjectInitializer);
+
+    /// Lease a free render target matching the settings, a new one is created if there's none
+    /// NOTE: The render target must be returned with ReleaseRenderTarget, its content is undefined until it's captured to
+    UTextureRenderTarget2D* AcquireRenderTarget(const FNVRenderTargetDesc& Desc);
+    /// Return a leased render target to the pool
+    void ReleaseRenderTarget(UTextureRenderTarget2D* RenderTarget);
+
+    /// Let the pool know a user may lease a render target with these settings, the pool keep (and create up front)
+    /// one render target of these settings as long as a user reserve them
+    /// NOTE: The users only lease the render target while their capture is issued so they take turns using it
+    void ReserveRenderTarget(const FNVRenderTargetDesc& Desc);
+    void UnreserveRenderTarget(const FNVRenderTargetDesc& Desc);
+
+    /// Release the free render targets which nobody reserve and which weren't used for more than MaxIdleFrames frames
+    void TrimUnusedRenderTargets();
+    /// Release all the render targets, the leased ones are kept until they are returned
+    void Reset();
+
+    void SetMaxIdleFrames(int32 NewMaxIdleFrames);
+
+    int32 GetRenderTargetCount() const;
+    int32 GetLeasedRenderTargetCount() const;
+
+protected:
+    UTextureRenderTarget2D* CreateRenderTarget(const FNVRenderTargetDesc& Desc);
+    int32 GetRenderTargetCount(const FNVRenderTargetDesc& Desc) const;
+    void ReleasePooledRenderTarget(int32 PooledIndex);
+
+protected:
+    UPROPERTY(Transient)
+    TArray<FNVPooledRenderTarget> PooledRenderTargets;
+
+    /// Number of users reserving each render target settings
+    TMap<FNVRenderTargetDesc, int32> ReservedCounts;
+
+    int32 MaxIdleFrames;
+};
@@ -9,11 +9,32 @@
 #include "Components/SceneCaptureComponent2D.h"
 #include "NVSceneCapturerUtils.h"
 #include "NVTextureReader.h"
+#include "NVRenderTargetPool.h"
 #include "Engine/TextureRenderTarget2D.h"
 #include "NVSceneCaptureComponent2D.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogNVSceneCapturerComponent2D, Log, All)
 
+class FNVSceneCaptureViewExtension;
+
+/// A buffer of the scene the component resolve to its own render target, see UNVSceneCaptureComponent2D::AddCaptureOutput
+USTRUCT()
+struct FNVSceneCaptureOutputData
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(Transient)
+    UTextureRenderTarget2D* RenderTarget;
+
+    ENVSceneCaptureOutput Output;
+    TEnumAsByte<ENVCapturedPixelFormat> ReadbackPixelFormat;
+    float OutputScale;
+
+    TSharedPtr<FNVTextureRenderTargetReader> RenderTargetReader;
+    TArray<TFunction<void(const FNVTexturePixelDataRef&)>> ReadbackCallbackList;
+};
+
 /// @cond DOXYGEN_SUPPRESSED_CODE
 UCLASS(Blueprintable, ClassGroup = (NVIDIA), meta = (BlueprintSpawnableComponent),
        HideCategories = (Replication, ComponentReplication, Cooking, Events, ComponentTick,
@@ -26,8 +47,8 @@ class NVSCENECAPTURER_API UNVSceneCaptureComponent2D : public USceneCaptureCompo
     GENERATED_BODY()
 
     /// Callback function get called after the scene capture component finished capturing scene and read back its pixels data
-    /// FNVTexturePixelData - The struct contain the captured scene's pixels data
-    typedef TFunction<void(const FNVTexturePixelData&)> OnFinishedCaptureScenePixelsDataCallback;
+    /// FNVTexturePixelDataRef - Reference to the struct contain the captured scene's pixels data
+    typedef TFunction<void(const FNVTexturePixelDataRef&)> OnFinishedCaptureScenePixelsDataCallback;
 
 
 public:
@@ -57,6 +78,33 @@ public:
     /// This function is combination of CaptureSceneToTexture and ReadPixelsDataFromTexture
     void CaptureSceneToPixelsData(UNVSceneCaptureComponent2D::OnFinishedCaptureScenePixelsDataCallback Callback);
 
+    /// Also resolve another buffer of the rendered scene (e.g: its depth) to its own render target, from the same render as the TextureTarget
+    /// NOTE: The velocity output is always captured as 2 channels 32 bits floating point
+    /// @param OutputScale  Multiplier applied to the resolved values, e.g: to normalize the depth
+    /// @return The index of the output, to use with CaptureOutputToPixelsData
+    int32 AddCaptureOutput(ENVSceneCaptureOutput Output, ENVCapturedPixelFormat PixelFormat, float OutputScale = 1.f);
+    void SetCaptureOutputScale(int32 OutputIndex, float NewOutputScale);
+
+    /// Same as CaptureSceneToPixelsData but read back the pixels of an output added with AddCaptureOutput
+    /// NOTE: All the outputs captured in the same frame share the same scene render
+    void CaptureOutputToPixelsData(int32 OutputIndex, UNVSceneCaptureComponent2D::OnFinishedCaptureScenePixelsDataCallback Callback);
+    UTextureRenderTarget2D* GetCaptureOutputRenderTarget(int32 OutputIndex) const;
+    int32 GetCaptureOutputCount() const;
+
+    /// Let another object take over reading back the captured pixels, e.g: so a viewpoint can read back the pixels of all its components together
+    /// NOTE: If the handler is null, the component read back the pixels itself
+    void SetReadbackRequestHandler(FNVTextureReader::OnReadbackRequestedCallback NewHandler);
+    /// Read back all the captured pixels now and wait for their callbacks to be called
+    void FlushPendingReadbacks();
+
+    /// Lease the render target from a pool only while capturing instead of creating one for this component
+    /// NOTE: Must be set before the component begin play, the pool isn't used if a valid TextureTarget is specified
+    void SetRenderTargetPool(UNVRenderTargetPool* NewRenderTargetPool);
+    bool UsePooledTextureTarget() const
+    {
+        return bUsePooledTextureTarget;
+    }
+
     UFUNCTION(BlueprintCallable, Category = "Exporter")
     void StartCapturing();
     UFUNCTION(BlueprintCallable, Category = "Exporter")
@@ -74,9 +122,6 @@ protected:
     /// Command tell this scene capturer to capture the scene into its render target texture later in the rendering phase
     void CaptureSceneToTexture();
 
-    /// Read back the pixels data from the captured texture
-    /// NOTE: This function run synchronously (it flush rendering commands) which can cause hitches on the game thread
-    bool ReadPixelsDataFromTexture(FNVTexturePixelData& OutPixelsData);
     /// Async function to read back the pixels data from the captured texture
     /// NOTE: This function run asynchronously, the callback function should use the context data to decide what to do with the pixels data
     void ReadPixelsDataFromTexture(OnFinishedCaptureScenePixelsDataCallback Callback);
@@ -86,6 +131,20 @@ protected:
 
     void OnSceneCaptured();
     void InitTextureRenderTarget();
+    UTextureRenderTarget2D* CreateTextureRenderTarget(const FString& BaseName, ETextureRenderTargetFormat RenderTargetFormat,
+                                                      EPixelFormat OverridePixelFormat, float Gamma);
+
+    /// Read back the pixels of a render target reader, with the component's readback settings
+    void ReadPixelsData(FNVTextureRenderTargetReader& Reader, ENVCapturedPixelFormat PixelFormat,
+                        TArray<OnFinishedCaptureScenePixelsDataCallback>& CallbackList);
+    /// Let the view extension resolve the outputs which need to be read back while the scene is rendered
+    bool BeginResolveCaptureOutputs();
+    void ProcessPendingReadbacks();
+
+    /// Settings of the render target this component lease from the pool
+    FNVRenderTargetDesc GetTextureTargetDesc() const;
+    void AcquirePooledTextureTarget();
+    void ReleasePooledTextureTarget();
 
 public: // Editor properties
     /// The size (width x height in pixels) of the captured TextureTarget
@@ -101,10 +160,40 @@ public: // Editor properties
     UPROPERTY(EditAnywhere, Category = "SceneCapture")
     TEnumAsByte<EPixelFormat> OverrideTexturePixelFormat;
 
+    /// Gamma of the render target leased from the pool
+    /// NOTE: 0 means use the display gamma
+    UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "SceneCapture")
+    float TextureTargetGamma;
+
+    /// Layout of the read back pixels, the captured pixels are converted on the GPU before they are read back
+    /// NOTE: NVCapturedPixelFormat_MAX mean read back the pixels in the TextureTarget's format
+    UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "SceneCapture")
+    TEnumAsByte<ENVCapturedPixelFormat> ReadbackPixelFormat;
+
     /// If true, don't read back the raw alpha value from the render target but set it to 1
     UPROPERTY(EditAnywhere, Category = "SceneCapture")
     bool bIgnoreReadbackAlpha;
+
+    /// Number of textures used to read back the captured pixels, more textures let more captures wait for the GPU at the same time
+    UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "SceneCapture", meta = (ClampMin = "1", UIMin = "1", UIMax = "8"))
+    int32 ReadbackTextureCount;
+
+    /// Maximum number of frames to wait for the GPU to finish copying the captured pixels before reading them back
+    /// NOTE: 0 means read the pixels back right after copying them, it's slower but the pixels data is available sooner
+    UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "SceneCapture", meta = (ClampMin = "0", UIMin = "0", UIMax = "8"))
+    int32 ReadbackFrameLatency;
 protected: // Transient properties
     FNVTextureRenderTargetReader RenderTargetReader;
     TArray<UNVSceneCaptureComponent2D::OnFinishedCaptureScenePixelsDataCallback> ReadbackCallbackList;
+    FNVTextureReader::OnReadbackRequestedCallback ReadbackRequestHandler;
+
+    UPROPERTY(Transient)
+    TArray<FNVSceneCaptureOutputData> CaptureOutputs;
+    TSharedPtr<FNVSceneCaptureViewExtension, ESPMode::ThreadSafe> CaptureOutputsViewExtension;
+
+    UPROPERTY(Transient)
+    UNVRenderTargetPool* RenderTargetPool;
+    bool bUsePooledTextureTarget;
+    /// Settings of the render target reserved in the pool, updated when the component's settings change
+    FNVRenderTargetDesc ReservedTextureTargetDesc;
 };
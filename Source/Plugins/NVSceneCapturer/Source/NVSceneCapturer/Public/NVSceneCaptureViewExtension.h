@@ -0,0 +1,58 @@
+/*
+* Copyright (c) 2018 NVIDIA Corporation. All rights reserved.
+* This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0
+* International License.  (https://creativecommons.org/licenses/by-nc-sa/4.0/legalcode)
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SceneViewExtension.h"
+#include "NVSceneCapturerUtils.h"
+
+class FTextureRenderTargetResource;
+
+/// A buffer of the rendered scene to resolve and the render target to resolve it to
+struct NVSCENECAPTURER_API FNVSceneCaptureOutputTarget
+{
+public:
+    FNVSceneCaptureOutputTarget();
+
+public:
+    ENVSceneCaptureOutput Output;
+    FTextureRenderTargetResource* RenderTargetResource;
+    /// Multiplier applied to the resolved values
+    float OutputScale;
+};
+
+///
+/// FNVSceneCaptureViewExtension - resolve the buffers of the scene rendered by a scene capture component (depth, custom stencil, velocity)
+/// to their own render targets, so the scene only need to be rendered once for all of them
+/// NOTE: The buffers are resolved right after the base pass, the custom depth and the velocity must already be rendered by then
+/// (e.g: r.CustomDepth.Order=0 and r.BasePassOutputsVelocity=1) otherwise their outputs are empty
+///
+class NVSCENECAPTURER_API FNVSceneCaptureViewExtension : public FSceneViewExtensionBase
+{
+public:
+    FNVSceneCaptureViewExtension(const FAutoRegister& AutoRegister);
+
+    /// Resolve the outputs during the scene renders issued after this call and before EndResolveOutputs
+    /// NOTE: Must be called on the game thread, the outputs are passed to the render thread with a render command
+    void BeginResolveOutputs(const TArray<FNVSceneCaptureOutputTarget>& OutputTargets);
+    void EndResolveOutputs();
+
+    // ISceneViewExtension interface
+    virtual void SetupViewFamily(FSceneViewFamily& InViewFamily) override {}
+    virtual void SetupView(FSceneViewFamily& InViewFamily, FSceneView& InView) override {}
+    virtual void BeginRenderViewFamily(FSceneViewFamily& InViewFamily) override {}
+    virtual void PreRenderViewFamily_RenderThread(FRHICommandListImmediate& RHICmdList, FSceneViewFamily& InViewFamily) override {}
+    virtual void PreRenderView_RenderThread(FRHICommandListImmediate& RHICmdList, FSceneView& InView) override {}
+    virtual void PostRenderBasePass_RenderThread(FRHICommandListImmediate& RHICmdList, FSceneView& InView) override;
+
+protected:
+    static void ResolveOutput_RenderThread(FRHICommandListImmediate& RHICmdList, const FSceneView& View, const FNVSceneCaptureOutputTarget& OutputTarget);
+
+protected:
+    /// NOTE: Only accessed on the render thread
+    TArray<FNVSceneCaptureOutputTarget> ActiveOutputTargets_RenderThread;
+};
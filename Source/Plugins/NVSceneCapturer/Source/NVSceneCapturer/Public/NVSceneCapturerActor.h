@@ -12,6 +12,7 @@
 #include "NVSceneCapturerViewpointComponent.h"
 #include "NVImageExporter.h"
 #include "NVSceneDataHandler.h"
+#include "NVRenderTargetPool.h"
 #include "NVSceneCapturerActor.generated.h"
 
 USTRUCT(BlueprintType)
@@ -184,6 +185,10 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Capturer")
     TArray<UNVSceneCapturerViewpointComponent*> GetViewpointList();
 
+    /// Number of captured frames which data are still being read back or gathered
+    UFUNCTION(BlueprintCallable, Category = "Capturer")
+    int32 GetInFlightFrameCount() const;
+
     /// Control what to do with the captured scene data
 	UFUNCTION(BlueprintCallable, Category = "Capturer")
 	UNVSceneDataHandler* GetSceneDataHandler() const;
@@ -191,6 +196,9 @@ public:
     /// Control what to do with the captured scene data
 	UNVSceneDataVisualizer* GetSceneDataVisualizer() const;
 
+    /// Pool of the render targets shared by the feature extractors of all the viewpoints, null if bPoolRenderTargets is false
+    UNVRenderTargetPool* GetRenderTargetPool() const;
+
     static TArray<FNVNamedImageSizePreset> const& GetImageSizePresets();
 
     /// Event properties
@@ -278,6 +286,9 @@ protected:
     void UpdateViewpointList();
     void StartCapturing_Internal();
 	void CaptureSceneToPixelsData();//int frame_index = 0);
+    /// Remove the in-flight frames which captured data were all handled
+    void RetireCapturedFrames();
+    bool CanCaptureMoreFrames() const;
     void CheckCaptureScene();
     void UpdateCapturerSettings();
     void OnCompleted();
@@ -329,6 +340,24 @@ protected: // Editor properties
     UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Capture")
     bool bPauseGameLogicWhenFlushing;
 
+    /// Maximum number of captured frames which data can be read back and gathered at the same time,
+    /// the scene keeps being simulated and randomized while the frames are in flight
+    /// When the pipeline is full, the capturer wait for the oldest frame instead of capturing the current one, without pausing the game
+    /// NOTE: Each frame in flight keeps its pixels data and annotation data alive, 0 means no limit
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, AdvancedDisplay, Category = "Capture", meta = (ClampMin = "0", UIMin = "0", UIMax = "8"))
+    int32 MaxInFlightFrames;
+
+    /// If true, the feature extractors of all the viewpoints share their render targets: each scene capture only lease
+    /// a render target from a pool while its capture is issued, so the captures with the same settings take turns using one render target
+    /// NOTE: The pooled captures are read back on their own instead of in their viewpoint's batch
+    /// NOTE: The scene data visualizer can't show the feature extractors which use the pooled render targets
+    UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "Capture")
+    bool bPoolRenderTargets;
+
+    /// Number of frames a pooled render target which isn't needed anymore (e.g: after the captured image size changed) is kept before being released
+    UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "Capture", meta = (EditCondition = "bPoolRenderTargets", ClampMin = "0", UIMin = "0"))
+    int32 MaxIdleFramesOfPooledRenderTarget;
+
     /// List of available image size presets
     UPROPERTY(config)
     TArray<FNVNamedImageSizePreset> ImageSizePresets;
@@ -372,4 +401,10 @@ protected: // Transient properties
 
 	UPROPERTY(Transient)
 	TArray<UNVSceneCapturerViewpointComponent*> ViewpointList;
+
+    UPROPERTY(Transient)
+    UNVRenderTargetPool* RenderTargetPool;
+
+    /// The captured frames which data are still referenced by the pending callbacks, oldest first
+    TArray<FNVCapturedFrameInfoPtr> InFlightFrames;
 };
\ No newline at end of file
@@ -37,9 +37,14 @@ enum class ENVImageFormat : uint8
     /// Windows Bitmap.
     BMP               UMETA(DisplayName = "BMP (Windows Bitmap"),
 
-    // OpenEXR (HDR) image file format
-    // TODO: Support HDR format
-    // EXR UMETA(DisplayName = "EXR (OpenEXR (HDR) image"),
+    /// PNG with 16 bits per channel, the 8 bits channels are widened and the floating point channels are clamped to [0, 1]
+    PNG16             UMETA(DisplayName = "PNG16 (16 bits per channel PNG)"),
+
+    /// OpenEXR (HDR) image, half or float channels, see FNVImageCompressionSettings
+    EXR               UMETA(DisplayName = "EXR (OpenEXR (HDR) image)"),
+
+    /// Uncompressed numpy array (.npy), the pixels are stored as is with their shape and type in the header
+    NPY               UMETA(DisplayName = "NPY (Numpy array)"),
 
     /// @cond DOXYGEN_SUPPRESSED_CODE
     NVImageFormat_MAX UMETA(Hidden)
@@ -48,6 +53,90 @@ enum class ENVImageFormat : uint8
 EImageFormat ConvertExportFormatToImageFormat(ENVImageFormat ExportFormat);
 FString GetExportImageExtension(ENVImageFormat ExportFormat);
 
+/// Filter applied to each row of a PNG image before it's compressed
+UENUM(BlueprintType)
+enum class ENVPngFilterType : uint8
+{
+    None              UMETA(DisplayName = "None"),
+    Sub               UMETA(DisplayName = "Sub"),
+    Up                UMETA(DisplayName = "Up"),
+    Average           UMETA(DisplayName = "Average"),
+    Paeth             UMETA(DisplayName = "Paeth"),
+
+    /// Pick the filter with the smallest result for each row, same as libpng's default
+    Adaptive          UMETA(DisplayName = "Adaptive"),
+
+    /// @cond DOXYGEN_SUPPRESSED_CODE
+    NVPngFilterType_MAX UMETA(Hidden)
+    /// @endcond DOXYGEN_SUPPRESSED_CODE
+};
+
+/// Compression of the EXR images
+UENUM(BlueprintType)
+enum class ENVExrCompression : uint8
+{
+    None              UMETA(DisplayName = "None"),
+    /// zlib compression of each scanline
+    ZIPS              UMETA(DisplayName = "ZIPS (zlib, 1 scanline)"),
+    /// zlib compression of blocks of 16 scanlines, usually smaller than ZIPS
+    ZIP               UMETA(DisplayName = "ZIP (zlib, 16 scanlines)"),
+
+    /// @cond DOXYGEN_SUPPRESSED_CODE
+    NVExrCompression_MAX UMETA(Hidden)
+    /// @endcond DOXYGEN_SUPPRESSED_CODE
+};
+
+/// Type of the channels of the EXR images
+UENUM(BlueprintType)
+enum class ENVExrPixelType : uint8
+{
+    /// Half for the 8 bits and half float pixels, float for the others so the values are kept as is
+    Auto              UMETA(DisplayName = "Auto"),
+    Half              UMETA(DisplayName = "Half (16 bits floating point)"),
+    Float             UMETA(DisplayName = "Float (32 bits floating point)"),
+
+    /// @cond DOXYGEN_SUPPRESSED_CODE
+    NVExrPixelType_MAX UMETA(Hidden)
+    /// @endcond DOXYGEN_SUPPRESSED_CODE
+};
+
+/// Settings used to compress the exported images
+USTRUCT(BlueprintType)
+struct NVSCENECAPTURER_API FNVImageCompressionSettings
+{
+    GENERATED_BODY()
+
+public:
+    FNVImageCompressionSettings();
+
+public:
+    /// zlib compression level of the PNG images: 0 - no compression, 1 - fastest, 9 - smallest file
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compression", meta = (ClampMin = "0", ClampMax = "9", UIMin = "0", UIMax = "9"))
+    int32 PngCompressionLevel;
+
+    /// Filter applied to the rows of the PNG images, some filters work better for some kinds of image (e.g: None for segmentation masks)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compression")
+    ENVPngFilterType PngFilterType;
+
+    /// Quality of the JPEG images: 1 - smallest file, 100 - best quality
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compression", meta = (ClampMin = "1", ClampMax = "100", UIMin = "1", UIMax = "100"))
+    int32 JpegQuality;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compression")
+    ENVExrCompression ExrCompression;
+
+    /// zlib compression level of the ZIP and ZIPS compressed EXR images: 0 - no compression, 1 - fastest, 9 - smallest file
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compression", meta = (ClampMin = "0", ClampMax = "9", UIMin = "0", UIMax = "9"))
+    int32 ExrCompressionLevel;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compression")
+    ENVExrPixelType ExrPixelType;
+
+    /// Whether the encoders can split a single image into parallel tasks (PNG stripes, EXR blocks)
+    /// NOTE: Not exposed, the image exporter's workers turn it off since the pool already compress an image per worker
+    bool bAllowParallelEncoding;
+};
+
 /// The pixel format which can be captured
 UENUM()
 enum ENVCapturedPixelFormat
@@ -68,12 +157,68 @@ enum ENVCapturedPixelFormat
 	/// NOTE: This format capture to 32 bits floating point value and can be exported to RGBA8 format
 	R32f,
 
+	/// R channel captured as 32 bit floating point integer id, packed into 24 bit RGB (8 bit per channel) on the GPU before it's read back
+	/// R = bits 16-23 of the id, G = bits 8-15, B = bits 0-7, A = 255
+	/// Use this format for the masks which store an id per pixel
+	PackedId24,
+
+	/// R channel captured as 32 bit floating point depth (cm), encoded to 16 bit unsigned integer on the GPU before it's read back
+	/// See ENVDepthEncoding for how the depth is encoded
+	DepthMillimeters16,
+	DepthLog16,
+	DepthHalf16,
+
 	/// @cond DOXYGEN_SUPPRESSED_CODE
 	NVCapturedPixelFormat_MAX UMETA(Hidden)
 	/// @endcond DOXYGEN_SUPPRESSED_CODE
 };
 ETextureRenderTargetFormat ConvertCapturedFormatToRenderTargetFormat(ENVCapturedPixelFormat PixelFormat);
 
+/// How the scene depth is stored in the exported images
+UENUM(BlueprintType)
+enum class ENVDepthEncoding : uint8
+{
+    /// Depth normalized by the max depth distance, 8 bit. Lose most of the precision
+    Normalized8          UMETA(DisplayName = "Normalized 8 bits"),
+
+    /// Depth in millimetres, 16 bit unsigned integer. Range [0, 65.535] meters, further pixels are clamped to 65535
+    Millimeters16        UMETA(DisplayName = "Millimeters 16 bits"),
+
+    /// Logarithmic depth, 16 bit unsigned integer: Depth (cm) = 2 ^ (Value * 24 / 65535)
+    /// Range [1cm, 167km], the precision is relative to the depth (~0.025%)
+    LogDepth16           UMETA(DisplayName = "Log depth 16 bits"),
+
+    /// Depth in meters as 16 bit floating point value, the half float bits are stored as is in a 16 bit unsigned integer
+    /// Range [0, 65504] meters, the precision is relative to the depth (~0.05%)
+    Half16               UMETA(DisplayName = "Half float 16 bits"),
+
+    /// Raw depth in cm as 32 bit floating point value
+    Float32              UMETA(DisplayName = "Float 32 bits"),
+
+    /// @cond DOXYGEN_SUPPRESSED_CODE
+    NVDepthEncoding_MAX UMETA(Hidden)
+    /// @endcond DOXYGEN_SUPPRESSED_CODE
+};
+ENVCapturedPixelFormat ConvertDepthEncodingToCapturedFormat(ENVDepthEncoding DepthEncoding);
+
+/// The buffers of the rendered scene a scene capture component can resolve besides its captured image
+UENUM()
+enum class ENVSceneCaptureOutput : uint8
+{
+    /// Depth of the scene in world units (cm)
+    SceneDepth,
+
+    /// Value (0 - 255) written in the custom stencil buffer by the meshes which render custom depth
+    CustomStencil,
+
+    /// Screen space velocity of the pixels, 2 channels
+    Velocity,
+
+    /// @cond DOXYGEN_SUPPRESSED_CODE
+    NVSceneCaptureOutput_MAX UMETA(Hidden)
+    /// @endcond DOXYGEN_SUPPRESSED_CODE
+};
+
 USTRUCT()
 struct FNVTexturePixelData
 {
@@ -90,6 +235,38 @@ public:
     FIntPoint PixelSize;
 };
 
+/// Thread-safe, ref-counted reference to a pixel data taken from FNVTexturePixelDataPool
+/// NOTE: Pass this around instead of copying the pixel data, the buffer is given back to the pool when the last reference is released
+typedef TSharedPtr<FNVTexturePixelData, ESPMode::ThreadSafe> FNVTexturePixelDataRef;
+
+///
+/// FNVTexturePixelDataPool - keep the pixel buffers of the finished captures so the next captures can reuse their memory
+///
+struct NVSCENECAPTURER_API FNVTexturePixelDataPool
+{
+public:
+    static FNVTexturePixelDataPool& Get();
+
+    /// Get a pixel data from the pool, its buffer is resized (uninitialized) to BufferSize bytes
+    FNVTexturePixelDataRef Acquire(uint32 BufferSize);
+
+    /// Free all the pixel buffers kept in the pool
+    void Empty();
+
+protected:
+    FNVTexturePixelDataPool();
+    ~FNVTexturePixelDataPool();
+
+    void Release(FNVTexturePixelData* PixelData);
+
+protected:
+    FCriticalSection PoolCriticalSection;
+    TArray<FNVTexturePixelData*> FreePixelDataList;
+
+    /// Maximum number of free pixel buffers to keep, the rest will be deleted when they are released
+    static const int32 MaxFreePixelDataCount;
+};
+
 /// Data to be captured and exported for each socket
 USTRUCT()
 struct NVSCENECAPTURER_API FNVSocketData
@@ -141,6 +318,8 @@ public:
 
     void BuildFromAABB(const FBox& AABB);
     void BuildFromOOBB(const FBox& OOBB, const FTransform& LocalTransform);
+    /// Build the cuboid from a box which is rotated in the local space before the local transform is applied, e.g: a FNVOrientedBounds
+    void BuildFromOOBB(const FBox& OOBB, const FQuat& BoxRotation, const FTransform& LocalTransform);
 
     FVector GetCenter() const
     {
@@ -183,6 +362,28 @@ private:
     FQuat Rotation;
 };
 
+/// Oriented bounding box of a set of points, see NVSceneCapturerUtils::CalculateOrientedBounds
+struct NVSCENECAPTURER_API FNVOrientedBounds
+{
+public:
+    FNVOrientedBounds();
+
+    bool IsValid() const
+    {
+        return (Box.IsValid != 0);
+    }
+
+public:
+    /// The bounding box of the points in the box's space
+    FBox Box;
+    /// Rotation from the box's space to the points' space
+    FQuat Rotation;
+    /// The mean of the points, in the points' space
+    FVector MeanPoint;
+    /// Direction of the points' largest variance, in the points' space. Its sign is picked so it never point below the XY plane (Z >= 0)
+    FVector PrincipalAxis;
+};
+
 USTRUCT()
 struct NVSCENECAPTURER_API FNVBox2D
 {
@@ -202,6 +403,69 @@ public:
     FVector2D bottom_right;
 };
 
+/// Run-length encoding of an object's pixels in the instance segmentation mask, same layout as the COCO uncompressed RLE
+/// NOTE: The pixels are visited column by column (Fortran order) and the first count is always the number of background pixels
+USTRUCT()
+struct NVSCENECAPTURER_API FNVInstanceMaskRLE
+{
+    GENERATED_BODY()
+
+public:
+    /// [height, width] of the mask, empty if the encoding isn't exported
+    UPROPERTY()
+    TArray<uint32> size;
+
+    /// Length of the alternating runs of background and object pixels
+    UPROPERTY()
+    TArray<uint32> counts;
+};
+
+/// Outer contour of a connected part of an object's pixels in the instance segmentation mask
+USTRUCT()
+struct NVSCENECAPTURER_API FNVPolygon2D
+{
+    GENERATED_BODY()
+
+public:
+    /// Center of the contour pixels, in the same image space as the other 2d coordinates
+    UPROPERTY()
+    TArray<FVector2D> points;
+};
+
+/// The image borders an object's visible pixels touch, the object is likely cut by them
+/// NOTE: Only measured from the instance segmentation mask, see FNVDataExportSettings::bComputeVisibilityFromInstanceMask
+namespace ENVTruncationFlags
+{
+    enum Type : uint32
+    {
+        None = 0,
+        Left = 1 << 0,
+        Top = 1 << 1,
+        Right = 1 << 2,
+        Bottom = 1 << 3,
+    };
+}
+
+/// The fields of FCapturedObjectData which are only exported when the frame's data calculated them, see FCapturedSceneData::OptionalObjectFields
+/// NOTE: The fields which aren't set are left out of the exported json instead of being written with their default value
+namespace ENVOptionalObjectFields
+{
+    enum Type : uint32
+    {
+        None = 0,
+        /// visible_pixel_count and projected_pixel_count, only when the visibility is measured from the instance mask
+        /// (see FNVDataExportSettings::bComputeVisibilityFromInstanceMask)
+        PixelCounts = 1 << 0,
+        /// truncation_flags
+        TruncationFlags = 1 << 1,
+        /// segmentation_rle
+        SegmentationRLE = 1 << 2,
+        /// segmentation_polygons
+        SegmentationPolygons = 1 << 3,
+    };
+}
+
+/// NOTE: FNVJsonWriter::WriteCapturedObjectData write these properties in the same order, update it when the properties change
 USTRUCT()
 struct NVSCENECAPTURER_API FCapturedObjectData
 {
@@ -238,6 +502,20 @@ public:    // Properties
     UPROPERTY()
     float visibility;
 
+    /// Number of the object's pixels in the instance segmentation mask
+    /// NOTE: The pixel counts and the truncation flags are only measured and exported when the annotation data is completed from the mask,
+    /// see ENVOptionalObjectFields
+    UPROPERTY()
+    uint32 visible_pixel_count;
+
+    /// Number of pixels the object would cover in the image if nothing occluded it, estimated from its projected collision hulls
+    UPROPERTY()
+    uint32 projected_pixel_count;
+
+    /// The image borders the object's visible pixels touch, combination of ENVTruncationFlags
+    UPROPERTY()
+    uint32 truncation_flags;
+
     UPROPERTY(Transient)
     FVector dimensions_worldspace;
 
@@ -298,6 +576,14 @@ public:    // Properties
     UPROPERTY()
     FNVBox2D bounding_box;
 
+    /// The object's visible pixels, only exported when FNVDataExportSettings::bExportInstanceMaskRLE is set
+    UPROPERTY()
+    FNVInstanceMaskRLE segmentation_rle;
+
+    /// Outer contours of the object's visible pixels, only exported when FNVDataExportSettings::bExportInstanceMaskPolygons is set
+    UPROPERTY()
+    TArray<FNVPolygon2D> segmentation_polygons;
+
     // TODO: Create a struct for the cuboid since it must have exactly 8 corner vertexes
     UPROPERTY()
     TArray<FVector> cuboid;
@@ -344,14 +630,71 @@ struct NVSCENECAPTURER_API FCapturedSceneData
 {
     GENERATED_BODY()
 
+public:
+    FCapturedSceneData();
+
 public: // Editor properties
     UPROPERTY()
     FCapturedViewpointData camera_data;
 
     UPROPERTY()
     TArray<FCapturedObjectData> Objects;
+
+    /// The optional fields the objects have in this frame, combination of ENVOptionalObjectFields
+    /// NOTE: It's not a property so it's never exported itself, it only decide which of the objects' fields are
+    uint32 OptionalObjectFields;
+};
+
+/// How the annotation data is encoded when it's exported
+UENUM(BlueprintType)
+enum class ENVAnnotationDataFormat : uint8
+{
+    /// Pretty printed json text, exported to ".json" files
+    Json          UMETA(DisplayName = "JSON"),
+
+    /// Compact binary records, exported to ".nvab" files, see NVAnnotationBinaryFormat.h
+    Binary        UMETA(DisplayName = "Binary"),
+};
+
+/// The annotation data of a captured frame, already encoded and ready to be exported
+struct NVSCENECAPTURER_API FNVSceneAnnotationData
+{
+public:
+    FNVSceneAnnotationData() : DataFormat(ENVAnnotationDataFormat::Json), ObjectCount(0) {}
+
+    ENVAnnotationDataFormat DataFormat;
+    /// The encoded data, e.g: UTF-8 json text
+    TArray<uint8> SerializedData;
+    /// Extension of the file the data should be exported to, e.g: ".json"
+    FString FileExtension;
+    /// Number of annotated objects in the data
+    uint32 ObjectCount;
 };
 
+/// The state of the scene when a frame was captured
+/// NOTE: The captured data callbacks of the frame keep a reference to it until they are handled, see ANVSceneCapturerActor::MaxInFlightFrames
+struct NVSCENECAPTURER_API FNVCapturedFrameInfo
+{
+public:
+    FNVCapturedFrameInfo();
+
+public:
+    /// Index of the frame in the capturer's frame counter
+    int32 FrameId;
+    /// Indexes used to name the exported files
+    int32 FrameIndexForFile;
+    int32 PicksetIndex;
+    int32 PicksetSubImage;
+    /// Engine frame number (GFrameCounter) when the frame was captured
+    uint64 EngineFrameNumber;
+    /// World time when the frame was captured
+    float CaptureTimestamp;
+    /// The randomized capturer settings used to capture the frame
+    float FOVAngle;
+    FNVImageSize CapturedImageSize;
+};
+typedef TSharedPtr<const FNVCapturedFrameInfo, ESPMode::ThreadSafe> FNVCapturedFrameInfoPtr;
+
 USTRUCT()
 struct NVSCENECAPTURER_API FCapturedFrameData
 {
@@ -407,7 +750,7 @@ enum class ENVBoundsGenerationType : uint8
     VE_AABB         UMETA(DisplayName = "AABB"),
     /// Object Space AABB, scaled, rotated and translated
     VE_OOBB         UMETA(DisplayName = "OOBB"),
-    /// Arbitrary tight fitting bounds generated from mesh vertices.
+    /// Arbitrary tight fitting bounds generated from the mesh's convex collision vertexes, or its LOD0 vertexes if it doesn't have any
     /// REMOVE: May not support this
     VE_TightOOBB    UMETA(DisplayName = "Tight Arbitrary OOBB")
 };
@@ -420,6 +763,10 @@ enum class ENVBoundBox2dGenerationType : uint8
 
     /// Generate the 2d bounding box from the mesh's body collision
     FromMeshBodyCollision,
+
+    /// Generate the 2d bounding box from the object's visible pixels in the instance segmentation mask
+    /// NOTE: The viewpoint must capture the mask (VertexColorMask feature extractor), otherwise the body collision is used
+    FromInstanceMask,
 };
 
 USTRUCT(BlueprintType)
@@ -577,7 +924,8 @@ namespace NVSceneCapturerUtils
     NVSCENECAPTURER_API FString GetDefaultDataOutputFolder();
     NVSCENECAPTURER_API FString GetOutputFileFullPath(uint32 Index, FString Extension, const FString& Subfolder, FString Filename = TEXT(""), uint8 ZeroPad = 6);
 
-    NVSCENECAPTURER_API TSharedPtr<FJsonValue> CustomPropertyToJsonValueFunc(UProperty* PropertyType, const void* Value);
+    /// Round the value to 4 decimal places, it's used for all the float values we export
+    NVSCENECAPTURER_API float ConvertFloatWithPrecision4(const float InValue);
 
     /// Convert a property to json value use our own shorthand format, e.g: for Vector3: [x, y, z] instead of {"x": x, "y": y, "z": z}
     NVSCENECAPTURER_API TSharedPtr<FJsonValue> CustomPropertyToJsonValueFunc(UProperty* PropertyType, const void* Value);
@@ -594,13 +942,18 @@ namespace NVSceneCapturerUtils
         return JsonObj;
     }
 
+    /// Convert the captured scene data to a json object: its properties, the objects' custom data and only the optional fields the frame have
+    /// NOTE: FNVJsonWriter::SerializeCapturedSceneData write the same json straight to text
+    NVSCENECAPTURER_API TSharedPtr<FJsonObject> CapturedSceneDataToJsonObject(const FCapturedSceneData& SceneData);
+
     NVSCENECAPTURER_API bool SaveJsonObjectToFile(const TSharedPtr<FJsonObject>& JsonObjData, const FString& Filename);
 
     NVSCENECAPTURER_API FString GetExportImageExtension(EImageFormat ImageFormat);
 
     NVSCENECAPTURER_API UMeshComponent* GetFirstValidMeshComponent(const AActor* CheckActor);
-    /// Get the list of vertexes from the mesh's simple collision
-    NVSCENECAPTURER_API TArray<FVector> GetSimpleCollisionVertexes(const class UMeshComponent* MeshComp);
+    /// Get the list of vertexes from the mesh's simple collision, fallback to the mesh's LOD0 vertexes if it doesn't have collision
+    /// @param bInWorldSpace if true, the vertexes are in world space, otherwise they're in the mesh's local space
+    NVSCENECAPTURER_API TArray<FVector> GetSimpleCollisionVertexes(const class UMeshComponent* MeshComp, bool bInWorldSpace = true);
 
     /// Get the number of bit in each pixel
     NVSCENECAPTURER_API uint8 GetBitCountPerChannel(EPixelFormat PixelFormat);
@@ -612,6 +965,8 @@ namespace NVSceneCapturerUtils
     NVSCENECAPTURER_API FColor ConvertInt32ToRGB(uint32 Value);
 	NVSCENECAPTURER_API FColor ConvertInt32ToRGBA(uint32 Value);
 	NVSCENECAPTURER_API FColor ConvertInt32ToVertexColor(uint32 Value);
+    /// Get back the id encoded in a vertex color by ConvertInt32ToVertexColor, e.g: from a pixel of the instance segmentation mask
+    NVSCENECAPTURER_API uint32 ConvertVertexColorToInt32(const FColor& VertexColor);
 
     /// Set the vertexes of the meshes in an actor to use the same color
     NVSCENECAPTURER_API void SetMeshVertexColor(AActor* MeshOwnerActor, const FColor& VertexColor);
@@ -623,19 +978,51 @@ namespace NVSceneCapturerUtils
     NVSCENECAPTURER_API void CalculateSphericalCoordinate(const FVector& TargetLocation, const FVector& SourceLocation, const FVector& ForwardDirection,
             float& OutTargetAzimuthAngle, float& OutTargetAltitudeAngle);
 
+    /// Calculate the area of the convex hull of a set of 2d points after clipping it to a rectangle, e.g: the image
+    NVSCENECAPTURER_API float CalculateClippedConvexHullArea(const TArray<FVector2D>& Points, const FBox2D& ClipRect);
+
+    //================ Binary masks ================
+    /// Encode a binary mask with the COCO run-length encoding of the whole image
+    /// @param Mask         One byte per pixel, row by row, non zero for the pixels in the mask
+    /// @param MaskRect     Where the mask is in the image, the pixels outside of it are background
+    /// @param ImageSize    Size of the image the counts cover
+    NVSCENECAPTURER_API void EncodeMaskRLE(const TArray<uint8>& Mask, const FIntRect& MaskRect, const FIntPoint& ImageSize, TArray<uint32>& OutCounts);
+    /// Trace the outer contour of each 8-connected part of a binary mask, the holes are not traced
+    /// @param Mask     One byte per pixel, row by row, non zero for the pixels in the mask
+    /// @return The contours go clockwise through the border pixels, in the mask's coordinates
+    NVSCENECAPTURER_API void TraceMaskContours(const TArray<uint8>& Mask, const FIntPoint& MaskSize, TArray<TArray<FIntPoint>>& OutContours);
+    /// Remove the points of a closed polygon which are closer than Tolerance to the simplified outline (Douglas-Peucker)
+    NVSCENECAPTURER_API void SimplifyClosedPolygon(TArray<FVector2D>& InOutPoints, float Tolerance);
+
     //================ Calculate 3D bounding box ================
     /// Get the mesh's bound cuboid using axis-aligned bounding box
     NVSCENECAPTURER_API FNVCuboidData GetMeshCuboid_AABB(const class UMeshComponent* MeshComp);
 
+    /// Get the bounding box of the mesh in its component's local space
+    /// @param bCheckMeshCollision If true, the function check the mesh's collision vertices when finding the bounding box instead of just checking all of its vertices
+    NVSCENECAPTURER_API FBox GetMeshLocalBounds(const class UMeshComponent* MeshComp, bool bCheckMeshCollision = true);
+
     /// Get the mesh's bound cuboid using object-oriented bounding box
     /// NOTE: This 'simple' approach calculate the mesh's AABB in its local space then transform it using the component's local-to-world transform
     /// @param bInWorldSpace if true, the result is location in world space, otherwise it's in the mesh's local space
     /// @param bCheckMeshCollision If true, the function check the mesh's collision vertices when finding the bounding box instead of just checking all of its vertices
     NVSCENECAPTURER_API FNVCuboidData GetMeshCuboid_OOBB_Simple(const class UMeshComponent* MeshComp, bool bInWorldSpace = true, bool bCheckMeshCollision = true);
 
-    /// Get the mesh's bound cuboid using object-oriented bounding box
-    /// NOTE: This 'complex' approach calculate the OOBB base on 'Principal Component Analysis':
+    /// Calculate a tight oriented bounding box of a set of points base on 'Principal Component Analysis':
     /// http://www.inf.fu-berlin.de/users/rote/Papers/pdf/On+the+bounding+boxes+obtained+by+principal+component+analysis.pdf
+    /// NOTE: The box's axes are matched with the closest axes of the points' space so its front face stay on the same side when it can
+    /// @param bMinimizeVolume If true, the box is rotated around each principal axis to the smallest rectangle of the points' convex hull projected on the other 2 axes
+    NVSCENECAPTURER_API FNVOrientedBounds CalculateOrientedBounds(const TArray<FVector>& Points, bool bMinimizeVolume = true);
+
+    /// Find the vertexes of the points' convex hull using the quickhull algorithm
+    /// @param MaxVertexCount The hull stop growing after this number of vertexes, 0 means no limit
+    /// NOTE: The farthest points are added to the hull first so the ones left out by MaxVertexCount are the closest to its faces
+    /// If the points are all on a plane or a line, they are all kept
+    NVSCENECAPTURER_API void ComputeConvexHullVertexes(const TArray<FVector>& Points, int32 MaxVertexCount, TArray<FVector>& OutHullVertexes);
+
+    /// Get the mesh's bound cuboid using object-oriented bounding box
+    /// NOTE: This 'complex' approach use the tight oriented bounds of the mesh (see CalculateOrientedBounds), they are
+    /// calculated once per static mesh and cached by FNVMeshOrientedBoundsCache. The skeletal meshes fall back to the 'simple' approach
     NVSCENECAPTURER_API FNVCuboidData GetMeshCuboid_OOBB_Complex(const class UMeshComponent* MeshComp);
 
     NVSCENECAPTURER_API FNVCuboidData GetActorCuboid_AABB(const AActor* CheckActor);
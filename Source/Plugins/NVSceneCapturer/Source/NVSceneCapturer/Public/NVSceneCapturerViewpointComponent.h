@@ -50,6 +50,18 @@ public: // Editor properties
 
     UPROPERTY(EditAnywhere, Category = Settings, meta = (editcondition="bOverrideCaptureSettings"))
     FNVSceneCapturerSettings CaptureSettings;
+
+    /// If true, the pixels captured by all the feature extractors of the viewpoint are read back together:
+    /// the captured textures with the same pixel format are stacked in 1 readback texture so each frame only need 1 GPU sync per pixel format
+    /// instead of 1 per feature extractor
+    UPROPERTY(EditAnywhere, AdvancedDisplay, Category = Settings)
+    bool bBatchPixelsDataReadback;
+
+    /// If true, the feature extractors which capture a buffer of the scene (depth, stencil, velocity) resolve it from the scene rendered by
+    /// another feature extractor of the viewpoint instead of rendering the scene again, so the scene is only rendered once per viewpoint
+    /// NOTE: The buffers are resolved on the GPU instead of by the feature extractors' post process materials
+    UPROPERTY(EditAnywhere, AdvancedDisplay, Category = Settings)
+    bool bShareSceneCapture;
 };
 
 
@@ -69,18 +81,18 @@ public:
     UNVSceneCapturerViewpointComponent(const FObjectInitializer& ObjectInitializer);
 
     /// Callback function get called after the scene capture component finished capturing scene and read back its pixels data
-    /// FNVTexturePixelData - The struct contain the captured scene's pixels data
+    /// FNVTexturePixelDataRef - Reference to the struct contain the captured scene's pixels data
     /// UNVSceneFeatureExtractor_PixelData* - Reference to the feature extractor that captured the scene pixels data
     /// UNVSceneCapturerViewpointComponent* - Reference to the viewpoint that captured the scene pixels data
-    typedef TFunction<void(const FNVTexturePixelData&, UNVSceneFeatureExtractor_PixelData*, UNVSceneCapturerViewpointComponent*)> OnFinishedCaptureScenePixelsDataCallback;
+    typedef TFunction<void(const FNVTexturePixelDataRef&, UNVSceneFeatureExtractor_PixelData*, UNVSceneCapturerViewpointComponent*)> OnFinishedCaptureScenePixelsDataCallback;
 
     bool CaptureSceneToPixelsData(UNVSceneCapturerViewpointComponent::OnFinishedCaptureScenePixelsDataCallback Callback);
 
     /// Callback function get called after the scene capture component finished capturing scene's annotation data
-    /// TSharedPtr<FJsonObject> - The JSON object contain the annotation data
+    /// FNVSceneAnnotationData - The serialized annotation data, it's only valid during the callback
     /// UNVSceneFeatureExtractor_AnnotationData* - Reference to the feature extractor that captured the scene annotation data
     /// UNVSceneCapturerViewpointComponent* - Reference to the viewpoint that captured the scene pixels data
-    typedef TFunction<void(TSharedPtr<FJsonObject>, UNVSceneFeatureExtractor_AnnotationData*, UNVSceneCapturerViewpointComponent*)> OnFinishedCaptureSceneAnnotationDataCallback;
+    typedef TFunction<void(const FNVSceneAnnotationData&, UNVSceneFeatureExtractor_AnnotationData*, UNVSceneCapturerViewpointComponent*)> OnFinishedCaptureSceneAnnotationDataCallback;
 
     bool CaptureSceneAnnotationData(UNVSceneCapturerViewpointComponent::OnFinishedCaptureSceneAnnotationDataCallback Callback);
 
@@ -89,6 +101,8 @@ public:
     const FNVSceneCapturerViewpointSettings& GetSettings() const;
     const FNVSceneCapturerSettings& GetCapturerSettings() const;
     const TArray<FNVFeatureExtractorSettings>& GetFeatureExtractorSettings() const;
+    /// Get the enabled feature extractor which capture the instance segmentation mask (vertex color mask), null if there's none
+    class UNVSceneFeatureExtractor_PixelData* GetInstanceMaskFeatureExtractor() const;
 
     bool IsEnabled() const;
     FString GetDisplayName() const;
@@ -106,6 +120,13 @@ protected:
     virtual void OnRegister() final;
     virtual void OnComponentDestroyed(bool bDestroyingHierarchy) final;
     virtual void OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport) final;
+    virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) final;
+
+    /// Collect the readback requested by a scene capture component, the batch is read back when all the components captured
+    void OnBatchReadbackRequested(FNVTextureReadbackRequest& ReadbackRequest);
+    void SubmitBatchReadback();
+    /// Read back all the pixels captured by the feature extractors and wait for their callbacks to be called
+    void FlushPendingReadbacks();
 
 public: // Editor properties
     UPROPERTY(EditAnywhere, Category = Config, meta = (ShowOnlyInnerProperties))
@@ -118,6 +139,14 @@ protected: // Transient properties
     UPROPERTY(Transient)
     class ANVSceneCapturerActor* OwnerSceneCapturer;
 
+    /// Reader used to read back the pixels of all the feature extractors together, see bBatchPixelsDataReadback
+    FNVTextureReader BatchPixelsReader;
+    TArray<FNVTextureReadbackRequest> BatchReadbackRequests;
+    /// Number of scene capture components which are going to request a readback for the current batch
+    int32 ExpectedBatchReadbackCount;
+    /// The frame when the last readback was added to the current batch
+    uint64 BatchReadbackFrameNumber;
+
 #if WITH_EDITORONLY_DATA
 protected: // Proxy editor mesh
     /// The frustum component used to show visually where the camera field of view is
@@ -8,6 +8,8 @@
 
 #include "NVSceneCapturerUtils.h"
 #include "NVImageExporter.h"
+#include "NVDatasetShardWriter.h"
+#include "NVDatasetIndex.h"
 #include "NVSceneDataHandler.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogNVSceneDataHandler, Log, All)
@@ -30,24 +32,24 @@ public:
     virtual bool IsHandlingData() const PURE_VIRTUAL(UNVSceneDataHandler::IsHandlingData, return false; );
 
     /// Handle the pixels data captured from the scene
-    /// @param CapturedPixelData - The scene's pixels data
+    /// @param CapturedPixelData - Reference to the scene's pixels data, keep the reference instead of copying the data if it's needed later
     /// @param CapturedFeatureExtractor - The feature extractor which captured the data
     /// @param CapturedViewpoint - The viewpoint which captured the data
-    /// @param FrameIndex - The frame when the data is captured
-    virtual bool HandleScenePixelsData(const FNVTexturePixelData& CapturedPixelData,
+    /// @param FrameInfo - The state of the scene when the data was captured, e.g: the indexes used to name the exported files
+    virtual bool HandleScenePixelsData(const FNVTexturePixelDataRef& CapturedPixelData,
         class UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor,
         class UNVSceneCapturerViewpointComponent* CapturedViewpoint,
-        int32 FrameIndex, int32 PicksetIndex, int32 PicksetSubImage) PURE_VIRTUAL(UNVSceneDataHandler::HandleScenePixelsData, return false; );
+        const FNVCapturedFrameInfo& FrameInfo) PURE_VIRTUAL(UNVSceneDataHandler::HandleScenePixelsData, return false; );
 
     /// Handle the annotation data captured from the scene
-    /// @param CapturedData  - The scene's annotated data
+    /// @param CapturedData  - The scene's serialized annotation data
     /// @param CapturedFeatureExtractor - The feature extractor which captured the data
     /// @param CapturedViewpoint - The viewpoint which captured the data
-    /// @param FrameIndex - The frame when the data is captured
-    virtual bool HandleSceneAnnotationData(const TSharedPtr<FJsonObject>& CapturedData,
+    /// @param FrameInfo - The state of the scene when the data was captured, e.g: the indexes used to name the exported files
+    virtual bool HandleSceneAnnotationData(const FNVSceneAnnotationData& CapturedData,
         class UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor,
         class UNVSceneCapturerViewpointComponent* CapturedViewpoint,
-        int32 FrameIndex, int32 PicksetIndex, int32 PicksetSubImage) PURE_VIRTUAL(UNVSceneDataHandler::HandleSceneAnnotationData, return false; );
+        const FNVCapturedFrameInfo& FrameInfo) PURE_VIRTUAL(UNVSceneDataHandler::HandleSceneAnnotationData, return false; );
 
     virtual void OnStartCapturingSceneData() PURE_VIRTUAL(UNVSceneDataHandler::OnStartCapturingSceneData, return; );
     virtual void OnStopCapturingSceneData() PURE_VIRTUAL(UNVSceneDataHandler::OnStopCapturingSceneData, return; );
@@ -91,24 +93,24 @@ public:
     virtual bool IsHandlingData() const override;
 
     /// Handle the pixels data captured from the scene
-    /// @param CapturedPixelData - The scene's pixels data
+    /// @param CapturedPixelData - Reference to the scene's pixels data, keep the reference instead of copying the data if it's needed later
     /// @param CapturedFeatureExtractor - The feature extractor which captured the data
     /// @param CapturedViewpoint - The viewpoint which captured the data
-    /// @param FrameIndex - The frame when the data is captured
-    virtual bool HandleScenePixelsData(const FNVTexturePixelData& CapturedPixelData,
+    /// @param FrameInfo - The state of the scene when the data was captured, e.g: the indexes used to name the exported files
+    virtual bool HandleScenePixelsData(const FNVTexturePixelDataRef& CapturedPixelData,
                                        UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor,
                                        UNVSceneCapturerViewpointComponent* CapturedViewpoint,
-                                       int32 FrameIndex, int32 PicksetIndex, int32 PicksetSubImage) override;
+                                       const FNVCapturedFrameInfo& FrameInfo) override;
 
     /// Handle the annotation data captured from the scene
-    /// @param CapturedData  - The scene's annotated data
+    /// @param CapturedData  - The scene's serialized annotation data
     /// @param CapturedFeatureExtractor - The feature extractor which captured the data
     /// @param CapturedViewpoint - The viewpoint which captured the data
-    /// @param FrameIndex - The frame when the data is captured
-    virtual bool HandleSceneAnnotationData(const TSharedPtr<FJsonObject>& CapturedData,
+    /// @param FrameInfo - The state of the scene when the data was captured, e.g: the indexes used to name the exported files
+    virtual bool HandleSceneAnnotationData(const FNVSceneAnnotationData& CapturedData,
                                            class UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor,
                                            class UNVSceneCapturerViewpointComponent* CapturedViewpoint,
-                                           int32 FrameIndex, int32 PicksetIndex, int32 PicksetSubImage) override;
+                                           const FNVCapturedFrameInfo& FrameInfo) override;
 
     virtual void OnStartCapturingSceneData() override;
     virtual void OnStopCapturingSceneData() override;
@@ -149,6 +151,25 @@ public:
 protected:
     void ExportCapturerSettings();
 
+    /// Build the part of the exported file name which come after the frame indexes: ".<viewpoint postfix>.<feature extractor postfix>"
+    FString GetExportFileNamePostfix(class UNVSceneFeatureExtractor* CapturedFeatureExtractor,
+                                     UNVSceneCapturerViewpointComponent* CapturedViewpoint) const;
+
+    /// Get the directory the captured data are written to
+    FString GetDataOutputDirectoryPath() const;
+
+    /// Fill in the part of the dataset index record which is known before the data is exported
+    FNVDatasetIndexRecord MakeIndexRecord(class UNVSceneFeatureExtractor* CapturedFeatureExtractor,
+                                          UNVSceneCapturerViewpointComponent* CapturedViewpoint,
+                                          int32 FrameIndex, int32 PicksetIndex, int32 PicksetSubImage,
+                                          const FString& FileExtension, ENVDatasetIndexEntryType EntryType) const;
+
+    /// Finish the dataset index of the current capturing session
+    void CloseIndexWriter();
+
+    /// Write the schema of the binary annotation format next to the data, only once per capturing session
+    void ExportAnnotationSchemaIfNeeded(const FNVSceneAnnotationData& CapturedData);
+
 public: // Editor properties
     // ToDo: move to protected.
     /// If true, the exporter will use the current map's name for the export folder, otherwise it will use the ExportFolderName
@@ -172,9 +193,21 @@ protected: // Editor properties
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Capture")
     bool bAutoOpenExportedDirectory;
 
+    /// Maximum number of images waiting to be exported, the capturer will pause when half of it is reached
+    /// NOTE: 0 means there's no limit
     UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "Capture")
     uint32 MaxSaveImageAsyncCount;
 
+    /// Number of threads used to compress and save the images
+    /// NOTE: 0 means the count is picked based on the number of cores of the machine
+    UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "Capture", meta = (ClampMin = "0", UIMin = "0", UIMax = "32"))
+    int32 ImageExporterWorkerCount;
+
+    /// If true, the exporter write a binary index of all the exported data ("_index.bin") while capturing
+    /// so the dataset can be opened without scanning its directory, see NVDatasetIndex.h for the layout
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Capture")
+    bool bExportDatasetIndex;
+
 protected: // Transient
     UPROPERTY(Transient)
     FString SubFolderName;
@@ -185,7 +218,72 @@ protected: // Transient
     TUniquePtr<FNVImageExporter_Thread> ImageExporterThread;
     IImageWrapperModule* ImageWrapperModule;
 
+    /// NOTE: The image exporter's worker threads keep a reference to the index while they add the records of the exported images
+    TSharedPtr<FNVDatasetIndexWriter, ESPMode::ThreadSafe> IndexWriter;
+
+    bool bAnnotationSchemaExported;
+
     static const FString DefaultDataOutputFolder;
+    static const FString DatasetIndexFileName;
+};
+
+//=================================== UNVSceneDataShardExporter ===================================
+///
+/// NVSceneDataShardExporter - export all the captured data into big sequential tar shard files instead of one file per image and annotation
+/// Each entry is named "<frame>_<pickset>_<sub image>.<viewpoint postfix>.<feature extractor postfix>.<extension>"
+/// so WebDataset style loaders can group all the entries of a frame by their key
+/// NOTE: The images are compressed in parallel so the entries of a frame are not guaranteed to be next to each other in the shard
+///
+UCLASS(Blueprintable, ClassGroup = (NVIDIA))
+class NVSCENECAPTURER_API UNVSceneDataShardExporter : public UNVSceneDataExporter
+{
+    GENERATED_BODY()
+
+public:
+    UNVSceneDataShardExporter();
+
+    virtual bool HandleScenePixelsData(const FNVTexturePixelDataRef& CapturedPixelData,
+                                       UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor,
+                                       UNVSceneCapturerViewpointComponent* CapturedViewpoint,
+                                       const FNVCapturedFrameInfo& FrameInfo) override;
+
+    virtual bool HandleSceneAnnotationData(const FNVSceneAnnotationData& CapturedData,
+                                           class UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor,
+                                           class UNVSceneCapturerViewpointComponent* CapturedViewpoint,
+                                           const FNVCapturedFrameInfo& FrameInfo) override;
+
+    virtual void OnStartCapturingSceneData() override;
+    virtual void OnStopCapturingSceneData() override;
+    virtual void OnCapturingCompleted() override;
+
+    UFUNCTION(BlueprintCallable, Category = "Exporter")
+    FString GetShardEntryName(class UNVSceneFeatureExtractor* CapturedFeatureExtractor,
+                              UNVSceneCapturerViewpointComponent* CapturedViewpoint,
+                              int32 FrameIndex, int32 PicksetIndex, int32 PicksetSubImage,
+                              const FString& FileExtension) const;
+
+protected:
+    /// Wait for the image exporter to export all the queued images then finish the last shard
+    void CloseShardWriter();
+
+protected: // Editor properties
+    /// Name of the shard files, they are named "<prefix>-<shard index>.tar"
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Shard")
+    FString ShardNamePrefix;
+
+    /// A new shard file is started when the current one reach this size (in MB)
+    /// NOTE: 0 means all the data go into one shard
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Shard", meta = (ClampMin = "0", UIMin = "0"))
+    int32 MaxShardSizeMB;
+
+    /// Number of entries written between each flush of the shard file
+    /// NOTE: 0 means the shard is only flushed when it's finished. The flush hand the data over to the OS, it doesn't force them to the disk
+    UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "Shard", meta = (ClampMin = "0", UIMin = "0"))
+    int32 FlushEveryNumEntries;
+
+protected: // Transient
+    /// NOTE: The image exporter's worker threads keep a reference to the writer while they add the compressed images
+    TSharedPtr<FNVDatasetShardWriter, ESPMode::ThreadSafe> ShardWriter;
 };
 
 //=================================== UNVSceneDataVisualizer ===================================
@@ -205,24 +303,24 @@ public:
     virtual bool IsHandlingData() const override;
 
     /// Handle the pixels data captured from the scene
-    /// @param CapturedPixelData - The scene's pixels data
+    /// @param CapturedPixelData - Reference to the scene's pixels data, keep the reference instead of copying the data if it's needed later
     /// @param CapturedFeatureExtractor - The feature extractor which captured the data
     /// @param CapturedViewpoint - The viewpoint which captured the data
-    /// @param FrameIndex - The frame when the data is captured
-    virtual bool HandleScenePixelsData(const FNVTexturePixelData& CapturedPixelData,
+    /// @param FrameInfo - The state of the scene when the data was captured, e.g: the indexes used to name the exported files
+    virtual bool HandleScenePixelsData(const FNVTexturePixelDataRef& CapturedPixelData,
                                        UNVSceneFeatureExtractor_PixelData* CapturedFeatureExtractor,
                                        UNVSceneCapturerViewpointComponent* CapturedViewpoint,
-                                       int32 FrameIndex, int32 PicksetIndex, int32 PicksetSubImage) override;
+                                       const FNVCapturedFrameInfo& FrameInfo) override;
 
     /// Handle the annotation data captured from the scene
-    /// @param CapturedData  - The scene's annotated data
+    /// @param CapturedData  - The scene's serialized annotation data
     /// @param CapturedFeatureExtractor - The feature extractor which captured the data
     /// @param CapturedViewpoint - The viewpoint which captured the data
-    /// @param FrameIndex - The frame when the data is captured
-    virtual bool HandleSceneAnnotationData(const TSharedPtr<FJsonObject>& CapturedData,
+    /// @param FrameInfo - The state of the scene when the data was captured, e.g: the indexes used to name the exported files
+    virtual bool HandleSceneAnnotationData(const FNVSceneAnnotationData& CapturedData,
         class UNVSceneFeatureExtractor_AnnotationData* CapturedFeatureExtractor,
         class UNVSceneCapturerViewpointComponent* CapturedViewpoint,
-        int32 FrameIndex, int32 PicksetIndex, int32 PicksetSubImage) override;
+        const FNVCapturedFrameInfo& FrameInfo) override;
 
     virtual void OnCapturingCompleted() override;
 
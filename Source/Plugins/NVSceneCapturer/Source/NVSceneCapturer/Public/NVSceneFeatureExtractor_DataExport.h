@@ -8,6 +8,9 @@
 
 #include "NVSceneFeatureExtractor.h"
 #include "NVSceneCapturerUtils.h"
+#include "NVActorGeometryCache.h"
+#include "ConvexVolume.h"
+#include "Async/TaskGraphInterfaces.h"
 #include "NVSceneFeatureExtractor_DataExport.generated.h"
 
 USTRUCT(BlueprintType)
@@ -44,6 +47,110 @@ public: // Editor properties
     /// Otherwise the coordinates are in  ratio between the position and the image size
     UPROPERTY(EditAnywhere, Category = "Export")
     bool bExportImageCoordinateInPixel;
+
+    /// If true, the data of the exported actors (bounding boxes, occlusion traces ...) are calculated on multiple threads
+    UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "Export")
+    bool bGatherActorDataInParallel;
+
+    /// How the annotation data is encoded, the binary format is smaller and much faster to load than the json
+    UPROPERTY(EditAnywhere, Category = "Export")
+    ENVAnnotationDataFormat AnnotationDataFormat;
+
+    /// If true, the objects' visibility is measured from the instance segmentation mask captured by the same viewpoint
+    /// (its VertexColorMask feature extractor) instead of tracing rays against the physics scene
+    /// NOTE: The annotation data of a frame is only exported once its mask is read back.
+    /// The traces are still used when the viewpoint doesn't capture the mask.
+    UPROPERTY(EditAnywhere, Category = "Export")
+    bool bComputeVisibilityFromInstanceMask;
+
+    /// If true, the objects' visible pixels in the instance segmentation mask are exported as COCO run-length encoding (segmentation_rle)
+    UPROPERTY(EditAnywhere, Category = "Export")
+    bool bExportInstanceMaskRLE;
+
+    /// If true, the outer contours of the objects' visible pixels in the instance segmentation mask are exported as polygons (segmentation_polygons)
+    UPROPERTY(EditAnywhere, Category = "Export")
+    bool bExportInstanceMaskPolygons;
+
+    /// The polygons' points which are closer than this distance (in pixel) to the simplified contour are removed, 0 keep all the border pixels
+    UPROPERTY(EditAnywhere, Category = "Export", meta = (ClampMin = "0", UIMin = "0", UIMax = "4", EditCondition = "bExportInstanceMaskPolygons"))
+    float PolygonSimplificationTolerance;
+
+public:
+    /// Whether any of the exported data is calculated from the instance segmentation mask
+    bool UseInstanceMask() const;
+};
+
+/// What to calculate from the instance segmentation mask of a frame, see FNVInstanceMaskQueue
+struct NVSCENECAPTURER_API FNVInstanceMaskAnalysisOptions
+{
+public:
+    FNVInstanceMaskAnalysisOptions();
+
+    /// Calculate the objects' visibility from their visible and projected pixel counts
+    bool bMeasureVisibility;
+    /// Replace the objects' 2d bounding box with the box of their visible pixels
+    bool bCalculateBoundingBox;
+    bool bEncodeRLE;
+    bool bTracePolygons;
+    float PolygonSimplificationTolerance;
+    /// Whether the 2d coordinates are in pixel or in ratio of the image size, see FNVDataExportSettings::bExportImageCoordinateInPixel
+    bool bExportImageCoordinateInPixel;
+
+    /// Get the optional fields of the objects the analysis set, combination of ENVOptionalObjectFields
+    uint32 GetAnalyzedObjectFields() const;
+};
+
+struct FNVPendingInstanceMaskFrame;
+typedef TSharedPtr<FNVPendingInstanceMaskFrame, ESPMode::ThreadSafe> FNVPendingInstanceMaskFramePtr;
+
+///
+/// FNVInstanceMaskQueue - pair the annotation data of each captured frame with the instance segmentation mask
+/// captured for the same frame, then complete the objects' data from the mask on a worker thread
+/// NOTE: The masks can be read back on the rendering thread so the queue can be used from any thread.
+/// The frames and the masks are paired by the engine frame they were captured in, both are added in the order they were captured
+/// so the masks older than the last added frame and the frames older than the last added mask are dropped
+///
+class NVSCENECAPTURER_API FNVInstanceMaskQueue : public TSharedFromThis<FNVInstanceMaskQueue, ESPMode::ThreadSafe>
+{
+public:
+    void AddFrame(const FNVPendingInstanceMaskFramePtr& Frame);
+    /// @param FrameNumber  The engine frame (GFrameCounter) the mask was captured in
+    void AddInstanceMask(uint64 FrameNumber, const FNVTexturePixelDataRef& MaskPixelData);
+    /// Wait for the frames being analyzed and hand them to their feature extractor, then drop the frames still waiting for their mask
+    /// NOTE: Must be called on the game thread, after the masks of all the captured frames are read back
+    void Drain();
+    /// Drop the frames and the masks which are still waiting for each other
+    void Reset();
+
+    /// Go through the mask once to find the pixels of each object, then calculate the data chosen in the options from them:
+    /// pixel count, truncation, visibility, 2d bounding box, run-length encoding and contour polygons
+    /// NOTE: The objects' projected_pixel_count must already be set to measure their visibility
+    static void AnalyzeInstanceMask(const FNVTexturePixelData& MaskPixelData, const FNVInstanceMaskAnalysisOptions& Options,
+                                    TArray<FCapturedObjectData>& Objects);
+
+protected:
+    void LaunchAnalysisTask(const FNVPendingInstanceMaskFramePtr& Frame, const FNVTexturePixelDataRef& MaskPixelData);
+    /// Hand the analyzed frames to their feature extractor, must be called on the game thread
+    void FinishAnalyzedFrames();
+    /// Drop the frames or the masks captured before a frame with a warning, their pair can't be added anymore
+    /// NOTE: QueueCriticalSection must be locked
+    void DropFramesBefore(uint64 FrameNumber);
+    void DropMasksBefore(uint64 FrameNumber);
+
+    struct FNVPendingInstanceMask
+    {
+        uint64 FrameNumber;
+        FNVTexturePixelDataRef PixelData;
+    };
+
+protected:
+    FCriticalSection QueueCriticalSection;
+    TArray<FNVPendingInstanceMaskFramePtr> PendingFrames;
+    TArray<FNVPendingInstanceMask> PendingMasks;
+    /// The frames which are analyzed and waiting to be handed to their feature extractor on the game thread
+    TArray<FNVPendingInstanceMaskFramePtr> AnalyzedFrames;
+    /// The analysis tasks which may still be running
+    FGraphEventArray AnalysisTasks;
 };
 
 // Base class for all the feature extractors that export the scene data to json file
@@ -56,33 +163,68 @@ public:
     UNVSceneFeatureExtractor_AnnotationData(const FObjectInitializer& ObjectInitializer);
 
     virtual void StartCapturing() override;
+    virtual void StopCapturing() override;
     virtual void UpdateCapturerSettings() override;
 
     /// Callback function get called after capturing scene's annotation data
-    /// TSharedPtr<FJsonObject> - The JSON object contain the annotation data
+    /// FNVSceneAnnotationData - The serialized annotation data, it's only valid during the callback
     /// UNVSceneFeatureExtractor_AnnotationData* - Reference to the feature extractor that captured the scene annotation data
-    typedef TFunction<void(TSharedPtr<FJsonObject>, UNVSceneFeatureExtractor_AnnotationData*)> OnFinishedCaptureSceneAnnotationDataCallback;
+    typedef TFunction<void(const FNVSceneAnnotationData&, UNVSceneFeatureExtractor_AnnotationData*)> OnFinishedCaptureSceneAnnotationDataCallback;
 
-    /// Capture the annotation data of the scene and return it in JSON format
+    /// Capture the annotation data of the scene and serialize it in the format chosen in the export settings
     bool CaptureSceneAnnotationData(UNVSceneFeatureExtractor_AnnotationData::OnFinishedCaptureSceneAnnotationDataCallback Callback);
 
+    /// Get the queue the viewpoint must pass its instance mask to, null if nothing is calculated from the mask
+    TSharedPtr<FNVInstanceMaskQueue, ESPMode::ThreadSafe> GetInstanceMaskQueue() const;
+
+    /// Encode the scene data in a format
+    static void SerializeSceneData(const FCapturedSceneData& SceneData, ENVAnnotationDataFormat DataFormat, FNVSceneAnnotationData& OutAnnotationData);
+    /// Hand the serialized data of a frame which was completed from its mask, must be called on the game thread
+    void FinishPendingInstanceMaskFrame(const FNVPendingInstanceMaskFrame& Frame);
+
 protected:
+    /// Capture the annotation data of the scene and convert it to a JSON object
+    /// NOTE: Building the JSON object is much slower than CaptureSceneAnnotationData(Callback), which serialize the data directly
     TSharedPtr<FJsonObject> CaptureSceneAnnotationData();
+    /// Gather the data of the viewpoint and all the exported actors in the scene
+    bool GatherSceneData(FCapturedSceneData& OutSceneData);
     virtual void UpdateSettings() override;
 
     void UpdateProjectionMatrix();
     /// NOTE: May make this function static
     bool GatherActorData(const AActor* CheckActor, FCapturedObjectData& ActorData);
-    bool ShouldExportActor(const AActor* CheckActor) const;
-    bool IsActorInViewFrustum(const FConvexVolume& ViewFrustum, const AActor* CheckActor) const;
+    /// Calculate the part of the actor's data which only read the actor and query the physics scene, it's safe to call from any thread
+    /// while the game thread is waiting for it
+    /// @param ActorGeometry    The actor's cached geometry, it must be taken from the geometry cache on the game thread
+    bool GatherActorData_AnyThread(const AActor* CheckActor, const FNVActorGeometryRecord& ActorGeometry, FCapturedObjectData& ActorData) const;
+    /// Fill in the part of the actor's data which must be gathered on the game thread: its segmentation id and custom data
+    void GatherActorData_GameThread(const AActor* CheckActor, FCapturedObjectData& ActorData) const;
+    bool ShouldExportActor(const AActor* CheckActor, const FNVActorGeometryRecord& ActorGeometry) const;
+    /// The checks of ShouldExportActor which don't need the actor's bounds: hidden state, tag and meshes
+    bool PassesActorFilters(const AActor* CheckActor, const FNVActorGeometryRecord& ActorGeometry) const;
+    /// The checks of ShouldExportActor which only need the actor's bounds: valid extent and view frustum
+    bool ShouldExportActorBounds(const FBoxSphereBounds& ActorBounds) const;
+    /// NOTE: Use the frustum cached by UpdateProjectionMatrix
+    bool IsBoundsInViewFrustum(const FBoxSphereBounds& ActorBounds) const;
 
     FVector ProjectWorldPositionToImagePosition(const FVector& WorldPosition) const;
+    /// Convert a position in the clip space (see ViewProjectionMatrix) to the image, same as ProjectWorldPositionToImagePosition without the depth
+    FVector2D ConvertClipPositionToImagePosition(float ClipX, float ClipY, float ClipW) const;
 
-    FBox2D GetBoundingBox2D(const AActor* CheckActor, bool bClampToImage = true) const;
+    FBox2D GetBoundingBox2D(const FNVActorGeometryRecord& ActorGeometry, bool bClampToImage = true) const;
     /// Calculate a 2D axis-aligned bounding box of a 3d shape knowing its vertexes on the viewport
-    FBox2D Calculate2dAABB(TArray<FVector> Vertexes, bool bClampToImage = true) const;
-    /// Calculate a 2D axis-aligned bounding box of a static mesh on the viewport
-    FBox2D Calculate2dAABB_MeshComplexCollision(const class UMeshComponent* CheckMeshComp, bool bClampToImage = true) const;
+    FBox2D Calculate2dAABB(const TArray<FVector>& Vertexes, bool bClampToImage = true) const;
+    /// Calculate a 2D axis-aligned bounding box of a mesh on the viewport by projecting the vertexes of its cached convex hull
+    FBox2D Calculate2dAABB_MeshComplexCollision(const FNVMeshGeometry& MeshGeometry, bool bClampToImage = true) const;
+
+    /// Estimate the occlusion of an actor by tracing rays from the viewpoint to its cuboid and its hull's bounds
+    void TraceActorOcclusion(const AActor* CheckActor, const FNVActorGeometryRecord& ActorGeometry, const FNVCuboidData& ActorCuboid,
+                             FCapturedObjectData& ActorData) const;
+    /// Estimate the number of pixels an actor would cover in the image if nothing occluded it
+    /// NOTE: The silhouette is approximated by the convex hull of all its projected collision hulls so it's an upper bound for concave meshes
+    uint32 CalculateProjectedPixelCount(const FNVActorGeometryRecord& ActorGeometry) const;
+    bool ShouldAnalyzeInstanceMask() const;
+    FNVInstanceMaskAnalysisOptions GetInstanceMaskAnalysisOptions() const;
 
 protected: // Editor properties
     UPROPERTY(EditAnywhere, SimpleDisplay, Category = Config, meta=(ShowOnlyInnerProperties))
@@ -94,6 +236,37 @@ protected: // Editor properties
     UPROPERTY(Transient)
     FMatrix ProjectionMatrix;
 
+    /// Planes of the view frustum, updated with ViewProjectionMatrix
+    FConvexVolume ViewFrustum;
+
 protected: // Transient properties
     FNVDataExportSettings ProtectedDataExportSettings;
+
+    /// The serialized data of the last capture, it's reused so its buffer doesn't need to be reallocated every frame
+    FNVSceneAnnotationData CapturedAnnotationData;
+
+    /// The frames waiting for their instance mask, only valid while capturing with any of the settings using the mask
+    TSharedPtr<FNVInstanceMaskQueue, ESPMode::ThreadSafe> InstanceMaskQueue;
+    /// Set while gathering the data of a frame which is going to be completed from its mask
+    bool bAnalyzeInstanceMask;
+};
+
+/// The annotation data of a frame waiting for its instance mask, see FNVInstanceMaskQueue
+struct FNVPendingInstanceMaskFrame
+{
+public:
+    FNVPendingInstanceMaskFrame() : FrameNumber(0), DataFormat(ENVAnnotationDataFormat::Json), bIsAnalyzed(false) {}
+
+    /// The engine frame (GFrameCounter) the data was captured in, it's matched with the mask's
+    uint64 FrameNumber;
+    FCapturedSceneData SceneData;
+    ENVAnnotationDataFormat DataFormat;
+    FNVInstanceMaskAnalysisOptions AnalysisOptions;
+    /// The serialized data, only valid once the mask is analyzed
+    FNVSceneAnnotationData AnnotationData;
+    /// Whether the data was completed from the frame's mask, the frames which are dropped are never analyzed
+    bool bIsAnalyzed;
+
+    TWeakObjectPtr<UNVSceneFeatureExtractor_AnnotationData> FeatureExtractor;
+    UNVSceneFeatureExtractor_AnnotationData::OnFinishedCaptureSceneAnnotationDataCallback Callback;
 };
@@ -29,12 +29,29 @@ public:
     UNVSceneFeatureExtractor_PixelData(const FObjectInitializer& ObjectInitializer);
 
     /// Callback function get called after the scene capture component finished capturing scene and read back its pixels data
-    /// FNVTexturePixelData - The struct contain the captured scene's pixels data
+    /// FNVTexturePixelDataRef - Reference to the struct contain the captured scene's pixels data
     /// UNVSceneFeatureExtractor_PixelData* - Reference to the feature extractor that captured the scene pixels data
-    typedef TFunction<void(const FNVTexturePixelData&, UNVSceneFeatureExtractor_PixelData*)> OnFinishedCaptureScenePixelsDataCallback;
+    typedef TFunction<void(const FNVTexturePixelDataRef&, UNVSceneFeatureExtractor_PixelData*)> OnFinishedCaptureScenePixelsDataCallback;
 
     virtual bool CaptureSceneToPixelsData(UNVSceneFeatureExtractor_PixelData::OnFinishedCaptureScenePixelsDataCallback Callback);
 
+    /// Let another object take over reading back the pixels captured by this feature extractor's scene capture components
+    void SetReadbackRequestHandler(FNVTextureReader::OnReadbackRequestedCallback NewHandler);
+    /// Number of batched pixels readbacks requested when CaptureSceneToPixelsData is called:
+    /// 1 per scene capture component, or 1 if the feature extractor use another feature extractor's scene capture
+    /// NOTE: The scene capture components which use a pooled render target read back their pixels themselves
+    int32 GetBatchedReadbackCount() const;
+    /// Read back the pixels this feature extractor's scene capture components captured and wait for their callbacks to be called
+    void FlushPendingReadbacks();
+
+    /// Get the buffer of the rendered scene this feature extractor capture, if it can be resolved from the scene rendered by
+    /// another feature extractor of the same viewpoint instead of rendering the scene again, see FNVSceneCapturerViewpointSettings::bShareSceneCapture
+    /// @param OutOutputScale   Multiplier applied to the resolved values
+    /// @return false if the feature extractor need its own scene capture
+    virtual bool GetSharedCaptureOutput(ENVSceneCaptureOutput& OutOutput, float& OutOutputScale) const;
+    /// Whether the other feature extractors can resolve their buffer from the scene rendered by this feature extractor's scene capture
+    virtual bool CanHostSharedSceneCapture() const;
+
     virtual void StartCapturing() override;
     virtual void StopCapturing() override;
     virtual void UpdateCapturerSettings() override;
@@ -43,10 +60,27 @@ public:
 
     virtual class UTextureRenderTarget2D* GetRenderTarget() const;
 
+    const FNVImageCompressionSettings& GetCompressionSettings() const
+    {
+        return CompressionSettings;
+    }
+
+    /// The format of the images exported from this feature extractor: its own format if it override it, otherwise the capturer's format
+    ENVImageFormat GetExportImageFormat() const;
+
 protected:
     virtual void UpdateSettings() override;
     virtual void UpdateMaterial();
 
+    /// The pixel format actually captured and read back, CapturedPixelFormat unless the feature extractor's settings need another one
+    virtual ENVCapturedPixelFormat GetEffectiveCapturedPixelFormat() const;
+
+    /// Use the scene capture of another feature extractor of the viewpoint if possible
+    /// @return true if this feature extractor doesn't need its own scene capture
+    bool AttachToSharedSceneCapture();
+    /// Whether the scene this feature extractor see is the same as the default view of the viewpoint
+    bool UseDefaultSceneView() const;
+
 protected: // Editor properties
     /// If true, only show the training actors in the exported images
     UPROPERTY(EditDefaultsOnly, Category = Config)
@@ -76,6 +110,10 @@ protected: // Editor properties
     UPROPERTY(EditDefaultsOnly, Category = Config, meta = (editcondition = "bOverrideExportImageType"))
     ENVImageFormat ExportImageFormat;
 
+    /// Settings used to compress the images exported from this feature extractor
+    UPROPERTY(EditDefaultsOnly, Category = Config)
+    FNVImageCompressionSettings CompressionSettings;
+
 	UPROPERTY(EditDefaultsOnly, Category = Config)
 	TEnumAsByte<ENVCapturedPixelFormat> CapturedPixelFormat;
 
@@ -97,6 +135,11 @@ protected: // Transient properties
 
     UPROPERTY(Transient)
     UNVSceneCaptureComponent2D* SceneCaptureComponent;
+
+    /// The scene capture of another feature extractor this feature extractor resolve its buffer from, see AttachToSharedSceneCapture
+    UPROPERTY(Transient)
+    UNVSceneCaptureComponent2D* SharedSceneCaptureComponent;
+    int32 SharedCaptureOutputIndex;
 };
 
 /// Base class for all the feature extractors that export the scene's depth buffer
@@ -108,13 +151,26 @@ class NVSCENECAPTURER_API UNVSceneFeatureExtractor_SceneDepth : public UNVSceneF
 public:
     UNVSceneFeatureExtractor_SceneDepth(const FObjectInitializer& ObjectInitializer);
 
+    virtual bool GetSharedCaptureOutput(ENVSceneCaptureOutput& OutOutput, float& OutOutputScale) const override;
+
 protected:
     virtual void UpdateMaterial() override;
+    virtual ENVCapturedPixelFormat GetEffectiveCapturedPixelFormat() const override;
+
+    /// Whether the depth is normalized by MaxDepthDistance before it's captured, the other encodings capture the depth in cm
+    bool UseNormalizedDepth() const;
 
 public: // Editor properties
     /// The furthest distance to quantize when capturing the scene's depth
+    /// NOTE: Only used by the Normalized8 depth encoding
     UPROPERTY(EditAnywhere, SimpleDisplay, Category=Config)
     float MaxDepthDistance;
+
+    /// How the depth is stored in the exported images
+    /// The 16 bits encodings are computed on the GPU before the pixels are read back and should be exported as PNG
+    /// NOTE: Normalized8 keep using the feature extractor's CapturedPixelFormat, the other encodings capture their own format instead
+    UPROPERTY(EditAnywhere, SimpleDisplay, Category=Config)
+    ENVDepthEncoding DepthEncoding;
 };
 
 UCLASS(Abstract)
@@ -125,6 +181,9 @@ class NVSCENECAPTURER_API UNVSceneFeatureExtractor_ScenePixelVelocity : public U
 public:
     UNVSceneFeatureExtractor_ScenePixelVelocity(const FObjectInitializer& ObjectInitializer);
 
+    virtual bool GetSharedCaptureOutput(ENVSceneCaptureOutput& OutOutput, float& OutOutputScale) const override;
+    virtual bool CanHostSharedSceneCapture() const override;
+
 protected:
     virtual void UpdateSettings() override;
 };
@@ -138,6 +197,8 @@ class NVSCENECAPTURER_API UNVSceneFeatureExtractor_StencilMask : public UNVScene
 public:
     UNVSceneFeatureExtractor_StencilMask(const FObjectInitializer& ObjectInitializer);
 
+    virtual bool GetSharedCaptureOutput(ENVSceneCaptureOutput& OutOutput, float& OutOutputScale) const override;
+
 protected:
     virtual void UpdateSettings() override;
 };
@@ -152,6 +213,8 @@ class NVSCENECAPTURER_API UNVSceneFeatureExtractor_VertexColorMask : public UNVS
 public:
     UNVSceneFeatureExtractor_VertexColorMask(const FObjectInitializer& ObjectInitializer);
 
+    virtual bool CanHostSharedSceneCapture() const override;
+
 protected:
     virtual void UpdateSettings() override;
 };
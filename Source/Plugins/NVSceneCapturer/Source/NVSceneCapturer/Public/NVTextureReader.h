@@ -7,10 +7,135 @@
 #pragma once
 
 #include "NVSceneCapturerUtils.h"
+#include "Async/Future.h"
 #include "NVTextureReader.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogNVTextureReader, Log, All)
 
+///
+/// FNVTextureReadbackRing - ring of persistent CPU readback textures
+/// The pixels are copied to a free texture in the ring and only mapped a few frames later (when the GPU fence is signaled)
+/// so the GPU doesn't need to finish the copy right away and the textures don't need to be created for every read
+/// NOTE: All the functions of this class must be called on the rendering thread
+///
+struct NVSCENECAPTURER_API FNVTextureReadbackRing
+{
+public:
+    typedef TFunction<void(uint8*, EPixelFormat, FIntPoint)> OnFinishedReadingRawPixelsCallback;
+
+    FNVTextureReadbackRing();
+    ~FNVTextureReadbackRing();
+
+    /// Change the size of the ring and how many frames the readback can be delayed before we force to map it
+    void SetSettings(int32 NewMaxReadbackTextureCount, int32 NewMaxFrameLatency);
+
+    /// Get a readback texture with the required size and format from the ring
+    /// NOTE: If all the textures in the ring are in use, the oldest pending readback will be finished right away to free its texture
+    FTexture2DRHIRef AcquireReadbackTexture(FRHICommandListImmediate& RHICmdList, EPixelFormat PixelFormat, const FIntPoint& TextureSize, int32& OutSlotIndex);
+
+    /// Mark a texture in the ring as waiting for the copy to finish, the callback will be called when its pixels are mapped
+    void QueueReadback(FRHICommandListImmediate& RHICmdList, int32 SlotIndex, OnFinishedReadingRawPixelsCallback Callback);
+
+    /// Map the readback textures which are ready and call their callbacks
+    /// @param bFlushAll  If true, map all the pending textures even when the GPU haven't finished copying them
+    void ProcessPendingReadbacks(FRHICommandListImmediate& RHICmdList, bool bFlushAll = false);
+
+    /// Make sure the ring have enough textures for a number of readbacks queued every frame so they don't need to be finished early
+    void ReserveReadbackTextures(int32 ReadbackCountPerFrame);
+
+    /// Release all the readback textures
+    void Release();
+
+    /// Number of readbacks which are requested but their callbacks are not called yet
+    /// NOTE: This function can be called from any thread
+    int32 GetPendingReadbackCount() const
+    {
+        return PendingReadbackCounter.GetValue();
+    }
+
+    /// NOTE: Must be called on the game thread when a readback is requested, before its render command is enqueued
+    void OnReadbackRequested()
+    {
+        PendingReadbackCounter.Increment();
+    }
+    /// Undo OnReadbackRequested when the readback couldn't be queued, its callback will never be called
+    void OnReadbackCanceled()
+    {
+        PendingReadbackCounter.Decrement();
+    }
+
+protected:
+    struct FNVReadbackSlot
+    {
+        FTexture2DRHIRef ReadbackTexture;
+        FGPUFenceRHIRef ReadbackFence;
+        OnFinishedReadingRawPixelsCallback Callback;
+        EPixelFormat PixelFormat;
+        FIntPoint TextureSize;
+        uint32 QueuedFrameNumber;
+        bool bIsPending;
+
+        FNVReadbackSlot();
+    };
+
+    bool IsReadbackReady(const FNVReadbackSlot& CheckSlot) const;
+    void FinishReadback(FRHICommandListImmediate& RHICmdList, int32 SlotIndex);
+
+protected:
+    TArray<FNVReadbackSlot> ReadbackSlots;
+    /// Index of the pending slots in the order they were queued so the callbacks are called in the same order
+    TArray<int32> PendingSlotIndexes;
+
+    int32 MaxReadbackTextureCount;
+    int32 MaxFrameLatency;
+
+    FThreadSafeCounter PendingReadbackCounter;
+};
+
+/// How the source pixels are converted on the GPU before they are read back
+enum class ENVPixelPackMode : uint8
+{
+    /// Draw the source pixels as is, the channels the readback pixel format doesn't have are dropped
+    None,
+    /// Pack the integer id in the R channel into the RGB channels, see ENVCapturedPixelFormat::PackedId24
+    PackId24,
+    /// Encode the depth (cm) in the R channel to a 16 bit unsigned integer, see ENVDepthEncoding
+    EncodeDepthMillimeters16,
+    EncodeDepthLog16,
+    EncodeDepthHalf16,
+};
+
+class FTextureRenderTargetResource;
+
+/// A request to read back the pixels of a texture, see FNVTextureReader::ReadPixelsDataBatch
+struct NVSCENECAPTURER_API FNVTextureReadbackRequest
+{
+public:
+    FNVTextureReadbackRequest();
+
+    /// Get the texture to read from, the render target's texture is taken from its resource if it's used
+    /// NOTE: Must be called on the rendering thread
+    FTexture2DRHIRef GetSourceTexture_RenderThread() const;
+
+public:
+    FTexture2DRHIRef SourceTexture;
+    /// If set, the texture to read from is taken from this render target's resource on the rendering thread instead of SourceTexture
+    /// NOTE: A render target's RHI texture is only created when the rendering thread initialize its resource, e.g: a new pooled render target
+    FTextureRenderTargetResource* SourceRenderTargetResource;
+    /// The region to read from the source texture
+    FIntRect SourceRect;
+    /// The pixel format of the read back pixels
+    EPixelFormat ReadbackPixelFormat;
+    /// The 2d size of the read back pixels
+    FIntPoint ReadbackSize;
+    /// How the pixels are converted before they are read back
+    ENVPixelPackMode PackMode;
+    /// If true, just set the alpha value of the readback pixels to 1, otherwise read it correctly
+    bool bIgnoreAlpha;
+    /// The function to call after the pixels data are read from the source texture
+    TFunction<void(const FNVTexturePixelDataRef&)> Callback;
+};
+
 // This class read the pixels data from a texture target
 USTRUCT()
 struct NVSCENECAPTURER_API FNVTextureReader
@@ -29,8 +154,13 @@ public:
     typedef TFunction<void(uint8*, EPixelFormat, FIntPoint)> OnFinishedReadingRawPixelsCallback;
 
     /// Callback function get called after finish reading pixels data
-    /// FNVTexturePixelData - The struct contain the texture's pixels data
-    typedef TFunction<void(const FNVTexturePixelData&)> OnFinishedReadingPixelsDataCallback;
+    /// FNVTexturePixelDataRef - Reference to the struct contain the texture's pixels data
+    /// NOTE: Keep the reference instead of copying the pixels data if it need to be used after the callback
+    typedef TFunction<void(const FNVTexturePixelDataRef&)> OnFinishedReadingPixelsDataCallback;
+
+    /// Callback function get called when a readback is requested and should be handled by someone else than the reader
+    /// FNVTextureReadbackRequest - The request to read back, the handler can move it
+    typedef TFunction<void(FNVTextureReadbackRequest&)> OnReadbackRequestedCallback;
 
     /// Read back the pixels data from the current source texture
     /// @param Callback  The function to call after all the pixels data are read from the source texture
@@ -38,10 +168,55 @@ public:
     /// NOTE: This function is async, the reading process will run on the rendering thread in parallel with the game thread
     virtual bool ReadPixelsData(OnFinishedReadingPixelsDataCallback Callback, bool bIgnoreAlpha = false);
 
+    /// Read back the pixels data from the current source texture
+    /// NOTE: This function is async, the future is fulfilled on a worker thread so waiting for it never block the rendering thread
+    /// Poll the future's IsReady instead of calling its Get on the game thread, Get wait until the GPU finished copying the pixels
+    /// @param bIgnoreAlpha  If true, just set the alpha value of the readback pixels to 1, otherwise read it correctly
+    TFuture<FNVTexturePixelDataRef> ReadPixelsDataAsync(bool bIgnoreAlpha = false);
+
     /// Read back the pixels data from the current source texture
     /// NOTE: This function is sync, the pixels data is returned right away but it may cause the game to hitches since it flush the rendering commands
+    /// Prefer the async functions, each call is counted in GetSyncFlushCount
     virtual bool ReadPixelsData(FNVTexturePixelData& OutPixelsData);
 
+    /// Build a request to read back the current source texture, e.g: to read it back together with other textures using ReadPixelsDataBatch
+    /// @param Callback      The function to call after all the pixels data are read from the source texture
+    /// @param bIgnoreAlpha  If true, just set the alpha value of the readback pixels to 1, otherwise read it correctly
+    virtual bool BuildReadbackRequest(OnFinishedReadingPixelsDataCallback Callback, bool bIgnoreAlpha, FNVTextureReadbackRequest& OutRequest);
+
+    /// Read back the pixels data of several textures together using this reader's readback ring
+    /// The textures with the same readback pixel format are stacked in 1 readback texture so they only need 1 GPU fence and 1 map,
+    /// then the stacked pixels are split back to 1 pixels data per request
+    /// NOTE: This function is async, the callbacks of the requests are called in the same order as the requests
+    /// @param Requests  The requests to read back, they are moved to the render command
+    bool ReadPixelsDataBatch(TArray<FNVTextureReadbackRequest>& Requests);
+
+    /// Change the settings of the readback ring used by the async ReadPixelsData
+    /// @param ReadbackTextureCount  Maximum number of readback textures in the ring (at least 1)
+    /// @param MaxFrameLatency       Maximum number of frames to wait for the GPU before forcing to map a readback texture
+    ///                              0 means map the texture right after copying to it
+    void SetReadbackSettings(int32 ReadbackTextureCount, int32 MaxFrameLatency);
+
+    /// Call the callbacks of the async readbacks which are finished
+    /// NOTE: Should be called every frame so the pending readbacks don't wait longer than needed
+    void ProcessPendingReadbacks();
+
+    /// Finish all the pending async readbacks
+    /// @param bWaitForCompletion  If true, flush the rendering commands so all the callbacks are called when this function returns
+    void FlushPendingReadbacks(bool bWaitForCompletion = false);
+
+    /// Number of async readbacks which are requested but not finished yet
+    int32 GetPendingReadbackCount() const;
+
+    /// Number of times the readers blocked the game thread to flush the rendering commands since the game started
+    /// NOTE: Debug counter, the capture should only flush when it stops, any other flush is reported in the log
+    static int32 GetSyncFlushCount();
+
+    /// Read back the pixels in the layout of a captured pixel format instead of the source texture's format
+    /// The pixels are converted on the GPU while they are copied to the readback texture so we only read back and copy the bytes we export
+    /// NOTE: NVCapturedPixelFormat_MAX mean read back the pixels in the source texture's format
+    void SetReadbackPixelFormat(ENVCapturedPixelFormat NewCapturedPixelFormat);
+
 protected:
     /// Change the information of the texture to read from
     /// @param NewSourceTexture          The texture to read from
@@ -53,6 +228,24 @@ protected:
         EPixelFormat NewReadbackPixelFormat = EPixelFormat::PF_Unknown,
         const FIntPoint& NewReadbackSize = FIntPoint::ZeroValue);
 
+    /// Read from a render target's texture, its RHI texture is only taken from the resource on the rendering thread when the pixels are copied
+    /// so the game thread doesn't need to wait for a new render target to be initialized
+    /// @param NewRenderTargetResource   The resource of the render target to read from
+    /// @param TextureSize               The size of the render target's texture
+    /// @param TextureFormat             The pixel format of the render target's texture
+    void SetSourceRenderTarget(FTextureRenderTargetResource* NewRenderTargetResource, const FIntPoint& TextureSize, EPixelFormat TextureFormat);
+
+    /// Update the readback region, size and pixel format using the settings of the texture to read from
+    void UpdateReadbackSettings(const FIntPoint& TextureSize, EPixelFormat TextureFormat);
+
+    bool HasSourceTexture() const
+    {
+        return SourceTexture.IsValid() || (SourceRenderTargetResource != nullptr);
+    }
+
+    /// Get the texture to read from, see FNVTextureReadbackRequest::GetSourceTexture_RenderThread
+    static FTexture2DRHIRef ResolveSourceTexture_RenderThread(const FTexture2DRHIRef& SourceTexture, const FTextureRenderTargetResource* SourceRenderTargetResource);
+
     /// Read back the pixels data from the current source texture
     /// @param Callback  The function to call after all the pixels data are read from the source texture
     /// @param NewSourceTexture          The texture to read from
@@ -79,38 +272,66 @@ protected:
 
     /// Read the pixel data from a render target
     /// @param SourceTexture         The texture to read from
+    /// @param SourceRenderTargetResource    If set, the texture to read from is taken from this resource on the rendering thread instead
     /// @param SourceRect            The area where to read from the SourceRenderTarget
     /// @param TargetPixelFormat     The pixel format of the read back pixels data
     /// @param TargetSize            The size of the read back pixels area
     /// @param bIgnoreAlpha          If true, just set the alpha value of the readback pixels to 1, otherwise read it correctly
+    /// @param PackMode              How the pixels are converted before they are read back
     /// @param Callback              Function to call after finished reading pixels data
+    /// @param ReadbackRing          The ring of readback textures to use. If it's null, a temporary texture is created and mapped right away
     static bool ReadPixelsRaw(const FTexture2DRHIRef& SourceTexture,
+                              FTextureRenderTargetResource* SourceRenderTargetResource,
                               const FIntRect& SourceRect,
                               EPixelFormat TargetPixelFormat,
                               const FIntPoint& TargetSize,
                               bool bIgnoreAlpha,
-                              OnFinishedReadingRawPixelsCallback Callback);
+                              ENVPixelPackMode PackMode,
+                              OnFinishedReadingRawPixelsCallback Callback,
+                              TSharedPtr<FNVTextureReadbackRing, ESPMode::ThreadSafe> ReadbackRing = nullptr);
 
-    static FNVTexturePixelData BuildPixelData(uint8* PixelsData, EPixelFormat PixelFormat, const FIntPoint& ImageSize, const FIntPoint& TargetSize);
+    /// Copy the read back pixels to a pixel data taken from FNVTexturePixelDataPool
+    static FNVTexturePixelDataRef BuildPixelData(uint8* PixelsData, EPixelFormat PixelFormat, const FIntPoint& ImageSize, const FIntPoint& TargetSize);
     static void BuildPixelData(FNVTexturePixelData& OutPixelsData, uint8* PixelsData, EPixelFormat PixelFormat, const FIntPoint& ImageSize, const FIntPoint& TargetSize);
 
+    /// Flush the rendering commands and count it in GetSyncFlushCount
+    /// @param Reason       What needed to flush, used in the log
+    /// @param bIsExpected  If false, the flush happened while capturing and is reported as a warning
+    static void FlushRenderingCommandsForReadback(const TCHAR* Reason, bool bIsExpected);
+
     /// Copy the pixels data from a texture to another one
     /// NOTE: The function return back right away but the action is running in the GPU
+    /// NOTE: If the pixels don't need to be resized nor converted, they are copied straight to the target, otherwise the source is drawn on the target
     /// @param RendererModule  Reference to the Renderer module
     /// @param RHICmdList      The RHI command list used to copy texture. This parameter can be used to wait for the action to be done
     /// @param SourceTexture   The original texture
     /// @param SourceRect      The region to copy from the SourceTexture
     /// @param TargetTexture   The target texture to copy pixels to
-    /// @param TargetRect      The region in the TargetTexture to copy pixels to
+    /// @param TargetRect      The region in the TargetTexture to copy pixels to, it doesn't need to start at the texture's origin
     /// @param bOverwriteAlpha   If true, overwrite the alpha of the target using the source texture's alpha
+    /// @param PackMode          How the source pixels are converted when they are drawn on the target
     static void CopyTexture2d(class IRendererModule* RendererModule, FRHICommandListImmediate& RHICmdList, const FTexture2DRHIRef& SourceTexture, const FIntRect& SourceRect,
-                              FTexture2DRHIRef& TargetTexture, const FIntRect& TargetRect, bool bOverwriteAlpha = true);
+                              FTexture2DRHIRef& TargetTexture, const FIntRect& TargetRect, bool bOverwriteAlpha = true,
+                              ENVPixelPackMode PackMode = ENVPixelPackMode::None);
+
+    /// Check whether the pixels can be copied from a texture to another one without drawing them, see CopyTexture2d
+    static bool CanCopyTextureDirectly(const FTexture2DRHIRef& SourceTexture, const FIntRect& SourceRect,
+                                       const FTexture2DRHIRef& TargetTexture, const FIntRect& TargetRect, bool bOverwriteAlpha, ENVPixelPackMode PackMode);
 
 protected:
     FTexture2DRHIRef SourceTexture;
+    /// The render target to read from if its texture is resolved on the rendering thread, see SetSourceRenderTarget
+    FTextureRenderTargetResource* SourceRenderTargetResource;
     FIntRect SourceRect;
     EPixelFormat ReadbackPixelFormat;
     FIntPoint ReadbackSize;
+
+    /// The readback pixel format to use instead of the source texture's format, see SetReadbackPixelFormat
+    EPixelFormat OverrideReadbackPixelFormat;
+    ENVPixelPackMode PackMode;
+
+    /// NOTE: The ring is only accessed on the rendering thread, the render commands keep a reference to it so it stay valid even after this reader is destroyed
+    TSharedPtr<FNVTextureReadbackRing, ESPMode::ThreadSafe> ReadbackRing;
 };
 
 class UTextureRenderTarget2D;
@@ -131,6 +352,7 @@ public:
 
     virtual bool ReadPixelsData(FNVTexturePixelData& OutPixelData) final;
     virtual bool ReadPixelsData(OnFinishedReadingPixelsDataCallback Callback, bool bIgnoreAlpha = false) final;
+    virtual bool BuildReadbackRequest(OnFinishedReadingPixelsDataCallback Callback, bool bIgnoreAlpha, FNVTextureReadbackRequest& OutRequest) final;
 
 protected:
     void UpdateTextureFromRenderTarget();